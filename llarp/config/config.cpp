@@ -39,6 +39,10 @@ namespace llarp
   {
     constexpr Default DefaultJobQueueSize{1024 * 8};
     constexpr Default DefaultWorkerThreads{0};
+    constexpr int DefaultLinkCryptoThreadsForRouter = 0;
+    constexpr int DefaultLinkCryptoThreadsForClient = 1;
+    constexpr Default DefaultPinLinkCryptoThreads{false};
+    constexpr Default DefaultTransitThreads{2};
     constexpr Default DefaultBlockBogons{true};
 
     conf.defineOption<int>(
@@ -177,6 +181,52 @@ namespace llarp
           m_workerThreads = arg;
         });
 
+    conf.defineOption<int>(
+        "router",
+        "link-crypto-threads",
+        Default{
+            params.isRelay ? DefaultLinkCryptoThreadsForRouter
+                           : DefaultLinkCryptoThreadsForClient},
+        Comment{
+            "The number of dedicated threads used to encrypt and decrypt link layer traffic.",
+            "Each peer session is always handled by the same thread so its packets stay in order.",
+            "0 means use the number of logical CPU cores detected at startup.",
+            "Clients only talk to a few routers and default to a single thread.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("link-crypto-threads must be >= 0");
+
+          m_linkCryptoThreads = arg;
+        });
+
+    conf.defineOption<bool>(
+        "router",
+        "pin-link-crypto-threads",
+        DefaultPinLinkCryptoThreads,
+        Comment{
+            "If enabled each link crypto thread is pinned to its own logical CPU core.",
+        },
+        AssignmentAcceptor(m_pinLinkCryptoThreads));
+
+    conf.defineOption<int>(
+        "router",
+        "transit-threads",
+        DefaultTransitThreads,
+        Comment{
+            "The number of dedicated threads used to forward traffic on paths through this router.",
+            "Each path is always handled by the same thread so its traffic stays in order.",
+            "0 means use the number of logical CPU cores detected at startup, on top of the",
+            "link crypto threads, so only use it on a router with cores to spare.",
+            "Only used by service nodes.",
+        },
+        [this](int arg) {
+          if (arg < 0)
+            throw std::invalid_argument("transit-threads must be >= 0");
+
+          m_transitThreads = arg;
+        });
+
     // Hidden option because this isn't something that should ever be turned off occasionally when
     // doing dev/testing work.
     conf.defineOption<bool>(
@@ -429,6 +479,36 @@ namespace llarp
           m_Paths = arg;
         });
 
+    conf.defineOption<std::string>(
+        "network",
+        "path-selection",
+        ClientOnly,
+        Default{"power-of-two"},
+        Comment{
+            "How to spread traffic over our paths, using the round trip time and loss each path",
+            "has shown on its latency probes:",
+            "  random - any path, ignoring how it performs",
+            "  weighted - at random, weighted towards the faster paths",
+            "  power-of-two - the faster of two paths picked at random",
+        },
+        [this](std::string arg) { m_PathSelection = path::ParsePathSelection(arg); });
+
+    conf.defineOption<int>(
+        "network",
+        "multipath",
+        ClientOnly,
+        Default{1},
+        Comment{
+            "Number of paths to stripe each session's traffic over, for bulk transfers to a",
+            "single remote. Each path gets traffic in proportion to its round trip time and how",
+            "much it has been dropping. 1 sends over one path at a time. Max 8.",
+        },
+        [this](int arg) {
+          if (arg < 1 or arg > 8)
+            throw std::invalid_argument("[network]:multipath must be >= 1 and <= 8");
+          m_MultipathLanes = arg;
+        });
+
     conf.defineOption<bool>(
         "network",
         "exit",
@@ -607,6 +687,33 @@ namespace llarp
           }
         });
 
+    conf.defineOption<int>(
+        "network",
+        "tun-queues",
+        Default{1},
+        Comment{
+            "Number of queues to read the interface on, each on a thread of its own (linux only).",
+            "The kernel keeps each flow on one queue. More than one spreads reading a busy",
+            "interface, such as an exit's, over several cores.",
+        },
+        [this](int arg) {
+          if (arg < 1 or arg > 64)
+            throw std::invalid_argument("[network]:tun-queues must be >= 1 and <= 64");
+          m_TunQueues = arg;
+        });
+
+    conf.defineOption<bool>(
+        "network",
+        "tun-offload",
+        Default{false},
+        Comment{
+            "Have the kernel hand the interface tcp super packets of up to 64KiB, which we cut",
+            "into packets as we read them, and take runs of tcp segments we write coalesced into",
+            "one (linux only). Saves syscalls and kernel work on busy tcp flows; every segment",
+            "is still framed and sent over the network on its own.",
+        },
+        AssignmentAcceptor(m_TunOffload));
+
     conf.defineOption<std::string>(
         "network",
         "ip6-range",
@@ -12,6 +12,7 @@
 #include <llarp/net/ip_address.hpp>
 #include <llarp/net/net_int.hpp>
 #include <llarp/net/ip_range_map.hpp>
+#include <llarp/path/path_scheduler.hpp>
 #include <llarp/service/address.hpp>
 #include <llarp/service/auth.hpp>
 #include <llarp/dns/srv_data.hpp>
@@ -60,6 +61,11 @@ namespace llarp
     int m_workerThreads = -1;
     int m_numNetThreads = -1;
 
+    int m_linkCryptoThreads = 1;
+    bool m_pinLinkCryptoThreads = false;
+
+    int m_transitThreads = 2;
+
     size_t m_JobQueueSize = 0;
 
     std::string m_routerContactFile;
@@ -99,12 +105,16 @@ namespace llarp
     std::set<RouterID> m_strictConnect;
     std::string m_ifname;
     IPRange m_ifaddr;
+    size_t m_TunQueues = 1;
+    bool m_TunOffload = false;
 
     std::optional<fs::path> m_keyfile;
     std::string m_endpointType;
     bool m_reachable = false;
     std::optional<int> m_Hops;
     std::optional<int> m_Paths;
+    std::optional<path::PathSelection> m_PathSelection;
+    size_t m_MultipathLanes = 1;
     bool m_AllowExit = false;
     std::set<RouterID> m_snodeBlacklist;
     net::IPRangeMap<service::Address> m_ExitMap;
@@ -4,4 +4,21 @@ namespace llarp
 {
   /// default queue length for logic jobs
   constexpr std::size_t event_loop_queue_size = 1024;
+
+  /// max number of datagrams read or written per recvmmsg/sendmmsg call on batched udp sockets
+  constexpr std::size_t udp_batch_size = 64;
+
+  /// max number of recvmmsg calls made per wakeup on batched udp sockets, so that a flood on one
+  /// socket cannot starve the rest of the event loop
+  constexpr std::size_t udp_batch_max_rounds = 8;
+
+  /// max number of datagrams a batched udp socket holds on to while its send buffer is full, to
+  /// send once it becomes writable; datagrams past this are dropped
+  constexpr std::size_t udp_batch_send_queue_size = 1024;
+
+  /// size of each preallocated receive buffer on batched udp sockets
+  constexpr std::size_t udp_batch_max_datagram_size = 2048;
+
+  /// max number of packets read off a network interface per call of its packet handler
+  constexpr std::size_t vpn_batch_size = 64;
 }  // namespace llarp
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "constants.hpp"
+#include "crypto_batch.hpp"
 #include "types.hpp"
 
 #include <llarp/util/buffer.hpp>
@@ -36,6 +37,10 @@ namespace llarp
     xchacha20_alt(
         const llarp_buffer_t&, const llarp_buffer_t&, const SharedSecret&, const byte_t*) = 0;
 
+    /// xchacha symmetric cipher over a batch of buffers sharing one key, each with its own nonce
+    virtual bool
+    xchacha20_batch(CryptoBatchItem*, size_t, const SharedSecret&) = 0;
+
     /// path dh creator's side
     virtual bool
     dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) = 0;
@@ -54,6 +59,9 @@ namespace llarp
     /// blake2s 256 bit "hmac" (keyed hash)
     virtual bool
     hmac(byte_t*, const llarp_buffer_t&, const SharedSecret&) = 0;
+    /// keyed hash of a batch of buffers sharing one key, each written to its digest
+    virtual bool
+    hmac_batch(const CryptoBatchItem*, size_t, const SharedSecret&) = 0;
     /// ed25519 sign
     virtual bool
     sign(Signature&, const SecretKey&, const llarp_buffer_t&) = 0;
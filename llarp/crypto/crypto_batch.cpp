@@ -0,0 +1,75 @@
+#include "crypto_batch.hpp"
+
+namespace llarp::simd
+{
+  namespace
+  {
+    enum class Backend
+    {
+      None,
+      AVX2,
+      AVX512
+    };
+
+    /// true if the kernel was compiled in; it processes an empty buffer, stubs process nothing
+    bool
+    HasKernel(size_t (*kernel)(CryptoBatchItem*, size_t, const uint8_t*))
+    {
+      const uint8_t key[32]{};
+      const uint8_t nonce[24]{};
+      uint8_t data[1]{};
+      CryptoBatchItem item{data, 0, nonce, nullptr};
+      return kernel(&item, 1, key) == 1;
+    }
+
+    Backend
+    DetectBackend()
+    {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f") and HasKernel(&xchacha20_xor_avx512))
+        return Backend::AVX512;
+      if (__builtin_cpu_supports("avx2") and HasKernel(&xchacha20_xor_avx2))
+        return Backend::AVX2;
+#endif
+      return Backend::None;
+    }
+
+    Backend
+    GetBackend()
+    {
+      static const Backend backend = DetectBackend();
+      return backend;
+    }
+  }  // namespace
+
+  const char*
+  xchacha20_backend()
+  {
+    switch (GetBackend())
+    {
+      case Backend::AVX512:
+        return "avx512";
+      case Backend::AVX2:
+        return "avx2";
+      default:
+        return "none";
+    }
+  }
+
+  size_t
+  xchacha20_xor(CryptoBatchItem* items, size_t num, const uint8_t* key)
+  {
+    // a lone buffer gains nothing from running in one lane of a multi-lane kernel
+    if (num < 2)
+      return 0;
+    const auto backend = GetBackend();
+    size_t done = 0;
+    if (backend == Backend::AVX512 and num >= 16)
+      done = xchacha20_xor_avx512(items, num - (num % 16), key);
+    // avx512 implies avx2, which picks up the tail
+    if (backend != Backend::None and num - done >= 2)
+      done += xchacha20_xor_avx2(items + done, num - done, key);
+    return done;
+  }
+}  // namespace llarp::simd
@@ -0,0 +1,45 @@
+#pragma once
+
+// kept free of anything but plain C types: it is included by translation units built with
+// -mavx2/-mavx512f, and any inline template they instantiate could end up used on cpus without
+// those extensions.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llarp
+{
+  /// one buffer of a batched symmetric crypto call (Crypto::xchacha20_batch / hmac_batch)
+  struct CryptoBatchItem
+  {
+    /// buffer transformed in place by xchacha20_batch, or hashed by hmac_batch
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    /// xchacha20_batch: 24 byte nonce for this buffer
+    const uint8_t* nonce = nullptr;
+    /// hmac_batch: where the 32 byte keyed hash of this buffer is written
+    uint8_t* digest = nullptr;
+  };
+
+  namespace simd
+  {
+    /// name of the widest multi-lane xchacha20 kernel usable on this cpu, or "none"
+    const char*
+    xchacha20_backend();
+
+    /// libsodium compatible crypto_stream_xchacha20_xor of many buffers sharing one 32 byte key,
+    /// each with its own nonce, in place.  buffers are processed several at a time, one per simd
+    /// lane.  returns how many leading items were processed; the caller handles the rest (all of
+    /// them if this cpu has no usable kernel).
+    size_t
+    xchacha20_xor(CryptoBatchItem* items, size_t num, const uint8_t* key);
+
+    /// 8 lane kernel; returns 0 if it was not compiled in
+    size_t
+    xchacha20_xor_avx2(CryptoBatchItem* items, size_t num, const uint8_t* key);
+
+    /// 16 lane kernel; returns 0 if it was not compiled in
+    size_t
+    xchacha20_xor_avx512(CryptoBatchItem* items, size_t num, const uint8_t* key);
+  }  // namespace simd
+}  // namespace llarp
@@ -90,6 +90,7 @@ namespace llarp
       if (avx2 && std::string(avx2) == "1")
       {
         ntru_init(1);
+        m_SimdBatch = false;
       }
       else
       {
@@ -149,6 +150,19 @@ namespace llarp
       return crypto_stream_xchacha20_xor(out.base, in.base, in.sz, n, k.data()) == 0;
     }
 
+    bool
+    CryptoLibSodium::xchacha20_batch(CryptoBatchItem* items, size_t num, const SharedSecret& k)
+    {
+      size_t idx = m_SimdBatch ? simd::xchacha20_xor(items, num, k.data()) : 0;
+      for (; idx < num; ++idx)
+      {
+        auto& item = items[idx];
+        if (crypto_stream_xchacha20_xor(item.data, item.data, item.size, item.nonce, k.data()) != 0)
+          return false;
+      }
+      return true;
+    }
+
     bool
     CryptoLibSodium::dh_client(
         llarp::SharedSecret& shared, const PubKey& pk, const SecretKey& sk, const TunnelNonce& n)
@@ -193,6 +207,23 @@ namespace llarp
           != -1;
     }
 
+    bool
+    CryptoLibSodium::hmac_batch(
+        const CryptoBatchItem* items, size_t num, const SharedSecret& secret)
+    {
+      // libsodium already picks its fastest blake2b compression function for this cpu, and a
+      // keyed blake2b over ~1.5KB is dominated by it
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        const auto& item = items[idx];
+        if (crypto_generichash_blake2b(
+                item.digest, HMACSIZE, item.data, item.size, secret.data(), HMACSECSIZE)
+            == -1)
+          return false;
+      }
+      return true;
+    }
+
     static bool
     hash(uint8_t* result, const llarp_buffer_t& buff)
     {
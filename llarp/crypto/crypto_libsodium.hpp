@@ -29,6 +29,10 @@ namespace llarp
           const SharedSecret&,
           const byte_t*) override;
 
+      /// xchacha symmetric cipher over a batch, several buffers at once with avx2/avx512
+      bool
+      xchacha20_batch(CryptoBatchItem*, size_t, const SharedSecret&) override;
+
       /// path dh creator's side
       bool
       dh_client(SharedSecret&, const PubKey&, const SecretKey&, const TunnelNonce&) override;
@@ -49,6 +53,9 @@ namespace llarp
       /// blake2s 256 bit hmac
       bool
       hmac(byte_t*, const llarp_buffer_t&, const SharedSecret&) override;
+      /// blake2b keyed hash of a batch
+      bool
+      hmac_batch(const CryptoBatchItem*, size_t, const SharedSecret&) override;
       /// ed25519 sign
       bool
       sign(Signature&, const SecretKey&, const llarp_buffer_t&) override;
@@ -107,6 +114,10 @@ namespace llarp
 
       bool
       check_passwd_hash(std::string pwhash, std::string challenge) override;
+
+     private:
+      /// false if AVX2_FORCE_DISABLE=1, keeps xchacha20_batch on libsodium
+      bool m_SimdBatch = true;
     };
   }  // namespace sodium
 
@@ -0,0 +1,153 @@
+#include "crypto_batch.hpp"
+
+#ifdef __AVX2__
+
+#include "xchacha20_simd.hpp"
+
+namespace llarp::simd
+{
+  namespace
+  {
+    constexpr size_t Lanes = 8;
+
+    inline __m256i
+    Rotl16(__m256i x)
+    {
+      const __m256i shuf = _mm256_setr_epi8(
+          2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+          2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+      return _mm256_shuffle_epi8(x, shuf);
+    }
+
+    inline __m256i
+    Rotl8(__m256i x)
+    {
+      const __m256i shuf = _mm256_setr_epi8(
+          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+      return _mm256_shuffle_epi8(x, shuf);
+    }
+
+    template <int N>
+    inline __m256i
+    Rotl(__m256i x)
+    {
+      return _mm256_or_si256(_mm256_slli_epi32(x, N), _mm256_srli_epi32(x, 32 - N));
+    }
+
+    inline void
+    QuarterRound(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+    {
+      a = _mm256_add_epi32(a, b);
+      d = Rotl16(_mm256_xor_si256(d, a));
+      c = _mm256_add_epi32(c, d);
+      b = Rotl<12>(_mm256_xor_si256(b, c));
+      a = _mm256_add_epi32(a, b);
+      d = Rotl8(_mm256_xor_si256(d, a));
+      c = _mm256_add_epi32(c, d);
+      b = Rotl<7>(_mm256_xor_si256(b, c));
+    }
+
+    /// the 20 chacha rounds over 8 independent states, one per lane
+    inline void
+    Rounds(__m256i* x)
+    {
+      for (int round = 0; round < 10; ++round)
+      {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+      }
+    }
+
+    /// one 32 bit word per lane, read at offset of each lane's nonce
+    inline __m256i
+    GatherNonce(const uint8_t* const* nonces, size_t offset)
+    {
+      return _mm256_setr_epi32(
+          Load32(nonces[0] + offset),
+          Load32(nonces[1] + offset),
+          Load32(nonces[2] + offset),
+          Load32(nonces[3] + offset),
+          Load32(nonces[4] + offset),
+          Load32(nonces[5] + offset),
+          Load32(nonces[6] + offset),
+          Load32(nonces[7] + offset));
+    }
+
+    /// xchacha20 over 1 to 8 items, one per lane; unused lanes recompute the first item's
+    /// keystream and are discarded
+    void
+    Kernel(CryptoBatchItem* items, size_t num, const uint8_t* key)
+    {
+      const uint8_t* nonces[Lanes];
+      for (size_t lane = 0; lane < Lanes; ++lane)
+        nonces[lane] = items[lane < num ? lane : 0].nonce;
+
+      // hchacha20(key, nonce[0..16]) gives every lane its own chacha20 subkey
+      __m256i x[16];
+      for (size_t idx = 0; idx < 4; ++idx)
+        x[idx] = _mm256_set1_epi32(ChaChaSigma[idx]);
+      for (size_t idx = 0; idx < 8; ++idx)
+        x[4 + idx] = _mm256_set1_epi32(Load32(key + 4 * idx));
+      for (size_t idx = 0; idx < 4; ++idx)
+        x[12 + idx] = GatherNonce(nonces, 4 * idx);
+      Rounds(x);
+
+      // chacha20 (64 bit counter) with the subkey and nonce[16..24]
+      __m256i state[16];
+      for (size_t idx = 0; idx < 4; ++idx)
+      {
+        state[idx] = _mm256_set1_epi32(ChaChaSigma[idx]);
+        state[4 + idx] = x[idx];
+        state[8 + idx] = x[12 + idx];
+      }
+      state[14] = GatherNonce(nonces, 16);
+      state[15] = GatherNonce(nonces, 20);
+
+      const size_t blocks = MaxBlocks(items, num);
+      for (size_t block = 0; block < blocks; ++block)
+      {
+        state[12] = _mm256_set1_epi32(static_cast<uint32_t>(block));
+        state[13] = _mm256_set1_epi32(static_cast<uint32_t>(uint64_t{block} >> 32));
+        for (size_t idx = 0; idx < 16; ++idx)
+          x[idx] = state[idx];
+        Rounds(x);
+        for (size_t idx = 0; idx < 16; ++idx)
+          x[idx] = _mm256_add_epi32(x[idx], state[idx]);
+
+        __m256i lo[Lanes], hi[Lanes];
+        Transpose8x8(x, lo);
+        Transpose8x8(x + 8, hi);
+        for (size_t lane = 0; lane < num; ++lane)
+          XorBlock(items[lane], block, lo[lane], hi[lane]);
+      }
+    }
+  }  // namespace
+
+  size_t
+  xchacha20_xor_avx2(CryptoBatchItem* items, size_t num, const uint8_t* key)
+  {
+    for (size_t idx = 0; idx < num; idx += Lanes)
+      Kernel(items + idx, num - idx < Lanes ? num - idx : Lanes, key);
+    return num;
+  }
+}  // namespace llarp::simd
+
+#else
+
+namespace llarp::simd
+{
+  size_t
+  xchacha20_xor_avx2(CryptoBatchItem*, size_t, const uint8_t*)
+  {
+    return 0;
+  }
+}  // namespace llarp::simd
+
+#endif
@@ -0,0 +1,132 @@
+#include "crypto_batch.hpp"
+
+#ifdef __AVX512F__
+
+#include "xchacha20_simd.hpp"
+
+namespace llarp::simd
+{
+  namespace
+  {
+    constexpr size_t Lanes = 16;
+
+    inline void
+    QuarterRound(__m512i& a, __m512i& b, __m512i& c, __m512i& d)
+    {
+      a = _mm512_add_epi32(a, b);
+      d = _mm512_rol_epi32(_mm512_xor_si512(d, a), 16);
+      c = _mm512_add_epi32(c, d);
+      b = _mm512_rol_epi32(_mm512_xor_si512(b, c), 12);
+      a = _mm512_add_epi32(a, b);
+      d = _mm512_rol_epi32(_mm512_xor_si512(d, a), 8);
+      c = _mm512_add_epi32(c, d);
+      b = _mm512_rol_epi32(_mm512_xor_si512(b, c), 7);
+    }
+
+    /// the 20 chacha rounds over 16 independent states, one per lane
+    inline void
+    Rounds(__m512i* x)
+    {
+      for (int round = 0; round < 10; ++round)
+      {
+        QuarterRound(x[0], x[4], x[8], x[12]);
+        QuarterRound(x[1], x[5], x[9], x[13]);
+        QuarterRound(x[2], x[6], x[10], x[14]);
+        QuarterRound(x[3], x[7], x[11], x[15]);
+        QuarterRound(x[0], x[5], x[10], x[15]);
+        QuarterRound(x[1], x[6], x[11], x[12]);
+        QuarterRound(x[2], x[7], x[8], x[13]);
+        QuarterRound(x[3], x[4], x[9], x[14]);
+      }
+    }
+
+    /// one 32 bit word per lane, read at offset of each lane's nonce
+    inline __m512i
+    GatherNonce(const uint8_t* const* nonces, size_t offset)
+    {
+      alignas(64) uint32_t words[Lanes];
+      for (size_t lane = 0; lane < Lanes; ++lane)
+        words[lane] = Load32(nonces[lane] + offset);
+      return _mm512_load_si512(words);
+    }
+
+    /// xchacha20 over 1 to 16 items, one per lane; unused lanes recompute the first item's
+    /// keystream and are discarded
+    void
+    Kernel(CryptoBatchItem* items, size_t num, const uint8_t* key)
+    {
+      const uint8_t* nonces[Lanes];
+      for (size_t lane = 0; lane < Lanes; ++lane)
+        nonces[lane] = items[lane < num ? lane : 0].nonce;
+
+      // hchacha20(key, nonce[0..16]) gives every lane its own chacha20 subkey
+      __m512i x[16];
+      for (size_t idx = 0; idx < 4; ++idx)
+        x[idx] = _mm512_set1_epi32(ChaChaSigma[idx]);
+      for (size_t idx = 0; idx < 8; ++idx)
+        x[4 + idx] = _mm512_set1_epi32(Load32(key + 4 * idx));
+      for (size_t idx = 0; idx < 4; ++idx)
+        x[12 + idx] = GatherNonce(nonces, 4 * idx);
+      Rounds(x);
+
+      // chacha20 (64 bit counter) with the subkey and nonce[16..24]
+      __m512i state[16];
+      for (size_t idx = 0; idx < 4; ++idx)
+      {
+        state[idx] = _mm512_set1_epi32(ChaChaSigma[idx]);
+        state[4 + idx] = x[idx];
+        state[8 + idx] = x[12 + idx];
+      }
+      state[14] = GatherNonce(nonces, 16);
+      state[15] = GatherNonce(nonces, 20);
+
+      const size_t blocks = MaxBlocks(items, num);
+      for (size_t block = 0; block < blocks; ++block)
+      {
+        state[12] = _mm512_set1_epi32(static_cast<uint32_t>(block));
+        state[13] = _mm512_set1_epi32(static_cast<uint32_t>(uint64_t{block} >> 32));
+        for (size_t idx = 0; idx < 16; ++idx)
+          x[idx] = state[idx];
+        Rounds(x);
+
+        // split into lanes 0..7 and 8..15 and transpose each half with the avx2 helper
+        __m256i rows[2][16];
+        for (size_t idx = 0; idx < 16; ++idx)
+        {
+          const __m512i word = _mm512_add_epi32(x[idx], state[idx]);
+          rows[0][idx] = _mm512_castsi512_si256(word);
+          rows[1][idx] = _mm512_extracti64x4_epi64(word, 1);
+        }
+        for (size_t half = 0; half < 2; ++half)
+        {
+          __m256i lo[8], hi[8];
+          Transpose8x8(rows[half], lo);
+          Transpose8x8(rows[half] + 8, hi);
+          for (size_t lane = 0; lane < 8 and half * 8 + lane < num; ++lane)
+            XorBlock(items[half * 8 + lane], block, lo[lane], hi[lane]);
+        }
+      }
+    }
+  }  // namespace
+
+  size_t
+  xchacha20_xor_avx512(CryptoBatchItem* items, size_t num, const uint8_t* key)
+  {
+    for (size_t idx = 0; idx < num; idx += Lanes)
+      Kernel(items + idx, num - idx < Lanes ? num - idx : Lanes, key);
+    return num;
+  }
+}  // namespace llarp::simd
+
+#else
+
+namespace llarp::simd
+{
+  size_t
+  xchacha20_xor_avx512(CryptoBatchItem*, size_t, const uint8_t*)
+  {
+    return 0;
+  }
+}  // namespace llarp::simd
+
+#endif
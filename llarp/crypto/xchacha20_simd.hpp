@@ -0,0 +1,95 @@
+#pragma once
+
+// helpers shared by the multi-lane xchacha20 kernels; only include from translation units built
+// with -mavx2 (or wider).
+
+#include "crypto_batch.hpp"
+
+#include <cstring>
+#include <immintrin.h>
+
+namespace llarp::simd
+{
+  /// "expand 32-byte k"
+  static constexpr uint32_t ChaChaSigma[4] = {0x61707865, 0x3320646e, 0x79622d32, 0x6b206574};
+
+  static inline uint32_t
+  Load32(const uint8_t* ptr)
+  {
+    uint32_t val;
+    std::memcpy(&val, ptr, sizeof(val));
+    return val;
+  }
+
+  /// 8x8 transpose of 32 bit words: rows[word] holds that word of 8 lanes, lanes[lane] gets the 8
+  /// words of that lane
+  static inline void
+  Transpose8x8(const __m256i* rows, __m256i* lanes)
+  {
+    const __m256i t0 = _mm256_unpacklo_epi32(rows[0], rows[1]);
+    const __m256i t1 = _mm256_unpackhi_epi32(rows[0], rows[1]);
+    const __m256i t2 = _mm256_unpacklo_epi32(rows[2], rows[3]);
+    const __m256i t3 = _mm256_unpackhi_epi32(rows[2], rows[3]);
+    const __m256i t4 = _mm256_unpacklo_epi32(rows[4], rows[5]);
+    const __m256i t5 = _mm256_unpackhi_epi32(rows[4], rows[5]);
+    const __m256i t6 = _mm256_unpacklo_epi32(rows[6], rows[7]);
+    const __m256i t7 = _mm256_unpackhi_epi32(rows[6], rows[7]);
+
+    const __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    const __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    const __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    const __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    const __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    const __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    const __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    const __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+
+    lanes[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    lanes[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    lanes[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    lanes[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    lanes[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    lanes[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    lanes[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    lanes[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+  }
+
+  /// xor one 64 byte keystream block (lo = bytes 0..31, hi = bytes 32..63) into block number
+  /// `block` of item, handling the short final block
+  static inline void
+  XorBlock(CryptoBatchItem& item, size_t block, __m256i lo, __m256i hi)
+  {
+    const size_t offset = block * 64;
+    if (offset >= item.size)
+      return;
+    uint8_t* ptr = item.data + offset;
+    const size_t remain = item.size - offset;
+    if (remain >= 64)
+    {
+      const __m256i* in = reinterpret_cast<const __m256i*>(ptr);
+      __m256i* out = reinterpret_cast<__m256i*>(ptr);
+      _mm256_storeu_si256(out, _mm256_xor_si256(_mm256_loadu_si256(in), lo));
+      _mm256_storeu_si256(out + 1, _mm256_xor_si256(_mm256_loadu_si256(in + 1), hi));
+      return;
+    }
+    alignas(32) uint8_t stream[64];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(stream), lo);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(stream + 32), hi);
+    for (size_t idx = 0; idx < remain; ++idx)
+      ptr[idx] ^= stream[idx];
+  }
+
+  /// number of 64 byte blocks needed for the longest of num items
+  static inline size_t
+  MaxBlocks(const CryptoBatchItem* items, size_t num)
+  {
+    size_t blocks = 0;
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      const size_t need = (items[idx].size + 63) / 64;
+      if (need > blocks)
+        blocks = need;
+    }
+    return blocks;
+  }
+}  // namespace llarp::simd
@@ -1,4 +1,5 @@
 #include "ev.hpp"
+#include <llarp/net/ip_packet.hpp>
 #include <llarp/util/mem.hpp>
 #include <llarp/util/str.hpp>
 
@@ -16,4 +17,17 @@ namespace llarp
   {
     return std::make_shared<llarp::uv::Loop>(queueLength);
   }
+
+  bool
+  EventLoop::add_network_interface(
+      std::shared_ptr<vpn::NetworkInterface> netif,
+      std::function<void(net::IPPacket)> packetHandler)
+  {
+    return add_network_interface(
+        std::move(netif),
+        [handler = std::move(packetHandler)](net::IPPacket* pkts, size_t num) {
+          for (size_t idx = 0; idx < num; ++idx)
+            handler(std::move(pkts[idx]));
+        });
+  }
 }  // namespace llarp
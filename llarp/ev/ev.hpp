@@ -10,6 +10,7 @@
 #include <list>
 #include <future>
 #include <utility>
+#include <vector>
 
 namespace uvw
 {
@@ -20,6 +21,7 @@ namespace llarp
 {
   struct SockAddr;
   struct UDPHandle;
+  struct UDPDatagram;
 
   namespace vpn
   {
@@ -171,10 +173,19 @@ namespace llarp
       };
     }
 
+    /// packets read off a network interface in one go, which the handler may move from
+    using PacketBatchHandler = std::function<void(net::IPPacket* pkts, size_t num)>;
+
+    /// hand everything netif has ready to batchHandler whenever it is readable, in batches
     virtual bool
+    add_network_interface(
+        std::shared_ptr<vpn::NetworkInterface> netif, PacketBatchHandler batchHandler) = 0;
+
+    /// hand what netif reads to packetHandler a packet at a time
+    bool
     add_network_interface(
         std::shared_ptr<vpn::NetworkInterface> netif,
-        std::function<void(net::IPPacket)> packetHandler) = 0;
+        std::function<void(net::IPPacket)> packetHandler);
 
     virtual bool
     add_ticker(std::function<void(void)> ticker) = 0;
@@ -186,10 +197,21 @@ namespace llarp
 
     using UDPReceiveFunc = std::function<void(UDPHandle&, SockAddr src, llarp::OwnedBuffer buf)>;
 
+    // Receive callback for batched UDP sockets: invoked once per wakeup with every datagram that
+    // was drained from the socket.  The datagram payloads point into buffers owned by the
+    // UDPHandle and are only valid for the duration of the callback.
+    using UDPReceiveBatchFunc = std::function<void(UDPHandle&, const std::vector<UDPDatagram>&)>;
+
     // Constructs a UDP socket that can be used for sending and/or receiving
     virtual std::shared_ptr<UDPHandle>
     make_udp(UDPReceiveFunc on_recv) = 0;
 
+    // Constructs a UDP socket that drains incoming datagrams in batches (using recvmmsg where the
+    // platform supports it; otherwise batches of one are delivered).  Datagrams larger than
+    // `udp_batch_max_datagram_size` are dropped.
+    virtual std::shared_ptr<UDPHandle>
+    make_batched_udp(UDPReceiveBatchFunc on_recv) = 0;
+
     /// Make a thread-safe event loop waker (an "async" in libuv terminology) on this event loop;
     /// you can call `->Trigger()` on the returned shared pointer to fire the callback at the next
     /// available event loop iteration.  (Multiple Trigger calls invoked before the call is actually
@@ -1,15 +1,28 @@
 #include "ev_libuv.hpp"
 #include "vpn.hpp"
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <type_traits>
 #include <llarp/util/thread/queue.hpp>
+#include <llarp/link/packet_buffer.hpp>
 
 #include <cstring>
 #include "ev.hpp"
 
 #include <uvw.hpp>
 
+#ifdef __linux__
+#include <deque>
+#include <sys/socket.h>
+#include <array>
+#endif
+
+#ifndef _WIN32
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
 namespace llarp::uv
 {
   std::shared_ptr<uvw::Loop>
@@ -62,16 +75,36 @@ namespace llarp::uv
     }
   };
 
+#ifdef __linux__
+  // Preallocated recvmmsg/sendmmsg state for batched udp sockets; reused on every wakeup so that
+  // steady state batched io does no allocations.
+  struct MMsgState
+  {
+    std::array<mmsghdr, udp_batch_size> msgs;
+    std::array<iovec, udp_batch_size> iovs;
+    std::array<sockaddr_storage, udp_batch_size> addrs;
+    std::vector<byte_t> storage = std::vector<byte_t>(udp_batch_size * udp_batch_max_datagram_size);
+  };
+#endif
+
   struct UDPHandle final : llarp::UDPHandle
   {
     UDPHandle(uvw::Loop& loop, ReceiveFunc rf);
 
+    UDPHandle(uvw::Loop& loop, ReceiveBatchFunc rf);
+
     bool
     listen(const SockAddr& addr) override;
 
     bool
     send(const SockAddr& dest, const llarp_buffer_t& buf) override;
 
+    UDPSendResult
+    send_batch(const std::vector<UDPDatagram>& pkts) override;
+
+    bool
+    set_dont_fragment() override;
+
     std::optional<int>
     file_descriptor() override
     {
@@ -90,6 +123,51 @@ namespace llarp::uv
    private:
     std::shared_ptr<uvw::UDPHandle> handle;
 
+    // Datagrams handed to on_recv_batch; reused between wakeups.
+    std::vector<UDPDatagram> recv_batch;
+
+#ifdef __linux__
+    // In batched mode we never start libuv's own receive on the udp handle (which would read one
+    // datagram per callback); instead we poll the bound socket and drain it with recvmmsg.  Since
+    // the uv_udp_t only ever does synchronous (try_) sends its io watcher stays inactive, so the
+    // poll handle is the only watcher of the fd.
+    std::shared_ptr<uvw::PollHandle> poller;
+    std::unique_ptr<MMsgState> recv_state;
+    std::unique_ptr<MMsgState> send_state;
+    std::mutex send_mutex;
+
+    // Datagrams a full send buffer left unsent, oldest first, sent from the poll handle once the
+    // socket is writable again.  Guarded by send_mutex.
+    struct QueuedDatagram
+    {
+      SockAddr addr;
+      PacketBuffer data;
+    };
+    std::deque<QueuedDatagram> send_queue;
+    // what queued datagrams are copied into
+    PacketBufferPool send_buffers;
+    // sends can come from any thread but the poll handle may only be restarted on the loop, so
+    // a send that queues wakes the loop with this to watch for the socket becoming writable
+    std::shared_ptr<uvw::AsyncHandle> send_wakeup;
+
+    void
+    drain_batch();
+
+    // hands pkts to sendmmsg until all are sent or skipped or the send buffer is full, adding
+    // how many went out to sent; returns how many datagrams were consumed
+    size_t
+    send_now(int fd, const UDPDatagram* pkts, size_t num, size_t& sent);
+
+    // queues what is left of a batch the send buffer had no room for, up to
+    // udp_batch_send_queue_size; returns how many were queued.  send_mutex must be held.
+    size_t
+    queue_unsent(const UDPDatagram* pkts, size_t num);
+
+    // sends what the queue holds now that the socket is writable; called on the loop
+    void
+    flush_send_queue();
+#endif
+
     void
     reset_handle(uvw::Loop& loop);
   };
@@ -167,6 +245,13 @@ namespace llarp::uv
         std::make_shared<llarp::uv::UDPHandle>(*m_Impl, std::move(on_recv)));
   }
 
+  std::shared_ptr<llarp::UDPHandle>
+  Loop::make_batched_udp(UDPReceiveBatchFunc on_recv)
+  {
+    return std::static_pointer_cast<llarp::UDPHandle>(
+        std::make_shared<llarp::uv::UDPHandle>(*m_Impl, std::move(on_recv)));
+  }
+
   static void
   setup_oneshot_timer(uvw::Loop& loop, llarp_time_t delay, std::function<void()> callback)
   {
@@ -234,8 +319,7 @@ namespace llarp::uv
 
   bool
   Loop::add_network_interface(
-      std::shared_ptr<llarp::vpn::NetworkInterface> netif,
-      std::function<void(llarp::net::IPPacket)> handler)
+      std::shared_ptr<llarp::vpn::NetworkInterface> netif, PacketBatchHandler handler)
   {
 #ifdef __linux__
     using event_t = uvw::PollEvent;
@@ -250,17 +334,27 @@ namespace llarp::uv
     if (!handle)
       return false;
 
-    handle->on<event_t>([netif = std::move(netif), handler = std::move(handler)](
-                            const event_t&, [[maybe_unused]] auto& handle) {
-      for (auto pkt = netif->ReadNextPacket(); pkt.sz > 0; pkt = netif->ReadNextPacket())
+    // packets are move only and uvw wants a listener it can copy, so the batch is shared
+    handle->on<event_t>([netif = std::move(netif),
+                         handler = std::move(handler),
+                         batch = std::make_shared<std::vector<llarp::net::IPPacket>>(
+                             vpn_batch_size)](const event_t&, [[maybe_unused]] auto& handle) {
+      auto& pkts = *batch;
+      for (;;)
       {
-        LogDebug("got packet ", pkt.sz);
+        const auto num = netif->ReadPackets(pkts.data(), pkts.size());
+        if (num == 0)
+          break;
+        LogDebug("got ", num, " packets");
         if (handler)
-          handler(std::move(pkt));
+          handler(pkts.data(), num);
         // on windows/apple, vpn packet io does not happen as an io action that wakes up the event
         // loop thus, we must manually wake up the event loop when we get a packet on our interface.
         // on linux this is a nop
         netif->MaybeWakeUpperLayers();
+        // a short batch means there is nothing more ready
+        if (num < pkts.size())
+          break;
       }
     });
 
@@ -296,14 +390,33 @@ namespace llarp::uv
   void
   UDPHandle::reset_handle(uvw::Loop& loop)
   {
+#ifdef __linux__
+    if (send_wakeup)
+    {
+      send_wakeup->close();
+      send_wakeup.reset();
+    }
+    if (poller)
+    {
+      poller->close();
+      poller.reset();
+    }
+#endif
     if (handle)
       handle->close();
     handle = loop.resource<uvw::UDPHandle>();
     handle->on<uvw::UDPDataEvent>([this](auto& event, auto& /*handle*/) {
-      on_recv(
-          *this,
-          SockAddr{event.sender.ip, huint16_t{static_cast<uint16_t>(event.sender.port)}},
-          OwnedBuffer{std::move(event.data), event.length});
+      SockAddr from{event.sender.ip, huint16_t{static_cast<uint16_t>(event.sender.port)}};
+      if (on_recv)
+      {
+        on_recv(*this, std::move(from), OwnedBuffer{std::move(event.data), event.length});
+        return;
+      }
+      // batched handle without recvmmsg support: deliver a batch of one
+      recv_batch.clear();
+      recv_batch.push_back(UDPDatagram{
+          std::move(from), reinterpret_cast<const byte_t*>(event.data.get()), event.length});
+      on_recv_batch(*this, recv_batch);
     });
   }
 
@@ -312,6 +425,17 @@ namespace llarp::uv
     reset_handle(loop);
   }
 
+  llarp::uv::UDPHandle::UDPHandle(uvw::Loop& loop, ReceiveBatchFunc rf)
+      : llarp::UDPHandle{std::move(rf)}
+  {
+    recv_batch.reserve(udp_batch_size);
+#ifdef __linux__
+    recv_state = std::make_unique<MMsgState>();
+    send_state = std::make_unique<MMsgState>();
+#endif
+    reset_handle(loop);
+  }
+
   bool
   UDPHandle::listen(const SockAddr& addr)
   {
@@ -324,12 +448,133 @@ namespace llarp::uv
       good = false;
     });
     handle->bind(*static_cast<const sockaddr*>(addr));
+#ifdef __linux__
+    if (good and on_recv_batch)
+    {
+      if (auto fd = file_descriptor())
+      {
+        poller = handle->loop().resource<uvw::PollHandle>(*fd);
+        poller->on<uvw::PollEvent>([this](const auto& event, auto&) {
+          if (event.flags & uvw::PollHandle::Event::WRITABLE)
+            flush_send_queue();
+          if (event.flags & uvw::PollHandle::Event::READABLE)
+            drain_batch();
+        });
+        poller->start(uvw::PollHandle::Event::READABLE);
+        send_wakeup = handle->loop().resource<uvw::AsyncHandle>();
+        send_wakeup->on<uvw::AsyncEvent>([this](const auto&, auto&) {
+          if (poller)
+            poller->start(
+                uvw::Flags<uvw::PollHandle::Event>{uvw::PollHandle::Event::READABLE}
+                | uvw::PollHandle::Event::WRITABLE);
+        });
+        handle->erase(err);
+        return good;
+      }
+    }
+#endif
     if (good)
       handle->recv();
     handle->erase(err);
     return good;
   }
 
+  bool
+  UDPHandle::set_dont_fragment()
+  {
+#ifndef _WIN32
+    const auto fd = file_descriptor();
+    if (not fd)
+      return false;
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    if (getsockname(*fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+      return false;
+    [[maybe_unused]] const int on = 1;
+    if (addr.ss_family == AF_INET6)
+    {
+#if defined(IPV6_MTU_DISCOVER) && defined(IPV6_PMTUDISC_DO)
+      const int val = IPV6_PMTUDISC_DO;
+      return setsockopt(*fd, IPPROTO_IPV6, IPV6_MTU_DISCOVER, &val, sizeof(val)) == 0;
+#elif defined(IPV6_DONTFRAG)
+      return setsockopt(*fd, IPPROTO_IPV6, IPV6_DONTFRAG, &on, sizeof(on)) == 0;
+#endif
+    }
+    else if (addr.ss_family == AF_INET)
+    {
+#if defined(IP_MTU_DISCOVER) && defined(IP_PMTUDISC_DO)
+      const int val = IP_PMTUDISC_DO;
+      return setsockopt(*fd, IPPROTO_IP, IP_MTU_DISCOVER, &val, sizeof(val)) == 0;
+#elif defined(IP_DONTFRAG)
+      return setsockopt(*fd, IPPROTO_IP, IP_DONTFRAG, &on, sizeof(on)) == 0;
+#endif
+    }
+#endif
+    return false;
+  }
+
+#ifdef __linux__
+  void
+  UDPHandle::drain_batch()
+  {
+    const auto fd = file_descriptor();
+    if (not fd)
+      return;
+    auto& st = *recv_state;
+    for (size_t round = 0; round < udp_batch_max_rounds; ++round)
+    {
+      for (size_t idx = 0; idx < udp_batch_size; ++idx)
+      {
+        st.iovs[idx].iov_base = st.storage.data() + (idx * udp_batch_max_datagram_size);
+        st.iovs[idx].iov_len = udp_batch_max_datagram_size;
+        auto& hdr = st.msgs[idx].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_name = &st.addrs[idx];
+        hdr.msg_namelen = sizeof(sockaddr_storage);
+        hdr.msg_iov = &st.iovs[idx];
+        hdr.msg_iovlen = 1;
+      }
+      const int n = ::recvmmsg(*fd, st.msgs.data(), st.msgs.size(), MSG_DONTWAIT, nullptr);
+      if (n == 0)
+        return;
+      if (n < 0)
+      {
+        // drained
+        if (errno == EAGAIN or errno == EWOULDBLOCK)
+          return;
+        // interrupted or a pending socket error (e.g. an icmp unreachable for an earlier send)
+        // was reported in place of data; there may still be datagrams queued behind it so keep
+        // draining, the round limit bounds how often we retry
+        if (errno != EINTR)
+          LogDebug("recvmmsg failed: ", strerror(errno));
+        continue;
+      }
+      recv_batch.clear();
+      for (int idx = 0; idx < n; ++idx)
+      {
+        const auto& msg = st.msgs[idx];
+        if (msg.msg_hdr.msg_flags & MSG_TRUNC)
+        {
+          LogDebug("dropping oversized datagram");
+          continue;
+        }
+        const auto& from = *reinterpret_cast<const sockaddr*>(&st.addrs[idx]);
+        if (from.sa_family != AF_INET and from.sa_family != AF_INET6)
+          continue;
+        recv_batch.push_back(UDPDatagram{
+            SockAddr{from},
+            static_cast<const byte_t*>(st.iovs[idx].iov_base),
+            static_cast<size_t>(msg.msg_len)});
+      }
+      if (not recv_batch.empty())
+        on_recv_batch(*this, recv_batch);
+      // a short read means the socket is drained
+      if (static_cast<size_t>(n) < udp_batch_size or not poller)
+        return;
+    }
+  }
+#endif
+
   bool
   UDPHandle::send(const SockAddr& to, const llarp_buffer_t& buf)
   {
@@ -340,10 +585,140 @@ namespace llarp::uv
         >= 0;
   }
 
+  UDPSendResult
+  UDPHandle::send_batch(const std::vector<UDPDatagram>& pkts)
+  {
+#ifdef __linux__
+    const auto fd = file_descriptor();
+    if (not send_state or not fd)
+      return llarp::UDPHandle::send_batch(pkts);
+    // sends can come from worker threads (e.g. link layer encryption) so the shared send state
+    // must be guarded
+    std::lock_guard lock{send_mutex};
+    UDPSendResult result;
+    // anything already waiting for the socket goes first, so keep the order and wait behind it
+    size_t consumed = 0;
+    if (send_queue.empty())
+    {
+      consumed = send_now(*fd, pkts.data(), pkts.size(), result.sent);
+      // send_now skips the datagrams the kernel rejects
+      result.dropped = consumed - result.sent;
+    }
+    if (consumed < pkts.size())
+    {
+      result.queued = queue_unsent(pkts.data() + consumed, pkts.size() - consumed);
+      result.dropped += pkts.size() - consumed - result.queued;
+    }
+    return result;
+#else
+    return llarp::UDPHandle::send_batch(pkts);
+#endif
+  }
+
+#ifdef __linux__
+  size_t
+  UDPHandle::send_now(int fd, const UDPDatagram* pkts, size_t num, size_t& sent)
+  {
+    auto& st = *send_state;
+    // index of the next datagram to hand to sendmmsg
+    size_t next = 0;
+    while (next < num)
+    {
+      const size_t batch = std::min(num - next, udp_batch_size);
+      for (size_t idx = 0; idx < batch; ++idx)
+      {
+        const auto& pkt = pkts[next + idx];
+        st.iovs[idx].iov_base = const_cast<byte_t*>(pkt.data);
+        st.iovs[idx].iov_len = pkt.size;
+        auto& hdr = st.msgs[idx].msg_hdr;
+        hdr = msghdr{};
+        hdr.msg_name = const_cast<sockaddr*>(static_cast<const sockaddr*>(pkt.addr));
+        hdr.msg_namelen = pkt.addr.sockaddr_len();
+        hdr.msg_iov = &st.iovs[idx];
+        hdr.msg_iovlen = 1;
+      }
+      const int n = ::sendmmsg(fd, st.msgs.data(), batch, MSG_DONTWAIT);
+      if (n > 0)
+      {
+        // a short send stopped at the datagram that failed, the next call retries from it and
+        // reports its error
+        sent += n;
+        next += n;
+        continue;
+      }
+      if (errno == EINTR)
+        continue;
+      // the send buffer is full; the rest waits for the socket to become writable
+      if (errno == EAGAIN or errno == EWOULDBLOCK or errno == ENOBUFS)
+        break;
+      // this datagram cannot be sent (e.g. unreachable or too big for the route), skip it
+      LogDebug("sendmmsg failed: ", strerror(errno));
+      ++next;
+    }
+    return next;
+  }
+
+  size_t
+  UDPHandle::queue_unsent(const UDPDatagram* pkts, size_t num)
+  {
+    // without a poll handle nothing would ever flush the queue
+    if (not poller or not send_wakeup)
+      return 0;
+    const bool wasEmpty = send_queue.empty();
+    const auto queued = std::min(num, udp_batch_send_queue_size - send_queue.size());
+    for (size_t idx = 0; idx < queued; ++idx)
+      send_queue.push_back(
+          QueuedDatagram{pkts[idx].addr, send_buffers.CopyFrom(pkts[idx].data, pkts[idx].size)});
+    if (wasEmpty and queued)
+      send_wakeup->send();
+    return queued;
+  }
+
+  void
+  UDPHandle::flush_send_queue()
+  {
+    const auto fd = file_descriptor();
+    if (not fd)
+      return;
+    std::lock_guard lock{send_mutex};
+    std::vector<UDPDatagram> pkts;
+    pkts.reserve(udp_batch_size);
+    while (not send_queue.empty())
+    {
+      pkts.clear();
+      for (size_t idx = 0; idx < send_queue.size() and idx < udp_batch_size; ++idx)
+      {
+        const auto& pkt = send_queue[idx];
+        pkts.push_back(UDPDatagram{pkt.addr, pkt.data.data(), pkt.data.size()});
+      }
+      size_t sent = 0;
+      const auto consumed = send_now(*fd, pkts.data(), pkts.size(), sent);
+      send_queue.erase(send_queue.begin(), send_queue.begin() + consumed);
+      // still full, keep watching for room
+      if (consumed < pkts.size())
+        return;
+    }
+    poller->start(uvw::PollHandle::Event::READABLE);
+  }
+#endif
+
   void
   UDPHandle::close()
   {
-    handle->close();
+#ifdef __linux__
+    if (send_wakeup)
+    {
+      send_wakeup->close();
+      send_wakeup.reset();
+    }
+    if (poller)
+    {
+      poller->close();
+      poller.reset();
+    }
+#endif
+    if (handle)
+      handle->close();
     handle.reset();
   }
 
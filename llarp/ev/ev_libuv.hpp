@@ -49,10 +49,12 @@ namespace llarp::uv
     bool
     add_ticker(std::function<void(void)> ticker) override;
 
+    using EventLoop::add_network_interface;
+
     bool
     add_network_interface(
         std::shared_ptr<llarp::vpn::NetworkInterface> netif,
-        std::function<void(llarp::net::IPPacket)> handler) override;
+        PacketBatchHandler handler) override;
 
     void
     call_soon(std::function<void(void)> f) override;
@@ -66,6 +68,9 @@ namespace llarp::uv
     std::shared_ptr<llarp::UDPHandle>
     make_udp(UDPReceiveFunc on_recv) override;
 
+    std::shared_ptr<llarp::UDPHandle>
+    make_batched_udp(UDPReceiveBatchFunc on_recv) override;
+
     void
     FlushLogic();
 
@@ -1,12 +1,40 @@
+#pragma once
+
 #include "ev.hpp"
 #include "../util/buffer.hpp"
+#include "../net/sock_addr.hpp"
+
+#include <vector>
 
 namespace llarp
 {
+  // A single datagram as passed through the batched UDP api.  The payload is not owned by this
+  // struct: for received batches it points into the UDPHandle's receive buffers, for sent batches
+  // it points at the caller's buffer.
+  struct UDPDatagram
+  {
+    SockAddr addr;
+    const byte_t* data;
+    size_t size;
+  };
+
+  // What became of a batch passed to UDPHandle::send_batch; the three add up to the batch size.
+  struct UDPSendResult
+  {
+    // taken by the kernel
+    size_t sent = 0;
+    // copied to go out once a full send buffer has room again; not sent yet, and lost if the
+    // socket closes first
+    size_t queued = 0;
+    // rejected by the kernel (e.g. unreachable or too big for the route), or no room to queue
+    size_t dropped = 0;
+  };
+
   // Base type for UDP handling; constructed via EventLoop::make_udp().
   struct UDPHandle
   {
     using ReceiveFunc = EventLoop::UDPReceiveFunc;
+    using ReceiveBatchFunc = EventLoop::UDPReceiveBatchFunc;
 
     // Starts listening for incoming UDP packets on the given address. Returns true on success,
     // false if the address could not be bound. If you send without calling this first then the
@@ -20,6 +48,34 @@ namespace llarp
     virtual bool
     send(const SockAddr& dest, const llarp_buffer_t& buf) = 0;
 
+    // Sends a batch of packets, each to its own recipient, with as few syscalls as the platform
+    // allows.  A packet that fails to send is dropped and the ones after it are still sent.
+    // Where the platform supports it, packets a full send buffer has no room for are copied and
+    // queued to go out once the socket is writable again.  The default implementation calls
+    // send() for each packet.
+    virtual UDPSendResult
+    send_batch(const std::vector<UDPDatagram>& pkts)
+    {
+      UDPSendResult result;
+      for (const auto& pkt : pkts)
+      {
+        if (send(pkt.addr, llarp_buffer_t{pkt.data, pkt.size}))
+          ++result.sent;
+        else
+          ++result.dropped;
+      }
+      return result;
+    }
+
+    // Sets the don't fragment bit on everything this socket sends from now on, so a datagram too
+    // big for the path is dropped instead of fragmented (path mtu probes rely on this).  Returns
+    // false if the platform or socket does not support it.  Call after listen().
+    virtual bool
+    set_dont_fragment()
+    {
+      return false;
+    }
+
     // Closes the listening UDP socket (if opened); this is typically called (automatically) during
     // destruction.  Does nothing if the UDP socket is already closed.
     virtual void
@@ -43,7 +99,13 @@ namespace llarp
       assert(this->on_recv);
     }
 
-    // Callback to invoke when data is received
+    explicit UDPHandle(ReceiveBatchFunc on_recv_batch) : on_recv_batch{std::move(on_recv_batch)}
+    {
+      assert(this->on_recv_batch);
+    }
+
+    // Callback to invoke when data is received; exactly one of these is set
     ReceiveFunc on_recv;
+    ReceiveBatchFunc on_recv_batch;
   };
 }  // namespace llarp
@@ -32,6 +32,10 @@ namespace llarp::vpn
     std::string ifname;
     huint32_t dnsaddr;
     std::set<InterfaceAddress> addrs;
+    /// how many queues to read the interface on where the platform can, each on its own thread
+    size_t queues = 1;
+    /// have the kernel hand us tcp super packets and take coalesced ones where the platform can
+    bool offload = false;
   };
 
   /// a vpn network interface
@@ -56,11 +60,33 @@ namespace llarp::vpn
     virtual net::IPPacket
     ReadNextPacket() = 0;
 
+    /// read up to num packets into pkts, returns how many we read; fewer than num means there
+    /// are no more ready
+    virtual size_t
+    ReadPackets(net::IPPacket* pkts, size_t num)
+    {
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        pkts[idx] = ReadNextPacket();
+        if (pkts[idx].sz == 0)
+          return idx;
+      }
+      return num;
+    }
+
     /// write a packet to the interface
     /// returns false if we dropped it
     virtual bool
     WritePacket(net::IPPacket pkt) = 0;
 
+    /// write out packets held back to be written together, called once a run of
+    /// WritePacket is done.  returns false if we dropped them
+    virtual bool
+    FlushWrites()
+    {
+      return true;
+    }
+
     /// idempotently wake up the upper layers as needed (platform dependant)
     virtual void
     MaybeWakeUpperLayers() const {};
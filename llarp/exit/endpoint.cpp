@@ -152,7 +152,7 @@ namespace llarp
       {
         return false;
       }
-      m_UpstreamQueue.emplace(pkt, counter);
+      m_UpstreamQueue.emplace(std::move(pkt), counter);
       m_TxRate += buf.underlying.sz;
       m_LastActive = m_Parent->Now();
       return true;
@@ -164,7 +164,8 @@ namespace llarp
       llarp::net::IPPacket pkt{};
       if (type == service::ProtocolType::QUIC)
       {
-        pkt.sz = std::min(buf.underlying.sz, sizeof(pkt.buf));
+        pkt = llarp::net::IPPacket{buf.underlying.sz};
+        pkt.sz = std::min(buf.underlying.sz, pkt.Capacity());
         std::copy_n(buf.underlying.base, pkt.sz, pkt.buf);
       }
       else
@@ -211,10 +212,7 @@ namespace llarp
     {
       // flush upstream queue
       while (m_UpstreamQueue.size())
-      {
-        m_Parent->QueueOutboundTraffic(m_UpstreamQueue.top().pkt);
-        m_UpstreamQueue.pop();
-      }
+        m_Parent->QueueOutboundTraffic(m_UpstreamQueue.pop_top().pkt);
       // flush downstream queue
       auto path = GetCurrentPath();
       bool sent = path != nullptr;
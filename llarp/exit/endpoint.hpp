@@ -5,6 +5,7 @@
 #include <llarp/path/ihophandler.hpp>
 #include <llarp/routing/transfer_traffic_message.hpp>
 #include <llarp/service/protocol_type.hpp>
+#include <llarp/util/priority_queue.hpp>
 #include <llarp/util/time.hpp>
 
 #include <queue>
@@ -122,7 +123,7 @@ namespace llarp
 
       struct UpstreamBuffer
       {
-        UpstreamBuffer(const llarp::net::IPPacket& p, uint64_t c) : pkt(p), counter(c)
+        UpstreamBuffer(llarp::net::IPPacket p, uint64_t c) : pkt(std::move(p)), counter(c)
         {}
 
         llarp::net::IPPacket pkt;
@@ -135,7 +136,7 @@ namespace llarp
         }
       };
 
-      using UpstreamQueue_t = std::priority_queue<UpstreamBuffer>;
+      using UpstreamQueue_t = util::movable_priority_queue<UpstreamBuffer>;
       UpstreamQueue_t m_UpstreamQueue;
       uint64_t m_Counter;
     };
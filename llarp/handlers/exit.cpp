@@ -363,8 +363,7 @@ namespace llarp
     {
       while (not m_InetToNetwork.empty())
       {
-        net::IPPacket pkt{m_InetToNetwork.top()};
-        m_InetToNetwork.pop();
+        net::IPPacket pkt{m_InetToNetwork.pop_top()};
 
         PubKey pk;
         {
@@ -428,6 +427,8 @@ namespace llarp
         session->FlushUpstream();
         session->FlushDownstream();
       }
+      if (m_NetIf)
+        m_NetIf->FlushWrites();
     }
 
     bool
@@ -445,6 +446,8 @@ namespace llarp
         vpn::InterfaceInfo info;
         info.ifname = m_ifname;
         info.addrs.emplace(m_OurRange);
+        info.queues = m_TunQueues;
+        info.offload = m_TunOffload;
 
         m_NetIf = GetRouter()->GetVPNPlatform()->ObtainInterface(std::move(info), m_Router);
         if (not m_NetIf)
@@ -731,6 +734,8 @@ namespace llarp
         m_ifname = *maybe;
       }
       LogInfo(Name(), " set ifname to ", m_ifname);
+      m_TunQueues = networkConfig.m_TunQueues;
+      m_TunOffload = networkConfig.m_TunOffload;
       if (auto* quic = GetQUICTunnel())
       {
         quic->listen([ifaddr = net::TruncateV6(m_IfAddr)](std::string_view, uint16_t port) {
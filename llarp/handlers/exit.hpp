@@ -3,6 +3,7 @@
 #include <llarp/exit/endpoint.hpp>
 #include "tun.hpp"
 #include <llarp/dns/server.hpp>
+#include <llarp/util/priority_queue.hpp>
 #include <unordered_map>
 
 namespace llarp
@@ -204,6 +205,8 @@ namespace llarp
       huint128_t m_NextAddr;
       IPRange m_OurRange;
       std::string m_ifname;
+      size_t m_TunQueues = 1;
+      bool m_TunOffload = false;
 
       std::unordered_map<huint128_t, llarp_time_t> m_IPActivity;
 
@@ -214,8 +217,10 @@ namespace llarp
 
       std::shared_ptr<quic::TunnelManager> m_QUIC;
 
-      using PacketQueue_t = std::
-          priority_queue<net::IPPacket, std::vector<net::IPPacket>, net::IPPacket::CompareOrder>;
+      using PacketQueue_t = util::movable_priority_queue<
+          net::IPPacket,
+          std::vector<net::IPPacket>,
+          net::IPPacket::CompareOrder>;
 
       /// internet to llarp packet queue
       PacketQueue_t m_InetToNetwork;
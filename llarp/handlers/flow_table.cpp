@@ -0,0 +1,70 @@
+#include "flow_table.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+
+namespace llarp::handlers
+{
+  FlowKey
+  MakeFlowKey(const net::IPPacket& pkt, huint128_t dst)
+  {
+    FlowKey key;
+    key.dst = dst;
+    size_t headerSize;
+    if (pkt.IsV4())
+    {
+      key.src = pkt.src4to6();
+      key.proto = pkt.Header()->protocol;
+      headerSize = pkt.Header()->ihl * 4;
+    }
+    else
+    {
+      // extension headers are not walked, flows behind them key on their addresses alone
+      key.src = pkt.srcv6();
+      key.proto = pkt.HeaderV6()->proto;
+      headerSize = 40;
+    }
+    const auto proto = net::IPProtocol{key.proto};
+    if ((proto == net::IPProtocol::TCP or proto == net::IPProtocol::UDP)
+        and pkt.sz >= headerSize + 4)
+    {
+      const auto* ports = pkt.buf + headerSize;
+      key.srcport = (uint16_t{ports[0]} << 8) | ports[1];
+      key.dstport = (uint16_t{ports[2]} << 8) | ports[3];
+    }
+    return key;
+  }
+
+  void
+  FlowTable::Put(
+      const FlowKey& key,
+      const service::ConvoRoute& route,
+      service::ProtocolType type,
+      bool viaExitRange,
+      llarp_time_t now)
+  {
+    if (m_Flows.size() >= MaxFlows and m_Flows.find(key) == m_Flows.end())
+    {
+      LogDebug("flow table full, dropping ", m_Flows.size(), " flows");
+      m_Flows.clear();
+    }
+    m_Flows[key] = Flow{route, type, viaExitRange, now};
+  }
+
+  void
+  FlowTable::Expire(llarp_time_t now, uint64_t generation)
+  {
+    for (auto itr = m_Flows.begin(); itr != m_Flows.end();)
+    {
+      if (now - itr->second.lastActive > IdleTimeout or itr->second.route.generation != generation)
+        itr = m_Flows.erase(itr);
+      else
+        ++itr;
+    }
+  }
+
+  util::StatusObject
+  FlowTable::ExtractStatus() const
+  {
+    return util::StatusObject{{"size", m_Flows.size()}, {"hits", m_Hits}, {"misses", m_Misses}};
+  }
+}  // namespace llarp::handlers
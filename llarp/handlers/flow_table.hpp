@@ -0,0 +1,134 @@
+#pragma once
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/net/net_int.hpp>
+#include <llarp/service/convo_route.hpp>
+#include <llarp/service/protocol_type.hpp>
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <functional>
+#include <tuple>
+#include <unordered_map>
+
+namespace llarp::handlers
+{
+  /// a flow from the user by its 5 tuple, ports are zero for protocols without them
+  struct FlowKey
+  {
+    huint128_t src;
+    huint128_t dst;
+    uint8_t proto = 0;
+    uint16_t srcport = 0;
+    uint16_t dstport = 0;
+
+    bool
+    operator==(const FlowKey& other) const
+    {
+      return std::tie(src, dst, proto, srcport, dstport)
+          == std::tie(other.src, other.dst, other.proto, other.srcport, other.dstport);
+    }
+
+    struct Hash
+    {
+      size_t
+      operator()(const FlowKey& k) const
+      {
+        size_t h = std::hash<huint128_t>{}(k.src);
+        h ^= std::hash<huint128_t>{}(k.dst) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        return h
+            ^ std::hash<uint64_t>{}(
+                   (uint64_t{k.proto} << 32) | (uint64_t{k.srcport} << 16) | k.dstport);
+      }
+    };
+  };
+
+  /// the flow key of a packet from the user going to dst
+  FlowKey
+  MakeFlowKey(const net::IPPacket& pkt, huint128_t dst);
+
+  /// established user flows pinned to what their packets were last sent on, so the rest of
+  /// their packets skip the address, session and convo tag lookups
+  class FlowTable
+  {
+   public:
+    struct Flow
+    {
+      service::ConvoRoute route;
+      service::ProtocolType type;
+      /// the flow goes to an exit we picked for its range, so only its source is rewritten
+      bool viaExitRange = false;
+      llarp_time_t lastActive = 0s;
+    };
+
+    /// most flows we keep, the table is dropped and built up again when it fills
+    static constexpr size_t MaxFlows = 4096;
+    /// flows idle this long are dropped on expire
+    static constexpr auto IdleTimeout = 30s;
+
+    /// the flow pinned for key if ready(route) says it can still be sent on, which counts as a
+    /// hit.  anything else is a miss, and a pinned flow that can't be sent on is dropped.
+    template <typename Ready_t>
+    Flow*
+    Find(const FlowKey& key, Ready_t&& ready)
+    {
+      const auto itr = m_Flows.find(key);
+      if (itr != m_Flows.end())
+      {
+        if (ready(itr->second.route))
+        {
+          m_Hits++;
+          return &itr->second;
+        }
+        m_Flows.erase(itr);
+      }
+      m_Misses++;
+      return nullptr;
+    }
+
+    /// pin a flow to a route its remote resolved to
+    void
+    Put(const FlowKey& key,
+        const service::ConvoRoute& route,
+        service::ProtocolType type,
+        bool viaExitRange,
+        llarp_time_t now);
+
+    /// drop idle flows and ones resolved before the endpoint's route generation moved on
+    void
+    Expire(llarp_time_t now, uint64_t generation);
+
+    void
+    Clear()
+    {
+      m_Flows.clear();
+    }
+
+    size_t
+    Size() const
+    {
+      return m_Flows.size();
+    }
+
+    uint64_t
+    Hits() const
+    {
+      return m_Hits;
+    }
+
+    uint64_t
+    Misses() const
+    {
+      return m_Misses;
+    }
+
+    util::StatusObject
+    ExtractStatus() const;
+
+   private:
+    std::unordered_map<FlowKey, Flow, FlowKey::Hash> m_Flows;
+    /// packets sent on their flow, and ones that had to be looked up
+    uint64_t m_Hits = 0;
+    uint64_t m_Misses = 0;
+  };
+}  // namespace llarp::handlers
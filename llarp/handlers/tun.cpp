@@ -24,6 +24,7 @@
 #include <llarp/rpc/endpoint_rpc.hpp>
 #include <llarp/util/str.hpp>
 #include <llarp/dns/srv_data.hpp>
+#include <llarp/vpn/packet_batch.hpp>
 
 #include <oxenc/bt.h>
 
@@ -85,7 +86,7 @@ namespace llarp
         : service::Endpoint(r, parent)
     {
       m_PacketRouter = std::make_unique<vpn::PacketRouter>(
-          [this](net::IPPacket pkt) { HandleGotUserPacket(std::move(pkt)); });
+          [this](net::IPPacket pkt) { m_UserPackets.emplace_back(std::move(pkt)); });
 #if defined(ANDROID) || defined(__APPLE__)
       m_Resolver = std::make_shared<DnsInterceptor>(r, this);
       m_PacketRouter->AddUDPHandler(huint16_t{53}, [&](net::IPPacket pkt) {
@@ -102,7 +103,7 @@ namespace llarp
         if (m_Resolver->ShouldHandlePacket(raddr, laddr, buf))
           m_Resolver->HandlePacket(raddr, laddr, buf);
         else
-          HandleGotUserPacket(std::move(pkt));
+          m_UserPackets.emplace_back(std::move(pkt));
       });
 #else
       m_Resolver = std::make_shared<dns::Proxy>(r->loop(), this);
@@ -138,6 +139,7 @@ namespace llarp
       obj["ourIP"] = m_OurIP.ToString();
       obj["nextIP"] = m_NextIP.ToString();
       obj["maxIP"] = m_MaxIP.ToString();
+      obj["flows"] = m_Flows.ExtractStatus();
       return obj;
     }
 
@@ -226,6 +228,8 @@ namespace llarp
           throw std::runtime_error("cannot find free interface name");
         m_IfName = *maybe;
       }
+      m_TunQueues = conf.m_TunQueues;
+      m_TunOffload = conf.m_TunOffload;
 
       m_OurRange = conf.m_ifaddr;
       if (!m_OurRange.addr.h)
@@ -366,10 +370,9 @@ namespace llarp
     {
       // flush network to user
       while (not m_NetworkToUserPktQueue.empty())
-      {
-        m_NetIf->WritePacket(m_NetworkToUserPktQueue.top().pkt);
-        m_NetworkToUserPktQueue.pop();
-      }
+        m_NetIf->WritePacket(m_NetworkToUserPktQueue.pop_top().pkt);
+      if (m_NetIf)
+        m_NetIf->FlushWrites();
 
       service::Endpoint::Pump(now);
     }
@@ -793,6 +796,7 @@ namespace llarp
     TunEndpoint::ResetInternalState()
     {
       service::Endpoint::ResetInternalState();
+      m_Flows.Clear();
     }
 
     bool
@@ -848,6 +852,8 @@ namespace llarp
       m_IPToAddr[ip] = addr;
       m_AddrToIP[addr] = ip;
       m_SNodes[addr] = SNode;
+      // flows to this ip may have gone to an exit before
+      InvalidateConvoRoutes();
       MarkIPActiveForever(ip);
       MarkAddressOutbound(addr);
       return true;
@@ -909,6 +915,8 @@ namespace llarp
 
       info.ifname = m_IfName;
       info.dnsaddr.FromString(m_LocalResolverAddr.toHost());
+      info.queues = m_TunQueues;
+      info.offload = m_TunOffload;
 
       LogInfo(Name(), " setting up network...");
 
@@ -928,9 +936,13 @@ namespace llarp
       m_IfName = m_NetIf->IfName();
       LogInfo(Name(), " got network interface ", m_IfName);
 
-      if (not Router()->loop()->add_network_interface(m_NetIf, [this](net::IPPacket pkt) {
-            m_PacketRouter->HandleIPPacket(std::move(pkt));
-          }))
+      if (not Router()->loop()->add_network_interface(
+              m_NetIf, [this](net::IPPacket* pkts, size_t num) {
+                for (size_t idx = 0; idx < num; ++idx)
+                  m_PacketRouter->HandleIPPacket(std::move(pkts[idx]));
+                HandleGotUserPackets(m_UserPackets);
+                m_UserPackets.clear();
+              }))
       {
         LogError(Name(), " failed to add network interface");
         return false;
@@ -992,6 +1004,8 @@ namespace llarp
     TunEndpoint::Tick(llarp_time_t now)
     {
       Endpoint::Tick(now);
+      // drop idle flows and ones whose route went stale
+      m_Flows.Expire(now, ConvoRouteGeneration());
     }
 
     bool
@@ -1058,95 +1072,148 @@ namespace llarp
     }
 
     void
-    TunEndpoint::HandleGotUserPacket(net::IPPacket pkt)
+    TunEndpoint::HandleGotUserPackets(std::vector<net::IPPacket>& pkts)
     {
-      huint128_t dst, src;
-      if (pkt.IsV4())
-      {
-        dst = pkt.dst4to6();
-        src = pkt.src4to6();
-      }
-      else
-      {
-        dst = pkt.dstv6();
-        src = pkt.srcv6();
-      }
+      const bool sent = vpn::VisitByDestination(
+          pkts, m_state->m_ExitEnabled, [this](auto dst, auto** group, size_t num) {
+            return HandleGotUserPacketsTo(dst, group, num);
+          });
+      if (sent)
+        Router()->TriggerPump();
+    }
 
-      if (m_state->m_ExitEnabled)
+    bool
+    TunEndpoint::HandleGotUserPacketsTo(huint128_t dst, net::IPPacket** pkts, size_t num)
+    {
+      const auto srcOf = [](const net::IPPacket& pkt) {
+        return pkt.IsV4() ? pkt.src4to6() : pkt.srcv6();
+      };
+      const auto now = Now();
+      // established flows go out on what they are pinned to, the rest are looked up below
+      bool sent = false;
+      bool sentMapped = false;
+      size_t missed = 0;
+      const auto ready = [this](const auto& route) { return ConvoRouteReady(route); };
+      for (size_t idx = 0; idx < num; ++idx)
       {
-        dst = net::ExpandV4(net::TruncateV6(dst));
+        auto& pkt = *pkts[idx];
+        auto* flow = m_Flows.Find(MakeFlowKey(pkt, dst), ready);
+        if (not flow)
+        {
+          pkts[missed++] = &pkt;
+          continue;
+        }
+        if (flow->viaExitRange)
+          pkt.ZeroSourceAddress();
+        else if (flow->type != service::ProtocolType::Exit)
+          pkt.ZeroAddresses();
+        if (SendOnConvoRoute(flow->route, pkt.ConstBuffer(), flow->type))
+        {
+          flow->lastActive = now;
+          sent = true;
+          sentMapped |= not flow->viaExitRange;
+        }
       }
+      if (sentMapped)
+        MarkIPActive(dst);
+      num = missed;
+      if (num == 0)
+        return sent;
+
       auto itr = m_IPToAddr.find(dst);
       if (itr == m_IPToAddr.end())
       {
-        service::Address addr{};
-
-        if (auto maybe = ObtainExitAddressFor(dst))
-          addr = *maybe;
-        else
+        const auto maybe = ObtainExitAddressFor(dst);
+        if (not maybe)
         {
           // send icmp unreachable as we dont have any exits for this ip
-          if (const auto icmp = pkt.MakeICMPUnreachable())
-            HandleWriteIPPacket(icmp->ConstBuffer(), dst, src, 0);
-
-          return;
+          vpn::ReplyUnreachable(pkts, num, [this, dst](const auto& icmp, auto src) {
+            HandleWriteIPPacket(icmp.ConstBuffer(), dst, src, 0);
+          });
+          return sent;
+        }
+        MarkAddressOutbound(*maybe);
+        const auto route = ResolveConvoRoute(*maybe);
+        // shared as the hook must be copyable and packets are not
+        auto pending = std::make_shared<std::vector<net::IPPacket>>();
+        for (size_t idx = 0; idx < num; ++idx)
+        {
+          if (route)
+            m_Flows.Put(
+                MakeFlowKey(*pkts[idx], dst), *route, service::ProtocolType::Exit, true, now);
+          pkts[idx]->ZeroSourceAddress();
+          pending->emplace_back(std::move(*pkts[idx]));
         }
-        pkt.ZeroSourceAddress();
-        MarkAddressOutbound(addr);
         EnsurePathToService(
-            addr,
-            [pkt, this](service::Address addr, service::OutboundContext* ctx) {
+            *maybe,
+            [pending = std::move(pending), this](
+                service::Address addr, service::OutboundContext* ctx) {
               if (ctx)
               {
-                ctx->SendPacketToRemote(pkt.ConstBuffer(), service::ProtocolType::Exit);
+                for (const auto& pkt : *pending)
+                  ctx->SendPacketToRemote(pkt.ConstBuffer(), service::ProtocolType::Exit);
                 Router()->TriggerPump();
                 return;
               }
               LogWarn("cannot ensure path to exit ", addr, " so we drop some packets");
             },
             PathAlignmentTimeout());
-        return;
+        return sent;
       }
       std::variant<service::Address, RouterID> to;
-      service::ProtocolType type;
-      if (m_SNodes.at(itr->second))
-      {
+      const bool snode = m_SNodes.at(itr->second);
+      if (snode)
         to = RouterID{itr->second.as_array()};
-        type = service::ProtocolType::TrafficV4;
-      }
       else
-      {
         to = service::Address{itr->second.as_array()};
-        type = m_state->m_ExitEnabled and src != m_OurIP ? service::ProtocolType::Exit
-                                                         : pkt.ServiceProtocol();
-      }
 
-      // prepare packet for insertion into network
-      // this includes clearing IP addresses, recalculating checksums, etc
-      // this does not happen for exits because the point is they don't rewrite addresses
-      if (type != service::ProtocolType::Exit)
-      {
-        if (pkt.IsV4())
-          pkt.UpdateIPv4Address({0}, {0});
-        else
-          pkt.UpdateIPv6Address({0}, {0});
-      }
-      // try sending it on an existing convotag
+      // try sending them on an existing convotag
       // this succeds for inbound convos, probably.
-      if (auto maybe = GetBestConvoTagFor(to))
+      const auto tag = GetBestConvoTagFor(to);
+      // if the remote has a ready session the flows here are pinned to it
+      const auto route = ResolveConvoRoute(to);
+      using Pending = std::vector<std::pair<net::IPPacket, service::ProtocolType>>;
+      auto pending = std::make_shared<Pending>();
+      bool sentNow = false;
+      for (size_t idx = 0; idx < num; ++idx)
       {
-        if (SendToOrQueue(*maybe, pkt.ConstBuffer(), type))
+        auto& pkt = *pkts[idx];
+        service::ProtocolType type;
+        if (snode)
+          type = service::ProtocolType::TrafficV4;
+        else
+          type = m_state->m_ExitEnabled and srcOf(pkt) != m_OurIP ? service::ProtocolType::Exit
+                                                                  : pkt.ServiceProtocol();
+        if (route)
+          m_Flows.Put(MakeFlowKey(pkt, dst), *route, type, false, now);
+
+        // prepare packet for insertion into network
+        // this includes clearing IP addresses, recalculating checksums, etc
+        // this does not happen for exits because the point is they don't rewrite addresses
+        if (type != service::ProtocolType::Exit)
         {
-          MarkIPActive(dst);
-          Router()->TriggerPump();
-          return;
+          if (pkt.IsV4())
+            pkt.UpdateIPv4Address({0}, {0});
+          else
+            pkt.UpdateIPv6Address({0}, {0});
+        }
+        if (tag and SendToOrQueue(*tag, pkt.ConstBuffer(), type))
+        {
+          sentNow = true;
+          continue;
         }
+        pending->emplace_back(std::move(pkt), type);
       }
+      if (sentNow and not sentMapped)
+        MarkIPActive(dst);
+      sent |= sentNow;
+      if (pending->empty())
+        return sent;
       // try establishing a path to this guy
       // will fail if it's an inbound convo
       EnsurePathTo(
           to,
-          [pkt, type, dst, to, this](auto maybe) {
+          [pending = std::move(pending), dst, to, this](auto maybe) {
             if (not maybe)
             {
               var::visit(
@@ -1154,8 +1221,12 @@ namespace llarp
                     LogWarn(Name(), " failed to ensure path to ", addr, " no convo tag found");
                   },
                   to);
+              return;
             }
-            if (SendToOrQueue(*maybe, pkt.ConstBuffer(), type))
+            bool sent = false;
+            for (const auto& [pkt, type] : *pending)
+              sent |= SendToOrQueue(*maybe, pkt.ConstBuffer(), type);
+            if (sent)
             {
               MarkIPActive(dst);
               Router()->TriggerPump();
@@ -1170,6 +1241,7 @@ namespace llarp
             }
           },
           PathAlignmentTimeout());
+      return sent;
     }
 
     bool
@@ -1360,6 +1432,7 @@ namespace llarp
         {
           m_AddrToIP[ident] = nextIP;
           m_IPToAddr[nextIP] = ident;
+          InvalidateConvoRoutes();
           m_SNodes[ident] = snode;
           var::visit(
               [&](auto&& remote) { llarp::LogInfo(Name(), " mapped ", remote, " to ", nextIP); },
@@ -1392,6 +1465,7 @@ namespace llarp
       m_IPToAddr[oldest.first] = ident;
       m_AddrToIP[ident] = oldest.first;
       m_SNodes[ident] = snode;
+      InvalidateConvoRoutes();
       nextIP = oldest.first;
 
       // mark ip active
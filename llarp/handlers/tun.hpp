@@ -7,10 +7,12 @@
 #include <llarp/net/ip_packet.hpp>
 #include <llarp/net/net.hpp>
 #include <llarp/service/endpoint.hpp>
+#include "flow_table.hpp"
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/vpn/packet_router.hpp>
 
 #include <future>
+#include <tuple>
 
 #include <type_traits>
 #include <variant>
@@ -113,9 +115,9 @@ namespace llarp
       HandleWriteIPPacket(
           const llarp_buffer_t& buf, huint128_t src, huint128_t dst, uint64_t seqno);
 
-      /// we got a packet from the user
+      /// we got packets from the user, which we may move from
       void
-      HandleGotUserPacket(llarp::net::IPPacket pkt);
+      HandleGotUserPackets(std::vector<net::IPPacket>& pkts);
 
       /// get the local interface's address
       huint128_t
@@ -276,12 +278,25 @@ namespace llarp
       /// use v6?
       bool m_UseV6;
       std::string m_IfName;
+      size_t m_TunQueues = 1;
+      bool m_TunOffload = false;
 
       std::optional<huint128_t> m_BaseV6Address;
 
       std::shared_ptr<vpn::NetworkInterface> m_NetIf;
 
       std::unique_ptr<vpn::PacketRouter> m_PacketRouter;
+      /// packets from the user the packet router passed on, handled once the batch they were
+      /// read in is routed
+      std::vector<net::IPPacket> m_UserPackets;
+
+      /// send the user's packets for one destination, returns true if any went out right away;
+      /// packets on an established flow are sent first and the rest moved to the front of pkts
+      bool
+      HandleGotUserPacketsTo(huint128_t dst, net::IPPacket** pkts, size_t num);
+
+      /// user flows pinned to the convo route their remote resolved to
+      FlowTable m_Flows;
 
       std::optional<net::TrafficPolicy> m_TrafficPolicy;
       /// ranges we advetise as reachable
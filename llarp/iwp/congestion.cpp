@@ -0,0 +1,190 @@
+#include "congestion.hpp"
+
+#include <llarp/util/time.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    CongestionControl::CongestionControl(llarp_time_t maxRTO)
+        : m_MaxRTO{maxRTO}, m_MinRTO{maxRTO}
+    {}
+
+    void
+    CongestionControl::SetMinRTO(llarp_time_t minRTO)
+    {
+      m_MinRTO = std::min(minRTO, m_MaxRTO);
+    }
+
+    bool
+    CongestionControl::CanSend(llarp_time_t now)
+    {
+      if (m_InFlight >= m_Window)
+        return false;
+      Refill(now);
+      return PacingRate() <= 0 or m_Credit >= 1;
+    }
+
+    void
+    CongestionControl::OnSent()
+    {
+      m_InFlight++;
+      if (PacingRate() > 0)
+        m_Credit -= 1;
+    }
+
+    void
+    CongestionControl::Refill(llarp_time_t now)
+    {
+      const auto rate = PacingRate();
+      if (rate > 0 and now > m_LastRefill)
+      {
+        // allow a burst of 2ms worth so timer jitter does not cost us throughput
+        const double burst = std::max(2.0, rate * 0.002);
+        m_Credit = std::min(m_Credit + rate * (now - m_LastRefill).count() / 1000.0, burst);
+      }
+      m_LastRefill = now;
+    }
+
+    llarp_time_t
+    CongestionControl::PacingDelay() const
+    {
+      const auto rate = PacingRate();
+      if (rate <= 0 or m_Credit >= 1)
+        return 0s;
+      const auto ms = static_cast<int64_t>(std::ceil((1 - m_Credit) * 1000.0 / rate));
+      return std::max(llarp_time_t{ms}, llarp_time_t{1ms});
+    }
+
+    void
+    CongestionControl::OnAcked(size_t fragments, llarp_time_t now)
+    {
+      const size_t before = m_InFlight;
+      m_InFlight -= std::min(fragments, m_InFlight);
+      // don't grow a window the sender is not filling
+      if (before * 2 < m_Window)
+        return;
+
+      if (m_Window < m_SSThresh)
+      {
+        m_Window = std::min(m_Window + fragments, MaxWindow);
+        return;
+      }
+
+      if (m_EpochStart == 0s)
+      {
+        m_EpochStart = now;
+        if (m_Window < m_WMax)
+          m_K = std::cbrt((m_WMax - m_Window) / C);
+        else
+        {
+          m_K = 0;
+          m_WMax = m_Window;
+        }
+        m_WEst = m_Window;
+      }
+      // where the cubic curve puts the window one rtt from now
+      const double t = (now - m_EpochStart).count() / 1000.0 + m_SRTT / 1000.0;
+      const double cubic = m_WMax + C * std::pow(t - m_K, 3);
+      // the window reno would have by now, so we are never slower than it on short rtts
+      m_WEst += (3 * (1 - Beta) / (1 + Beta)) * fragments / m_Window;
+      const double target = std::min(std::max(cubic, m_WEst), m_Window * 1.5);
+      if (target > m_Window)
+        m_Window = std::min(m_Window + (target - m_Window) * fragments / m_Window, MaxWindow);
+    }
+
+    void
+    CongestionControl::OnRTTSample(llarp_time_t rtt)
+    {
+      if (rtt < 0s)
+        return;
+      const double sample = rtt.count();
+      if (not m_HaveRTT)
+      {
+        m_HaveRTT = true;
+        m_SRTT = sample;
+        m_RTTVar = sample / 2;
+        m_MinRTT = sample;
+        return;
+      }
+      m_RTTVar = 0.75 * m_RTTVar + 0.25 * std::abs(m_SRTT - sample);
+      m_SRTT = 0.875 * m_SRTT + 0.125 * sample;
+      m_MinRTT = std::min(m_MinRTT, sample);
+    }
+
+    void
+    CongestionControl::OnLoss(size_t fragments, llarp_time_t now)
+    {
+      if (fragments == 0)
+        return;
+      m_InFlight -= std::min(fragments, m_InFlight);
+      // losses from the same flight only count once
+      const auto rtt = m_HaveRTT ? SmoothedRTT() : m_MaxRTO;
+      if (m_LastDecrease > 0s and now - m_LastDecrease < rtt)
+        return;
+      m_LastDecrease = now;
+      m_Losses++;
+      // fast convergence: give up bandwidth sooner if we were already shrinking
+      m_WMax = m_Window < m_WMax ? m_Window * (1 + Beta) / 2 : m_Window;
+      m_Window = std::max(m_Window * Beta, MinWindow);
+      m_SSThresh = m_Window;
+      m_EpochStart = 0s;
+    }
+
+    void
+    CongestionControl::OnDiscard(size_t fragments)
+    {
+      m_InFlight -= std::min(fragments, m_InFlight);
+    }
+
+    llarp_time_t
+    CongestionControl::RetransmitTimeout() const
+    {
+      if (not m_HaveRTT)
+        return m_MaxRTO;
+      const auto rto =
+          llarp_time_t{static_cast<int64_t>(std::ceil(m_SRTT + std::max(4 * m_RTTVar, 1.0)))};
+      return std::clamp<llarp_time_t>(rto, m_MinRTO, m_MaxRTO);
+    }
+
+    llarp_time_t
+    CongestionControl::SmoothedRTT() const
+    {
+      return m_HaveRTT ? llarp_time_t{std::llround(m_SRTT)} : 0s;
+    }
+
+    llarp_time_t
+    CongestionControl::MinRTT() const
+    {
+      return m_HaveRTT ? llarp_time_t{std::llround(m_MinRTT)} : 0s;
+    }
+
+    double
+    CongestionControl::PacingRate() const
+    {
+      if (not m_HaveRTT)
+        return 0;
+      const double gain = m_Window < m_SSThresh ? SlowStartPacingGain : PacingGain;
+      // sub millisecond rtts are seen as 1ms by our clock
+      return gain * m_Window * 1000.0 / std::max(m_SRTT, 1.0);
+    }
+
+    util::StatusObject
+    CongestionControl::ExtractStatus() const
+    {
+      return {
+          {"window", m_Window},
+          {"ssthresh", m_SSThresh},
+          {"inFlight", m_InFlight},
+          {"srtt", to_json(SmoothedRTT())},
+          {"rttvar", m_RTTVar},
+          {"minRTT", m_MinRTT},
+          {"rto", to_json(RetransmitTimeout())},
+          {"pacingRate", PacingRate()},
+          {"lossEvents", m_Losses}};
+    }
+  }  // namespace iwp
+}  // namespace llarp
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/types.hpp>
+
+#include <cstddef>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// per session congestion controller for outbound message fragments: a CUBIC (RFC 8312)
+    /// window counted in fragments, an RFC 6298 smoothed RTT / retransmit timeout fed by
+    /// XMIT -> ACKS samples, and a token bucket that paces fragments at a multiple of
+    /// window / RTT.  until the first RTT sample there is no pacing and the initial window
+    /// goes out as a burst.
+    class CongestionControl
+    {
+     public:
+      /// fragments we may have in flight before any feedback
+      static constexpr double InitialWindow = 10;
+      static constexpr double MinWindow = 2;
+      static constexpr double MaxWindow = 8192;
+      /// cubic multiplicative decrease factor
+      static constexpr double Beta = 0.7;
+      /// cubic scaling constant, in fragments per second cubed
+      static constexpr double C = 0.4;
+      /// pacing rate as a multiple of window / RTT in slow start and in congestion avoidance
+      static constexpr double SlowStartPacingGain = 2.0;
+      static constexpr double PacingGain = 1.25;
+      /// floor on the retransmit timeout against peers that send eSACK
+      static constexpr std::chrono::milliseconds MinRTO = 50ms;
+
+      /// maxRTO is the retransmit timeout before the first RTT sample, its ceiling and, until
+      /// SetMinRTO, its floor
+      explicit CongestionControl(llarp_time_t maxRTO);
+
+      /// lower the retransmit timeout floor; only worth it once the peer reports what it got
+      /// with eSACK, as older peers only ACK every ACKResendInterval and we would time out
+      /// fragments that are fine
+      void
+      SetMinRTO(llarp_time_t minRTO);
+
+      /// may we put one more fragment on the wire now; false when the window is full or the
+      /// pacer has no credit left
+      bool
+      CanSend(llarp_time_t now);
+
+      /// a fragment was put on the wire
+      void
+      OnSent();
+
+      /// fragments in flight were acked; grows the window
+      void
+      OnAcked(size_t fragments, llarp_time_t now);
+
+      /// round trip time from sending a message's XMIT to the first ACKS covering it
+      void
+      OnRTTSample(llarp_time_t rtt);
+
+      /// fragments in flight were declared lost; shrinks the window at most once per RTT
+      void
+      OnLoss(size_t fragments, llarp_time_t now);
+
+      /// fragments in flight belonged to a message we gave up on
+      void
+      OnDiscard(size_t fragments);
+
+      /// how long until the pacer has credit for another fragment; zero if it already has or
+      /// we are not pacing
+      llarp_time_t
+      PacingDelay() const;
+
+      llarp_time_t
+      RetransmitTimeout() const;
+
+      double
+      Window() const
+      {
+        return m_Window;
+      }
+
+      size_t
+      InFlight() const
+      {
+        return m_InFlight;
+      }
+
+      /// zero until we have an RTT sample
+      llarp_time_t
+      SmoothedRTT() const;
+
+      /// lowest RTT seen, zero until we have a sample
+      llarp_time_t
+      MinRTT() const;
+
+      /// fragments per second, zero while unpaced
+      double
+      PacingRate() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      void
+      Refill(llarp_time_t now);
+
+      const llarp_time_t m_MaxRTO;
+      llarp_time_t m_MinRTO;
+
+      double m_Window = InitialWindow;
+      double m_SSThresh = MaxWindow;
+      size_t m_InFlight = 0;
+
+      /// cubic state: window before the last decrease, start of the current growth epoch, the
+      /// time it takes to grow back to m_WMax, and the reno friendly estimate
+      double m_WMax = 0;
+      llarp_time_t m_EpochStart = 0s;
+      double m_K = 0;
+      double m_WEst = 0;
+      llarp_time_t m_LastDecrease = 0s;
+
+      /// rtt estimator state, in milliseconds
+      bool m_HaveRTT = false;
+      double m_SRTT = 0;
+      double m_RTTVar = 0;
+      double m_MinRTT = 0;
+
+      /// pacer token bucket, in fragments
+      double m_Credit = 0;
+      llarp_time_t m_LastRefill = 0s;
+
+      uint64_t m_Losses = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -1,6 +1,7 @@
 #include "linklayer.hpp"
 #include "session.hpp"
 #include <llarp/config/key_manager.hpp>
+#include <llarp/ev/udp_handle.hpp>
 #include <memory>
 #include <unordered_set>
 
@@ -47,40 +48,91 @@ namespace llarp::iwp
     return 2;
   }
 
-  void
-  LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt)
+  std::shared_ptr<ILinkSession>
+  LinkLayer::SessionFor(const SockAddr& from, bool& isNewSession)
   {
+    isNewSession = false;
+    if (const auto* session = m_SessionsByAddr.Find(from))
+      return *session;
     std::shared_ptr<ILinkSession> session;
-    auto itr = m_AuthedAddrs.find(from);
-    bool isNewSession = false;
-    if (itr == m_AuthedAddrs.end())
     {
       Lock_t lock{m_PendingMutex};
-      auto it = m_Pending.find(from);
-      if (it == m_Pending.end())
+      auto itr = m_Pending.find(from);
+      if (itr != m_Pending.end() and not itr->second->IsClosed())
+        session = itr->second;
+      else
       {
         if (not m_Inbound)
-          return;
+          return nullptr;
+        // a closed session waits in m_Pending for Pump to time it out; the new one takes its
+        // place there, so that it is pumped and it is the one MapAddr promotes
         isNewSession = true;
-        it = m_Pending.emplace(from, std::make_shared<Session>(this, from)).first;
+        session = std::make_shared<Session>(this, from);
+        m_Pending.insert_or_assign(from, session);
       }
-      session = it->second;
     }
-    else
+    m_SessionsByAddr.Insert(from, session);
+    return session;
+  }
+
+  void
+  LinkLayer::RemoveNewSession(const SockAddr& from, const ILinkSession* session)
+  {
+    LogDebug("Brand new session failed; removing from pending sessions list");
     {
-      if (auto s_itr = m_AuthedLinks.find(itr->second); s_itr != m_AuthedLinks.end())
-        session = s_itr->second;
+      Lock_t lock{m_PendingMutex};
+      if (auto itr = m_Pending.find(from); itr != m_Pending.end() and itr->second.get() == session)
+        m_Pending.erase(itr);
     }
-    if (session)
+    UnmapAddr(from, session);
+  }
+
+  void
+  LinkLayer::RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt)
+  {
+    bool isNewSession = false;
+    if (auto session = SessionFor(from, isNewSession))
     {
       bool success = session->Recv_LL(std::move(pkt));
       if (not success and isNewSession)
+        RemoveNewSession(from, session.get());
+      WakeupPlaintext();
+    }
+  }
+
+  void
+  LinkLayer::RecvFromBatch(const std::vector<UDPDatagram>& pkts)
+  {
+    // datagrams from one remote tend to arrive back to back, so we only redo the session lookup
+    // when the source address changes, and we wake up the plaintext handlers once per batch
+    // rather than once per packet.
+    const SockAddr* lastFrom = nullptr;
+    std::shared_ptr<ILinkSession> session;
+    bool isNewSession = false;
+    bool wakeup = false;
+    for (const auto& pkt : pkts)
+    {
+      if (lastFrom == nullptr or not(*lastFrom == pkt.addr))
       {
-        LogDebug("Brand new session failed; removing from pending sessions list");
-        m_Pending.erase(from);
+        lastFrom = &pkt.addr;
+        session = SessionFor(pkt.addr, isNewSession);
+      }
+      if (not session)
+        continue;
+      if (session->Recv_LL(m_PacketBuffers->CopyFrom(pkt.data, pkt.size)))
+      {
+        isNewSession = false;
+        wakeup = true;
+      }
+      else if (isNewSession)
+      {
+        RemoveNewSession(pkt.addr, session.get());
+        session.reset();
+        lastFrom = nullptr;
       }
-      WakeupPlaintext();
     }
+    if (wakeup)
+      WakeupPlaintext();
   }
 
   std::shared_ptr<ILinkSession>
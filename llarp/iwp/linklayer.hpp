@@ -44,6 +44,9 @@ namespace llarp::iwp
     void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) override;
 
+    void
+    RecvFromBatch(const std::vector<UDPDatagram>& pkts) override;
+
     void
     WakeupPlaintext();
 
@@ -51,6 +54,15 @@ namespace llarp::iwp
     PrintableName() const;
 
    private:
+    /// find the session for a remote address, creating a new pending inbound session if we accept
+    /// inbound sessions and have none; sets isNewSession if one was created.
+    std::shared_ptr<ILinkSession>
+    SessionFor(const SockAddr& from, bool& isNewSession);
+
+    /// drop a session SessionFor just created whose first packet it rejected
+    void
+    RemoveNewSession(const SockAddr& from, const ILinkSession* session);
+
     void
     HandleWakeupPlaintext();
 
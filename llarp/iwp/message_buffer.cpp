@@ -11,9 +11,11 @@ namespace llarp
         ILinkSession::Message_t msg,
         llarp_time_t now,
         ILinkSession::CompletionHandler handler,
-        uint16_t priority)
+        uint16_t priority,
+        size_t fragsize)
         : m_Data{std::move(msg)}
         , m_MsgID{msgid}
+        , m_FragmentSize{fragsize}
         , m_Completed{handler}
         , m_LastFlush{now}
         , m_StartedAt{now}
@@ -21,14 +23,15 @@ namespace llarp
     {
       const llarp_buffer_t buf(m_Data);
       CryptoManager::instance()->shorthash(m_Digest, buf);
-      m_Acks.set(0);
+      for (size_t idx = 0; idx == 0 or idx < m_Data.size(); idx += m_FragmentSize)
+        m_Pending.set(idx / m_FragmentSize);
     }
 
     ILinkSession::Packet_t
-    OutboundMessage::XMIT() const
+    OutboundMessage::XMIT(PacketBufferPool& pool) const
     {
-      size_t extra = std::min(m_Data.size(), FragmentSize);
-      auto xmit = CreatePacket(Command::eXMIT, 10 + 32 + extra, 0, 0);
+      size_t extra = std::min(m_Data.size(), m_FragmentSize);
+      auto xmit = CreatePacket(pool, Command::eXMIT, 10 + 32 + extra, 0, 0);
       oxenc::write_host_as_big(
           static_cast<uint16_t>(m_Data.size()), xmit.data() + CommandOverhead + PacketOverhead);
       oxenc::write_host_as_big(m_MsgID, xmit.data() + 2 + CommandOverhead + PacketOverhead);
@@ -49,51 +52,99 @@ namespace llarp
     }
 
     bool
-    OutboundMessage::ShouldFlush(llarp_time_t now) const
+    OutboundMessage::ShouldFlush(llarp_time_t now, llarp_time_t rto) const
     {
-      return now - m_LastFlush >= TXFlushInterval;
+      return now - m_LastFlush >= rto;
     }
 
-    void
+    size_t
     OutboundMessage::Ack(byte_t bitmask)
     {
-      m_Acks = std::bitset<8>(bitmask);
+      // acks only ever accumulate on the remote, so an ACKS that arrives late can't unack
+      m_Acks |= Fragments_t{bitmask};
+      const auto acked = (m_Sent & m_Acks).count();
+      m_Sent &= ~m_Acks;
+      m_Pending &= ~m_Acks;
+      return acked;
     }
 
-    void
-    OutboundMessage::FlushUnAcked(
-        std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
+    ILinkSession::Packet_t
+    OutboundMessage::SendNextFragment(PacketBufferPool& pool, llarp_time_t now)
     {
+      size_t frag = 0;
+      while (not m_Pending.test(frag))
+        frag++;
+      m_Pending.reset(frag);
+      m_Sent.set(frag);
+      m_FragmentSentAt[frag] = now;
+      m_LastFlush = now;
+      if (frag == 0)
+      {
+        if (m_FirstSentAt == 0s)
+        {
+          m_FirstSentAt = now;
+          m_RTTSampleable = true;
+        }
+        return XMIT(pool);
+      }
       /// overhead for a data packet in plaintext
       static constexpr size_t Overhead = 10;
-      uint16_t idx = 0;
+      const uint16_t idx = frag * m_FragmentSize;
       const auto datasz = m_Data.size();
-      while (idx < datasz)
+      const size_t fragsz = idx + m_FragmentSize < datasz ? m_FragmentSize : datasz - idx;
+      auto pkt = CreatePacket(pool, Command::eDATA, fragsz + Overhead, 0, 0);
+      oxenc::write_host_as_big(idx, pkt.data() + 2 + PacketOverhead);
+      oxenc::write_host_as_big(m_MsgID, pkt.data() + 4 + PacketOverhead);
+      std::copy(
+          m_Data.begin() + idx,
+          m_Data.begin() + idx + fragsz,
+          pkt.data() + PacketOverhead + Overhead + 2);
+      return pkt;
+    }
+
+    size_t
+    OutboundMessage::Requeue(const Fragments_t& fragments)
+    {
+      const auto lost = (m_Sent & fragments).count();
+      m_Sent &= ~fragments;
+      m_Pending |= fragments & ~m_Acks;
+      if (lost)
+        m_RTTSampleable = false;
+      return lost;
+    }
+
+    size_t
+    OutboundMessage::RequeueUnAcked()
+    {
+      Fragments_t unacked;
+      for (size_t idx = 0; idx == 0 or idx < m_Data.size(); idx += m_FragmentSize)
       {
-        if (not m_Acks[idx / FragmentSize])
-        {
-          const size_t fragsz = idx + FragmentSize < datasz ? FragmentSize : datasz - idx;
-          auto frag = CreatePacket(Command::eDATA, fragsz + Overhead, 0, 0);
-          oxenc::write_host_as_big(idx, frag.data() + 2 + PacketOverhead);
-          oxenc::write_host_as_big(m_MsgID, frag.data() + 4 + PacketOverhead);
-          std::copy(
-              m_Data.begin() + idx,
-              m_Data.begin() + idx + fragsz,
-              frag.data() + PacketOverhead + Overhead + 2);
-          sendpkt(std::move(frag));
-        }
-        idx += FragmentSize;
+        if (not m_Acks.test(idx / m_FragmentSize))
+          unacked.set(idx / m_FragmentSize);
       }
-      m_LastFlush = now;
+      return Requeue(unacked);
+    }
+
+    size_t
+    OutboundMessage::FastRetransmit(
+        const Fragments_t& gaps, llarp_time_t now, llarp_time_t minRTT)
+    {
+      Fragments_t lost;
+      for (size_t frag = 0; frag < MaxFragments; ++frag)
+      {
+        if (gaps.test(frag) and m_Sent.test(frag) and now - m_FragmentSentAt[frag] >= minRTT)
+          lost.set(frag);
+      }
+      return Requeue(lost);
     }
 
     bool
     OutboundMessage::IsTransmitted() const
     {
       const auto sz = m_Data.size();
-      for (uint16_t idx = 0; idx < sz; idx += FragmentSize)
+      for (size_t idx = 0; idx == 0 or idx < sz; idx += m_FragmentSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragmentSize))
           return false;
       }
       return true;
@@ -116,8 +167,13 @@ namespace llarp
       m_Completed = nullptr;
     }
 
-    InboundMessage::InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now)
-        : m_Data(size_t{sz}), m_Digset{std::move(h)}, m_MsgID(msgid), m_LastActiveAt{now}
+    InboundMessage::InboundMessage(
+        uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now, size_t fragsize)
+        : m_Data(size_t{sz})
+        , m_Digset{std::move(h)}
+        , m_MsgID(msgid)
+        , m_FragmentSize{fragsize}
+        , m_LastActiveAt{now}
     {}
 
     void
@@ -130,20 +186,99 @@ namespace llarp
       }
       byte_t* dst = m_Data.data() + idx;
       std::copy_n(buf.base, buf.sz, dst);
-      m_Acks.set(idx / FragmentSize);
-      LogTrace("got fragment ", idx / FragmentSize);
+      m_Acks.set(idx / m_FragmentSize);
+      LogTrace("got fragment ", idx / m_FragmentSize);
       m_LastActiveAt = now;
     }
 
     ILinkSession::Packet_t
-    InboundMessage::ACKS() const
+    InboundMessage::ACKS(PacketBufferPool& pool) const
     {
-      auto acks = CreatePacket(Command::eACKS, 9);
+      auto acks = CreatePacket(pool, Command::eACKS, 9);
       oxenc::write_host_as_big(m_MsgID, acks.data() + CommandOverhead + PacketOverhead);
       acks[PacketOverhead + 10] = AcksBitmask();
       return acks;
     }
 
+    Fragments_t
+    InboundMessage::Gaps() const
+    {
+      Fragments_t gaps;
+      size_t highest = MaxFragments;
+      while (highest > 0 and not m_Acks.test(highest - 1))
+        highest--;
+      for (size_t frag = 0; frag + 1 < highest; ++frag)
+      {
+        if (not m_Acks.test(frag))
+          gaps.set(frag);
+      }
+      return gaps;
+    }
+
+    bool
+    InboundMessage::ShouldSendSACK() const
+    {
+      const auto fresh = (m_Acks & ~m_LastSACKAcks).count();
+      return fresh >= 2 or (fresh and Gaps().any());
+    }
+
+    ILinkSession::Packet_t
+    InboundMessage::SACK(PacketBufferPool& pool)
+    {
+      m_LastSACKAcks = m_Acks;
+      const auto gaps = Gaps();
+      // runs of missing fragments as (first, count)
+      std::array<std::pair<uint16_t, uint16_t>, (MaxFragments + 1) / 2> ranges;
+      size_t numRanges = 0;
+      for (size_t frag = 0; frag < MaxFragments; ++frag)
+      {
+        if (not gaps.test(frag))
+          continue;
+        if (numRanges and ranges[numRanges - 1].first + ranges[numRanges - 1].second == frag)
+          ranges[numRanges - 1].second++;
+        else
+          ranges[numRanges++] = {frag, 1};
+      }
+      auto sack = CreatePacket(pool, Command::eSACK, 10 + 4 * numRanges);
+      byte_t* ptr = sack.data() + PacketOverhead + CommandOverhead;
+      oxenc::write_host_as_big(m_MsgID, ptr);
+      ptr[8] = AcksBitmask();
+      ptr[9] = numRanges;
+      ptr += 10;
+      for (size_t idx = 0; idx < numRanges; ++idx)
+      {
+        oxenc::write_host_as_big(ranges[idx].first, ptr);
+        oxenc::write_host_as_big(ranges[idx].second, ptr + 2);
+        ptr += 4;
+      }
+      return sack;
+    }
+
+    std::optional<SelectiveAck>
+    DecodeSACK(const ILinkSession::Packet_t& pkt)
+    {
+      static constexpr size_t Header = PacketOverhead + CommandOverhead + 10;
+      if (pkt.size() < Header)
+        return std::nullopt;
+      const byte_t* ptr = pkt.data() + PacketOverhead + CommandOverhead;
+      SelectiveAck sack;
+      sack.msgid = oxenc::load_big_to_host<uint64_t>(ptr);
+      sack.acks = ptr[8];
+      const size_t numRanges = ptr[9];
+      if (pkt.size() < Header + 4 * numRanges)
+        return std::nullopt;
+      ptr += 10;
+      for (size_t idx = 0; idx < numRanges; ++idx)
+      {
+        const auto first = oxenc::load_big_to_host<uint16_t>(ptr);
+        const auto count = oxenc::load_big_to_host<uint16_t>(ptr + 2);
+        for (size_t frag = first; frag < MaxFragments and frag < size_t{first} + count; ++frag)
+          sack.gaps.set(frag);
+        ptr += 4;
+      }
+      return sack;
+    }
+
     byte_t
     InboundMessage::AcksBitmask() const
     {
@@ -154,9 +289,9 @@ namespace llarp
     InboundMessage::IsCompleted() const
     {
       const auto sz = m_Data.size();
-      for (size_t idx = 0; idx < sz; idx += FragmentSize)
+      for (size_t idx = 0; idx < sz; idx += m_FragmentSize)
       {
-        if (not m_Acks.test(idx / FragmentSize))
+        if (not m_Acks.test(idx / m_FragmentSize))
           return false;
       }
       return true;
@@ -175,9 +310,12 @@ namespace llarp
     }
 
     void
-    InboundMessage::SendACKS(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now)
+    InboundMessage::SendACKS(
+        PacketBufferPool& pool,
+        std::function<void(ILinkSession::Packet_t)> sendpkt,
+        llarp_time_t now)
     {
-      sendpkt(ACKS());
+      sendpkt(ACKS(pool));
       m_LastACKSent = now;
     }
 
@@ -1,6 +1,10 @@
 #pragma once
+#include <array>
+#include <optional>
 #include <vector>
+#include <llarp/constants/evloop.hpp>
 #include <llarp/constants/link_layer.hpp>
+#include <llarp/crypto/constants.hpp>
 #include <llarp/link/session.hpp>
 #include <llarp/util/aligned.hpp>
 #include <llarp/util/buffer.hpp>
@@ -24,14 +28,48 @@ namespace llarp
       eNACK = 4,
       /// multiack
       eMACK = 5,
+      /// selective ack: acks plus the ranges of fragments missing below the highest one
+      /// received, sent as fragments arrive; only to peers that advertise FeatureSACK
+      eSACK = 6,
       /// close session
       eCLOS = 0xff,
     };
 
-    /// max size of data fragments
+    /// size of data fragments every peer takes, and the smallest we send; sessions whose path
+    /// mtu search finds room send bigger ones
     static constexpr size_t FragmentSize = 1024;
+    /// packet crypto overhead size
+    static constexpr size_t PacketOverhead = HMACSIZE + TUNNONCESIZE;
     /// plaintext header overhead size
     static constexpr size_t CommandOverhead = 2;
+    /// wire overhead of an XMIT (size, msgid and digest), the biggest packet a fragment rides in
+    static constexpr size_t XMITOverhead =
+        PacketOverhead + CommandOverhead + sizeof(uint16_t) + sizeof(uint64_t) + ShortHash::SIZE;
+    /// wire overhead of a DATA (message size, offset and msgid) in front of the fragment
+    static constexpr size_t DATAOverhead =
+        PacketOverhead + CommandOverhead + sizeof(uint16_t) + sizeof(uint64_t);
+    /// largest fragment we send or accept, so an XMIT still fits a batched udp receive buffer
+    static constexpr size_t MaxFragmentSize = udp_batch_max_datagram_size - XMITOverhead;
+    /// most fragments a message can have, at the smallest fragment size
+    static constexpr size_t MaxFragments = MAX_LINK_MSG_SIZE / FragmentSize;
+    // ACKS carry the acks in a single byte
+    static_assert(MaxFragments <= 8);
+
+    /// one bit per fragment of a message
+    using Fragments_t = std::bitset<MaxFragments>;
+
+    /// decoded eSACK
+    struct SelectiveAck
+    {
+      uint64_t msgid = 0;
+      byte_t acks = 0;
+      /// fragments the remote reports missing
+      Fragments_t gaps;
+    };
+
+    /// decode the plaintext of an eSACK packet; nullopt if it is malformed
+    std::optional<SelectiveAck>
+    DecodeSACK(const ILinkSession::Packet_t& pkt);
 
     struct OutboundMessage
     {
@@ -41,15 +79,31 @@ namespace llarp
           ILinkSession::Message_t data,
           llarp_time_t now,
           ILinkSession::CompletionHandler handler,
-          uint16_t priority);
+          uint16_t priority,
+          size_t fragsize = FragmentSize);
 
       ILinkSession::Message_t m_Data;
       uint64_t m_MsgID = 0;
-      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      /// size of the fragments we cut m_Data into, fixed for the life of the message
+      size_t m_FragmentSize = FragmentSize;
+      /// fragments the remote has acked; fragment 0 travels in the XMIT
+      Fragments_t m_Acks;
+      /// fragments waiting for the session's pacer to (re)send them
+      Fragments_t m_Pending;
+      /// fragments on the wire and not yet acked, i.e. what we count against the congestion
+      /// window
+      Fragments_t m_Sent;
       ILinkSession::CompletionHandler m_Completed;
+      /// when we last put a fragment of this message on the wire
       llarp_time_t m_LastFlush = 0s;
       ShortHash m_Digest;
       llarp_time_t m_StartedAt = 0s;
+      /// when the XMIT first went out; the first ACKS gives an rtt sample unless we had to
+      /// retransmit before it came
+      llarp_time_t m_FirstSentAt = 0s;
+      bool m_RTTSampleable = false;
+      /// when each fragment was last put on the wire
+      std::array<llarp_time_t, MaxFragments> m_FragmentSentAt{};
       uint16_t m_ResendPriority;
 
       bool
@@ -61,16 +115,47 @@ namespace llarp
       }
 
       ILinkSession::Packet_t
-      XMIT() const;
+      XMIT(PacketBufferPool& pool) const;
 
-      void
+      /// merge in an ACKS bitmask; returns how many fragments in flight it acked
+      size_t
       Ack(byte_t bitmask);
 
-      void
-      FlushUnAcked(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
+      bool
+      HasPending() const
+      {
+        return m_Pending.any();
+      }
+
+      /// fragments on the wire and not yet acked
+      size_t
+      InFlight() const
+      {
+        return m_Sent.count();
+      }
 
+      /// packet for the lowest pending fragment (the XMIT for fragment 0), moving it from
+      /// pending to in flight
+      ILinkSession::Packet_t
+      SendNextFragment(PacketBufferPool& pool, llarp_time_t now);
+
+      /// queue the given fragments for resending; returns how many of them were in flight and so
+      /// are now presumed lost
+      size_t
+      Requeue(const Fragments_t& fragments);
+
+      /// Requeue every fragment not acked yet
+      size_t
+      RequeueUnAcked();
+
+      /// Requeue the gaps an eSACK reported, skipping fragments sent less than the minimum rtt
+      /// ago (the SACK can't have seen those yet); returns how many are presumed lost
+      size_t
+      FastRetransmit(const Fragments_t& gaps, llarp_time_t now, llarp_time_t minRTT);
+
+      /// nothing sent for a retransmit timeout
       bool
-      ShouldFlush(llarp_time_t now) const;
+      ShouldFlush(llarp_time_t now, llarp_time_t rto) const;
 
       void
       Completed();
@@ -88,14 +173,23 @@ namespace llarp
     struct InboundMessage
     {
       InboundMessage() = default;
-      InboundMessage(uint64_t msgid, uint16_t sz, ShortHash h, llarp_time_t now);
+      InboundMessage(
+          uint64_t msgid,
+          uint16_t sz,
+          ShortHash h,
+          llarp_time_t now,
+          size_t fragsize = FragmentSize);
 
       ILinkSession::Message_t m_Data;
       ShortHash m_Digset;
       uint64_t m_MsgID = 0;
+      /// fragment size the sender chose, going by the data in its XMIT
+      size_t m_FragmentSize = FragmentSize;
       llarp_time_t m_LastACKSent = 0s;
       llarp_time_t m_LastActiveAt = 0s;
-      std::bitset<MAX_LINK_MSG_SIZE / FragmentSize> m_Acks;
+      Fragments_t m_Acks;
+      /// what we had received when we last sent an eSACK
+      Fragments_t m_LastSACKAcks;
 
       void
       HandleData(uint16_t idx, const llarp_buffer_t& buf, llarp_time_t now);
@@ -116,10 +210,26 @@ namespace llarp
       ShouldSendACKS(llarp_time_t now) const;
 
       void
-      SendACKS(std::function<void(ILinkSession::Packet_t)> sendpkt, llarp_time_t now);
+      SendACKS(
+          PacketBufferPool& pool,
+          std::function<void(ILinkSession::Packet_t)> sendpkt,
+          llarp_time_t now);
+
+      ILinkSession::Packet_t
+      ACKS(PacketBufferPool& pool) const;
+
+      /// fragments not received yet that lie below the highest one we have
+      Fragments_t
+      Gaps() const;
+
+      /// the sender should hear about what we have now rather than on the next ACKS: a
+      /// fragment arrived while there is a gap (like tcp's immediate ack of out of order
+      /// segments) or two arrived in order since we last told it (like tcp's delayed ack)
+      bool
+      ShouldSendSACK() const;
 
       ILinkSession::Packet_t
-      ACKS() const;
+      SACK(PacketBufferPool& pool);
     };
 
   }  // namespace iwp
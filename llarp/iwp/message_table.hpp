@@ -0,0 +1,279 @@
+#pragma once
+
+#include <llarp/util/types.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// in flight messages of one direction of a session, keyed by msgid.  msgids are handed out
+    /// sequentially, so the live ones sit in a narrow window [front, back] and live in a power of
+    /// two ring at slot msgid & mask: lookup, insert and erase are O(1) with no allocation once
+    /// the ring has grown to the working set.  the ring shrinks again once the window has drained
+    /// to a quarter of it, so one far ahead msgid does not pin a big ring for the session's
+    /// lifetime.  Msg_t must carry its own id as m_MsgID.
+    template <typename Msg_t>
+    class MessageTable
+    {
+     public:
+      /// maxWindow bounds how far apart the oldest and newest live msgid may be, which also
+      /// bounds the ring size
+      explicit MessageTable(size_t maxWindow, size_t initialSize = 64)
+          : m_MaxWindow{maxWindow}, m_MinSlots{RoundUp(initialSize)}
+      {
+        m_Slots.resize(m_MinSlots);
+      }
+
+      size_t
+      size() const
+      {
+        return m_Count;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Count == 0;
+      }
+
+      /// ring slots currently allocated
+      size_t
+      Capacity() const
+      {
+        return m_Slots.size();
+      }
+
+      Msg_t*
+      Find(uint64_t msgid)
+      {
+        if (m_Count == 0 or msgid - m_Front >= m_Slots.size())
+          return nullptr;
+        auto& slot = m_Slots[msgid & Mask()];
+        if (slot and slot->m_MsgID == msgid)
+          return &*slot;
+        return nullptr;
+      }
+
+      /// insert msg under msg.m_MsgID; returns nullptr if that id is already present or would
+      /// stretch the window past maxWindow
+      Msg_t*
+      Emplace(Msg_t msg)
+      {
+        const uint64_t msgid = msg.m_MsgID;
+        if (m_Count == 0)
+        {
+          m_Front = msgid;
+          m_Back = msgid;
+        }
+        else
+        {
+          if (Find(msgid))
+            return nullptr;
+          uint64_t front = m_Front;
+          uint64_t back = m_Back;
+          // outside the window: stretch whichever edge is nearer
+          if (msgid - m_Front > m_Back - m_Front)
+          {
+            if (m_Front - msgid < msgid - m_Back)
+              front = msgid;
+            else
+              back = msgid;
+          }
+          if (back - front >= m_MaxWindow)
+            return nullptr;
+          if (back - front >= m_Slots.size())
+            Resize(RoundUp(back - front + 1));
+          m_Front = front;
+          m_Back = back;
+        }
+        auto& slot = m_Slots[msgid & Mask()];
+        slot.emplace(std::move(msg));
+        m_Count++;
+        return &*slot;
+      }
+
+      bool
+      Erase(uint64_t msgid)
+      {
+        auto* msg = Find(msgid);
+        if (msg == nullptr)
+          return false;
+        m_Slots[msgid & Mask()].reset();
+        if (--m_Count == 0)
+        {
+          if (m_Slots.size() > m_MinSlots)
+            Resize(m_MinSlots);
+          return true;
+        }
+        // walk the window edges in past the hole; amortized O(1) for sequential ids
+        while (not Find(m_Front))
+          m_Front++;
+        while (not Find(m_Back))
+          m_Back--;
+        // halve down to twice the window so growing again is at least a window of inserts away
+        const size_t want = std::max(m_MinSlots, RoundUp(m_Back - m_Front + 1) * 2);
+        if (want * 2 <= m_Slots.size())
+          Resize(want);
+        return true;
+      }
+
+      /// oldest live message, or nullptr if empty
+      Msg_t*
+      Front()
+      {
+        return m_Count ? Find(m_Front) : nullptr;
+      }
+
+      /// visit every live message from oldest to newest msgid; O(window)
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t&& visit)
+      {
+        if (m_Count == 0)
+          return;
+        for (uint64_t msgid = m_Front; msgid - m_Front <= m_Back - m_Front; ++msgid)
+        {
+          if (auto* msg = Find(msgid))
+            visit(*msg);
+        }
+      }
+
+     private:
+      size_t
+      Mask() const
+      {
+        return m_Slots.size() - 1;
+      }
+
+      static size_t
+      RoundUp(size_t need)
+      {
+        size_t sz = 1;
+        while (sz < need)
+          sz <<= 1;
+        return sz;
+      }
+
+      /// rehash into sz slots, which must hold the whole window
+      void
+      Resize(size_t sz)
+      {
+        std::vector<std::optional<Msg_t>> slots(sz);
+        for (auto& slot : m_Slots)
+        {
+          if (slot)
+            slots[slot->m_MsgID & (sz - 1)] = std::move(slot);
+        }
+        m_Slots = std::move(slots);
+      }
+
+      const size_t m_MaxWindow;
+      const size_t m_MinSlots;
+      std::vector<std::optional<Msg_t>> m_Slots;
+      size_t m_Count = 0;
+      uint64_t m_Front = 0;
+      uint64_t m_Back = 0;
+    };
+
+    /// hashed timer wheel of msgids: Pump only looks at the msgids whose deadline has come up
+    /// instead of every message in flight.  entries are never cancelled; when one fires the
+    /// owner re-checks the message (it may be gone, or its deadline may have moved later) and
+    /// schedules it again if it is still pending.
+    class MessageTimerWheel
+    {
+     public:
+      /// resolution is the bucket width; buckets * resolution should cover the longest deadline
+      /// so entries are only looked at once
+      MessageTimerWheel(llarp_time_t resolution, size_t buckets)
+          : m_Resolution{resolution.count() > 0 ? resolution : llarp_time_t{1}}
+      {
+        size_t sz = 1;
+        while (sz < buckets)
+          sz <<= 1;
+        m_Buckets.resize(sz);
+      }
+
+      void
+      Schedule(uint64_t msgid, llarp_time_t when)
+      {
+        const uint64_t tick = std::max(Tick(when), m_Cursor);
+        m_Buckets[tick & (m_Buckets.size() - 1)].push_back(Entry{msgid, when});
+        m_Size++;
+      }
+
+      /// call visit(msgid) for every entry due at or before now, each at most once; visit may
+      /// schedule again
+      template <typename Visit_t>
+      void
+      Expire(llarp_time_t now, Visit_t&& visit)
+      {
+        const uint64_t target = Tick(now);
+        if (m_Size == 0)
+        {
+          m_Cursor = std::max(m_Cursor, target);
+          return;
+        }
+        uint64_t first = std::min(m_Cursor, target);
+        // a full turn of the wheel visits every bucket
+        if (target - first >= m_Buckets.size())
+          first = target - (m_Buckets.size() - 1);
+        for (uint64_t tick = first; tick <= target; ++tick)
+        {
+          auto& bucket = m_Buckets[tick & (m_Buckets.size() - 1)];
+          if (bucket.empty())
+            continue;
+          m_Firing.clear();
+          m_Firing.swap(bucket);
+          for (const auto& entry : m_Firing)
+          {
+            if (entry.when <= now)
+            {
+              m_Size--;
+              m_Due.push_back(entry.msgid);
+            }
+            else
+              bucket.push_back(entry);
+          }
+        }
+        // the current bucket stays live: entries scheduled later in this tick land in it
+        m_Cursor = target;
+        for (const auto msgid : m_Due)
+          visit(msgid);
+        m_Due.clear();
+      }
+
+      /// number of scheduled entries, including ones whose message has since gone away
+      size_t
+      size() const
+      {
+        return m_Size;
+      }
+
+     private:
+      struct Entry
+      {
+        uint64_t msgid;
+        llarp_time_t when;
+      };
+
+      uint64_t
+      Tick(llarp_time_t when) const
+      {
+        return when.count() > 0 ? static_cast<uint64_t>(when / m_Resolution) : 0;
+      }
+
+      const llarp_time_t m_Resolution;
+      std::vector<std::vector<Entry>> m_Buckets;
+      /// scratch space reused across Expire calls
+      std::vector<Entry> m_Firing;
+      std::vector<uint64_t> m_Due;
+      uint64_t m_Cursor = 0;
+      size_t m_Size = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -0,0 +1,96 @@
+#include "path_mtu.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+#include <llarp/util/time.hpp>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    std::optional<uint16_t>
+    PathMTU::NextRung() const
+    {
+      for (const auto datagram : ProbeDatagramSizes)
+      {
+        if (FragmentSizeFor(datagram) > m_FragmentSize)
+          return FragmentSizeFor(datagram);
+      }
+      return std::nullopt;
+    }
+
+    std::optional<uint16_t>
+    PathMTU::NextProbe(llarp_time_t now)
+    {
+      if (m_SearchDoneAt > 0s)
+      {
+        if (now - m_SearchDoneAt < RaiseInterval)
+          return std::nullopt;
+        m_SearchDoneAt = 0s;
+      }
+      if (m_Probing and now - m_ProbeSentAt < ProbeTimeout)
+        return std::nullopt;
+      const auto rung = NextRung();
+      if (m_Probing != rung.value_or(0))
+        m_ProbeCount = 0;
+      if (not rung or m_ProbeCount >= MaxProbes)
+      {
+        // nothing bigger gets through, or there is nothing bigger to try
+        m_Probing = 0;
+        m_ProbeCount = 0;
+        m_SearchDoneAt = now;
+        return std::nullopt;
+      }
+      m_Probing = *rung;
+      m_ProbeSentAt = now;
+      m_ProbeCount++;
+      m_ProbesSent++;
+      return m_Probing;
+    }
+
+    void
+    PathMTU::OnProbeAcked(uint16_t fragsize, llarp_time_t now)
+    {
+      if (fragsize != m_Probing)
+        return;
+      LogDebug("path mtu probe for ", fragsize, " byte fragments acked");
+      m_FragmentSize = fragsize;
+      m_Probing = 0;
+      m_ProbeCount = 0;
+      m_Timeouts = 0;
+      if (not NextRung())
+        m_SearchDoneAt = now;
+    }
+
+    void
+    PathMTU::OnDelivered()
+    {
+      m_Timeouts = 0;
+    }
+
+    void
+    PathMTU::OnDeliveryTimeout(llarp_time_t now)
+    {
+      if (m_FragmentSize == iwp::FragmentSize or ++m_Timeouts < BlackHoleTimeouts)
+        return;
+      LogWarn(
+          "falling back from ", m_FragmentSize, " to ", iwp::FragmentSize, " byte fragments");
+      m_FragmentSize = iwp::FragmentSize;
+      m_Probing = 0;
+      m_ProbeCount = 0;
+      m_Timeouts = 0;
+      m_SearchDoneAt = now;
+      m_BlackHoles++;
+    }
+
+    util::StatusObject
+    PathMTU::ExtractStatus() const
+    {
+      return {
+          {"fragmentSize", m_FragmentSize},
+          {"probing", m_Probing},
+          {"searching", m_SearchDoneAt == 0s},
+          {"probesSent", m_ProbesSent},
+          {"blackHoles", m_BlackHoles}};
+    }
+  }  // namespace iwp
+}  // namespace llarp
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "message_buffer.hpp"
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/types.hpp>
+
+#include <array>
+#include <optional>
+
+namespace llarp
+{
+  namespace iwp
+  {
+    /// per session path mtu search (in the spirit of RFC 8899 datagram PLPMTUD) for the size
+    /// of the fragments we send.  we start at FragmentSize, which every path and peer takes,
+    /// and probe the next rung of ProbeDatagramSizes with a keepalive padded out to the size
+    /// of an XMIT carrying a fragment that big.  an acked probe raises our fragment size, a
+    /// rung that goes unacked MaxProbes times ends the search until RaiseInterval has passed,
+    /// and repeated delivery timeouts drop us back to FragmentSize in case the path shrank.
+    class PathMTU
+    {
+     public:
+      /// udp payloads we try to fill, smallest first: the ipv6 minimum mtu, a 1420 byte tunnel
+      /// mtu, and ethernet with room for an ipv6 header.  probes go out with the don't fragment
+      /// bit set, and we stop at ethernet as bigger frames are rare off a LAN.
+      static constexpr std::array<size_t, 3> ProbeDatagramSizes = {
+          1280 - 48, 1420 - 28, 1500 - 48};
+      static constexpr size_t MaxProbes = 3;
+      /// how long we wait for a probe's ack before trying again
+      static constexpr std::chrono::milliseconds ProbeTimeout = 1s;
+      /// how long after a search ends before we look for a bigger mtu again
+      static constexpr std::chrono::milliseconds RaiseInterval = 10min;
+      /// consecutive delivery timeouts at a raised fragment size before we fall back
+      static constexpr size_t BlackHoleTimeouts = 3;
+
+      /// the fragment size that fills a datagram of this size with an XMIT
+      static constexpr uint16_t
+      FragmentSizeFor(size_t datagram)
+      {
+        return datagram - XMITOverhead;
+      }
+
+      /// fragment size to probe now, if one is due; the caller sends the probe
+      std::optional<uint16_t>
+      NextProbe(llarp_time_t now);
+
+      /// the remote got a probe for this fragment size
+      void
+      OnProbeAcked(uint16_t fragsize, llarp_time_t now);
+
+      /// a message made it across
+      void
+      OnDelivered();
+
+      /// a message timed out; enough of these in a row at a raised size and we fall back to
+      /// FragmentSize and search again
+      void
+      OnDeliveryTimeout(llarp_time_t now);
+
+      /// size of the fragments we should send now
+      uint16_t
+      FragmentSize() const
+      {
+        return m_FragmentSize;
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      std::optional<uint16_t>
+      NextRung() const;
+
+      uint16_t m_FragmentSize = iwp::FragmentSize;
+      /// size of the outstanding probe, 0 if there is none
+      uint16_t m_Probing = 0;
+      llarp_time_t m_ProbeSentAt = 0s;
+      size_t m_ProbeCount = 0;
+      /// when the last search gave up, 0 while searching
+      llarp_time_t m_SearchDoneAt = 0s;
+      size_t m_Timeouts = 0;
+      uint64_t m_ProbesSent = 0;
+      uint64_t m_BlackHoles = 0;
+    };
+  }  // namespace iwp
+}  // namespace llarp
@@ -4,7 +4,9 @@
 #include <llarp/messages/discard.hpp>
 #include <llarp/util/meta/memfn.hpp>
 #include <llarp/router/abstractrouter.hpp>
+#include <llarp/ev/udp_handle.hpp>
 
+#include <algorithm>
 #include <queue>
 
 namespace llarp
@@ -12,10 +14,11 @@ namespace llarp
   namespace iwp
   {
     ILinkSession::Packet_t
-    CreatePacket(Command cmd, size_t plainsize, size_t minpad, size_t variance)
+    CreatePacket(
+        PacketBufferPool& pool, Command cmd, size_t plainsize, size_t minpad, size_t variance)
     {
       const size_t pad = minpad > 0 ? minpad + (variance > 0 ? randint() % variance : 0) : 0;
-      ILinkSession::Packet_t pkt(PacketOverhead + plainsize + pad + CommandOverhead);
+      auto pkt = pool.Acquire(PacketOverhead + plainsize + pad + CommandOverhead);
       // randomize pad
       if (pad)
       {
@@ -29,6 +32,106 @@ namespace llarp
       return pkt;
     }
 
+    void
+    EncryptPacketInPlace(ILinkSession::Packet_t& pkt, const SharedSecret& key)
+    {
+      llarp_buffer_t pktbuf{pkt};
+      const TunnelNonce nonce_ptr{pkt.data() + HMACSIZE};
+      pktbuf.base += PacketOverhead;
+      pktbuf.cur = pktbuf.base;
+      pktbuf.sz -= PacketOverhead;
+      CryptoManager::instance()->xchacha20(pktbuf, key, nonce_ptr);
+      pktbuf.base = pkt.data() + HMACSIZE;
+      pktbuf.sz = pkt.size() - HMACSIZE;
+      CryptoManager::instance()->hmac(pkt.data(), pktbuf, key);
+    }
+
+    bool
+    DecryptPacketInPlace(ILinkSession::Packet_t& pkt, const SharedSecret& key)
+    {
+      if (pkt.size() <= PacketOverhead)
+        return false;
+      ShortHash H;
+      llarp_buffer_t curbuf{pkt.data() + ShortHash::SIZE, pkt.size() - ShortHash::SIZE};
+      if (not CryptoManager::instance()->hmac(H.data(), curbuf, key))
+        return false;
+      if (not std::equal(H.begin(), H.end(), pkt.data()))
+        return false;
+      const TunnelNonce N{curbuf.base};
+      curbuf.base += TunnelNonce::SIZE;
+      curbuf.cur = curbuf.base;
+      curbuf.sz -= TunnelNonce::SIZE;
+      return CryptoManager::instance()->xchacha20(curbuf, key, N);
+    }
+
+    void
+    EncryptPacketsInPlace(std::vector<ILinkSession::Packet_t>& pkts, const SharedSecret& key)
+    {
+      std::vector<CryptoBatchItem> items;
+      items.reserve(pkts.size());
+      for (auto& pkt : pkts)
+      {
+        items.push_back(CryptoBatchItem{
+            pkt.data() + PacketOverhead, pkt.size() - PacketOverhead, pkt.data() + HMACSIZE});
+      }
+      CryptoManager::instance()->xchacha20_batch(items.data(), items.size(), key);
+      for (size_t idx = 0; idx < pkts.size(); ++idx)
+      {
+        auto& pkt = pkts[idx];
+        items[idx] =
+            CryptoBatchItem{pkt.data() + HMACSIZE, pkt.size() - HMACSIZE, nullptr, pkt.data()};
+      }
+      CryptoManager::instance()->hmac_batch(items.data(), items.size(), key);
+    }
+
+    size_t
+    DecryptPacketsInPlace(std::vector<ILinkSession::Packet_t>& pkts, const SharedSecret& key)
+    {
+      const size_t total = pkts.size();
+      pkts.erase(
+          std::remove_if(
+              pkts.begin(),
+              pkts.end(),
+              [](const auto& pkt) { return pkt.size() <= PacketOverhead; }),
+          pkts.end());
+
+      std::vector<ShortHash> digests(pkts.size());
+      std::vector<CryptoBatchItem> items;
+      items.reserve(pkts.size());
+      for (size_t idx = 0; idx < pkts.size(); ++idx)
+      {
+        auto& pkt = pkts[idx];
+        items.push_back(CryptoBatchItem{
+            pkt.data() + HMACSIZE, pkt.size() - HMACSIZE, nullptr, digests[idx].data()});
+      }
+      if (not CryptoManager::instance()->hmac_batch(items.data(), items.size(), key))
+      {
+        pkts.clear();
+        return total;
+      }
+
+      // compact the batch down to the packets that authenticated, keeping their items in step
+      size_t kept = 0;
+      for (size_t idx = 0; idx < pkts.size(); ++idx)
+      {
+        auto& pkt = pkts[idx];
+        if (not std::equal(digests[idx].begin(), digests[idx].end(), pkt.data()))
+          continue;
+        items[kept] = CryptoBatchItem{
+            pkt.data() + PacketOverhead, pkt.size() - PacketOverhead, pkt.data() + HMACSIZE};
+        if (kept != idx)
+          pkts[kept] = std::move(pkt);
+        ++kept;
+      }
+      pkts.resize(kept);
+      if (not CryptoManager::instance()->xchacha20_batch(items.data(), kept, key))
+      {
+        pkts.clear();
+        return total;
+      }
+      return total - kept;
+    }
+
     constexpr size_t PlaintextQueueSize = 512;
 
     Session::Session(LinkLayer* p, const RouterContact& rc, const AddressInfo& ai)
@@ -37,6 +140,7 @@ namespace llarp
         , m_Parent(p)
         , m_CreatedAt{p->Now()}
         , m_RemoteAddr{ai}
+        , m_WorkerAffinity{std::hash<SockAddr>{}(m_RemoteAddr)}
         , m_ChosenAI(ai)
         , m_RemoteRC(rc)
         , m_PlaintextRecv{PlaintextQueueSize}
@@ -53,6 +157,7 @@ namespace llarp
         , m_Parent(p)
         , m_CreatedAt{p->Now()}
         , m_RemoteAddr{from}
+        , m_WorkerAffinity{std::hash<SockAddr>{}(m_RemoteAddr)}
         , m_PlaintextRecv{PlaintextQueueSize}
     {
       token.Randomize();
@@ -72,6 +177,21 @@ namespace llarp
       m_TXRate += sz;
     }
 
+    void
+    Session::SendBatch_LL(const std::vector<Packet_t>& pkts)
+    {
+      LogTrace("send ", pkts.size(), " packets to ", m_RemoteAddr);
+      std::vector<UDPDatagram> batch;
+      batch.reserve(pkts.size());
+      for (const auto& pkt : pkts)
+      {
+        batch.push_back(UDPDatagram{m_RemoteAddr, pkt.data(), pkt.size()});
+        m_TXRate += pkt.size();
+      }
+      m_Parent->SendBatchTo_LL(batch);
+      m_LastTX = time_now_ms();
+    }
+
     bool
     Session::GotInboundLIM(const LinkIntroMessage* msg)
     {
@@ -82,6 +202,8 @@ namespace llarp
         return false;
       }
       m_State = State::Ready;
+      // advertise our features right away rather than at the first keepalive
+      SendKeepAlive();
       GotLIM = util::memFn(&Session::GotRenegLIM, this);
       m_RemoteRC = msg->rc;
       m_Parent->MapAddr(m_RemoteRC.pubkey, this);
@@ -104,6 +226,7 @@ namespace llarp
         if (st == ILinkSession::DeliveryStatus::eDeliverySuccess)
         {
           self->m_State = State::Ready;
+          self->SendKeepAlive();
           self->m_Parent->MapAddr(self->m_RemoteRC.pubkey, self.get());
           self->m_Parent->SessionEstablished(self.get(), false);
         }
@@ -154,19 +277,8 @@ namespace llarp
     Session::EncryptWorker(CryptoQueue_t msgs)
     {
       LogTrace("encrypt worker ", msgs.size(), " messages");
-      for (auto& pkt : msgs)
-      {
-        llarp_buffer_t pktbuf{pkt};
-        const TunnelNonce nonce_ptr{pkt.data() + HMACSIZE};
-        pktbuf.base += PacketOverhead;
-        pktbuf.cur = pktbuf.base;
-        pktbuf.sz -= PacketOverhead;
-        CryptoManager::instance()->xchacha20(pktbuf, m_SessionKey, nonce_ptr);
-        pktbuf.base = pkt.data() + HMACSIZE;
-        pktbuf.sz = pkt.size() - HMACSIZE;
-        CryptoManager::instance()->hmac(pkt.data(), pktbuf, m_SessionKey);
-        Send_LL(pkt.data(), pkt.size());
-      }
+      EncryptPacketsInPlace(msgs, m_SessionKey);
+      SendBatch_LL(msgs);
     }
 
     void
@@ -174,8 +286,8 @@ namespace llarp
     {
       if (m_State == State::Closed)
         return;
-      auto close_msg = CreatePacket(Command::eCLOS, 0, 16, 16);
-      m_Parent->UnmapAddr(m_RemoteAddr);
+      auto close_msg = CreatePacket(Buffers(), Command::eCLOS, 0, 16, 16);
+      m_Parent->UnmapAddr(m_RemoteAddr, this);
       m_State = State::Closed;
       if (m_SentClosed.test_and_set())
         return;
@@ -197,20 +309,71 @@ namespace llarp
       const auto now = m_Parent->Now();
       const auto msgid = m_TXID++;
       const auto bufsz = buf.size();
-      auto& msg =
-          m_TXMsgs.emplace(msgid, OutboundMessage{msgid, std::move(buf), now, completed, priority})
-              .first->second;
-      TriggerPump();
-      EncryptAndSend(msg.XMIT());
-      if (bufsz > FragmentSize)
+      auto* msg = m_TXMsgs.Emplace(OutboundMessage{
+          msgid, std::move(buf), now, completed, priority, m_PMTU.FragmentSize()});
+      if (msg == nullptr)
       {
-        msg.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        // the oldest message still in flight is too far behind this one
+        if (completed)
+          completed(ILinkSession::DeliveryStatus::eDeliveryDropped);
+        return false;
       }
+      m_FlushTimers.Schedule(msgid, now + m_CC.RetransmitTimeout());
+      m_PacedTX.push_back(msgid);
+      SendPaced(now);
+      TriggerPump();
       m_Stats.totalInFlightTX++;
-      LogDebug("send message ", msgid, " to ", m_RemoteAddr);
+      LogDebug("send message ", msgid, " (", bufsz, " bytes) to ", m_RemoteAddr);
       return true;
     }
 
+    bool
+    Session::SendPaced(llarp_time_t now)
+    {
+      if (m_State == State::Closed)
+        return false;
+      bool sent = false;
+      while (not m_PacedTX.empty())
+      {
+        auto* msg = m_TXMsgs.Find(m_PacedTX.front());
+        if (msg == nullptr or not msg->HasPending())
+        {
+          m_PacedTX.pop_front();
+          continue;
+        }
+        if (not m_CC.CanSend(now))
+        {
+          // a full window reopens when acks come in, an empty pacer needs the timer
+          if (const auto delay = m_CC.PacingDelay(); delay > 0s)
+            ArmPacer(delay);
+          break;
+        }
+        auto frag = msg->SendNextFragment(Buffers(), now);
+        m_Stats.totalBytesCopied += frag.size()
+            - (frag[PacketOverhead + 1] == Command::eXMIT ? XMITOverhead : DATAOverhead);
+        EncryptAndSend(std::move(frag));
+        m_CC.OnSent();
+        sent = true;
+      }
+      return sent;
+    }
+
+    void
+    Session::ArmPacer(llarp_time_t delay)
+    {
+      if (m_PacerArmed)
+        return;
+      m_PacerArmed = true;
+      m_Parent->Loop()->call_later(delay, [self = weak_from_this()] {
+        auto ptr = self.lock();
+        if (not ptr)
+          return;
+        ptr->m_PacerArmed = false;
+        if (ptr->SendPaced(ptr->m_Parent->Now()))
+          ptr->TriggerPump();
+      });
+    }
+
     void
     Session::SendMACK()
     {
@@ -220,7 +383,7 @@ namespace llarp
         const auto sz = m_SendMACKs.size();
         const auto max = Session::MaxACKSInMACK;
         auto numAcks = std::min(sz, max);
-        auto mack = CreatePacket(Command::eMACK, 1 + (numAcks * sizeof(uint64_t)));
+        auto mack = CreatePacket(Buffers(), Command::eMACK, 1 + (numAcks * sizeof(uint64_t)));
         mack[PacketOverhead + CommandOverhead] = byte_t{static_cast<byte_t>(numAcks)};
         byte_t* ptr = mack.data() + 3 + PacketOverhead;
         LogTrace("send ", numAcks, " macks to ", m_RemoteAddr);
@@ -239,7 +402,7 @@ namespace llarp
     void
     Session::TriggerPump()
     {
-      m_Parent->Router()->TriggerPump();
+      m_Parent->TriggerPump();
     }
 
     void
@@ -250,40 +413,75 @@ namespace llarp
       {
         if (ShouldPing())
           SendKeepAlive();
-        for (auto& [id, msg] : m_RXMsgs)
+        if (m_State == State::Ready and (m_RemoteFeatures & FeaturePMTU)
+            and m_Parent->DontFragment())
         {
-          if (msg.ShouldSendACKS(now))
+          if (const auto probe = m_PMTU.NextProbe(now))
           {
-            msg.SendACKS(util::memFn(&Session::EncryptAndSend, this), now);
+            LogTrace("probing path mtu for ", *probe, " byte fragments to ", m_RemoteAddr);
+            SendPING(*probe, 0);
           }
         }
+        // only messages whose timer came up are looked at; a fired timer whose message is gone
+        // is dropped, one whose deadline moved later is put back
+        m_ACKTimers.Expire(now, [&](uint64_t rxid) {
+          auto* msg = m_RXMsgs.Find(rxid);
+          if (msg == nullptr)
+            return;
+          if (msg->ShouldSendACKS(now))
+            msg->SendACKS(Buffers(), util::memFn(&Session::EncryptAndSend, this), now);
+          m_ACKTimers.Schedule(rxid, msg->m_LastACKSent + ACKResendInterval + 1ms);
+        });
         std::priority_queue<
             OutboundMessage*,
             std::vector<OutboundMessage*>,
             ComparePtr<OutboundMessage*>>
             to_resend;
-        for (auto& [id, msg] : m_TXMsgs)
-        {
-          if (msg.ShouldFlush(now))
-            to_resend.push(&msg);
-        }
-        if (not to_resend.empty())
+        const auto rto = m_CC.RetransmitTimeout();
+        m_FlushTimers.Expire(now, [&](uint64_t txid) {
+          auto* msg = m_TXMsgs.Find(txid);
+          if (msg == nullptr)
+            return;
+          if (msg->ShouldFlush(now, rto))
+            to_resend.push(msg);
+          else
+            m_FlushTimers.Schedule(txid, msg->m_LastFlush + rto);
+        });
+        // whatever was in flight for a whole retransmit timeout is lost: give it back to the
+        // pacer, most important first
+        for (; not to_resend.empty(); to_resend.pop())
         {
-          for (auto& msg = to_resend.top(); not to_resend.empty(); to_resend.pop())
-            msg->FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+          auto* msg = to_resend.top();
+          if (const auto lost = msg->RequeueUnAcked())
+          {
+            m_CC.OnLoss(lost, now);
+            m_PacedTX.push_back(msg->m_MsgID);
+          }
+          m_FlushTimers.Schedule(msg->m_MsgID, now + rto);
         }
+        SendPaced(now);
       }
+      // packet buffers are move only but QueueWork needs a copyable job, so the batches ride along
+      // in a shared_ptr
       if (not m_EncryptNext.empty())
       {
         m_Parent->QueueWork(
-            [self = shared_from_this(), data = m_EncryptNext] { self->EncryptWorker(data); });
+            m_WorkerAffinity,
+            [self = shared_from_this(),
+             data = std::make_shared<CryptoQueue_t>(std::move(m_EncryptNext))] {
+              self->EncryptWorker(std::move(*data));
+            });
         m_EncryptNext.clear();
       }
 
       if (not m_DecryptNext.empty())
       {
         m_Parent->QueueWork(
-            [self = shared_from_this(), data = m_DecryptNext] { self->DecryptWorker(data); });
+            m_WorkerAffinity,
+            [self = shared_from_this(),
+             data = std::make_shared<CryptoQueue_t>(std::move(m_DecryptNext))] {
+              self->DecryptWorker(std::move(*data));
+            });
         m_DecryptNext.clear();
       }
     }
@@ -317,7 +515,12 @@ namespace llarp
     Session::GetSessionStats() const
     {
       // TODO: thread safety
-      return m_Stats;
+      auto stats = m_Stats;
+      stats.congestionWindow = m_CC.Window();
+      stats.fragmentsInFlight = m_CC.InFlight();
+      stats.smoothedRTT = m_CC.SmoothedRTT();
+      stats.pacingRate = m_CC.PacingRate() * m_PMTU.FragmentSize();
+      return stats;
     }
 
     util::StatusObject
@@ -337,13 +540,22 @@ namespace llarp
           {"txPktsAcked", m_Stats.totalAckedTX},
           {"txPktsDropped", m_Stats.totalDroppedTX},
           {"txPktsInFlight", m_Stats.totalInFlightTX},
+          {"bytesCopied", m_Stats.totalBytesCopied},
 
           {"state", StateToString(m_State)},
           {"inbound", m_Inbound},
           {"replayFilter", m_ReplayFilter.size()},
           {"txMsgQueueSize", m_TXMsgs.size()},
           {"rxMsgQueueSize", m_RXMsgs.size()},
+          {"txMsgRingSlots", m_TXMsgs.Capacity()},
+          {"rxMsgRingSlots", m_RXMsgs.Capacity()},
+          {"congestion", m_CC.ExtractStatus()},
+          {"pathMTU", m_PMTU.ExtractStatus()},
+          {"remoteFeatures", m_RemoteFeatures},
+          {"sacksSent", m_SACKsSent},
+          {"fastRetransmits", m_FastRetransmits},
           {"remoteAddr", m_RemoteAddr.toString()},
+          {"packetBuffers", Buffers().ExtractStatus()},
           {"remoteRC", m_RemoteRC.ExtractStatus()},
           {"created", to_json(m_CreatedAt)},
           {"uptime", to_json(now - m_CreatedAt)}};
@@ -387,34 +599,30 @@ namespace llarp
       }
       // remove pending outbound messsages that timed out
       // inform waiters
+      // msgids are handed out in send order, so the timed out ones are the oldest
+      while (auto* msg = m_TXMsgs.Front())
       {
-        auto itr = m_TXMsgs.begin();
-        while (itr != m_TXMsgs.end())
-        {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_Stats.totalDroppedTX++;
-            m_Stats.totalInFlightTX--;
-            LogTrace("Dropped unacked packet to ", m_RemoteAddr);
-            itr->second.InformTimeout();
-            itr = m_TXMsgs.erase(itr);
-          }
-          else
-            ++itr;
-        }
+        if (not msg->IsTimedOut(now))
+          break;
+        m_Stats.totalDroppedTX++;
+        m_Stats.totalInFlightTX--;
+        LogTrace("Dropped unacked packet to ", m_RemoteAddr);
+        m_CC.OnDiscard(msg->InFlight());
+        m_PMTU.OnDeliveryTimeout(now);
+        msg->InformTimeout();
+        m_TXMsgs.Erase(msg->m_MsgID);
       }
       {
         // remove pending inbound messages that timed out
-        auto itr = m_RXMsgs.begin();
-        while (itr != m_RXMsgs.end())
+        std::vector<uint64_t> timedout;
+        m_RXMsgs.ForEach([&](const InboundMessage& msg) {
+          if (msg.IsTimedOut(now))
+            timedout.push_back(msg.m_MsgID);
+        });
+        for (const auto rxid : timedout)
         {
-          if (itr->second.IsTimedOut(now))
-          {
-            m_ReplayFilter.emplace(itr->first, now);
-            itr = m_RXMsgs.erase(itr);
-          }
-          else
-            ++itr;
+          m_ReplayFilter.emplace(rxid, now);
+          m_RXMsgs.Erase(rxid);
         }
       }
       {
@@ -441,7 +649,7 @@ namespace llarp
       TunnelNonce N;
       N.Randomize();
       {
-        ILinkSession::Packet_t req(Introduction::SIZE + PacketOverhead);
+        auto req = Buffers().Acquire(Introduction::SIZE + PacketOverhead);
         const auto pk = m_Parent->GetOurRC().pubkey;
         const auto e_pk = m_Parent->RouterEncryptionSecret().toPublic();
         auto itr = req.data() + PacketOverhead;
@@ -541,7 +749,7 @@ namespace llarp
         LogError("failed to transport_dh_server on inbound intro from ", m_RemoteAddr);
         return;
       }
-      Packet_t reply(token.size() + PacketOverhead);
+      auto reply = Buffers().Acquire(token.size() + PacketOverhead);
       // random nonce
       CryptoManager::instance()->randbytes(reply.data() + HMACSIZE, TUNNONCESIZE);
       // set token
@@ -567,7 +775,7 @@ namespace llarp
             m_RemoteAddr);
         return;
       }
-      Packet_t reply(token.size() + PacketOverhead);
+      auto reply = Buffers().Acquire(token.size() + PacketOverhead);
       if (not DecryptMessageInPlace(pkt))
       {
         LogError(m_Parent->PrintableName(), " intro ack decrypt failed from ", m_RemoteAddr);
@@ -591,38 +799,20 @@ namespace llarp
         LogError("packet too small from ", m_RemoteAddr);
         return false;
       }
-      const llarp_buffer_t buf(pkt);
-      ShortHash H;
-      llarp_buffer_t curbuf(buf.base, buf.sz);
-      curbuf.base += ShortHash::SIZE;
-      curbuf.sz -= ShortHash::SIZE;
-      if (not CryptoManager::instance()->hmac(H.data(), curbuf, m_SessionKey))
-      {
-        LogError("failed to caclulate keyed hash for ", m_RemoteAddr);
-        return false;
-      }
-      const ShortHash expected{buf.base};
-      if (H != expected)
+      if (not DecryptPacketInPlace(pkt, m_SessionKey))
       {
         LogDebug(
             m_Parent->PrintableName(),
-            " keyed hash mismatch ",
-            H,
-            " != ",
-            expected,
-            " from ",
+            " keyed hash mismatch from ",
             m_RemoteAddr,
             " state=",
             int(m_State),
             " size=",
-            buf.sz);
+            pkt.size());
         return false;
       }
-      const TunnelNonce N{curbuf.base};
-      curbuf.base += 32;
-      curbuf.sz -= 32;
-      LogTrace("decrypt: ", curbuf.sz, " bytes from ", m_RemoteAddr);
-      return CryptoManager::instance()->xchacha20(curbuf, m_SessionKey, N);
+      LogTrace("decrypt: ", pkt.size() - PacketOverhead, " bytes from ", m_RemoteAddr);
+      return true;
     }
 
     void
@@ -643,28 +833,29 @@ namespace llarp
     void
     Session::DecryptWorker(CryptoQueue_t msgs)
     {
-      auto itr = msgs.begin();
-      while (itr != msgs.end())
-      {
-        auto& pkt = *itr;
-        if (not DecryptMessageInPlace(pkt))
-        {
-          itr = msgs.erase(itr);
-          LogError("failed to decrypt session data from ", m_RemoteAddr);
-          continue;
-        }
-        if (pkt[PacketOverhead] != llarp::constants::proto_version)
-        {
-          LogError(
-              "protocol version mismatch ",
-              int(pkt[PacketOverhead]),
-              " != ",
-              llarp::constants::proto_version);
-          itr = msgs.erase(itr);
-          continue;
-        }
-        ++itr;
-      }
+      // drop anything that fails to decrypt by compacting the batch in place; the surviving packet
+      // handles are moved, never their contents
+      if (const auto dropped = DecryptPacketsInPlace(msgs, m_SessionKey); dropped > 0)
+        LogError("failed to decrypt ", dropped, " packets of session data from ", m_RemoteAddr);
+      msgs.erase(
+          std::remove_if(
+              msgs.begin(),
+              msgs.end(),
+              [](auto& pkt) {
+                if (pkt[PacketOverhead] != llarp::constants::proto_version)
+                {
+                  LogError(
+                      "protocol version mismatch ",
+                      int(pkt[PacketOverhead]),
+                      " != ",
+                      llarp::constants::proto_version);
+                  return true;
+                }
+                return false;
+              }),
+          msgs.end());
+      if (msgs.empty())
+        return;
       m_PlaintextRecv.tryPushBack(std::move(msgs));
       m_PlaintextEmpty.clear();
       m_Parent->WakeupPlaintext();
@@ -703,12 +894,17 @@ namespace llarp
             case Command::eMACK:
               HandleMACK(std::move(result));
               break;
+            case Command::eSACK:
+              HandleSACK(std::move(result));
+              break;
             default:
               LogError("invalid command ", int(result[PacketOverhead + 1]), " from ", m_RemoteAddr);
           }
         }
       }
       SendMACK();
+      // acks may have opened the congestion window
+      SendPaced(m_Parent->Now());
       m_Parent->WakeupPlaintext();
     }
 
@@ -732,13 +928,14 @@ namespace llarp
       {
         auto acked = oxenc::load_big_to_host<uint64_t>(ptr);
         LogTrace("mack containing txid=", acked, " from ", m_RemoteAddr);
-        auto itr = m_TXMsgs.find(acked);
-        if (itr != m_TXMsgs.end())
+        if (auto* msg = m_TXMsgs.Find(acked))
         {
           m_Stats.totalAckedTX++;
           m_Stats.totalInFlightTX--;
-          itr->second.Completed();
-          m_TXMsgs.erase(itr);
+          m_CC.OnAcked(msg->InFlight(), m_Parent->Now());
+          m_PMTU.OnDelivered();
+          msg->Completed();
+          m_TXMsgs.Erase(acked);
         }
         else
         {
@@ -759,20 +956,19 @@ namespace llarp
       }
       auto txid = oxenc::load_big_to_host<uint64_t>(data.data() + CommandOverhead + PacketOverhead);
       LogTrace("got nack on ", txid, " from ", m_RemoteAddr);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr != m_TXMsgs.end())
+      const auto now = m_Parent->Now();
+      if (auto* msg = m_TXMsgs.Find(txid))
       {
-        EncryptAndSend(itr->second.XMIT());
+        // they never got our XMIT
+        m_CC.OnLoss(msg->Requeue(Fragments_t{1}), now);
+        m_PacedTX.push_front(txid);
       }
-      m_LastRX = m_Parent->Now();
+      m_LastRX = now;
     }
 
     void
     Session::HandleXMIT(Packet_t data)
     {
-      static constexpr size_t XMITOverhead =
-          (CommandOverhead + PacketOverhead + sizeof(uint16_t) + sizeof(uint64_t)
-           + ShortHash::SIZE);
       if (data.size() < XMITOverhead)
       {
         LogError("short XMIT from ", m_RemoteAddr);
@@ -799,32 +995,42 @@ namespace llarp
       }
       {
         const auto now = m_Parent->Now();
-        auto itr = m_RXMsgs.find(rxid);
-        if (itr == m_RXMsgs.end())
+        if (m_RXMsgs.Find(rxid) == nullptr)
         {
-          itr = m_RXMsgs.emplace(rxid, InboundMessage{rxid, sz, ShortHash{pos}, m_Parent->Now()})
-                    .first;
+          // the XMIT carries all of fragment 0, so its size is the fragment size the sender
+          // picked for this message (or more than the whole message)
+          const size_t extra = data.size() - XMITOverhead;
+          if (extra > sz or (extra < sz and (extra < FragmentSize or extra > MaxFragmentSize)))
+          {
+            LogError("bad xmit of ", extra, " bytes for ", sz, " from ", m_RemoteAddr);
+            return;
+          }
+          const size_t fragsize = std::max(extra, FragmentSize);
+          auto* msg = m_RXMsgs.Emplace(InboundMessage{rxid, sz, ShortHash{pos}, now, fragsize});
+          if (msg == nullptr)
+          {
+            LogDebug("rxid=", rxid, " too far outside receive window from ", m_RemoteAddr);
+            return;
+          }
+          m_ACKTimers.Schedule(rxid, now);
           TriggerPump();
 
-          sz = std::min(sz, uint16_t{FragmentSize});
-          if ((data.size() - XMITOverhead) == sz)
           {
+            const llarp_buffer_t buf(data.data() + XMITOverhead, extra);
+            msg->HandleData(0, buf, now);
+            m_Stats.totalBytesCopied += buf.sz;
+            if (not msg->IsCompleted())
             {
-              const llarp_buffer_t buf(data.data() + (data.size() - sz), sz);
-              itr->second.HandleData(0, buf, now);
-              if (not itr->second.IsCompleted())
-              {
-                return;
-              }
-
-              if (not itr->second.Verify())
-              {
-                LogError("bad short xmit hash from ", m_RemoteAddr);
-                return;
-              }
+              return;
+            }
+
+            if (not msg->Verify())
+            {
+              LogError("bad short xmit hash from ", m_RemoteAddr);
+              return;
             }
-            HandleRecvMsgCompleted(itr->second);
           }
+          HandleRecvMsgCompleted(*msg);
         }
         else
           LogTrace("got duplicate xmit on ", rxid, " from ", m_RemoteAddr);
@@ -834,7 +1040,7 @@ namespace llarp
     void
     Session::HandleDATA(Packet_t data)
     {
-      if (data.size() < (CommandOverhead + sizeof(uint16_t) + sizeof(uint64_t) + PacketOverhead))
+      if (data.size() < DATAOverhead)
       {
         LogError("short DATA from ", m_RemoteAddr, " ", data.size());
         return;
@@ -843,13 +1049,13 @@ namespace llarp
       auto sz = oxenc::load_big_to_host<uint16_t>(data.data() + CommandOverhead + PacketOverhead);
       auto rxid = oxenc::load_big_to_host<uint64_t>(
           data.data() + CommandOverhead + sizeof(uint16_t) + PacketOverhead);
-      auto itr = m_RXMsgs.find(rxid);
-      if (itr == m_RXMsgs.end())
+      auto* msg = m_RXMsgs.Find(rxid);
+      if (msg == nullptr)
       {
         if (m_ReplayFilter.find(rxid) == m_ReplayFilter.end())
         {
           LogTrace("no rxid=", rxid, " for ", m_RemoteAddr);
-          auto nack = CreatePacket(Command::eNACK, 8);
+          auto nack = CreatePacket(Buffers(), Command::eNACK, 8);
           oxenc::write_host_as_big(rxid, nack.data() + PacketOverhead + CommandOverhead);
           EncryptAndSend(std::move(nack));
         }
@@ -862,20 +1068,28 @@ namespace llarp
       }
 
       {
-        const llarp_buffer_t buf(
-            data.data() + PacketOverhead + 12, data.size() - (PacketOverhead + 12));
-        itr->second.HandleData(sz, buf, m_Parent->Now());
+        const llarp_buffer_t buf(data.data() + DATAOverhead, data.size() - DATAOverhead);
+        msg->HandleData(sz, buf, m_Parent->Now());
+        m_Stats.totalBytesCopied += buf.sz;
       }
 
-      if (itr->second.IsCompleted())
+      // tell the sender about gaps and progress as we see them instead of waiting for the next
+      // ACKS
+      if (not msg->IsCompleted() and (m_RemoteFeatures & FeatureSACK) and msg->ShouldSendSACK())
       {
-        if (itr->second.Verify())
+        EncryptAndSend(msg->SACK(Buffers()));
+        m_SACKsSent++;
+      }
+
+      if (msg->IsCompleted())
+      {
+        if (msg->Verify())
         {
-          HandleRecvMsgCompleted(itr->second);
+          HandleRecvMsgCompleted(*msg);
         }
         else
         {
-          LogError("hash mismatch for message ", itr->first);
+          LogError("hash mismatch for message ", rxid);
         }
       }
     }
@@ -887,10 +1101,10 @@ namespace llarp
       if (m_ReplayFilter.emplace(rxid, m_Parent->Now()).second)
       {
         m_Parent->HandleMessage(this, msg.m_Data);
-        EncryptAndSend(msg.ACKS());
+        EncryptAndSend(msg.ACKS(Buffers()));
         LogDebug("recv'd message ", rxid, " from ", m_RemoteAddr);
       }
-      m_RXMsgs.erase(rxid);
+      m_RXMsgs.Erase(rxid);
     }
 
     void
@@ -904,24 +1118,66 @@ namespace llarp
       const auto now = m_Parent->Now();
       m_LastRX = now;
       auto txid = oxenc::load_big_to_host<uint64_t>(data.data() + 2 + PacketOverhead);
-      auto itr = m_TXMsgs.find(txid);
-      if (itr == m_TXMsgs.end())
+      auto* msg = m_TXMsgs.Find(txid);
+      if (msg == nullptr)
       {
         LogTrace("no txid=", txid, " for ", m_RemoteAddr);
         return;
       }
-      itr->second.Ack(data[10 + PacketOverhead]);
+      GotAcks(*msg, data[10 + PacketOverhead], now);
+    }
 
-      if (itr->second.IsTransmitted())
+    void
+    Session::HandleSACK(Packet_t data)
+    {
+      const auto sack = DecodeSACK(data);
+      if (not sack)
       {
-        LogDebug("sent message ", itr->first, " to ", m_RemoteAddr);
-        itr->second.Completed();
-        itr = m_TXMsgs.erase(itr);
+        LogError("short SACK from ", m_RemoteAddr);
+        return;
       }
-      else
+      const auto now = m_Parent->Now();
+      m_LastRX = now;
+      auto* msg = m_TXMsgs.Find(sack->msgid);
+      if (msg == nullptr)
       {
-        itr->second.FlushUnAcked(util::memFn(&Session::EncryptAndSend, this), now);
+        LogTrace("no txid=", sack->msgid, " for ", m_RemoteAddr);
+        return;
+      }
+      if (GotAcks(*msg, sack->acks, now))
+        return;
+      if (const auto lost = msg->FastRetransmit(sack->gaps, now, m_CC.MinRTT()))
+      {
+        LogTrace(
+            "fast retransmit ", lost, " fragments of txid=", sack->msgid, " to ", m_RemoteAddr);
+        m_CC.OnLoss(lost, now);
+        m_PacedTX.push_front(sack->msgid);
+        m_FastRetransmits += lost;
+      }
+    }
+
+    bool
+    Session::GotAcks(OutboundMessage& msg, byte_t bitmask, llarp_time_t now)
+    {
+      if (const auto acked = msg.Ack(bitmask))
+      {
+        if (msg.m_RTTSampleable)
+        {
+          m_CC.OnRTTSample(now - msg.m_FirstSentAt);
+          msg.m_RTTSampleable = false;
+        }
+        m_CC.OnAcked(acked, now);
       }
+      // the rest are either still on their way or get resent by the pacer when their
+      // retransmit timeout comes up
+      if (not msg.IsTransmitted())
+        return false;
+      const auto txid = msg.m_MsgID;
+      LogDebug("sent message ", txid, " to ", m_RemoteAddr);
+      m_PMTU.OnDelivered();
+      msg.Completed();
+      m_TXMsgs.Erase(txid);
+      return true;
     }
 
     void Session::HandleCLOS(Packet_t)
@@ -930,9 +1186,35 @@ namespace llarp
       Close();
     }
 
-    void Session::HandlePING(Packet_t)
+    void
+    Session::HandlePING(Packet_t data)
     {
-      m_LastRX = m_Parent->Now();
+      const auto now = m_Parent->Now();
+      m_LastRX = now;
+      if (data.size() < PacketOverhead + CommandOverhead + 16)
+        return;
+      const byte_t* ptr = data.data() + PacketOverhead + CommandOverhead;
+      if (oxenc::load_big_to_host<uint64_t>(ptr) != FeatureMagic)
+        return;
+      const auto features = oxenc::load_big_to_host<uint64_t>(ptr + 8);
+      if (features != m_RemoteFeatures)
+        LogDebug("remote features ", features, " from ", m_RemoteAddr);
+      m_RemoteFeatures = features;
+      // a peer that only ACKs now and then would see retransmits of fragments it has
+      m_CC.SetMinRTO(features & FeatureSACK ? CongestionControl::MinRTO : TXFlushInterval);
+      // without FeaturePMTU the rest is keepalive pad
+      if (not(features & FeaturePMTU)
+          or data.size() < PacketOverhead + CommandOverhead + KeepAliveSize)
+        return;
+      const auto probe = oxenc::load_big_to_host<uint16_t>(ptr + 16);
+      const auto probeAck = oxenc::load_big_to_host<uint16_t>(ptr + 18);
+      if (probeAck)
+        m_PMTU.OnProbeAcked(probeAck, now);
+      if (probe and probe <= MaxFragmentSize and data.size() >= XMITOverhead + probe)
+      {
+        LogTrace("acking ", probe, " byte path mtu probe from ", m_RemoteAddr);
+        SendPING(0, probe);
+      }
     }
 
     bool
@@ -940,18 +1222,40 @@ namespace llarp
     {
       if (m_State == State::Ready)
       {
-        EncryptAndSend(CreatePacket(Command::ePING, 0));
+        SendPING(0, 0);
         return true;
       }
       return false;
     }
 
+    void
+    Session::SendPING(uint16_t probe, uint16_t probeAck)
+    {
+      const size_t plainsize =
+          probe ? XMITOverhead - PacketOverhead - CommandOverhead + probe : KeepAliveSize;
+      // probes are exactly as big as the XMIT they stand in for, so no random pad
+      auto ping = probe ? CreatePacket(Buffers(), Command::ePING, plainsize, 0, 0)
+                        : CreatePacket(Buffers(), Command::ePING, plainsize);
+      byte_t* ptr = ping.data() + PacketOverhead + CommandOverhead;
+      oxenc::write_host_as_big(FeatureMagic, ptr);
+      oxenc::write_host_as_big(OurFeatures, ptr + 8);
+      oxenc::write_host_as_big(probe, ptr + 16);
+      oxenc::write_host_as_big(probeAck, ptr + 18);
+      EncryptAndSend(std::move(ping));
+    }
+
     bool
     Session::IsEstablished() const
     {
       return m_State == State::Ready;
     }
 
+    bool
+    Session::IsClosed() const
+    {
+      return m_State == State::Closed;
+    }
+
     bool
     Session::Recv_LL(ILinkSession::Packet_t data)
     {
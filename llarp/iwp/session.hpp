@@ -2,7 +2,10 @@
 
 #include <llarp/link/session.hpp>
 #include "linklayer.hpp"
+#include "congestion.hpp"
 #include "message_buffer.hpp"
+#include "message_table.hpp"
+#include "path_mtu.hpp"
 #include <llarp/net/ip_address.hpp>
 
 #include <map>
@@ -16,11 +19,29 @@ namespace llarp
 {
   namespace iwp
   {
-    /// packet crypto overhead size
-    static constexpr size_t PacketOverhead = HMACSIZE + TUNNONCESIZE;
     /// creates a packet with plaintext size + wire overhead + random pad
     ILinkSession::Packet_t
-    CreatePacket(Command cmd, size_t plainsize, size_t min_pad = 16, size_t pad_variance = 16);
+    CreatePacket(
+        PacketBufferPool& pool,
+        Command cmd,
+        size_t plainsize,
+        size_t min_pad = 16,
+        size_t pad_variance = 16);
+    /// encrypt and authenticate a packet built by CreatePacket in place with a session key
+    void
+    EncryptPacketInPlace(ILinkSession::Packet_t& pkt, const SharedSecret& key);
+    /// authenticate and decrypt a packet in place with a session key; returns false if the packet
+    /// is too short or its keyed hash does not match
+    bool
+    DecryptPacketInPlace(ILinkSession::Packet_t& pkt, const SharedSecret& key);
+    /// EncryptPacketInPlace over a batch of packets sharing a session key, using the batch crypto
+    /// api so several packets are ciphered at once
+    void
+    EncryptPacketsInPlace(std::vector<ILinkSession::Packet_t>& pkts, const SharedSecret& key);
+    /// DecryptPacketInPlace over a batch of packets sharing a session key; packets that fail are
+    /// removed from the batch.  returns how many were removed.
+    size_t
+    DecryptPacketsInPlace(std::vector<ILinkSession::Packet_t>& pkts, const SharedSecret& key);
     /// Time how long we try delivery for
     static constexpr std::chrono::milliseconds DeliveryTimeout = 500ms;
     /// Time how long we wait to recieve a message
@@ -35,6 +56,31 @@ namespace llarp
     static constexpr std::chrono::milliseconds PingInterval = 5s;
     /// How long we wait for a session to die with no tx from them
     static constexpr auto SessionAliveTimeout = PingInterval * 5;
+    /// bucket width of the per session ack / retransmit timer wheels
+    static constexpr std::chrono::milliseconds MessageTimerResolution = 10ms;
+    /// enough buckets that one turn of the wheel covers the longest ack / retransmit interval
+    static constexpr size_t MessageTimerBuckets = 64;
+    static_assert(MessageTimerResolution * MessageTimerBuckets > TXFlushInterval);
+    static_assert(MessageTimerResolution * MessageTimerBuckets > ACKResendInterval);
+
+    /// optional protocol features a session advertises in the payload of its keepalives; older
+    /// peers ignore that payload, so they never see anything they don't understand
+    enum Feature : uint64_t
+    {
+      /// wants eSACK sent as fragments arrive, and fast retransmits the gaps they report
+      FeatureSACK = 1 << 0,
+      /// answers path mtu probes and takes fragments bigger than FragmentSize
+      FeaturePMTU = 1 << 1,
+    };
+    /// features this build speaks
+    static constexpr uint64_t OurFeatures = FeatureSACK | FeaturePMTU;
+    /// leads the feature bits in a keepalive, so an older peer's random keepalive pad is not
+    /// taken for them ("iwpfeat1")
+    static constexpr uint64_t FeatureMagic = 0x6977706665617431;
+    /// keepalive plaintext: FeatureMagic, our feature bits, then with FeaturePMTU the fragment
+    /// size this keepalive probes for (0 if it is not a probe, which is padded out to the size
+    /// of an XMIT carrying such a fragment) and the fragment size of a probe we are acking
+    static constexpr size_t KeepAliveSize = 20;
 
     struct Session : public ILinkSession, public std::enable_shared_from_this<Session>
     {
@@ -68,6 +114,10 @@ namespace llarp
       void
       Send_LL(const byte_t* buf, size_t sz);
 
+      /// send a batch of encrypted packets to the remote in as few syscalls as possible
+      void
+      SendBatch_LL(const std::vector<Packet_t>& pkts);
+
       void EncryptAndSend(ILinkSession::Packet_t);
 
       void
@@ -84,6 +134,9 @@ namespace llarp
       bool
       IsEstablished() const override;
 
+      bool
+      IsClosed() const override;
+
       bool
       TimedOut(llarp_time_t now) const override;
 
@@ -153,6 +206,14 @@ namespace llarp
       };
       static std::string
       StateToString(State state);
+
+      /// the pool we lease packet buffers from (owned by our link layer)
+      PacketBufferPool&
+      Buffers() const
+      {
+        return m_Parent->PacketBuffers();
+      }
+
       State m_State;
       SessionStats m_Stats;
 
@@ -162,6 +223,8 @@ namespace llarp
       LinkLayer* const m_Parent;
       const llarp_time_t m_CreatedAt;
       const SockAddr m_RemoteAddr;
+      /// picks the crypto worker shard for this session, so its batches run in order on one thread
+      const uint64_t m_WorkerAffinity;
 
       AddressInfo m_ChosenAI;
       /// remote rc
@@ -191,8 +254,37 @@ namespace llarp
       void
       ResetRates();
 
-      std::map<uint64_t, InboundMessage> m_RXMsgs;
-      std::map<uint64_t, OutboundMessage> m_TXMsgs;
+      MessageTable<InboundMessage> m_RXMsgs{MaxSendQueueSize};
+      MessageTable<OutboundMessage> m_TXMsgs{MaxSendQueueSize};
+      /// when each rx message next needs its acks sent
+      MessageTimerWheel m_ACKTimers{MessageTimerResolution, MessageTimerBuckets};
+      /// when each tx message next needs its unacked fragments flushed
+      MessageTimerWheel m_FlushTimers{MessageTimerResolution, MessageTimerBuckets};
+      /// paces tx fragments and sizes how many may be in flight
+      CongestionControl m_CC{TXFlushInterval};
+      /// tx msgids with fragments waiting on the pacer, oldest first
+      std::deque<uint64_t> m_PacedTX;
+      /// a pacer timer is pending on the event loop
+      bool m_PacerArmed = false;
+      /// Feature bits the remote advertised
+      uint64_t m_RemoteFeatures = 0;
+      uint64_t m_SACKsSent = 0;
+      uint64_t m_FastRetransmits = 0;
+      /// picks the size of the fragments we send
+      PathMTU m_PMTU;
+
+      /// send a keepalive, probing or acking a path mtu probe when those are non zero
+      void
+      SendPING(uint16_t probe, uint16_t probeAck);
+
+      /// send pending tx fragments for as long as the congestion window and pacer allow,
+      /// arming the pacer timer if it is the pacer that stops us; returns true if anything was
+      /// sent
+      bool
+      SendPaced(llarp_time_t now);
+
+      void
+      ArmPacer(llarp_time_t delay);
 
       /// maps rxid to time recieved
       std::unordered_map<uint64_t, llarp_time_t> m_ReplayFilter;
@@ -262,6 +354,14 @@ namespace llarp
       void
       HandleACKS(Packet_t msg);
 
+      void
+      HandleSACK(Packet_t msg);
+
+      /// apply an acks bitmask from an ACKS or SACK to a tx message, completing and removing it
+      /// once every fragment is acked; returns true if it was removed
+      bool
+      GotAcks(OutboundMessage& msg, byte_t bitmask, llarp_time_t now);
+
       void
       HandleNACK(Packet_t msg);
 
@@ -29,7 +29,7 @@ namespace llarp
     virtual bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
+        ILinkSession::Message_t buf,
         ILinkSession::CompletionHandler completed,
         uint16_t priority = 0) = 0;
 
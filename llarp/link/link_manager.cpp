@@ -37,7 +37,7 @@ namespace llarp
   bool
   LinkManager::SendTo(
       const RouterID& remote,
-      const llarp_buffer_t& buf,
+      ILinkSession::Message_t buf,
       ILinkSession::CompletionHandler completed,
       uint16_t priority)
   {
@@ -54,7 +54,7 @@ namespace llarp
       return false;
     }
 
-    return link->SendTo(remote, buf, completed, priority);
+    return link->SendTo(remote, std::move(buf), completed, priority);
   }
 
   bool
@@ -27,7 +27,7 @@ namespace llarp
     bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
+        ILinkSession::Message_t buf,
         ILinkSession::CompletionHandler completed,
         uint16_t priority) override;
 
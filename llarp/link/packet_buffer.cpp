@@ -0,0 +1,100 @@
+#include "packet_buffer.hpp"
+
+#include <llarp/util/buffer_pool.hpp>
+
+#include <algorithm>
+#include <utility>
+
+namespace llarp
+{
+  namespace
+  {
+    using Buffers = util::SizeClassPool<PacketBufferPool::BufferSize>;
+    static_assert(Buffers::SlabBuffers == PacketBufferPool::SlabBuffers);
+    static_assert(Buffers::ReleaseThreshold == PacketBufferPool::ReleaseThreshold);
+  }  // namespace
+
+  PacketBuffer::PacketBuffer(PacketBuffer&& other) noexcept
+      : m_Data{std::exchange(other.m_Data, nullptr)}
+      , m_Size{std::exchange(other.m_Size, 0)}
+      , m_Capacity{std::exchange(other.m_Capacity, 0)}
+  {}
+
+  PacketBuffer&
+  PacketBuffer::operator=(PacketBuffer&& other) noexcept
+  {
+    if (this != &other)
+    {
+      Release();
+      m_Data = std::exchange(other.m_Data, nullptr);
+      m_Size = std::exchange(other.m_Size, 0);
+      m_Capacity = std::exchange(other.m_Capacity, 0);
+    }
+    return *this;
+  }
+
+  PacketBuffer::~PacketBuffer()
+  {
+    Release();
+  }
+
+  void
+  PacketBuffer::Release()
+  {
+    if (m_Data == nullptr)
+      return;
+    if (m_Capacity == PacketBufferPool::BufferSize)
+      Buffers::Give(0, m_Data);
+    else
+      delete[] m_Data;
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Capacity = 0;
+  }
+
+  PacketBuffer
+  PacketBufferPool::Acquire(size_t sz)
+  {
+    if (sz > BufferSize)
+    {
+      m_Misses.fetch_add(1, std::memory_order_relaxed);
+      m_Oversized.fetch_add(1, std::memory_order_relaxed);
+      return PacketBuffer{new byte_t[sz], sz, sz};
+    }
+    if (auto* buf = Buffers::TakeFree(0))
+    {
+      m_Hits.fetch_add(1, std::memory_order_relaxed);
+      return PacketBuffer{buf, sz, BufferSize};
+    }
+    m_Misses.fetch_add(1, std::memory_order_relaxed);
+    m_Slabs.fetch_add(1, std::memory_order_relaxed);
+    return PacketBuffer{Buffers::Carve(0), sz, BufferSize};
+  }
+
+  PacketBuffer
+  PacketBufferPool::CopyFrom(const byte_t* ptr, size_t sz)
+  {
+    auto pkt = Acquire(sz);
+    std::copy_n(ptr, sz, pkt.data());
+    m_BytesCopied.fetch_add(sz, std::memory_order_relaxed);
+    return pkt;
+  }
+
+  uint64_t
+  PacketBufferPool::ReleasedSlabs()
+  {
+    return Buffers::ReleasedSlabs();
+  }
+
+  util::StatusObject
+  PacketBufferPool::ExtractStatus() const
+  {
+    return util::StatusObject{
+        {"hits", Hits()},
+        {"misses", Misses()},
+        {"oversized", m_Oversized.load(std::memory_order_relaxed)},
+        {"bytesCopied", BytesCopied()},
+        {"allocated", m_Slabs.load(std::memory_order_relaxed) * SlabBuffers},
+        {"releasedSlabs", ReleasedSlabs()}};
+  }
+}  // namespace llarp
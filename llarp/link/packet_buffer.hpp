@@ -0,0 +1,188 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/types.hpp>
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace llarp
+{
+  class PacketBufferPool;
+
+  /// owning handle to a packet buffer leased from a PacketBufferPool; the buffer goes back to the
+  /// free list of the thread that destroys the handle.  move only, so a packet can be handed from
+  /// the socket through the crypto workers and back out to the socket without ever being copied.
+  class PacketBuffer
+  {
+   public:
+    PacketBuffer() = default;
+
+    PacketBuffer(const PacketBuffer&) = delete;
+    PacketBuffer&
+    operator=(const PacketBuffer&) = delete;
+
+    PacketBuffer(PacketBuffer&& other) noexcept;
+    PacketBuffer&
+    operator=(PacketBuffer&& other) noexcept;
+
+    ~PacketBuffer();
+
+    byte_t*
+    data()
+    {
+      return m_Data;
+    }
+
+    const byte_t*
+    data() const
+    {
+      return m_Data;
+    }
+
+    size_t
+    size() const
+    {
+      return m_Size;
+    }
+
+    bool
+    empty() const
+    {
+      return m_Size == 0;
+    }
+
+    size_t
+    capacity() const
+    {
+      return m_Capacity;
+    }
+
+    /// grow or shrink the packet; the new size must fit in the leased buffer
+    void
+    resize(size_t sz)
+    {
+      assert(sz <= m_Capacity);
+      m_Size = sz;
+    }
+
+    byte_t&
+    operator[](size_t idx)
+    {
+      assert(idx < m_Size);
+      return m_Data[idx];
+    }
+
+    const byte_t&
+    operator[](size_t idx) const
+    {
+      assert(idx < m_Size);
+      return m_Data[idx];
+    }
+
+    byte_t*
+    begin()
+    {
+      return m_Data;
+    }
+
+    byte_t*
+    end()
+    {
+      return m_Data + m_Size;
+    }
+
+    const byte_t*
+    begin() const
+    {
+      return m_Data;
+    }
+
+    const byte_t*
+    end() const
+    {
+      return m_Data + m_Size;
+    }
+
+   private:
+    friend class PacketBufferPool;
+
+    PacketBuffer(byte_t* buf, size_t sz, size_t cap) : m_Data{buf}, m_Size{sz}, m_Capacity{cap}
+    {}
+
+    void
+    Release();
+
+    byte_t* m_Data = nullptr;
+    size_t m_Size = 0;
+    size_t m_Capacity = 0;
+  };
+
+  /// thread safe allocator for fixed size (mtu sized) packet buffers.
+  ///
+  /// buffers come from a process wide util::SizeClassPool with a single class, so leasing and
+  /// returning one takes no lock, steady state traffic does not touch the heap, and slabs left
+  /// idle after a burst are freed.  slabs belong to the process and not to a pool, so leased
+  /// buffers may outlive their pool.  requests larger than BufferSize are served from the heap
+  /// and counted as oversized.
+  class PacketBufferPool
+  {
+   public:
+    /// size of every pooled buffer; fits any datagram we accept on a link socket
+    static constexpr size_t BufferSize = 2048;
+    /// how many buffers we allocate at once when the free list runs dry
+    static constexpr size_t SlabBuffers = 64;
+    static constexpr size_t SlabBytes = BufferSize * SlabBuffers;
+    /// idle buffers the shared free list holds before it frees the slabs it has all of
+    static constexpr size_t ReleaseThreshold = 8192;
+
+    PacketBufferPool() = default;
+    PacketBufferPool(const PacketBufferPool&) = delete;
+    PacketBufferPool(PacketBufferPool&&) = delete;
+
+    /// lease a buffer holding `sz` bytes; the contents are uninitialized
+    PacketBuffer
+    Acquire(size_t sz);
+
+    /// lease a buffer holding a copy of [ptr, ptr + sz)
+    PacketBuffer
+    CopyFrom(const byte_t* ptr, size_t sz);
+
+    /// number of leases served from a free list
+    uint64_t
+    Hits() const
+    {
+      return m_Hits.load(std::memory_order_relaxed);
+    }
+
+    /// number of leases that needed a new slab (or a heap allocation if oversized)
+    uint64_t
+    Misses() const
+    {
+      return m_Misses.load(std::memory_order_relaxed);
+    }
+
+    /// total bytes copied into leased buffers by CopyFrom
+    uint64_t
+    BytesCopied() const
+    {
+      return m_BytesCopied.load(std::memory_order_relaxed);
+    }
+
+    /// number of slabs freed process wide because all their buffers sat idle
+    static uint64_t
+    ReleasedSlabs();
+
+    util::StatusObject
+    ExtractStatus() const;
+
+   private:
+    std::atomic<uint64_t> m_Hits{0};
+    std::atomic<uint64_t> m_Misses{0};
+    std::atomic<uint64_t> m_Oversized{0};
+    std::atomic<uint64_t> m_Slabs{0};
+    std::atomic<uint64_t> m_BytesCopied{0};
+  };
+}  // namespace llarp
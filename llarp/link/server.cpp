@@ -37,13 +37,15 @@ namespace llarp
       , PumpDone(std::move(pumpDone))
       , QueueWork(std::move(work))
       , m_RouterEncSecret(keyManager->encryptionKey)
+      , m_PacketBuffers{std::make_shared<PacketBufferPool>()}
       , m_SecretKey(keyManager->transportKey)
+      , m_SessionsByAddr{randint()}
   {}
 
   llarp_time_t
   ILinkLayer::Now() const
   {
-    return m_Router->loop()->time_now();
+    return m_Loop->time_now();
   }
 
   bool
@@ -132,15 +134,6 @@ namespace llarp
   bool
   ILinkLayer::Configure(AbstractRouter* router, std::string ifname, int af, uint16_t port)
   {
-    m_Router = router;
-    m_udp = m_Router->loop()->make_udp(
-        [this]([[maybe_unused]] UDPHandle& udp, const SockAddr& from, llarp_buffer_t buf) {
-          ILinkSession::Packet_t pkt;
-          pkt.resize(buf.sz);
-          std::copy_n(buf.base, buf.sz, pkt.data());
-          RecvFrom(from, std::move(pkt));
-        });
-
     if (ifname == "*")
     {
       if (router->IsServiceNode())
@@ -203,12 +196,35 @@ namespace llarp
       }
     }
     m_ourAddr.setPort(port);
+    return Configure(router->loop(), [router] { router->TriggerPump(); }, m_ourAddr);
+  }
+
+  bool
+  ILinkLayer::Configure(EventLoop_ptr loop, std::function<void(void)> triggerPump, SockAddr addr)
+  {
+    m_Loop = std::move(loop);
+    m_TriggerPump = std::move(triggerPump);
+    m_ourAddr = std::move(addr);
+    m_udp = m_Loop->make_batched_udp(
+        [this]([[maybe_unused]] UDPHandle& udp, const std::vector<UDPDatagram>& pkts) {
+          RecvFromBatch(pkts);
+        });
     if (not m_udp->listen(m_ourAddr))
       return false;
+    m_DontFragment = m_udp->set_dont_fragment();
+    if (not m_DontFragment)
+      LogInfo("cannot set don't fragment on ", m_ourAddr, ", path mtu probing disabled");
 
     return true;
   }
 
+  void
+  ILinkLayer::RecvFromBatch(const std::vector<UDPDatagram>& pkts)
+  {
+    for (const auto& pkt : pkts)
+      RecvFrom(pkt.addr, m_PacketBuffers->CopyFrom(pkt.data, pkt.size));
+  }
+
   void
   ILinkLayer::Pump()
   {
@@ -230,7 +246,7 @@ namespace llarp
           llarp::LogInfo("session to ", RouterID(itr->second->GetPubKey()), " timed out");
           itr->second->Close();
           closedSessions.emplace(itr->first);
-          UnmapAddr(itr->second->GetRemoteEndpoint());
+          UnmapAddr(itr->second->GetRemoteEndpoint(), itr->second.get());
           itr = m_AuthedLinks.erase(itr);
         }
       }
@@ -249,7 +265,7 @@ namespace llarp
         else
         {
           LogInfo("pending session at ", itr->first, " timed out");
-          UnmapAddr(itr->second->GetRemoteEndpoint());
+          UnmapAddr(itr->second->GetRemoteEndpoint(), itr->second.get());
           // defer call so we can acquire mutexes later
           closedPending.emplace_back(std::move(itr->second));
           itr = m_Pending.erase(itr);
@@ -275,9 +291,9 @@ namespace llarp
   }
 
   void
-  ILinkLayer::UnmapAddr(const SockAddr& addr)
+  ILinkLayer::UnmapAddr(const SockAddr& addr, const ILinkSession* session)
   {
-    m_AuthedAddrs.erase(addr);
+    m_SessionsByAddr.Erase(addr, session);
   }
 
   bool
@@ -295,10 +311,10 @@ namespace llarp
         s->Close();
         return false;
       }
-      m_AuthedAddrs.emplace(addr, pk);
+      // already in m_SessionsByAddr from when it was pending
       m_AuthedLinks.emplace(pk, itr->second);
       itr = m_Pending.erase(itr);
-      m_Router->TriggerPump();
+      m_TriggerPump();
       return true;
     }
     return false;
@@ -397,7 +413,7 @@ namespace llarp
   {
     // Tie the lifetime of this repeater to this arbitrary shared_ptr:
     m_repeater_keepalive = std::make_shared<int>(0);
-    m_Router->loop()->call_every(
+    m_Loop->call_every(
         LINK_LAYER_TICK_INTERVAL, m_repeater_keepalive, [this] { Tick(Now()); });
     return true;
   }
@@ -486,10 +502,18 @@ namespace llarp
       LogError("could not send udp packet to ", to);
   }
 
+  void
+  ILinkLayer::SendBatchTo_LL(const std::vector<UDPDatagram>& pkts)
+  {
+    // what a full send buffer queued still goes out, so only drops are worth reporting
+    if (const auto result = m_udp->send_batch(pkts); result.dropped)
+      LogError("could not send ", result.dropped, " of ", pkts.size(), " udp packets");
+  }
+
   bool
   ILinkLayer::SendTo(
       const RouterID& remote,
-      const llarp_buffer_t& buf,
+      ILinkSession::Message_t buf,
       ILinkSession::CompletionHandler completed,
       uint16_t priority)
   {
@@ -508,9 +532,7 @@ namespace llarp
         }
       }
     }
-    ILinkSession::Message_t pkt(buf.sz);
-    std::copy_n(buf.base, buf.sz, pkt.begin());
-    return s && s->SendMessageBuffer(std::move(pkt), completed, priority);
+    return s && s->SendMessageBuffer(std::move(buf), completed, priority);
   }
 
   bool
@@ -540,7 +562,8 @@ namespace llarp
   {
     Lock_t lock(m_PendingMutex);
     const auto address = s->GetRemoteEndpoint();
-    if (m_Pending.count(address))
+    // a pending or established session already owns this address's datagrams
+    if (not m_SessionsByAddr.Insert(address, s))
       return false;
     m_Pending.emplace(address, s);
     return true;
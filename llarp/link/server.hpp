@@ -3,6 +3,7 @@
 #include <llarp/crypto/types.hpp>
 #include <llarp/ev/ev.hpp>
 #include "session.hpp"
+#include "session_index.hpp"
 #include <llarp/net/sock_addr.hpp>
 #include <llarp/router_contact.hpp>
 #include <llarp/util/status.hpp>
@@ -65,8 +66,9 @@ namespace llarp
   using PumpDoneHandler = std::function<void(void)>;
 
   using Work_t = std::function<void(void)>;
-  /// queue work to worker thread
-  using WorkerFunc_t = std::function<void(Work_t)>;
+  /// queue work to a worker thread; work queued with the same affinity key runs in order on the
+  /// same thread
+  using WorkerFunc_t = std::function<void(uint64_t, Work_t)>;
 
   /// before connection hook, called before we try connecting via outbound link
   using BeforeConnectFunc_t = std::function<void(llarp::RouterContact)>;
@@ -101,14 +103,24 @@ namespace llarp
     void
     ForEachSession(std::function<void(ILinkSession*)> visit) EXCLUDES(m_AuthedLinksMutex);
 
+    /// drop session's entry in the address index, unless a newer session has taken the address
     void
-    UnmapAddr(const SockAddr& addr);
+    UnmapAddr(const SockAddr& addr, const ILinkSession* session);
 
     void
     SendTo_LL(const SockAddr& to, const llarp_buffer_t& pkt);
 
+    /// send a batch of packets with as few syscalls as possible
+    void
+    SendBatchTo_LL(const std::vector<UDPDatagram>& pkts);
+
+    /// listen on router's loop at the address ifname names; "*" picks the one router goes out on
     virtual bool
-    Configure(AbstractRouter* loop, std::string ifname, int af, uint16_t port);
+    Configure(AbstractRouter* router, std::string ifname, int af, uint16_t port);
+
+    /// listen on loop at addr, calling triggerPump whenever our sessions have work to pump
+    bool
+    Configure(EventLoop_ptr loop, std::function<void(void)> triggerPump, SockAddr addr);
 
     virtual std::shared_ptr<ILinkSession>
     NewOutboundSession(const RouterContact& rc, const AddressInfo& ai) = 0;
@@ -123,6 +135,11 @@ namespace llarp
     virtual void
     RecvFrom(const SockAddr& from, ILinkSession::Packet_t pkt) = 0;
 
+    /// handle every datagram drained from the socket in one wakeup; the default implementation
+    /// copies each one out and calls RecvFrom
+    virtual void
+    RecvFromBatch(const std::vector<UDPDatagram>& pkts);
+
     bool
     PickAddress(const RouterContact& rc, AddressInfo& picked) const;
 
@@ -150,7 +167,7 @@ namespace llarp
     virtual bool
     SendTo(
         const RouterID& remote,
-        const llarp_buffer_t& buf,
+        ILinkSession::Message_t buf,
         ILinkSession::CompletionHandler completed,
         uint16_t priority);
 
@@ -226,11 +243,33 @@ namespace llarp
     std::optional<int>
     GetUDPFD() const;
 
-    // Gets a pointer to the router owning us.
-    AbstractRouter*
-    Router() const
+    /// pool that all of our sessions lease their packet buffers from
+    PacketBufferPool&
+    PacketBuffers() const
+    {
+      return *m_PacketBuffers;
+    }
+
+    /// whether what we send has the don't fragment bit set, without which a path mtu probe
+    /// that gets through tells us nothing
+    bool
+    DontFragment() const
+    {
+      return m_DontFragment;
+    }
+
+    /// the event loop we run on
+    const EventLoop_ptr&
+    Loop() const
+    {
+      return m_Loop;
+    }
+
+    /// ask whoever configured us to pump our sessions
+    void
+    TriggerPump() const
     {
-      return m_Router;
+      m_TriggerPump();
     }
 
    private:
@@ -247,10 +286,13 @@ namespace llarp
     bool
     PutSession(const std::shared_ptr<ILinkSession>& s);
 
-    AbstractRouter* m_Router;
+    EventLoop_ptr m_Loop;
+    std::function<void(void)> m_TriggerPump;
     SockAddr m_ourAddr;
     std::shared_ptr<llarp::UDPHandle> m_udp;
+    const std::shared_ptr<PacketBufferPool> m_PacketBuffers;
     SecretKey m_SecretKey;
+    bool m_DontFragment = false;
 
     using AuthedLinks = std::unordered_multimap<RouterID, std::shared_ptr<ILinkSession>>;
     using Pending = std::unordered_map<SockAddr, std::shared_ptr<ILinkSession>>;
@@ -258,7 +300,9 @@ namespace llarp
     AuthedLinks m_AuthedLinks GUARDED_BY(m_AuthedLinksMutex);
     mutable DECLARE_LOCK(Mutex_t, m_PendingMutex, ACQUIRED_AFTER(m_AuthedLinksMutex));
     Pending m_Pending GUARDED_BY(m_PendingMutex);
-    std::unordered_map<SockAddr, RouterID> m_AuthedAddrs;
+    /// every pending and established session by remote address, for the receive path; a
+    /// session leaves it when it is closed or times out
+    SessionIndex<ILinkSession> m_SessionsByAddr;
     std::unordered_map<SockAddr, llarp_time_t> m_RecentlyClosed;
 
    private:
@@ -5,6 +5,7 @@
 #include <llarp/ev/ev.hpp>
 #include <llarp/router_contact.hpp>
 #include <llarp/util/types.hpp>
+#include "packet_buffer.hpp"
 
 #include <functional>
 
@@ -25,6 +26,16 @@ namespace llarp
     uint64_t totalAckedTX = 0;
     uint64_t totalDroppedTX = 0;
     uint64_t totalInFlightTX = 0;
+
+    /// message bytes copied into the packets we send and out of the ones we receive
+    uint64_t totalBytesCopied = 0;
+
+    // congestion control
+    double congestionWindow = 0;
+    uint64_t fragmentsInFlight = 0;
+    llarp_time_t smoothedRTT = 0s;
+    /// bytes per second, 0 while unpaced
+    uint64_t pacingRate = 0;
   };
 
   struct ILinkSession
@@ -52,7 +63,7 @@ namespace llarp
     /// message delivery result hook function
     using CompletionHandler = std::function<void(DeliveryStatus)>;
 
-    using Packet_t = std::vector<byte_t>;
+    using Packet_t = PacketBuffer;
     using Message_t = std::vector<byte_t>;
 
     /// send a message buffer to the remote endpoint
@@ -81,6 +92,10 @@ namespace llarp
     virtual bool
     IsEstablished() const = 0;
 
+    /// return true once the session is closed and will take no more traffic
+    virtual bool
+    IsClosed() const = 0;
+
     /// return true if this session has timed out
     virtual bool
     TimedOut(llarp_time_t now) const = 0;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <llarp/net/sock_addr.hpp>
+#include <llarp/util/flat_index.hpp>
+#include <llarp/util/types.hpp>
+
+#include <cstring>
+#include <memory>
+
+namespace llarp
+{
+  /// a remote address packed as SockAddr::operator== compares it: the v6 or v4 mapped address and
+  /// the port.  converts from a SockAddr implicitly so a SessionIndex is used with addresses.
+  struct SessionKey
+  {
+    byte_t ip[16] = {};
+    uint16_t port = 0;
+
+    SessionKey() = default;
+
+    SessionKey(const SockAddr& addr)
+    {
+      const sockaddr_in6* in6 = addr;
+      std::memcpy(ip, &in6->sin6_addr, sizeof(ip));
+      port = in6->sin6_port;
+    }
+
+    bool
+    operator==(const SessionKey& other) const
+    {
+      return port == other.port and std::memcmp(ip, other.ip, sizeof(ip)) == 0;
+    }
+  };
+
+  template <typename Session_t>
+  struct SessionIndexTraits
+  {
+    using Key = SessionKey;
+    using Value = std::shared_ptr<Session_t>;
+
+    static uint64_t
+    Hash(uint64_t seed, const Key& key)
+    {
+      uint64_t hi, lo;
+      std::memcpy(&hi, key.ip, sizeof(hi));
+      std::memcpy(&lo, key.ip + sizeof(hi), sizeof(lo));
+      return util::Mix64(util::Mix64(util::Mix64(seed ^ hi) ^ lo) ^ key.port);
+    }
+  };
+
+  /// index from remote address to session for the per datagram lookup on the link layer receive
+  /// path; like the rest of the link layer's session bookkeeping it belongs to the event loop
+  /// thread
+  template <typename Session_t>
+  using SessionIndex = util::FlatIndex<SessionIndexTraits<Session_t>>;
+}  // namespace llarp
@@ -213,7 +213,7 @@ namespace
       // got a new flow, let's check if we want it
       if (m_Filter(m_User, &flow_addr, &flow_userdata, &flow_timeoutseconds))
         return;
-      AddFlow(from, flow_addr, flow_userdata, flow_timeoutseconds, pkt);
+      AddFlow(from, flow_addr, flow_userdata, flow_timeoutseconds, std::move(pkt));
     }
   };
 }  // namespace
@@ -983,10 +983,12 @@ extern "C"
       if (pkt.sz == 0)
         return EINVAL;
       std::promise<int> ret;
-      ctx->impl->router->loop()->call([addr = *maybe, pkt = std::move(pkt), ep, &ret]() {
+      // shared as the call must be copyable and packets are not
+      auto shared = std::make_shared<llarp::net::IPPacket>(std::move(pkt));
+      ctx->impl->router->loop()->call([addr = *maybe, pkt = std::move(shared), ep, &ret]() {
         if (auto tag = ep->GetBestConvoTagFor(addr))
         {
-          if (ep->SendToOrQueue(*tag, pkt.ConstBuffer(), llarp::service::ProtocolType::TrafficV4))
+          if (ep->SendToOrQueue(*tag, pkt->ConstBuffer(), llarp::service::ProtocolType::TrafficV4))
           {
             ret.set_value(0);
             return;
@@ -61,7 +61,7 @@ namespace llarp
   }
 
   bool
-  DHTImmediateMessage::HandleMessage(AbstractRouter* router) const
+  DHTImmediateMessage::HandleMessage(AbstractRouter* router)
   {
     DHTImmediateMessage reply;
     reply.session = session;
@@ -21,7 +21,7 @@ namespace llarp
     BEncode(llarp_buffer_t* buf) const override;
 
     bool
-    HandleMessage(AbstractRouter* router) const override;
+    HandleMessage(AbstractRouter* router) override;
 
     void
     Clear() override;
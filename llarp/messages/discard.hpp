@@ -52,7 +52,7 @@ namespace llarp
     }
 
     bool
-    HandleMessage(AbstractRouter* /*router*/) const override
+    HandleMessage(AbstractRouter* /*router*/) override
     {
       return true;
     }
@@ -99,7 +99,7 @@ namespace llarp
   }
 
   bool
-  LinkIntroMessage::HandleMessage(AbstractRouter* /*router*/) const
+  LinkIntroMessage::HandleMessage(AbstractRouter* /*router*/)
   {
     if (!Verify())
       return false;
@@ -27,7 +27,7 @@ namespace llarp
     BEncode(llarp_buffer_t* buf) const override;
 
     bool
-    HandleMessage(AbstractRouter* router) const override;
+    HandleMessage(AbstractRouter* router) override;
 
     bool
     Sign(std::function<bool(Signature&, const llarp_buffer_t&)> signer);
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <llarp/constants/link_layer.hpp>
 #include <llarp/link/session.hpp>
 #include <llarp/router_id.hpp>
 #include <llarp/util/bencode.hpp>
 #include <llarp/path/path_types.hpp>
+#include <llarp/util/logging/logger.hpp>
 
+#include <array>
+#include <optional>
 #include <vector>
 
 namespace llarp
@@ -45,8 +49,25 @@ namespace llarp
     virtual bool
     BEncode(llarp_buffer_t* buf) const = 0;
 
+    /// encode into a buffer of our own for the link layer to send, nullopt if we don't fit in
+    /// a link message.  relay messages also have a non-const Encode that writes around the frame
+    /// their payload already sits in and takes it, leaving the message without a payload.
+    virtual std::optional<ILinkSession::Message_t>
+    Encode() const
+    {
+      std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+      llarp_buffer_t buf{tmp};
+      if (not BEncode(&buf))
+      {
+        LogWarn("failed to encode ", Name(), " message, buffer size left: ", buf.size_left());
+        return std::nullopt;
+      }
+      return ILinkSession::Message_t{tmp.data(), buf.cur};
+    }
+
+    /// not const: relay messages hand their payload on to the hop instead of copying it
     virtual bool
-    HandleMessage(AbstractRouter* router) const = 0;
+    HandleMessage(AbstractRouter* router) = 0;
 
     virtual void
     Clear() = 0;
@@ -4,13 +4,115 @@
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/util/bencode.hpp>
 
+#include <array>
+#include <charconv>
+
 namespace llarp
 {
+  namespace
+  {
+    /// read a relay payload, copying it out of the link's receive buffer into a frame of its own
+    bool
+    DecodeRelayPayload(RelayFrame& X, llarp_buffer_t* buf)
+    {
+      llarp_buffer_t strbuf;
+      if (not bencode_read_string(buf, &strbuf) or strbuf.sz > MAX_RELAY_PAYLOAD_SIZE)
+        return false;
+      X = RelayFrame{strbuf.base, strbuf.sz};
+      RelayStats::CountCopy(strbuf.sz);
+      return true;
+    }
+
+    /// length of n written in decimal
+    constexpr size_t
+    Digits(size_t n)
+    {
+      size_t digits = 1;
+      for (; n >= 10; n /= 10)
+        digits++;
+      return digits;
+    }
+
+    static_assert(
+        RelayFrame::TrailerSize == 3 + Digits(TunnelNonce::SIZE) + 1 + TunnelNonce::SIZE + 1);
+  }  // namespace
+
+  RelayFrame::RelayFrame(const byte_t* ptr, size_t sz) : m_Offset{HeaderSize(sz)}, m_Size{sz}
+  {
+    // reserve the whole frame first so the payload is written once rather than zeroed then copied
+    m_Buffer.reserve(m_Offset + m_Size + TrailerSize);
+    m_Buffer.resize(m_Offset);
+    m_Buffer.insert(m_Buffer.end(), ptr, ptr + sz);
+    m_Buffer.resize(m_Buffer.size() + TrailerSize);
+  }
+
+  size_t
+  RelayFrame::HeaderSize(size_t sz)
+  {
+    // d 1:a1:? 1:p16:<pathid> 1:vi<version>e 1:x<sz>:
+    return 1 + 6 + (3 + Digits(PathID_t::SIZE) + 1 + PathID_t::SIZE)
+        + (3 + 2 + Digits(llarp::constants::proto_version)) + (3 + Digits(sz) + 1);
+  }
+
+  void
+  RelayFrame::clear()
+  {
+    m_Buffer.clear();
+    m_Offset = 0;
+    m_Size = 0;
+  }
+
+  std::optional<ILinkSession::Message_t>
+  RelayFrame::Finish(const char* t, const PathID_t& pathid, const TunnelNonce& Y) &&
+  {
+    if (empty())
+    {
+      LogError("refusing to encode a relay message with no payload");
+      return std::nullopt;
+    }
+    if (m_Size > MAX_RELAY_PAYLOAD_SIZE)
+    {
+      LogWarn("relay payload of ", m_Size, " bytes is over ", MAX_RELAY_PAYLOAD_SIZE);
+      return std::nullopt;
+    }
+    llarp_buffer_t header{m_Buffer.data(), m_Offset};
+    llarp_buffer_t trailer{m_Buffer.data() + m_Offset + m_Size, TrailerSize};
+    // the payload's length prefix by hand, writef would put its nul terminator in the payload
+    std::array<char, 24> prefix;
+    auto prefixEnd = std::to_chars(prefix.data(), prefix.data() + prefix.size(), m_Size).ptr;
+    *prefixEnd++ = ':';
+    const bool encoded = bencode_start_dict(&header) and BEncodeWriteDictMsgType(&header, "a", t)
+        and BEncodeWriteDictEntry("p", pathid, &header)
+        and BEncodeWriteDictInt("v", llarp::constants::proto_version, &header)
+        and bencode_write_bytestring(&header, "x", 1) and header.write(prefix.data(), prefixEnd)
+        and BEncodeWriteDictEntry("y", Y, &trailer) and bencode_end(&trailer);
+    if (not encoded or header.size_left() or trailer.size_left())
+    {
+      LogWarn("failed to lay out relay message around ", m_Size, " bytes of payload");
+      return std::nullopt;
+    }
+    auto msg = std::move(m_Buffer);
+    clear();
+    return msg;
+  }
+
+  util::StatusObject
+  RelayStats::ExtractStatus()
+  {
+    const uint64_t relayed = m_Relayed.load(std::memory_order_relaxed);
+    const uint64_t copied = m_BytesCopied.load(std::memory_order_relaxed);
+    return util::StatusObject{
+        {"relayed", relayed},
+        {"relayedBytes", m_RelayedBytes.load(std::memory_order_relaxed)},
+        {"bytesCopied", copied},
+        {"bytesCopiedPerMessage", relayed ? double(copied) / relayed : 0.0}};
+  }
+
   void
   RelayUpstreamMessage::Clear()
   {
     pathid.Zero();
-    X.Clear();
+    X.clear();
     Y.Zero();
     version = 0;
   }
@@ -27,13 +129,20 @@ namespace llarp
       return false;
     if (!BEncodeWriteDictInt("v", llarp::constants::proto_version, buf))
       return false;
-    if (!BEncodeWriteDictEntry("x", X, buf))
+    if (!BEncodeWriteDictString("x", X, buf))
       return false;
+    RelayStats::CountCopy(X.size());
     if (!BEncodeWriteDictEntry("y", Y, buf))
       return false;
     return bencode_end(buf);
   }
 
+  std::optional<ILinkSession::Message_t>
+  RelayUpstreamMessage::Encode()
+  {
+    return std::move(X).Finish("u", pathid, Y);
+  }
+
   bool
   RelayUpstreamMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf)
   {
@@ -42,20 +151,24 @@ namespace llarp
       return false;
     if (!BEncodeMaybeVerifyVersion("v", version, llarp::constants::proto_version, read, key, buf))
       return false;
-    if (!BEncodeMaybeReadDictEntry("x", X, read, key, buf))
-      return false;
+    if (key == "x")
+    {
+      if (not DecodeRelayPayload(X, buf))
+        return false;
+      read = true;
+    }
     if (!BEncodeMaybeReadDictEntry("y", Y, read, key, buf))
       return false;
     return read;
   }
 
   bool
-  RelayUpstreamMessage::HandleMessage(AbstractRouter* r) const
+  RelayUpstreamMessage::HandleMessage(AbstractRouter* r)
   {
     auto path = r->pathContext().GetByDownstream(session->GetPubKey(), pathid);
     if (path)
     {
-      return path->HandleUpstream(llarp_buffer_t(X), Y, r);
+      return path->HandleUpstream(std::move(X), Y, r);
     }
     return false;
   }
@@ -64,7 +177,7 @@ namespace llarp
   RelayDownstreamMessage::Clear()
   {
     pathid.Zero();
-    X.Clear();
+    X.clear();
     Y.Zero();
     version = 0;
   }
@@ -81,13 +194,20 @@ namespace llarp
       return false;
     if (!BEncodeWriteDictInt("v", llarp::constants::proto_version, buf))
       return false;
-    if (!BEncodeWriteDictEntry("x", X, buf))
+    if (!BEncodeWriteDictString("x", X, buf))
       return false;
+    RelayStats::CountCopy(X.size());
     if (!BEncodeWriteDictEntry("y", Y, buf))
       return false;
     return bencode_end(buf);
   }
 
+  std::optional<ILinkSession::Message_t>
+  RelayDownstreamMessage::Encode()
+  {
+    return std::move(X).Finish("d", pathid, Y);
+  }
+
   bool
   RelayDownstreamMessage::DecodeKey(const llarp_buffer_t& key, llarp_buffer_t* buf)
   {
@@ -96,20 +216,24 @@ namespace llarp
       return false;
     if (!BEncodeMaybeVerifyVersion("v", version, llarp::constants::proto_version, read, key, buf))
       return false;
-    if (!BEncodeMaybeReadDictEntry("x", X, read, key, buf))
-      return false;
+    if (key == "x")
+    {
+      if (not DecodeRelayPayload(X, buf))
+        return false;
+      read = true;
+    }
     if (!BEncodeMaybeReadDictEntry("y", Y, read, key, buf))
       return false;
     return read;
   }
 
   bool
-  RelayDownstreamMessage::HandleMessage(AbstractRouter* r) const
+  RelayDownstreamMessage::HandleMessage(AbstractRouter* r)
   {
     auto path = r->pathContext().GetByUpstream(session->GetPubKey(), pathid);
     if (path)
     {
-      return path->HandleDownstream(llarp_buffer_t(X), Y, r);
+      return path->HandleDownstream(std::move(X), Y, r);
     }
     llarp::LogWarn("no path for downstream message id=", pathid);
     return false;
@@ -1,17 +1,144 @@
 #pragma once
 
-#include <llarp/crypto/encrypted.hpp>
 #include <llarp/crypto/types.hpp>
 #include "link_message.hpp"
 #include <llarp/path/path_types.hpp>
+#include <llarp/util/status.hpp>
 
+#include <atomic>
+#include <optional>
 #include <vector>
 
 namespace llarp
 {
+  /// largest onion payload a relay message carries
+  constexpr size_t MAX_RELAY_PAYLOAD_SIZE = MAX_LINK_MSG_SIZE - 128;
+
+  /// process wide counters for the relay hot path.  a relayed payload is copied once, in from
+  /// the link when its message is decoded; after that its frame is moved from the parser
+  /// through the hop queues and crypto to the link send.
+  struct RelayStats
+  {
+    /// payload bytes copied by a relay message decode or a BEncode
+    static void
+    CountCopy(size_t bytes)
+    {
+      m_BytesCopied.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    /// a transit hop handed a message on to the next hop
+    static void
+    CountRelayed(size_t bytes)
+    {
+      m_Relayed.fetch_add(1, std::memory_order_relaxed);
+      m_RelayedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static util::StatusObject
+    ExtractStatus();
+
+   private:
+    inline static std::atomic<uint64_t> m_BytesCopied{0};
+    inline static std::atomic<uint64_t> m_Relayed{0};
+    inline static std::atomic<uint64_t> m_RelayedBytes{0};
+  };
+
+  /// the onion payload of a relay message, laid out inside the buffer the encoded message is
+  /// sent from, with room for the bencoded header in front and the trailer behind.  onion crypto
+  /// keeps the payload's size, so the frame a payload arrives in is the one it leaves in: it is
+  /// copied in once from the link, ciphered in place at each hop, and when the next hop's
+  /// message is encoded only the header and trailer are written around it.  move only.
+  class RelayFrame
+  {
+   public:
+    /// bencoded "1:y32:<nonce>e" behind the payload
+    static constexpr size_t TrailerSize = 6 + TunnelNonce::SIZE + 1;
+
+    RelayFrame() = default;
+
+    /// a new frame holding a copy of [ptr, ptr + sz)
+    RelayFrame(const byte_t* ptr, size_t sz);
+
+    RelayFrame(RelayFrame&&) = default;
+    RelayFrame&
+    operator=(RelayFrame&&) = default;
+
+    RelayFrame(const RelayFrame&) = delete;
+    RelayFrame&
+    operator=(const RelayFrame&) = delete;
+
+    /// size of the bencoded header in front of a payload of `sz` bytes, from the message type
+    /// up to the payload's length prefix
+    static size_t
+    HeaderSize(size_t sz);
+
+    byte_t*
+    data()
+    {
+      return m_Buffer.data() + m_Offset;
+    }
+
+    const byte_t*
+    data() const
+    {
+      return m_Buffer.data() + m_Offset;
+    }
+
+    size_t
+    size() const
+    {
+      return m_Size;
+    }
+
+    bool
+    empty() const
+    {
+      return m_Size == 0;
+    }
+
+    byte_t*
+    begin()
+    {
+      return data();
+    }
+
+    byte_t*
+    end()
+    {
+      return data() + m_Size;
+    }
+
+    const byte_t*
+    begin() const
+    {
+      return data();
+    }
+
+    const byte_t*
+    end() const
+    {
+      return data() + m_Size;
+    }
+
+    void
+    clear();
+
+    /// write a relay message of type `t` around the payload and hand over the buffer as the
+    /// encoded message, leaving this frame empty.  fails on a frame with no payload (including
+    /// one already finished) and on a payload bigger than MAX_RELAY_PAYLOAD_SIZE.
+    std::optional<ILinkSession::Message_t>
+    Finish(const char* t, const PathID_t& pathid, const TunnelNonce& Y) &&;
+
+   private:
+    std::vector<byte_t> m_Buffer;
+    size_t m_Offset = 0;
+    size_t m_Size = 0;
+  };
+
   struct RelayUpstreamMessage : public ILinkMessage
   {
-    Encrypted<MAX_LINK_MSG_SIZE - 128> X;
+    /// onion payload; handed off to the hop by HandleMessage and to the link by Encode
+    RelayFrame X;
     TunnelNonce Y;
 
     bool
@@ -20,8 +147,16 @@ namespace llarp
     bool
     BEncode(llarp_buffer_t* buf) const override;
 
+    /// a const message still encodes into a copy
+    using ILinkMessage::Encode;
+
+    /// lay the message out around X and take it; fails if X is empty, which it is after the
+    /// first call
+    std::optional<ILinkSession::Message_t>
+    Encode();
+
     bool
-    HandleMessage(AbstractRouter* router) const override;
+    HandleMessage(AbstractRouter* router) override;
 
     void
     Clear() override;
@@ -40,7 +175,8 @@ namespace llarp
 
   struct RelayDownstreamMessage : public ILinkMessage
   {
-    Encrypted<MAX_LINK_MSG_SIZE - 128> X;
+    /// onion payload; handed off to the hop by HandleMessage and to the link by Encode
+    RelayFrame X;
     TunnelNonce Y;
 
     bool
@@ -49,8 +185,16 @@ namespace llarp
     bool
     BEncode(llarp_buffer_t* buf) const override;
 
+    /// a const message still encodes into a copy
+    using ILinkMessage::Encode;
+
+    /// lay the message out around X and take it; fails if X is empty, which it is after the
+    /// first call
+    std::optional<ILinkSession::Message_t>
+    Encode();
+
     bool
-    HandleMessage(AbstractRouter* router) const override;
+    HandleMessage(AbstractRouter* router) override;
 
     void
     Clear() override;
@@ -61,7 +61,7 @@ namespace llarp
   }
 
   bool
-  LR_CommitMessage::HandleMessage(AbstractRouter* router) const
+  LR_CommitMessage::HandleMessage(AbstractRouter* router)
   {
     if (frames.size() != path::max_len)
     {
@@ -187,6 +187,8 @@ namespace llarp
     std::shared_ptr<Hop> hop;
 
     const std::optional<IpAddress> fromAddr;
+    const path::KeyExchangeService::Clock_t::time_point queued =
+        path::KeyExchangeService::Clock_t::now();
 
     LRCMFrameDecrypt(Context* ctx, Decrypter_ptr dec, const LR_CommitMessage* commit)
         : decrypter(std::move(dec))
@@ -406,6 +408,8 @@ namespace llarp
         self->decrypter = nullptr;
         return;
       }
+      self->context->KeyExchange().RecordCommit(
+          path::KeyExchangeService::Clock_t::now() - self->queued);
       // generate hash of hop key for nonce mutation
       crypto->shorthash(self->hop->nonceXOR, llarp_buffer_t(self->hop->pathKey));
       if (self->record.work && self->record.work->IsValid(now))
@@ -473,10 +477,10 @@ namespace llarp
     // copy frames so we own them
     auto frameDecrypt = std::make_shared<LRCMFrameDecrypt>(context, std::move(decrypter), this);
 
-    // decrypt frames async
+    // decrypt frames async, along with whatever other key exchanges are pending
     frameDecrypt->decrypter->AsyncDecrypt(
-        frameDecrypt->frames[0], frameDecrypt, [r = context->Router()](auto func) {
-          r->QueueWork(std::move(func));
+        frameDecrypt->frames[0], frameDecrypt, [context](auto func) {
+          context->KeyExchange().Queue(std::move(func));
         });
     return true;
   }
@@ -122,7 +122,7 @@ namespace llarp
   }
 
   bool
-  LR_StatusMessage::HandleMessage(AbstractRouter* router) const
+  LR_StatusMessage::HandleMessage(AbstractRouter* router)
   {
     llarp::LogDebug("Received LR_Status message from (", session->GetPubKey(), ")");
     if (frames.size() != path::max_len)
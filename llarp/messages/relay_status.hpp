@@ -79,7 +79,7 @@ namespace llarp
     BEncode(llarp_buffer_t* buf) const override;
 
     bool
-    HandleMessage(AbstractRouter* router) const override;
+    HandleMessage(AbstractRouter* router) override;
 
     void
     SetDummyFrames();
@@ -2,6 +2,7 @@
 #include "ip.hpp"
 
 #include <llarp/util/buffer.hpp>
+#include <llarp/util/buffer_pool.hpp>
 #include <llarp/util/mem.hpp>
 #include <llarp/util/str.hpp>
 #ifndef _WIN32
@@ -76,6 +77,74 @@ namespace llarp::net
     throw std::invalid_argument{"no such ip protocol: '" + data + "'"};
   }
 
+  namespace
+  {
+    /// the buffer sizes packets are leased from, the last one fits any packet we carry
+    using Buffers = util::SizeClassPool<128, 256, 512, 1024, IPPacket::MaxSize>;
+  }  // namespace
+
+  IPPacket::IPPacket(size_t capacity)
+  {
+    m_SizeClass = Buffers::ClassFor(capacity);
+    buf = Buffers::Take(m_SizeClass);
+  }
+
+  IPPacket::IPPacket(IPPacket&& other) noexcept
+      : timestamp{other.timestamp}, sz{other.sz}, buf{other.buf}, m_SizeClass{other.m_SizeClass}
+  {
+    other.buf = nullptr;
+    other.sz = 0;
+  }
+
+  IPPacket&
+  IPPacket::operator=(IPPacket&& other) noexcept
+  {
+    if (this == &other)
+      return *this;
+    Release();
+    timestamp = other.timestamp;
+    sz = other.sz;
+    buf = other.buf;
+    m_SizeClass = other.m_SizeClass;
+    other.buf = nullptr;
+    other.sz = 0;
+    return *this;
+  }
+
+  IPPacket::~IPPacket()
+  {
+    Release();
+  }
+
+  void
+  IPPacket::Release()
+  {
+    if (buf == nullptr)
+      return;
+    Buffers::Give(m_SizeClass, buf);
+    buf = nullptr;
+  }
+
+  size_t
+  IPPacket::Capacity() const
+  {
+    return buf ? Buffers::ClassSizes[m_SizeClass] : 0;
+  }
+
+  IPPacket
+  IPPacket::Copy() const
+  {
+    IPPacket pkt;
+    if (buf)
+    {
+      pkt = IPPacket{sz};
+      std::copy_n(buf, sz, pkt.buf);
+    }
+    pkt.sz = sz;
+    pkt.timestamp = timestamp;
+    return pkt;
+  }
+
   inline static uint32_t*
   in6_uint32_ptr(in6_addr& addr)
   {
@@ -109,8 +178,14 @@ namespace llarp::net
   bool
   IPPacket::Load(const llarp_buffer_t& pkt)
   {
-    if (pkt.sz > sizeof(buf) or pkt.sz == 0)
+    if (pkt.sz > MaxSize or pkt.sz == 0)
       return false;
+    if (Capacity() < pkt.sz)
+    {
+      const auto when = timestamp;
+      *this = IPPacket{pkt.sz};
+      timestamp = when;
+    }
     sz = pkt.sz;
     std::copy_n(pkt.base, sz, buf);
     return true;
@@ -555,12 +630,17 @@ namespace llarp::net
     {
       constexpr auto icmp_Header_size = 8;
       constexpr auto ip_Header_size = 20;
-      net::IPPacket pkt{};
+      // size pf ip header
+      const size_t l3_HeaderSize = Header()->ihl * 4;
+      // size of l4 packet to reflect back
+      const size_t l4_PacketSize = 8;
+      net::IPPacket pkt{ip_Header_size + icmp_Header_size + l3_HeaderSize + l4_PacketSize};
       auto* pkt_Header = pkt.Header();
 
       pkt_Header->version = 4;
       pkt_Header->ihl = 0x05;
       pkt_Header->tos = 0;
+      pkt_Header->id = 0;
       pkt_Header->check = 0;
       pkt_Header->tot_len = ntohs(icmp_Header_size + ip_Header_size);
       pkt_Header->saddr = Header()->daddr;
@@ -568,10 +648,6 @@ namespace llarp::net
       pkt_Header->protocol = 1;  // ICMP
       pkt_Header->ttl = 1;
       pkt_Header->frag_off = htons(0b0100000000000000);
-      // size pf ip header
-      const size_t l3_HeaderSize = Header()->ihl * 4;
-      // size of l4 packet to reflect back
-      const size_t l4_PacketSize = 8;
       pkt_Header->tot_len += ntohs(l4_PacketSize + l3_HeaderSize);
 
       uint16_t* checksum;
@@ -618,7 +694,8 @@ namespace llarp::net
       return std::nullopt;
 
     const uint8_t* ptr = buf + ((hdr->ihl * 4) + l4_HeaderSize);
-    return std::make_pair(reinterpret_cast<const char*>(ptr), std::distance(ptr, buf + sz));
+    return std::make_pair(
+        reinterpret_cast<const char*>(ptr), std::distance<const uint8_t*>(ptr, buf + sz));
   }
 
   IPPacket
@@ -631,16 +708,15 @@ namespace llarp::net
   {
     net::IPPacket pkt;
 
-    if (buf.sz + 28 > sizeof(pkt.buf))
-    {
-      pkt.sz = 0;
+    if (buf.sz + 28 > IPPacket::MaxSize)
       return pkt;
-    }
+    pkt = IPPacket{buf.sz + 28};
     auto* hdr = pkt.Header();
     pkt.buf[1] = 0;
     hdr->version = 4;
     hdr->ihl = 5;
     hdr->tot_len = htons(buf.sz + 28);
+    hdr->id = 0;
     hdr->protocol = 0x11;  // udp
     hdr->ttl = 64;
     hdr->frag_off = htons(0b0100000000000000);
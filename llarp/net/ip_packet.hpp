@@ -106,14 +106,41 @@ namespace llarp::net
   IPProtocol
   ParseIPProtocol(std::string data);
 
-  /// an Packet
+  /// an ip packet.  its bytes live in a buffer leased from a pool of a few size classes, so a
+  /// packet is a pointer and a size wherever it is queued and a small one does not pin a whole
+  /// mtu.  packets are move only, use Copy() to get a second one.
   struct IPPacket
   {
     static constexpr size_t MaxSize = 1500;
     llarp_time_t timestamp;
-    size_t sz;
+    size_t sz = 0;
+    /// the packet's bytes, null until a buffer is leased
+    byte_t* buf = nullptr;
 
-    alignas(ip_header) byte_t buf[MaxSize];
+    IPPacket() = default;
+
+    /// lease a buffer of at least capacity bytes, capped at MaxSize, to read or build into
+    explicit IPPacket(size_t capacity);
+
+    IPPacket(const IPPacket&) = delete;
+
+    IPPacket&
+    operator=(const IPPacket&) = delete;
+
+    IPPacket(IPPacket&& other) noexcept;
+
+    IPPacket&
+    operator=(IPPacket&& other) noexcept;
+
+    ~IPPacket();
+
+    /// how many bytes buf can hold
+    size_t
+    Capacity() const;
+
+    /// a packet of its own with the same bytes and timestamp
+    IPPacket
+    Copy() const;
 
     static IPPacket
     UDP(nuint32_t srcaddr,
@@ -256,6 +283,14 @@ namespace llarp::net
     /// make an icmp unreachable reply packet based of this ip packet
     std::optional<IPPacket>
     MakeICMPUnreachable() const;
+
+   private:
+    /// hand buf back to the pool
+    void
+    Release();
+
+    /// which size class buf was leased from
+    uint8_t m_SizeClass = 0;
   };
 
   /// generate ip checksum
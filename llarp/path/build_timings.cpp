@@ -0,0 +1,88 @@
+#include "build_timings.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    util::StatusObject
+    BuildTimings::ExtractStatus() const
+    {
+      // hop positions up to the farthest one we heard from
+      size_t positions = 0;
+      for (size_t idx = 0; idx < status.size(); ++idx)
+      {
+        if (status[idx].Count())
+          positions = idx + 1;
+      }
+      std::vector<util::StatusObject> byHop;
+      for (size_t idx = 0; idx < positions; ++idx)
+        byHop.emplace_back(status[idx].ExtractStatus());
+      return util::StatusObject{
+          {"select", select.ExtractStatus()},
+          {"keys", keys.ExtractStatus()},
+          {"send", send.ExtractStatus()},
+          {"status", byHop},
+          {"confirm", confirm.ExtractStatus()},
+          {"established", established.ExtractStatus()}};
+    }
+
+    util::LatencyHistogram::Duration_t
+    BuildTrace::Since(Clock_t::time_point then)
+    {
+      return std::chrono::duration_cast<util::LatencyHistogram::Duration_t>(
+          Clock_t::now() - then);
+    }
+
+    void
+    BuildTrace::Start(std::shared_ptr<BuildTimings> timings)
+    {
+      m_Timings = std::move(timings);
+      m_Started = Clock_t::now();
+    }
+
+    void
+    BuildTrace::KeysDone()
+    {
+      if (not m_Timings)
+        return;
+      m_Timings->keys.Record(Since(m_Started));
+      m_KeysDone = Clock_t::now();
+    }
+
+    void
+    BuildTrace::Sent()
+    {
+      if (not m_Timings)
+        return;
+      m_Timings->send.Record(Since(m_KeysDone));
+      m_Sent = Clock_t::now();
+    }
+
+    void
+    BuildTrace::StatusArrived(size_t hop)
+    {
+      if (not m_Timings)
+        return;
+      m_Timings->status[std::min(hop, m_Timings->status.size() - 1)].Record(Since(m_Sent));
+    }
+
+    void
+    BuildTrace::Confirmed()
+    {
+      if (not m_Timings)
+        return;
+      m_Timings->confirm.Record(Since(m_Sent));
+    }
+
+    void
+    BuildTrace::Established()
+    {
+      if (not m_Timings)
+        return;
+      m_Timings->established.Record(Since(m_Started));
+      m_Timings.reset();
+    }
+  }  // namespace path
+}  // namespace llarp
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <llarp/constants/path.hpp>
+#include <llarp/util/histogram.hpp>
+#include <llarp/util/status.hpp>
+
+#include <array>
+#include <chrono>
+#include <memory>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// how long one endpoint's path builds spend in each stage
+    struct BuildTimings
+    {
+      /// picking the hops
+      util::LatencyHistogram select;
+      /// generating every hop's keys, from queueing them to the build being back on the event
+      /// loop
+      util::LatencyHistogram keys;
+      /// the LRCM waiting to go out to the first hop
+      util::LatencyHistogram send;
+      /// LRCM sent until its status came back, by position of the hop the status is from: the
+      /// last hop for a build that went through, the hop that turned it down otherwise
+      std::array<util::LatencyHistogram, max_len> status;
+      /// LRCM sent until the path was confirmed
+      util::LatencyHistogram confirm;
+      /// keys queued until the path was established, i.e. the whole build
+      util::LatencyHistogram established;
+
+      util::StatusObject
+      ExtractStatus() const;
+    };
+
+    /// one build's way through the stages, recorded into its endpoint's timings as it goes.
+    /// each stage is handed on from the one before through the event loop, so no locking.
+    class BuildTrace
+    {
+     public:
+      using Clock_t = std::chrono::steady_clock;
+
+      /// the build's keys were queued
+      void
+      Start(std::shared_ptr<BuildTimings> timings);
+
+      void
+      KeysDone();
+
+      /// the LRCM went out to the first hop
+      void
+      Sent();
+
+      /// a status came back from the hop at this position
+      void
+      StatusArrived(size_t hop);
+
+      void
+      Confirmed();
+
+      /// the path is up, which ends the trace
+      void
+      Established();
+
+     private:
+      static util::LatencyHistogram::Duration_t
+      Since(Clock_t::time_point then);
+
+      std::shared_ptr<BuildTimings> m_Timings;
+      Clock_t::time_point m_Started;
+      Clock_t::time_point m_KeysDone;
+      Clock_t::time_point m_Sent;
+    };
+  }  // namespace path
+}  // namespace llarp
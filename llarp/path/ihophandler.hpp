@@ -3,11 +3,11 @@
 #include <llarp/crypto/types.hpp>
 #include <llarp/util/types.hpp>
 #include <llarp/crypto/encrypted_frame.hpp>
-#include <llarp/util/decaying_hashset.hpp>
 #include <llarp/messages/relay.hpp>
-#include <vector>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 struct llarp_buffer_t;
 
@@ -24,17 +24,16 @@ namespace llarp
   {
     struct IHopHandler
     {
-      using TrafficEvent_t = std::pair<std::vector<byte_t>, TunnelNonce>;
-      using TrafficQueue_t = std::list<TrafficEvent_t>;
+      using TrafficEvent_t = std::pair<RelayFrame, TunnelNonce>;
+      /// one contiguous batch per flush rather than a list node per message; the array is
+      /// recycled between flushes (TakeBatch/RecycleBatch) so steady traffic doesn't regrow it
+      using TrafficQueue_t = std::vector<TrafficEvent_t>;
 
       virtual ~IHopHandler() = default;
 
       virtual PathID_t
       RXID() const = 0;
 
-      void
-      DecayFilters(llarp_time_t now);
-
       virtual bool
       Expired(llarp_time_t now) const = 0;
 
@@ -47,10 +46,10 @@ namespace llarp
 
       // handle data in upstream direction
       virtual bool
-      HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*);
+      HandleUpstream(RelayFrame X, const TunnelNonce& Y, AbstractRouter*);
       // handle data in downstream direction
       virtual bool
-      HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*);
+      HandleDownstream(RelayFrame X, const TunnelNonce& Y, AbstractRouter*);
 
       /// return timestamp last remote activity happened at
       virtual llarp_time_t
@@ -71,12 +70,32 @@ namespace llarp
       virtual void
       FlushDownstream(AbstractRouter* r) = 0;
 
+      /// most events a spare batch keeps room for, so a burst doesn't pin its memory
+      static constexpr size_t MaxSpareBatch = 1024;
+
+      /// swap a queue's traffic out for a flush, leaving the spare batch to queue into; event
+      /// loop thread only, like the queues
+      static TrafficQueue_t
+      TakeBatch(TrafficQueue_t& queue, TrafficQueue_t& spare)
+      {
+        return std::exchange(queue, std::exchange(spare, {}));
+      }
+
+      /// keep a flushed batch, emptied of its payloads, as the spare for the next flush
+      static void
+      RecycleBatch(TrafficQueue_t batch, TrafficQueue_t& spare)
+      {
+        batch.clear();
+        if (batch.capacity() > spare.capacity() and batch.capacity() <= MaxSpareBatch)
+          spare = std::move(batch);
+      }
+
      protected:
       uint64_t m_SequenceNum = 0;
       TrafficQueue_t m_UpstreamQueue;
       TrafficQueue_t m_DownstreamQueue;
-      util::DecayingHashSet<TunnelNonce> m_UpstreamReplayFilter;
-      util::DecayingHashSet<TunnelNonce> m_DownstreamReplayFilter;
+      TrafficQueue_t m_UpstreamSpare;
+      TrafficQueue_t m_DownstreamSpare;
 
       virtual void
       UpstreamWork(TrafficQueue_t queue, AbstractRouter* r) = 0;
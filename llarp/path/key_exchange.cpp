@@ -0,0 +1,134 @@
+#include "key_exchange.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace path
+  {
+    KeyExchangeService::KeyExchangeService(WorkerFunc_t worker, size_t parallelism)
+        : m_Worker{std::move(worker)}, m_Parallelism{std::max(parallelism, size_t{1})}
+    {}
+
+    void
+    KeyExchangeService::SetParallelism(size_t parallelism)
+    {
+      m_Parallelism = std::max(parallelism, size_t{1});
+    }
+
+    void
+    KeyExchangeService::Queue(Job_t job)
+    {
+      size_t drains;
+      {
+        util::Lock lock{m_Mutex};
+        m_Pending.emplace_back(std::move(job));
+        drains = ScheduleDrains();
+      }
+      QueueDrains(drains);
+    }
+
+    void
+    KeyExchangeService::Queue(std::vector<Job_t> jobs)
+    {
+      size_t drains;
+      {
+        util::Lock lock{m_Mutex};
+        for (auto& job : jobs)
+          m_Pending.emplace_back(std::move(job));
+        drains = ScheduleDrains();
+      }
+      QueueDrains(drains);
+    }
+
+    size_t
+    KeyExchangeService::ScheduleDrains()
+    {
+      // a drain per pending exchange up to the parallelism, less those already going
+      const size_t wanted = std::min(m_Parallelism.load(), m_Pending.size());
+      if (wanted <= m_Draining)
+        return 0;
+      const size_t drains = wanted - m_Draining;
+      m_Draining = wanted;
+      return drains;
+    }
+
+    void
+    KeyExchangeService::QueueDrains(size_t count)
+    {
+      for (size_t idx = 0; idx < count; ++idx)
+        m_Worker([this] { Drain(); });
+    }
+
+    void
+    KeyExchangeService::Drain()
+    {
+      std::vector<Job_t> batch;
+      for (;;)
+      {
+        {
+          util::Lock lock{m_Mutex};
+          if (m_Pending.empty())
+          {
+            m_Draining--;
+            return;
+          }
+          // share what's pending between the drains, a batch at a time so a late burst still
+          // gets spread out
+          const size_t take = std::clamp(m_Pending.size() / m_Parallelism, size_t{1}, MaxBatch);
+          for (size_t idx = 0; idx < take; ++idx)
+          {
+            batch.emplace_back(std::move(m_Pending.front()));
+            m_Pending.pop_front();
+          }
+        }
+        m_Batches++;
+        m_Exchanges += batch.size();
+        for (auto& job : batch)
+          job();
+        batch.clear();
+      }
+    }
+
+    void
+    KeyExchangeService::RecordBuild(Clock_t::duration elapsed)
+    {
+      m_BuildLatency.Record(
+          std::chrono::duration_cast<util::LatencyHistogram::Duration_t>(elapsed));
+    }
+
+    void
+    KeyExchangeService::RecordBuildHop(Clock_t::duration elapsed)
+    {
+      m_BuildHopLatency.Record(
+          std::chrono::duration_cast<util::LatencyHistogram::Duration_t>(elapsed));
+    }
+
+    void
+    KeyExchangeService::RecordCommit(Clock_t::duration elapsed)
+    {
+      m_CommitLatency.Record(
+          std::chrono::duration_cast<util::LatencyHistogram::Duration_t>(elapsed));
+    }
+
+    util::StatusObject
+    KeyExchangeService::ExtractStatus() const
+    {
+      size_t pending, draining;
+      {
+        util::Lock lock{m_Mutex};
+        pending = m_Pending.size();
+        draining = m_Draining;
+      }
+      return util::StatusObject{
+          {"parallelism", m_Parallelism.load()},
+          {"pending", pending},
+          {"draining", draining},
+          {"batches", m_Batches.load()},
+          {"exchanges", m_Exchanges.load()},
+          {"buildLatency", m_BuildLatency.ExtractStatus()},
+          {"buildHopLatency", m_BuildHopLatency.ExtractStatus()},
+          {"commitLatency", m_CommitLatency.ExtractStatus()}};
+    }
+  }  // namespace path
+}  // namespace llarp
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <llarp/util/histogram.hpp>
+#include <llarp/util/status.hpp>
+#include <llarp/util/thread/threading.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// runs the asymmetric crypto of path building on the worker threads: the key exchange for
+    /// each hop of our own builds, and the dh of each LRCM we are asked to relay.  exchanges
+    /// queued while the workers are busy are collected and handed out in batches, one worker job
+    /// per batch rather than per exchange, split across up to Parallelism jobs at once so a
+    /// burst of builds or commits spreads over every worker while a lone build still gets a
+    /// worker per hop.  also keeps the crypto latency histograms of builds and commits.
+    class KeyExchangeService
+    {
+     public:
+      using Job_t = std::function<void(void)>;
+      using WorkerFunc_t = std::function<void(Job_t)>;
+      using Clock_t = std::chrono::steady_clock;
+
+      /// most exchanges one worker job runs before it gives the worker back
+      static constexpr size_t MaxBatch = 16;
+
+      /// worker queues a job on a worker thread; parallelism is how many jobs may drain the
+      /// pending exchanges at once, usually the number of worker threads
+      KeyExchangeService(WorkerFunc_t worker, size_t parallelism);
+
+      void
+      SetParallelism(size_t parallelism);
+
+      /// queue one exchange
+      void
+      Queue(Job_t job);
+
+      /// queue several exchanges at once, e.g. every hop of a path build
+      void
+      Queue(std::vector<Job_t> jobs);
+
+      /// one of our builds has all its keys, elapsed since its exchanges were queued
+      void
+      RecordBuild(Clock_t::duration elapsed);
+
+      /// one hop's exchange of one of our builds took this long to run
+      void
+      RecordBuildHop(Clock_t::duration elapsed);
+
+      /// the dh of an LRCM finished, elapsed since it was queued
+      void
+      RecordCommit(Clock_t::duration elapsed);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      /// schedule drain jobs for whatever is pending; returns how many to queue
+      size_t
+      ScheduleDrains() REQUIRES(m_Mutex);
+
+      void
+      QueueDrains(size_t count);
+
+      /// run batches of pending exchanges until there are none
+      void
+      Drain();
+
+      const WorkerFunc_t m_Worker;
+      std::atomic<size_t> m_Parallelism;
+      mutable util::Mutex m_Mutex;
+      std::deque<Job_t> m_Pending GUARDED_BY(m_Mutex);
+      size_t m_Draining GUARDED_BY(m_Mutex) = 0;
+      std::atomic<uint64_t> m_Batches{0};
+      std::atomic<uint64_t> m_Exchanges{0};
+      util::LatencyHistogram m_BuildLatency;
+      util::LatencyHistogram m_BuildHopLatency;
+      util::LatencyHistogram m_CommitLatency;
+    };
+  }  // namespace path
+}  // namespace llarp
@@ -30,8 +30,11 @@ namespace llarp
         std::weak_ptr<PathSet> pathset,
         PathRole startingRoles,
         std::string shortName)
-        : m_PathSet{std::move(pathset)}, _role{startingRoles}, m_shortName{std::move(shortName)}
-
+        : m_PathSet{std::move(pathset)}
+        , _role{startingRoles}
+        , m_shortName{std::move(shortName)}
+        , m_UpstreamReplayFilter{randint()}
+        , m_DownstreamReplayFilter{randint()}
     {
       hops.resize(h.size());
       size_t hsz = h.size();
@@ -67,19 +70,26 @@ namespace llarp
     }
 
     bool
-    Path::HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
+    Path::HandleUpstream(RelayFrame X, const TunnelNonce& Y, AbstractRouter* r)
     {
       if (not m_UpstreamReplayFilter.Insert(Y))
         return false;
-      return IHopHandler::HandleUpstream(X, Y, r);
+      return IHopHandler::HandleUpstream(std::move(X), Y, r);
     }
 
     bool
-    Path::HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter* r)
+    Path::HandleDownstream(RelayFrame X, const TunnelNonce& Y, AbstractRouter* r)
     {
       if (not m_DownstreamReplayFilter.Insert(Y))
         return false;
-      return IHopHandler::HandleDownstream(X, Y, r);
+      return IHopHandler::HandleDownstream(std::move(X), Y, r);
+    }
+
+    void
+    Path::DecayFilters(llarp_time_t now)
+    {
+      m_UpstreamReplayFilter.Decay(now);
+      m_DownstreamReplayFilter.Decay(now);
     }
 
     RouterID
@@ -191,6 +201,7 @@ namespace llarp
         ++index;
       }
 
+      buildTrace.StatusArrived(std::min(index, hops.size() - 1));
       if ((currentStatus & LR_StatusRecord::SUCCESS) == LR_StatusRecord::SUCCESS)
       {
         llarp::LogDebug("LR_Status message processed, path build successful");
@@ -304,6 +315,7 @@ namespace llarp
       else if (st == ePathEstablished && _status == ePathBuilding)
       {
         LogInfo("path ", Name(), " is built, took ", now - buildStarted);
+        buildTrace.Established();
       }
       else if (st == ePathTimeout && _status == ePathEstablished)
       {
@@ -356,6 +368,9 @@ namespace llarp
           {"rxRateCurrent", m_LastRXRate},
           {"replayTX", m_UpstreamReplayFilter.Size()},
           {"replayRX", m_DownstreamReplayFilter.Size()},
+          {"replayTXSaturations", m_UpstreamReplayFilter.Saturations()},
+          {"replayRXSaturations", m_DownstreamReplayFilter.Saturations()},
+          {"quality", quality.ExtractStatus()},
           {"hasExit", SupportsAnyRoles(ePathRoleExit)}};
 
       std::vector<util::StatusObject> hopsObj;
@@ -411,6 +426,9 @@ namespace llarp
     {
       const auto now = r->Now();
       // send path latency test
+      // the last probe is still out, so count it lost
+      if (m_LastLatencyTestID)
+        quality.OnProbeLost();
       routing::PathLatencyMessage latency{};
       latency.T = randint();
       latency.S = NextSeqNo();
@@ -485,9 +503,10 @@ namespace llarp
     {
       for (const auto& msg : msgs)
       {
+        const auto sz = msg.X.size();
         if (r->SendToOrQueue(Upstream(), msg))
         {
-          m_TXRate += msg.X.size();
+          m_TXRate += sz;
         }
         else
         {
@@ -512,13 +531,17 @@ namespace llarp
           n ^= hop.nonceXOR;
         }
         auto& msg = sendmsgs[idx];
-        msg.X = buf;
+        msg.X = std::move(ev.first);
         msg.Y = ev.second;
         msg.pathid = TXID();
         ++idx;
       }
-      r->loop()->call([self = shared_from_this(), data = std::move(sendmsgs), r]() mutable {
-        self->HandleAllUpstream(std::move(data), r);
+      r->loop()->call([self = shared_from_this(),
+                       data = std::make_shared<decltype(sendmsgs)>(std::move(sendmsgs)),
+                       batch = std::make_shared<TrafficQueue_t>(std::move(msgs)),
+                       r] {
+        self->HandleAllUpstream(std::move(*data), r);
+        RecycleBatch(std::move(*batch), self->m_UpstreamSpare);
       });
     }
 
@@ -527,9 +550,12 @@ namespace llarp
     {
       if (not m_UpstreamQueue.empty())
       {
+        // relay frames are move only but QueueWork needs a copyable job, so the queue rides along
+        // in a shared_ptr
+        auto batch = TakeBatch(m_UpstreamQueue, m_UpstreamSpare);
         r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_UpstreamQueue, {}),
-                      r]() mutable { self->UpstreamWork(std::move(data), r); });
+                      data = std::make_shared<TrafficQueue_t>(std::move(batch)),
+                      r] { self->UpstreamWork(std::move(*data), r); });
       }
     }
 
@@ -538,9 +564,10 @@ namespace llarp
     {
       if (not m_DownstreamQueue.empty())
       {
+        auto batch = TakeBatch(m_DownstreamQueue, m_DownstreamSpare);
         r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_DownstreamQueue, {}),
-                      r]() mutable { self->DownstreamWork(std::move(data), r); });
+                      data = std::make_shared<TrafficQueue_t>(std::move(batch)),
+                      r] { self->DownstreamWork(std::move(*data), r); });
       }
     }
 
@@ -587,11 +614,15 @@ namespace llarp
           sendMsgs[idx].Y ^= hop.nonceXOR;
           CryptoManager::instance()->xchacha20(buf, hop.shared, sendMsgs[idx].Y);
         }
-        sendMsgs[idx].X = buf;
+        sendMsgs[idx].X = std::move(ev.first);
         ++idx;
       }
-      r->loop()->call([self = shared_from_this(), msgs = std::move(sendMsgs), r]() mutable {
-        self->HandleAllDownstream(std::move(msgs), r);
+      r->loop()->call([self = shared_from_this(),
+                       data = std::make_shared<decltype(sendMsgs)>(std::move(sendMsgs)),
+                       batch = std::make_shared<TrafficQueue_t>(std::move(msgs)),
+                       r] {
+        self->HandleAllDownstream(std::move(*data), r);
+        RecycleBatch(std::move(*batch), self->m_DownstreamSpare);
       });
     }
 
@@ -665,9 +696,8 @@ namespace llarp
         CryptoManager::instance()->randbytes(buf.cur, pad_size - buf.sz);
         buf.sz = pad_size;
       }
-      buf.cur = buf.base;
       LogDebug("send routing message ", msg.S, " with ", buf.sz, " bytes to endpoint ", Endpoint());
-      return HandleUpstream(buf, N, r);
+      return HandleUpstream(RelayFrame{buf.base, buf.sz}, N, r);
     }
 
     bool
@@ -694,6 +724,7 @@ namespace llarp
       const auto now = llarp::time_now_ms();
       if (_status == ePathBuilding)
       {
+        buildTrace.Confirmed();
         // finish initializing introduction
         intro.expiresAt = buildStarted + hops[0].lifetime;
 
@@ -747,6 +778,7 @@ namespace llarp
       if (m_LastLatencyTestID)
       {
         m_LatencySamples.emplace_back(now - m_LastLatencyTestTime);
+        quality.OnRoundTrip(m_LatencySamples.back());
 
         while (m_LatencySamples.size() > MaxLatencySamples)
           m_LatencySamples.pop_front();
@@ -4,7 +4,9 @@
 #include <llarp/crypto/encrypted_frame.hpp>
 #include <llarp/crypto/types.hpp>
 #include <llarp/messages/relay.hpp>
+#include "build_timings.hpp"
 #include "ihophandler.hpp"
+#include "path_scheduler.hpp"
 #include "path_types.hpp"
 #include "pathbuilder.hpp"
 #include "pathset.hpp"
@@ -14,6 +16,7 @@
 #include <llarp/service/intro.hpp>
 #include <llarp/util/aligned.hpp>
 #include <llarp/util/compare_ptr.hpp>
+#include <llarp/util/replay_filter.hpp>
 #include <llarp/util/thread/threading.hpp>
 #include <llarp/util/time.hpp>
 
@@ -93,6 +96,11 @@ namespace llarp
 
       llarp_time_t buildStarted = 0s;
 
+      /// stage timings of the build that made this path
+      BuildTrace buildTrace;
+      /// how this path has been doing on its latency probes
+      PathQuality quality;
+
       Path(
           const std::vector<RouterContact>& routers,
           std::weak_ptr<PathSet> parent,
@@ -203,11 +211,15 @@ namespace llarp
 
       // handle data in upstream direction
       bool
-      HandleUpstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*) override;
+      HandleUpstream(RelayFrame X, const TunnelNonce& Y, AbstractRouter*) override;
       // handle data in downstream direction
 
       bool
-      HandleDownstream(const llarp_buffer_t& X, const TunnelNonce& Y, AbstractRouter*) override;
+      HandleDownstream(RelayFrame X, const TunnelNonce& Y, AbstractRouter*) override;
+
+      /// start new replay filter generations if they are due
+      void
+      DecayFilters(llarp_time_t now);
 
       const std::string&
       ShortName() const;
@@ -429,6 +441,8 @@ namespace llarp
       uint64_t m_TXRate = 0;
       std::deque<llarp_time_t> m_LatencySamples;
       const std::string m_shortName;
+      util::RotatingReplayFilter<TunnelNonce> m_UpstreamReplayFilter;
+      util::RotatingReplayFilter<TunnelNonce> m_DownstreamReplayFilter;
     };
   }  // namespace path
 }  // namespace llarp
@@ -1,10 +1,14 @@
 #include "path_context.hpp"
 
+#include <llarp/crypto/crypto.hpp>
 #include <llarp/messages/relay_commit.hpp>
 #include "path.hpp"
 #include <llarp/router/abstractrouter.hpp>
 #include <llarp/router/i_outbound_message_handler.hpp>
 
+#include <algorithm>
+#include <thread>
+
 namespace llarp
 {
   namespace path
@@ -12,8 +16,103 @@ namespace llarp
     static constexpr auto DefaultPathBuildLimit = 500ms;
 
     PathContext::PathContext(AbstractRouter* router)
-        : m_Router(router), m_AllowTransit(false), m_PathLimits(DefaultPathBuildLimit)
-    {}
+        : m_Router(router)
+        , m_AllowTransit(false)
+        , m_PathLimits(DefaultPathBuildLimit)
+        , m_TransitIndex(randint())
+        , m_OwnIndex(randint())
+        , m_KeyExchange(
+              [router](auto job) { router->QueueWork(std::move(job)); },
+              std::thread::hardware_concurrency())
+    {
+      m_ShardStats.emplace_back(std::make_unique<TransitShardStats>());
+    }
+
+    void
+    PathContext::StartTransitShards(size_t numShards, size_t queueSize)
+    {
+      if (m_TransitShards)
+        return;
+      m_ShardStats.clear();
+      for (size_t idx = 0; idx < numShards; ++idx)
+        m_ShardStats.emplace_back(std::make_unique<TransitShardStats>());
+      m_TransitShards =
+          std::make_unique<thread::ShardedWorkerPool>(numShards, queueSize, false, "llarp-transit");
+      m_TransitShards->Start();
+    }
+
+    void
+    PathContext::StopTransitShards()
+    {
+      if (m_TransitShards)
+        m_TransitShards->Stop();
+    }
+
+    static constexpr auto TransitDropWarnInterval = 5s;
+
+    void
+    PathContext::QueueTransitWork(
+        const PathID_t& path, size_t frames, std::function<void(void)> job)
+    {
+      if (not m_TransitShards)
+      {
+        m_Router->QueueWork(std::move(job));
+        return;
+      }
+      const auto key = std::hash<PathID_t>{}(path);
+      if (m_TransitShards->QueueJob(key, std::move(job)))
+        return;
+      ShardStats(path).dropped.fetch_add(frames, std::memory_order_relaxed);
+      const auto now = time_now_ms();
+      auto last = m_LastDropWarn.load(std::memory_order_relaxed);
+      if (now - last > TransitDropWarnInterval and m_LastDropWarn.compare_exchange_strong(last, now))
+      {
+        LogWarn(
+            "transit shard ",
+            m_TransitShards->ShardFor(key),
+            " is full, dropped ",
+            frames,
+            " frames on ",
+            path);
+      }
+    }
+
+    TransitShardStats&
+    PathContext::ShardStats(const PathID_t& path)
+    {
+      if (not m_TransitShards)
+        return *m_ShardStats.front();
+      return *m_ShardStats[m_TransitShards->ShardFor(std::hash<PathID_t>{}(path))];
+    }
+
+    util::StatusObject
+    PathContext::ExtractStatus() const
+    {
+      util::StatusObject status{{"running", false}, {"shards", std::vector<util::StatusObject>(1)}};
+      if (m_TransitShards)
+        status = m_TransitShards->ExtractStatus();
+      auto& shards = status["shards"];
+      for (size_t idx = 0; idx < m_ShardStats.size(); ++idx)
+      {
+        const auto& stats = *m_ShardStats[idx];
+        shards[idx]["frames"] = stats.frames.load(std::memory_order_relaxed);
+        shards[idx]["bytes"] = stats.bytes.load(std::memory_order_relaxed);
+        shards[idx]["dropped"] = stats.dropped.load(std::memory_order_relaxed);
+      }
+      return status;
+    }
+
+    KeyExchangeService&
+    PathContext::KeyExchange()
+    {
+      return m_KeyExchange;
+    }
+
+    const KeyExchangeService&
+    PathContext::KeyExchange() const
+    {
+      return m_KeyExchange;
+    }
 
     void
     PathContext::AllowTransit()
@@ -64,10 +163,11 @@ namespace llarp
     PathContext::FindOwnedPathsWithEndpoint(const RouterID& r)
     {
       EndpointPathPtrSet found;
-      m_OurPaths.ForEach([&](const Path_ptr& p) {
+      for (const auto& p : m_OurPaths)
+      {
         if (p->Endpoint() == r && p->IsReady())
           found.insert(p);
-      });
+      }
       return found;
     }
 
@@ -90,185 +190,76 @@ namespace llarp
       return m_Router->SendToOrQueue(nextHop, msg, handler);
     }
 
-    template <
-        typename Lock_t,
-        typename Map_t,
-        typename Key_t,
-        typename CheckValue_t,
-        typename GetFunc_t,
-        typename Return_ptr = HopHandler_ptr>
-    Return_ptr
-    MapGet(Map_t& map, const Key_t& k, CheckValue_t check, GetFunc_t get)
-    {
-      Lock_t lock(map.first);
-      auto range = map.second.equal_range(k);
-      for (auto i = range.first; i != range.second; ++i)
-      {
-        if (check(i->second))
-          return get(i->second);
-      }
-      return nullptr;
-    }
-
-    template <typename Lock_t, typename Map_t, typename Key_t, typename CheckValue_t>
-    bool
-    MapHas(Map_t& map, const Key_t& k, CheckValue_t check)
-    {
-      Lock_t lock(map.first);
-      auto range = map.second.equal_range(k);
-      for (auto i = range.first; i != range.second; ++i)
-      {
-        if (check(i->second))
-          return true;
-      }
-      return false;
-    }
-
-    template <typename Lock_t, typename Map_t, typename Key_t, typename Value_t>
-    void
-    MapPut(Map_t& map, const Key_t& k, const Value_t& v)
-    {
-      Lock_t lock(map.first);
-      map.second.emplace(k, v);
-    }
-
-    template <typename Lock_t, typename Map_t, typename Visit_t>
-    void
-    MapIter(Map_t& map, Visit_t v)
-    {
-      Lock_t lock(map.first);
-      for (const auto& item : map.second)
-        v(item);
-    }
-
-    template <typename Lock_t, typename Map_t, typename Key_t, typename Check_t>
     void
-    MapDel(Map_t& map, const Key_t& k, Check_t check)
+    PathContext::AddOwnPath(PathSet_ptr set, Path_ptr path)
     {
-      Lock_t lock(map.first);
-      auto range = map.second.equal_range(k);
-      for (auto i = range.first; i != range.second;)
-      {
-        if (check(i->second))
-          i = map.second.erase(i);
-        else
-          ++i;
-      }
+      set->AddPath(path);
+      m_OwnIndex.Insert({path->TXID(), HopSide::Own}, path.get());
+      m_OwnIndex.Insert({path->RXID(), HopSide::Own}, path.get());
+      m_OurPaths.emplace_back(std::move(path));
     }
 
-    void
-    PathContext::AddOwnPath(PathSet_ptr set, Path_ptr path)
+    TransitHop*
+    PathContext::FindTransitHop(
+        const PathID_t& id, HopSide side, const RouterID& neighbour) const
     {
-      set->AddPath(path);
-      MapPut<util::Lock>(m_OurPaths, path->TXID(), path);
-      MapPut<util::Lock>(m_OurPaths, path->RXID(), path);
+      const auto* found = m_TransitIndex.Find({id, side, neighbour});
+      return found ? *found : nullptr;
     }
 
     bool
     PathContext::HasTransitHop(const TransitHopInfo& info)
     {
-      return MapHas<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths, info.txID, [info](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return info == hop->info;
-          });
+      const auto* hop = FindTransitHop(info.txID, HopSide::Upstream, info.upstream);
+      return hop and hop->info == info;
     }
 
     std::optional<std::weak_ptr<TransitHop>>
     PathContext::TransitHopByInfo(const TransitHopInfo& info)
     {
-      // this is ugly as sin
-      auto own = MapGet<
-          SyncTransitMap_t::Lock_t,
-          decltype(m_TransitPaths),
-          PathID_t,
-          std::function<bool(const std::shared_ptr<TransitHop>&)>,
-          std::function<TransitHop*(const std::shared_ptr<TransitHop>&)>,
-          TransitHop*>(
-          m_TransitPaths,
-          info.txID,
-          [info](const auto& hop) -> bool { return hop->info == info; },
-          [](const auto& hop) -> TransitHop* { return hop.get(); });
-      if (own)
-        return own->weak_from_this();
+      if (auto* hop = FindTransitHop(info.txID, HopSide::Upstream, info.upstream);
+          hop and hop->info == info)
+        return hop->weak_from_this();
       return std::nullopt;
     }
 
     std::optional<std::weak_ptr<TransitHop>>
     PathContext::TransitHopByUpstream(const RouterID& upstream, const PathID_t& id)
     {
-      // this is ugly as sin as well
-      auto own = MapGet<
-          SyncTransitMap_t::Lock_t,
-          decltype(m_TransitPaths),
-          PathID_t,
-          std::function<bool(const std::shared_ptr<TransitHop>&)>,
-          std::function<TransitHop*(const std::shared_ptr<TransitHop>&)>,
-          TransitHop*>(
-          m_TransitPaths,
-          id,
-          [upstream](const auto& hop) -> bool { return hop->info.upstream == upstream; },
-          [](const auto& hop) -> TransitHop* { return hop.get(); });
-      if (own)
-        return own->weak_from_this();
+      if (auto* hop = FindTransitHop(id, HopSide::Upstream, upstream))
+        return hop->weak_from_this();
       return std::nullopt;
     }
 
     HopHandler_ptr
     PathContext::GetByUpstream(const RouterID& remote, const PathID_t& id)
     {
-      auto own = MapGet<util::Lock>(
-          m_OurPaths,
-          id,
-          [](const Path_ptr) -> bool {
-            // TODO: is this right?
-            return true;
-          },
-          [](Path_ptr p) -> HopHandler_ptr { return p; });
-      if (own)
-        return own;
-
-      return MapGet<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths,
-          id,
-          [remote](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return hop->info.upstream == remote;
-          },
-          [](const std::shared_ptr<TransitHop>& h) -> HopHandler_ptr { return h; });
+      if (const auto* own = m_OwnIndex.Find({id, HopSide::Own}))
+        return (*own)->shared_from_this();
+      if (auto* hop = FindTransitHop(id, HopSide::Upstream, remote))
+        return hop->shared_from_this();
+      return nullptr;
     }
 
     bool
     PathContext::TransitHopPreviousIsRouter(const PathID_t& path, const RouterID& otherRouter)
     {
-      SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-      auto itr = m_TransitPaths.second.find(path);
-      if (itr == m_TransitPaths.second.end())
-        return false;
-      return itr->second->info.downstream == otherRouter;
+      return FindTransitHop(path, HopSide::Downstream, otherRouter) != nullptr;
     }
 
     HopHandler_ptr
     PathContext::GetByDownstream(const RouterID& remote, const PathID_t& id)
     {
-      return MapGet<SyncTransitMap_t::Lock_t>(
-          m_TransitPaths,
-          id,
-          [remote](const std::shared_ptr<TransitHop>& hop) -> bool {
-            return hop->info.downstream == remote;
-          },
-          [](const std::shared_ptr<TransitHop>& h) -> HopHandler_ptr { return h; });
+      if (auto* hop = FindTransitHop(id, HopSide::Downstream, remote))
+        return hop->shared_from_this();
+      return nullptr;
     }
 
     PathSet_ptr
     PathContext::GetLocalPathSet(const PathID_t& id)
     {
-      auto& map = m_OurPaths;
-      util::Lock lock(map.first);
-      auto itr = map.second.find(id);
-      if (itr != map.second.end())
-      {
-        if (auto parent = itr->second->m_PathSet.lock())
-          return parent;
-      }
+      if (const auto* own = m_OwnIndex.Find({id, HopSide::Own}))
+        return (*own)->m_PathSet.lock();
       return nullptr;
     }
 
@@ -287,61 +278,84 @@ namespace llarp
     TransitHop_ptr
     PathContext::GetPathForTransfer(const PathID_t& id)
     {
-      const RouterID us(OurRouterID());
-      auto& map = m_TransitPaths;
-      {
-        SyncTransitMap_t::Lock_t lock(map.first);
-        auto range = map.second.equal_range(id);
-        for (auto i = range.first; i != range.second; ++i)
-        {
-          if (i->second->info.upstream == us)
-            return i->second;
-        }
-      }
+      if (auto* hop = FindTransitHop(id, HopSide::Upstream, RouterID{OurRouterID()}))
+        return hop->shared_from_this();
       return nullptr;
     }
 
     void
     PathContext::PumpUpstream()
     {
-      m_TransitPaths.ForEach([&](auto& ptr) { ptr->FlushUpstream(m_Router); });
-      m_OurPaths.ForEach([&](auto& ptr) { ptr->FlushUpstream(m_Router); });
+      m_TransitHops.ForEach([&](auto* hop) { hop->FlushUpstream(m_Router); });
+      for (const auto& path : m_OurPaths)
+        path->FlushUpstream(m_Router);
     }
 
     void
     PathContext::PumpDownstream()
     {
-      m_TransitPaths.ForEach([&](auto& ptr) { ptr->FlushDownstream(m_Router); });
-      m_OurPaths.ForEach([&](auto& ptr) { ptr->FlushDownstream(m_Router); });
+      m_TransitHops.ForEach([&](auto* hop) { hop->FlushDownstream(m_Router); });
+      for (const auto& path : m_OurPaths)
+        path->FlushDownstream(m_Router);
     }
 
     uint64_t
     PathContext::CurrentTransitPaths()
     {
-      SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-      const auto& map = m_TransitPaths.second;
-      return map.size() / 2;
+      return m_TransitHops.size();
     }
 
     uint64_t
     PathContext::CurrentOwnedPaths(path::PathStatus st)
     {
-      uint64_t num{};
-      util::Lock lock{m_OurPaths.first};
-      auto& map = m_OurPaths.second;
-      for (auto itr = map.begin(); itr != map.end(); ++itr)
+      return std::count_if(m_OurPaths.begin(), m_OurPaths.end(), [st](const auto& path) {
+        return path->Status() == st;
+      });
+    }
+
+    void
+    PathContext::PutTransitHop(std::shared_ptr<TransitHop> hop)
+    {
+      const auto& info = hop->info;
+      for (const auto& id : {info.txID, info.rxID})
       {
-        if (itr->second->Status() == st)
-          num++;
+        if (not m_TransitIndex.Insert({id, HopSide::Upstream, info.upstream}, hop.get()))
+          LogWarn("transit hop ", info, " shares path id ", id, " with another from upstream");
+        if (not m_TransitIndex.Insert({id, HopSide::Downstream, info.downstream}, hop.get()))
+          LogWarn("transit hop ", info, " shares path id ", id, " with another from downstream");
       }
-      return num / 2;
+      auto* ptr = hop.get();
+      m_TransitHops.Insert(std::move(hop));
+      // torn down before it got here
+      if (ptr->destroy)
+        m_TransitHops.MoveToFront(ptr);
     }
 
     void
-    PathContext::PutTransitHop(std::shared_ptr<TransitHop> hop)
+    PathContext::RemoveTransitHop(TransitHop* hop)
     {
-      MapPut<SyncTransitMap_t::Lock_t>(m_TransitPaths, hop->info.txID, hop);
-      MapPut<SyncTransitMap_t::Lock_t>(m_TransitPaths, hop->info.rxID, hop);
+      const auto& info = hop->info;
+      for (const auto& id : {info.txID, info.rxID})
+      {
+        m_Router->outboundMessageHandler().RemovePath(id);
+        m_TransitIndex.Erase({id, HopSide::Upstream, info.upstream}, hop);
+        m_TransitIndex.Erase({id, HopSide::Downstream, info.downstream}, hop);
+      }
+      m_TransitHops.Unlink(hop);
+    }
+
+    void
+    PathContext::ExpireTransitHopEarly(TransitHop& hop)
+    {
+      if (hop.expiryHook.owner)
+        m_TransitHops.MoveToFront(&hop);
+    }
+
+    void
+    PathContext::RemoveOwnPath(const Path_ptr& path)
+    {
+      m_OwnIndex.Erase({path->TXID(), HopSide::Own}, path.get());
+      m_OwnIndex.Erase({path->RXID(), HopSide::Own}, path.get());
     }
 
     void
@@ -350,43 +364,58 @@ namespace llarp
       // decay limits
       m_PathLimits.Decay(now);
 
+      while (auto* hop = m_TransitHops.Front())
       {
-        SyncTransitMap_t::Lock_t lock(m_TransitPaths.first);
-        auto& map = m_TransitPaths.second;
-        auto itr = map.begin();
-        while (itr != map.end())
-        {
-          if (itr->second->Expired(now))
-          {
-            m_Router->outboundMessageHandler().RemovePath(itr->first);
-            itr = map.erase(itr);
-          }
-          else
-          {
-            itr->second->DecayFilters(now);
-            ++itr;
-          }
-        }
+        if (not hop->Expired(now))
+          break;
+        RemoveTransitHop(hop);
       }
+
+      auto itr = m_OurPaths.begin();
+      while (itr != m_OurPaths.end())
       {
-        util::Lock lock(m_OurPaths.first);
-        auto& map = m_OurPaths.second;
-        auto itr = map.begin();
-        while (itr != map.end())
+        if ((*itr)->Expired(now))
         {
-          if (itr->second->Expired(now))
-          {
-            itr = map.erase(itr);
-          }
-          else
-          {
-            itr->second->DecayFilters(now);
-            ++itr;
-          }
+          RemoveOwnPath(*itr);
+          *itr = std::move(m_OurPaths.back());
+          m_OurPaths.pop_back();
         }
+        else
+        {
+          (*itr)->DecayFilters(now);
+          ++itr;
+        }
+      }
+
+      for (auto timings = m_BuildTimings.begin(); timings != m_BuildTimings.end();)
+      {
+        if (timings->second.owner.expired())
+          timings = m_BuildTimings.erase(timings);
+        else
+          ++timings;
       }
     }
 
+    std::shared_ptr<BuildTimings>
+    PathContext::BuildTimingsFor(const PathSet_ptr& set)
+    {
+      auto& entry = m_BuildTimings[set->Name()];
+      // a path set that took over the name of one that is gone carries on its timings
+      entry.owner = set;
+      if (not entry.timings)
+        entry.timings = std::make_shared<BuildTimings>();
+      return entry.timings;
+    }
+
+    util::StatusObject
+    PathContext::ExtractBuildStats() const
+    {
+      util::StatusObject stats = util::StatusObject::object();
+      for (const auto& [name, entry] : m_BuildTimings)
+        stats[name] = entry.timings->ExtractStatus();
+      return stats;
+    }
+
     routing::MessageHandler_ptr
     PathContext::GetHandler(const PathID_t& id)
     {
@@ -398,18 +427,7 @@ namespace llarp
       }
       if (h)
         return h;
-      const RouterID us(OurRouterID());
-      auto& map = m_TransitPaths;
-      {
-        SyncTransitMap_t::Lock_t lock(map.first);
-        auto range = map.second.equal_range(id);
-        for (auto i = range.first; i != range.second; ++i)
-        {
-          if (i->second->info.upstream == us)
-            return i->second;
-        }
-      }
-      return nullptr;
+      return GetPathForTransfer(id);
     }
 
     void PathContext::RemovePathSet(PathSet_ptr)
@@ -3,6 +3,9 @@
 #include <llarp/crypto/encrypted_frame.hpp>
 #include <llarp/net/ip_address.hpp>
 #include "ihophandler.hpp"
+#include "build_timings.hpp"
+#include "key_exchange.hpp"
+#include "path_index.hpp"
 #include "path_types.hpp"
 #include "pathset.hpp"
 #include "transit_hop.hpp"
@@ -10,10 +13,16 @@
 #include <llarp/router/i_outbound_message_handler.hpp>
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/decaying_hashset.hpp>
+#include <llarp/util/status.hpp>
+#include <llarp/util/thread/sharded_worker_pool.hpp>
 #include <llarp/util/types.hpp>
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace llarp
 {
@@ -30,14 +39,66 @@ namespace llarp
 
     using TransitHop_ptr = std::shared_ptr<TransitHop>;
 
+    /// what one transit forwarding shard has handed to the outbound queue; cache line aligned as
+    /// each is bumped by its own shard's thread
+    struct alignas(64) TransitShardStats
+    {
+      std::atomic<uint64_t> frames{0};
+      std::atomic<uint64_t> bytes{0};
+      std::atomic<uint64_t> dropped{0};
+    };
+
     struct PathContext
     {
       explicit PathContext(AbstractRouter* router);
 
-      /// called from router tick function
+      /// spawn the threads that forward transit traffic.  transit hops are partitioned across
+      /// them by path id, so every batch on a path runs on the same thread in order; until this
+      /// is called hop work goes to the router's general worker threads
+      void
+      StartTransitShards(size_t numShards, size_t queueSize);
+
+      /// run the transit work already queued then join the shard threads
+      void
+      StopTransitShards();
+
+      /// queue a transit hop's work on the shard that owns this path; if that shard is full the
+      /// job is dropped and its frames are counted as dropped
+      void
+      QueueTransitWork(const PathID_t& path, size_t frames, std::function<void(void)> job);
+
+      /// counters of the shard that owns this path
+      TransitShardStats&
+      ShardStats(const PathID_t& path);
+
+      util::StatusObject
+      ExtractStatus() const;
+
+      /// runs the key exchanges of our path builds and the LRCMs we relay
+      KeyExchangeService&
+      KeyExchange();
+
+      const KeyExchangeService&
+      KeyExchange() const;
+
+      /// the stage timings of this path set's builds, kept by its name for as long as it is
+      /// around
+      std::shared_ptr<BuildTimings>
+      BuildTimingsFor(const PathSet_ptr& set);
+
+      /// build stage timings of every path set we build for, by name
+      util::StatusObject
+      ExtractBuildStats() const;
+
+      /// called from router tick function; transit hops are popped off the front of their
+      /// expiry list, so only the hops that expired are looked at
       void
       ExpirePaths(llarp_time_t now);
 
+      /// have a torn down transit hop expired on the next tick
+      void
+      ExpireTransitHopEarly(TransitHop& hop);
+
       void
       PumpUpstream();
 
@@ -115,47 +176,8 @@ namespace llarp
       void
       RemovePathSet(PathSet_ptr set);
 
-      using TransitHopsMap_t = std::unordered_multimap<PathID_t, TransitHop_ptr>;
-
-      struct SyncTransitMap_t
-      {
-        using Mutex_t = util::NullMutex;
-        using Lock_t = util::NullLock;
-
-        Mutex_t first;  // protects second
-        TransitHopsMap_t second GUARDED_BY(first);
-
-        /// Invokes a callback for each transit path; visit must be invokable with a `const
-        /// TransitHop_ptr&` argument.
-        template <typename TransitHopVisitor>
-        void
-        ForEach(TransitHopVisitor&& visit) EXCLUDES(first)
-        {
-          Lock_t lock(first);
-          for (const auto& item : second)
-            visit(item.second);
-        }
-      };
-
-      // maps path id -> pathset owner of path
-      using OwnedPathsMap_t = std::unordered_map<PathID_t, Path_ptr>;
-
-      struct SyncOwnedPathsMap_t
-      {
-        util::Mutex first;  // protects second
-        OwnedPathsMap_t second GUARDED_BY(first);
-
-        /// Invokes a callback for each owned path; visit must be invokable with a `const Path_ptr&`
-        /// argument.
-        template <typename OwnedHopVisitor>
-        void
-        ForEach(OwnedHopVisitor&& visit)
-        {
-          util::Lock lock(first);
-          for (const auto& item : second)
-            visit(item.second);
-        }
-      };
+      /// every transit hop, in expiry order; owns them
+      using TransitExpiry_t = ExpiryList<TransitHop, &TransitHop::expiryHook>;
 
       const EventLoop_ptr&
       loop();
@@ -178,11 +200,41 @@ namespace llarp
       CurrentOwnedPaths(path::PathStatus status = path::PathStatus::ePathEstablished);
 
      private:
+      /// the transit hop this id names when it comes from this side, nullptr if none
+      TransitHop*
+      FindTransitHop(const PathID_t& id, HopSide side, const RouterID& neighbour) const;
+
+      void
+      RemoveTransitHop(TransitHop* hop);
+
+      void
+      RemoveOwnPath(const Path_ptr& path);
+
       AbstractRouter* m_Router;
-      SyncTransitMap_t m_TransitPaths;
-      SyncOwnedPathsMap_t m_OurPaths;
       bool m_AllowTransit;
       util::DecayingHashSet<IpAddress> m_PathLimits;
+      /// transit hops answer to both of their path ids from either neighbour, as they always have
+      PathIndex<TransitHop> m_TransitIndex;
+      TransitExpiry_t m_TransitHops;
+      /// our own paths answer to their tx and rx ids, whoever asks
+      PathIndex<Path> m_OwnIndex;
+      /// a client's handful of paths; not worth an expiry list as when they expire depends on
+      /// their status
+      std::vector<Path_ptr> m_OurPaths;
+      std::unique_ptr<thread::ShardedWorkerPool> m_TransitShards;
+      /// one per shard, or a single one while there are no shards
+      std::vector<std::unique_ptr<TransitShardStats>> m_ShardStats;
+      /// when we last warned about a full transit shard
+      std::atomic<llarp_time_t> m_LastDropWarn{0s};
+      KeyExchangeService m_KeyExchange;
+
+      struct BuildTimingsEntry
+      {
+        std::weak_ptr<PathSet> owner;
+        std::shared_ptr<BuildTimings> timings;
+      };
+      /// by path set name; dropped once the path set is gone
+      std::unordered_map<std::string, BuildTimingsEntry> m_BuildTimings;
     };
   }  // namespace path
 }  // namespace llarp
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "path_types.hpp"
+
+#include <llarp/router_id.hpp>
+#include <llarp/util/flat_index.hpp>
+#include <llarp/util/time.hpp>
+
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// which neighbour a path id is looked up from
+    enum class HopSide : uint8_t
+    {
+      /// one of our own paths, which answers to its ids whoever asks
+      Own,
+      /// traffic from a transit hop's upstream router
+      Upstream,
+      /// traffic from a transit hop's downstream router
+      Downstream,
+    };
+
+    /// what a hop is looked up by.  the neighbour is part of the key so two hops sharing a path
+    /// id (ids are picked by whoever builds the path) never shadow each other.
+    struct PathKey
+    {
+      PathID_t id;
+      HopSide side = HopSide::Own;
+      RouterID neighbour;
+
+      PathKey() = default;
+
+      PathKey(const PathID_t& id, HopSide side, const RouterID& neighbour = {})
+          : id{id}, side{side}, neighbour{neighbour}
+      {}
+
+      bool
+      operator==(const PathKey& other) const
+      {
+        return side == other.side and id == other.id and neighbour == other.neighbour;
+      }
+    };
+
+    template <typename Hop_t>
+    struct PathIndexTraits
+    {
+      using Key = PathKey;
+      using Value = Hop_t*;
+
+      static uint64_t
+      Hash(uint64_t seed, const Key& key)
+      {
+        uint64_t hi, lo, router;
+        std::memcpy(&hi, key.id.data(), sizeof(hi));
+        std::memcpy(&lo, key.id.data() + sizeof(hi), sizeof(lo));
+        std::memcpy(&router, key.neighbour.data(), sizeof(router));
+        return util::Mix64(util::Mix64(util::Mix64(seed ^ hi) ^ lo) ^ router ^ uint64_t(key.side));
+      }
+    };
+
+    /// index from path id, side and neighbour to a hop for the per message lookup on the relay
+    /// path.  it does not own its hops and, like the rest of PathContext, belongs to the event
+    /// loop thread.
+    template <typename Hop_t>
+    using PathIndex = util::FlatIndex<PathIndexTraits<Hop_t>>;
+
+    /// what a hop needs to be linked into an ExpiryList
+    template <typename Hop_t>
+    struct ExpiryHook
+    {
+      Hop_t* prev = nullptr;
+      Hop_t* next = nullptr;
+      /// the list's reference to the hop while it is linked
+      std::shared_ptr<Hop_t> owner;
+    };
+
+    /// intrusive doubly linked list of hops kept in ExpireTime() order, so expiring them is a
+    /// matter of popping the front until it hasn't expired.  the list holds a reference to each
+    /// hop it links (through the hop's own hook, so linking never allocates) until it is
+    /// unlinked.  hops mostly arrive with the longest time left, so inserting walks back from
+    /// the tail and is O(1) in practice.  event loop thread only.
+    template <typename Hop_t, ExpiryHook<Hop_t> Hop_t::*Hook>
+    class ExpiryList
+    {
+     public:
+      ExpiryList() = default;
+      ExpiryList(const ExpiryList&) = delete;
+      ExpiryList&
+      operator=(const ExpiryList&) = delete;
+
+      ~ExpiryList()
+      {
+        Clear();
+      }
+
+      size_t
+      size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Size == 0;
+      }
+
+      /// the hop that expires first, nullptr if there are none
+      Hop_t*
+      Front() const
+      {
+        return m_Head;
+      }
+
+      /// link a hop in by its expiry time, after any that expire at the same time
+      void
+      Insert(std::shared_ptr<Hop_t> hop)
+      {
+        Hop_t* after = m_Tail;
+        while (after and hop->ExpireTime() < after->ExpireTime())
+          after = (after->*Hook).prev;
+        LinkAfter(after, std::move(hop));
+      }
+
+      /// move a linked hop to the front, e.g. because it was torn down early
+      void
+      MoveToFront(Hop_t* hop)
+      {
+        if (hop == m_Head)
+          return;
+        auto owner = Unlink(hop);
+        LinkAfter(nullptr, std::move(owner));
+      }
+
+      /// unlink a hop, handing back the list's reference to it
+      std::shared_ptr<Hop_t>
+      Unlink(Hop_t* hop)
+      {
+        auto& hook = hop->*Hook;
+        assert(hook.owner.get() == hop);
+        (hook.prev ? (hook.prev->*Hook).next : m_Head) = hook.next;
+        (hook.next ? (hook.next->*Hook).prev : m_Tail) = hook.prev;
+        hook.prev = hook.next = nullptr;
+        m_Size--;
+        return std::move(hook.owner);
+      }
+
+      /// visit every hop in expiry order; visit must not link or unlink hops
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t&& visit) const
+      {
+        for (Hop_t* hop = m_Head; hop; hop = (hop->*Hook).next)
+          visit(hop);
+      }
+
+      void
+      Clear()
+      {
+        while (m_Head)
+          Unlink(m_Head);
+      }
+
+     private:
+      void
+      LinkAfter(Hop_t* after, std::shared_ptr<Hop_t> hop)
+      {
+        Hop_t* const ptr = hop.get();
+        auto& hook = ptr->*Hook;
+        assert(not hook.owner);
+        hook.owner = std::move(hop);
+        hook.prev = after;
+        hook.next = after ? (after->*Hook).next : m_Head;
+        (after ? (after->*Hook).next : m_Head) = ptr;
+        (hook.next ? (hook.next->*Hook).prev : m_Tail) = ptr;
+        m_Size++;
+      }
+
+      Hop_t* m_Head = nullptr;
+      Hop_t* m_Tail = nullptr;
+      size_t m_Size = 0;
+    };
+  }  // namespace path
+}  // namespace llarp
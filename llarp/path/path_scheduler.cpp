@@ -0,0 +1,111 @@
+#include "path_scheduler.hpp"
+
+#include <llarp/crypto/crypto.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace llarp
+{
+  namespace path
+  {
+    PathSelection
+    ParsePathSelection(std::string data)
+    {
+      std::unordered_map<std::string, PathSelection> values = {
+          {"random", PathSelection::eRandom},
+          {"weighted", PathSelection::eWeighted},
+          {"power-of-two", PathSelection::ePowerOfTwo}};
+      const auto itr = values.find(data);
+      if (itr == values.end())
+        throw std::invalid_argument("no such path selection: " + data);
+      return itr->second;
+    }
+
+    std::string
+    ToString(PathSelection selection)
+    {
+      switch (selection)
+      {
+        case PathSelection::eRandom:
+          return "random";
+        case PathSelection::eWeighted:
+          return "weighted";
+        case PathSelection::ePowerOfTwo:
+          return "power-of-two";
+      }
+      return "unknown";
+    }
+
+    void
+    PathQuality::OnRoundTrip(llarp_time_t rtt)
+    {
+      const double ms = std::chrono::duration<double, std::milli>(rtt).count();
+      if (m_Measured)
+        m_RoundTrip += Alpha * (ms - m_RoundTrip);
+      else
+        m_RoundTrip = ms;
+      m_Measured = true;
+      m_Loss -= Alpha * m_Loss;
+    }
+
+    void
+    PathQuality::OnProbeLost()
+    {
+      m_Loss += Alpha * (1 - m_Loss);
+    }
+
+    double
+    PathQuality::Cost() const
+    {
+      return std::max(m_RoundTrip, 1.0) / (1 - std::min(m_Loss, MaxLoss));
+    }
+
+    util::StatusObject
+    PathQuality::ExtractStatus() const
+    {
+      return util::StatusObject{{"rtt", m_RoundTrip}, {"loss", m_Loss}, {"cost", Cost()}};
+    }
+
+    size_t
+    PathScheduler::Pick(const std::vector<double>& costs) const
+    {
+      const size_t num = costs.size();
+      if (num < 2)
+        return 0;
+      switch (selection)
+      {
+        case PathSelection::eRandom:
+          return randint() % num;
+        case PathSelection::eWeighted:
+        {
+          // a path twice as slow as another gets a quarter of the traffic it does
+          std::vector<double> weights(num);
+          double total = 0;
+          for (size_t idx = 0; idx < num; ++idx)
+          {
+            weights[idx] = 1 / (costs[idx] * costs[idx]);
+            total += weights[idx];
+          }
+          double pick = total * (randint() >> 11) * 0x1p-53;
+          for (size_t idx = 0; idx < num; ++idx)
+          {
+            if (pick < weights[idx])
+              return idx;
+            pick -= weights[idx];
+          }
+          return num - 1;
+        }
+        case PathSelection::ePowerOfTwo:
+        {
+          const size_t first = randint() % num;
+          // any index but first, each as likely as the others
+          const size_t second = (first + 1 + randint() % (num - 1)) % num;
+          return costs[second] < costs[first] ? second : first;
+        }
+      }
+      return 0;
+    }
+  }  // namespace path
+}  // namespace llarp
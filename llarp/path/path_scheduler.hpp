@@ -0,0 +1,111 @@
+#pragma once
+
+#include <llarp/util/status.hpp>
+#include <llarp/util/time.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace llarp
+{
+  namespace path
+  {
+    /// how a path set picks among its established paths
+    enum class PathSelection
+    {
+      /// uniformly at random, ignoring how the paths perform
+      eRandom,
+      /// at random, weighted by the inverse square of each path's cost
+      eWeighted,
+      /// the cheaper of two paths drawn at random
+      ePowerOfTwo
+    };
+
+    /// parse a path selection from its config name
+    /// @throws std::invalid_argument if there is no such path selection
+    PathSelection
+    ParsePathSelection(std::string data);
+
+    std::string
+    ToString(PathSelection selection);
+
+    /// smoothed round trip time and loss of one path, fed by its latency probes
+    struct PathQuality
+    {
+      /// weight of the newest probe; probes are latency_interval apart so this reacts within a
+      /// couple of minutes
+      static constexpr double Alpha = 0.25;
+      /// highest loss a cost is scaled for, so a path losing everything is very expensive
+      /// rather than infinitely so
+      static constexpr double MaxLoss = 0.95;
+
+      /// a probe came back after this long
+      void
+      OnRoundTrip(llarp_time_t rtt);
+
+      /// a probe never came back
+      void
+      OnProbeLost();
+
+      /// smoothed round trip time in milliseconds
+      double
+      RoundTrip() const
+      {
+        return m_RoundTrip;
+      }
+
+      /// smoothed fraction of probes lost
+      double
+      Loss() const
+      {
+        return m_Loss;
+      }
+
+      /// whether a probe has come back yet
+      bool
+      Measured() const
+      {
+        return m_Measured;
+      }
+
+      /// expected time to get something across: the round trip time scaled up by how many
+      /// tries it takes with this loss.  only comparable between measured paths
+      double
+      Cost() const;
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      double m_RoundTrip = 0;
+      double m_Loss = 0;
+      bool m_Measured = false;
+    };
+
+    /// picks which path traffic goes over given what each one costs
+    struct PathScheduler
+    {
+      PathSelection selection = PathSelection::ePowerOfTwo;
+
+      /// index of the path to use out of paths with these costs, which must not be empty
+      size_t
+      Pick(const std::vector<double>& costs) const;
+    };
+
+    /// leave out of these candidates the paths with no round trip yet, unless that is all of
+    /// them.  every path is probed on its own as soon as it is built, so they are measured soon
+    /// enough; until then a path known to be fast beats one that may not work at all.  quality
+    /// gives a candidate's PathQuality.
+    template <typename Candidate_t, typename Quality_t>
+    void
+    DropUnmeasured(std::vector<Candidate_t>& candidates, Quality_t&& quality)
+    {
+      const auto unmeasured = [&quality](const auto& c) { return not quality(c).Measured(); };
+      if (std::all_of(candidates.begin(), candidates.end(), unmeasured))
+        return;
+      candidates.erase(
+          std::remove_if(candidates.begin(), candidates.end(), unmeasured), candidates.end());
+    }
+  }  // namespace path
+}  // namespace llarp
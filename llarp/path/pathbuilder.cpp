@@ -11,29 +11,34 @@
 #include <llarp/tooling/path_event.hpp>
 #include <llarp/link/link_manager.hpp>
 
+#include <atomic>
 #include <functional>
 
 namespace llarp
 {
   struct AsyncPathKeyExchangeContext : std::enable_shared_from_this<AsyncPathKeyExchangeContext>
   {
-    using WorkFunc_t = std::function<void(void)>;
-    using WorkerFunc_t = std::function<void(WorkFunc_t)>;
     using Path_t = path::Path_ptr;
     using PathSet_t = path::PathSet_ptr;
+    using Clock_t = path::KeyExchangeService::Clock_t;
     PathSet_t pathset = nullptr;
     Path_t path = nullptr;
     using Handler = std::function<void(std::shared_ptr<AsyncPathKeyExchangeContext>)>;
 
     Handler result;
-    size_t idx = 0;
     AbstractRouter* router = nullptr;
-    WorkerFunc_t work;
+    path::KeyExchangeService* keyExchange = nullptr;
     EventLoop_ptr loop;
     LR_CommitMessage LRCM;
+    /// hops whose keys are still being generated
+    std::atomic<size_t> pending{0};
+    std::atomic<bool> failed{false};
+    Clock_t::time_point started;
 
-    void
-    GenerateNextKey()
+    /// generate the keys and commit record of one hop.  a hop only needs its own keys and the
+    /// next hop's rc, which we already have, so every hop of a build is generated at once.
+    bool
+    GenerateKey(size_t idx)
     {
       // current hop
       auto& hop = path->hops[idx];
@@ -48,13 +53,13 @@ namespace llarp
       if (!crypto->dh_client(hop.shared, hop.rc.enckey, hop.commkey, hop.nonce))
       {
         LogError(pathset->Name(), " Failed to generate shared key for path build");
-        return;
+        return false;
       }
       // generate nonceXOR valueself->hop->pathKey
       crypto->shorthash(hop.nonceXOR, llarp_buffer_t(hop.shared));
-      ++idx;
 
-      bool isFarthestHop = idx == path->hops.size();
+      const size_t next = idx + 1;
+      bool isFarthestHop = next == path->hops.size();
 
       LR_CommitRecord record;
       if (isFarthestHop)
@@ -63,8 +68,8 @@ namespace llarp
       }
       else
       {
-        hop.upstream = path->hops[idx].rc.pubkey;
-        record.nextRC = std::make_unique<RouterContact>(path->hops[idx].rc);
+        hop.upstream = path->hops[next].rc.pubkey;
+        record.nextRC = std::make_unique<RouterContact>(path->hops[next].rc);
       }
       // build record
       record.lifetime = path::default_lifetime;
@@ -83,7 +88,7 @@ namespace llarp
         // failed to encode?
         LogError(pathset->Name(), " Failed to generate Commit Record");
         DumpBuffer(buf);
-        return;
+        return false;
       }
       // use ephemeral keypair for frame
       SecretKey framekey;
@@ -91,39 +96,55 @@ namespace llarp
       if (!frame.EncryptInPlace(framekey, hop.rc.enckey))
       {
         LogError(pathset->Name(), " Failed to encrypt LRCR");
-        return;
+        return false;
       }
+      return true;
+    }
 
-      if (isFarthestHop)
-      {
-        // farthest hop
-        // TODO: encrypt junk frames because our public keys are not eligator
-        loop->call([self = shared_from_this()] {
-          self->result(self);
-          self->result = nullptr;
-        });
-      }
-      else
-      {
-        // next hop
-        work([self = shared_from_this()] { self->GenerateNextKey(); });
-      }
+    /// one hop's keys are done; the last hop done hands the build back to the event loop
+    void
+    HopDone(bool ok)
+    {
+      if (not ok)
+        failed = true;
+      if (pending.fetch_sub(1) != 1)
+        return;
+      keyExchange->RecordBuild(Clock_t::now() - started);
+      if (failed)
+        return;
+      // TODO: encrypt junk frames because our public keys are not eligator
+      loop->call([self = shared_from_this()] {
+        self->result(self);
+        self->result = nullptr;
+      });
     }
 
     /// Generate all keys asynchronously and call handler when done
     void
-    AsyncGenerateKeys(Path_t p, EventLoop_ptr l, WorkerFunc_t worker, Handler func)
+    AsyncGenerateKeys(Path_t p, EventLoop_ptr l, path::KeyExchangeService& exchanges, Handler func)
     {
       path = p;
       loop = std::move(l);
       result = func;
-      work = worker;
+      keyExchange = &exchanges;
 
       for (size_t i = 0; i < path::max_len; ++i)
       {
         LRCM.frames[i].Randomize();
       }
-      work([self = shared_from_this()] { self->GenerateNextKey(); });
+      pending = path->hops.size();
+      started = Clock_t::now();
+      std::vector<path::KeyExchangeService::Job_t> hops;
+      for (size_t idx = 0; idx < path->hops.size(); ++idx)
+      {
+        hops.emplace_back([self = shared_from_this(), idx] {
+          const auto hopStarted = Clock_t::now();
+          const bool ok = self->GenerateKey(idx);
+          self->keyExchange->RecordBuildHop(Clock_t::now() - hopStarted);
+          self->HopDone(ok);
+        });
+      }
+      keyExchange->Queue(std::move(hops));
     }
   };
 
@@ -135,6 +156,7 @@ namespace llarp
 
     ctx->router->NotifyRouterEvent<tooling::PathAttemptEvent>(ctx->router->pubkey(), ctx->path);
 
+    ctx->path->buildTrace.KeysDone();
     ctx->router->pathContext().AddOwnPath(ctx->pathset, ctx->path);
     ctx->pathset->PathBuildStarted(ctx->path);
 
@@ -143,7 +165,9 @@ namespace llarp
       if (status != SendStatus::Success)
       {
         path->EnterState(path::ePathFailed, router->Now());
+        return;
       }
+      path->buildTrace.Sent();
     };
     if (ctx->router->SendToOrQueue(remote, ctx->LRCM, sentHandler))
     {
@@ -218,7 +242,8 @@ namespace llarp
       util::StatusObject obj{
           {"buildStats", m_BuildStats.ExtractStatus()},
           {"numHops", uint64_t{numHops}},
-          {"numPaths", uint64_t{numDesiredPaths}}};
+          {"numPaths", uint64_t{numDesiredPaths}},
+          {"pathSelection", ToString(m_Scheduler.selection)}};
       std::transform(
           m_Paths.begin(),
           m_Paths.end(),
@@ -325,8 +350,20 @@ namespace llarp
     void
     Builder::BuildOne(PathRole roles)
     {
+      const auto started = BuildTrace::Clock_t::now();
       if (const auto maybe = GetHopsForBuild())
+      {
+        RecordHopSelection(started);
         Build(*maybe, roles);
+      }
+    }
+
+    void
+    Builder::RecordHopSelection(BuildTrace::Clock_t::time_point started)
+    {
+      m_router->pathContext().BuildTimingsFor(GetSelf())->select.Record(
+          std::chrono::duration_cast<util::LatencyHistogram::Duration_t>(
+              BuildTrace::Clock_t::now() - started));
     }
 
     bool Builder::UrgentBuild(llarp_time_t) const
@@ -403,8 +440,10 @@ namespace llarp
     bool
     Builder::BuildOneAlignedTo(const RouterID remote)
     {
+      const auto started = BuildTrace::Clock_t::now();
       if (const auto maybe = GetHopsAlignedToForBuild(remote); maybe.has_value())
       {
+        RecordHopSelection(started);
         LogInfo(Name(), " building path to ", remote);
         Build(*maybe);
         return true;
@@ -441,10 +480,11 @@ namespace llarp
       LogInfo(Name(), " build ", path->ShortName(), ": ", path->HopsString());
 
       path->SetBuildResultHook([self](Path_ptr p) { self->HandlePathBuilt(p); });
+      path->buildTrace.Start(m_router->pathContext().BuildTimingsFor(self));
       ctx->AsyncGenerateKeys(
           path,
           m_router->loop(),
-          [r = m_router](auto func) { r->QueueWork(std::move(func)); },
+          m_router->pathContext().KeyExchange(),
           &PathBuilderKeysGenerated);
     }
 
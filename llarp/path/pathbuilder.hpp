@@ -1,5 +1,6 @@
 #pragma once
 
+#include "build_timings.hpp"
 #include "pathset.hpp"
 #include <llarp/util/status.hpp>
 #include <llarp/util/decaying_hashset.hpp>
@@ -56,6 +57,10 @@ namespace llarp
       void
       DoPathBuildBackoff();
 
+      /// note how long picking the hops of a build took
+      void
+      RecordHopSelection(BuildTrace::Clock_t::time_point started);
+
      public:
       AbstractRouter* const m_router;
       SecretKey enckey;
@@ -118,10 +118,14 @@ namespace llarp
         RouterID id, std::unordered_set<RouterID> excluding, PathRole roles) const
     {
       Lock_t l{m_PathsMutex};
+      // the closest two
       Path_ptr path = nullptr;
+      Path_ptr runnerUp = nullptr;
       AlignedBuffer<32> dist;
+      AlignedBuffer<32> runnerUpDist;
       AlignedBuffer<32> to = id;
       dist.Fill(0xff);
+      runnerUpDist.Fill(0xff);
       for (const auto& item : m_Paths)
       {
         if (!item.second->IsReady())
@@ -133,11 +137,21 @@ namespace llarp
         AlignedBuffer<32> localDist = item.second->Endpoint() ^ to;
         if (localDist < dist)
         {
+          runnerUpDist = dist;
+          runnerUp = path;
           dist = localDist;
           path = item.second;
         }
+        else if (localDist < runnerUpDist)
+        {
+          runnerUpDist = localDist;
+          runnerUp = item.second;
+        }
       }
-      return path;
+      // picking at random is how it used to be, which always went with the closest
+      if (runnerUp == nullptr or m_Scheduler.selection == PathSelection::eRandom)
+        return path;
+      return SchedulePath({path, runnerUp});
     }
 
     Path_ptr
@@ -211,14 +225,7 @@ namespace llarp
         }
         ++itr;
       }
-      if (chosen.empty())
-        return nullptr;
-      size_t idx = 0;
-      if (chosen.size() >= 2)
-      {
-        idx = rand() % chosen.size();
-      }
-      return chosen[idx];
+      return SchedulePath(chosen);
     }
 
     Path_ptr
@@ -401,6 +408,12 @@ namespace llarp
       return found;
     }
 
+    static const PathQuality&
+    QualityOf(const Path_ptr& path)
+    {
+      return path->quality;
+    }
+
     Path_ptr
     PathSet::PickRandomEstablishedPath(PathRole roles) const
     {
@@ -413,13 +426,8 @@ namespace llarp
           established.push_back(itr->second);
         ++itr;
       }
-      auto sz = established.size();
-      if (sz)
-      {
-        return established[randint() % sz];
-      }
-
-      return nullptr;
+      DropUnmeasured(established, QualityOf);
+      return SchedulePath(established);
     }
 
     Path_ptr
@@ -434,19 +442,33 @@ namespace llarp
           established.push_back(itr->second);
         ++itr;
       }
+      DropUnmeasured(established, QualityOf);
       Path_ptr chosen = nullptr;
-      llarp_time_t minLatency = 30s;
+      double minCost = 0;
       for (const auto& path : established)
       {
-        if (path->intro.latency < minLatency and path->intro.latency != 0s)
+        const auto cost = path->quality.Cost();
+        if (chosen == nullptr or cost < minCost)
         {
-          minLatency = path->intro.latency;
+          minCost = cost;
           chosen = path;
         }
       }
       return chosen;
     }
 
+    Path_ptr
+    PathSet::SchedulePath(const std::vector<Path_ptr>& candidates) const
+    {
+      if (candidates.empty())
+        return nullptr;
+      std::vector<double> costs;
+      costs.reserve(candidates.size());
+      for (const auto& path : candidates)
+        costs.push_back(path->quality.Cost());
+      return candidates[m_Scheduler.Pick(costs)];
+    }
+
     void
     PathSet::UpstreamFlush(AbstractRouter* r)
     {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "path_scheduler.hpp"
 #include "path_types.hpp"
 #include "service/protocol_type.hpp"
 #include <llarp/router_id.hpp>
@@ -239,6 +240,21 @@ namespace llarp
         return nullptr;
       }
 
+      /// set how traffic is spread over our established paths
+      void
+      SetPathSelection(PathSelection selection)
+      {
+        m_Scheduler.selection = selection;
+      }
+
+      PathSelection
+      GetPathSelection() const
+      {
+        return m_Scheduler.selection;
+      }
+
+      /// get an established path whose endpoint is close to router.  unless paths are picked
+      /// at random this is the better of the two closest ones.
       Path_ptr
       GetEstablishedPathClosestTo(
           RouterID router,
@@ -248,6 +264,7 @@ namespace llarp
       Path_ptr
       PickEstablishedPath(PathRole roles = ePathRoleAny) const;
 
+      /// pick an established path the way our path selection says to
       Path_ptr
       PickRandomEstablishedPath(PathRole roles = ePathRoleAny) const;
 
@@ -311,6 +328,7 @@ namespace llarp
 
      protected:
       BuildStats m_BuildStats;
+      PathScheduler m_Scheduler;
 
       void
       TickPaths(AbstractRouter* r);
@@ -322,6 +340,10 @@ namespace llarp
       PathMap_t m_Paths;
 
      private:
+      /// pick one of these paths with our scheduler, nullptr if there are none
+      Path_ptr
+      SchedulePath(const std::vector<Path_ptr>& candidates) const;
+
       std::unordered_map<RouterID, std::weak_ptr<path::Path>> m_PathCache;
     };
 
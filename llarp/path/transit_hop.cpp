@@ -21,6 +21,57 @@ namespace llarp
 {
   namespace path
   {
+    namespace
+    {
+      /// apply (or remove) our onion layer to a whole traffic queue with one batch cipher call
+      void
+      CipherTraffic(IHopHandler::TrafficQueue_t& msgs, const SharedSecret& key)
+      {
+        std::vector<CryptoBatchItem> items;
+        items.reserve(msgs.size());
+        for (auto& [data, nonce] : msgs)
+          items.push_back(CryptoBatchItem{data.data(), data.size(), nonce.data()});
+        CryptoManager::instance()->xchacha20_batch(items.data(), items.size(), key);
+      }
+
+      /// lay a ciphered batch out as messages for the next hop and hand them to the outbound
+      /// queue from the forwarding shard, with one pump wakeup for the lot
+      template <typename Relay_t>
+      void
+      ForwardTraffic(
+          IHopHandler::TrafficQueue_t& msgs,
+          const RouterID& to,
+          const PathID_t& pathid,
+          const TunnelNonce& nonceXOR,
+          AbstractRouter* r)
+      {
+        uint64_t frames = 0, bytes = 0;
+        for (auto& [data, nonce] : msgs)
+        {
+          Relay_t msg;
+          msg.pathid = pathid;
+          msg.Y = nonce ^ nonceXOR;
+          msg.X = std::move(data);
+          const auto sz = msg.X.size();
+          llarp::LogDebug("relay ", sz, " bytes to ", to, " on ", pathid);
+          auto encoded = msg.Encode();
+          if (encoded
+              and r->outboundMessageHandler().QueueEncoded(
+                  to, pathid, msg.Priority(), std::move(*encoded)))
+          {
+            RelayStats::CountRelayed(sz);
+            frames++;
+            bytes += sz;
+          }
+        }
+        auto& stats = r->pathContext().ShardStats(pathid);
+        stats.frames.fetch_add(frames, std::memory_order_relaxed);
+        stats.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        stats.dropped.fetch_add(msgs.size() - frames, std::memory_order_relaxed);
+        r->TriggerPump();
+      }
+    }  // namespace
+
     std::ostream&
     TransitHopInfo::print(std::ostream& stream, int level, int spaces) const
     {
@@ -33,11 +84,9 @@ namespace llarp
       return stream;
     }
 
-    TransitHop::TransitHop()
-        : m_UpstreamGather(transit_hop_queue_size), m_DownstreamGather(transit_hop_queue_size)
+    TransitHop::TransitHop() : m_UpstreamGather(transit_hop_queue_size)
     {
       m_UpstreamGather.enable();
-      m_DownstreamGather.enable();
       m_UpstreamWorkCounter = 0;
       m_DownstreamWorkCounter = 0;
     }
@@ -100,69 +149,64 @@ namespace llarp
         CryptoManager::instance()->randbytes(buf.cur, dlt);
         buf.sz += dlt;
       }
-      buf.cur = buf.base;
-      return HandleDownstream(buf, N, r);
+      return HandleDownstream(RelayFrame{buf.base, buf.sz}, N, r);
     }
 
     void
     TransitHop::DownstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
     {
-      auto flushIt = [self = shared_from_this(), r]() {
-        std::vector<RelayDownstreamMessage> msgs;
-        while (auto maybe = self->m_DownstreamGather.tryPopFront())
-        {
-          msgs.push_back(*maybe);
-        }
-        self->HandleAllDownstream(std::move(msgs), r);
-      };
-      for (auto& ev : msgs)
-      {
-        RelayDownstreamMessage msg;
-        const llarp_buffer_t buf(ev.first);
-        msg.pathid = info.rxID;
-        msg.Y = ev.second ^ nonceXOR;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
-        msg.X = buf;
-        llarp::LogDebug(
-            "relay ",
-            msg.X.size(),
-            " bytes downstream from ",
-            info.upstream,
-            " to ",
-            info.downstream);
-        if (m_DownstreamGather.full())
-        {
-          r->loop()->call(flushIt);
-        }
-        if (m_DownstreamGather.enabled())
-          m_DownstreamGather.pushBack(msg);
-      }
-      r->loop()->call(flushIt);
+      if (m_Stopped)
+        return;
+      CipherTraffic(msgs, pathKey);
+      ForwardTraffic<RelayDownstreamMessage>(msgs, info.downstream, info.rxID, nonceXOR, r);
+      util::Lock lock{m_SpareMutex};
+      RecycleBatch(std::move(msgs), m_DownstreamSpare);
     }
 
     void
     TransitHop::UpstreamWork(TrafficQueue_t msgs, AbstractRouter* r)
     {
+      if (m_Stopped)
+        return;
+      CipherTraffic(msgs, pathKey);
+      if (not IsEndpoint(r->pubkey()))
+      {
+        ForwardTraffic<RelayUpstreamMessage>(msgs, info.upstream, info.txID, nonceXOR, r);
+        util::Lock lock{m_SpareMutex};
+        RecycleBatch(std::move(msgs), m_UpstreamSpare);
+        return;
+      }
+      // we are the endpoint: routing messages are handled on the event loop
+      size_t gathered = 0;
       for (auto& ev : msgs)
       {
-        const llarp_buffer_t buf(ev.first);
         RelayUpstreamMessage msg;
-        CryptoManager::instance()->xchacha20(buf, pathKey, ev.second);
         msg.pathid = info.txID;
         msg.Y = ev.second ^ nonceXOR;
-        msg.X = buf;
-        if (m_UpstreamGather.tryPushBack(msg) != thread::QueueReturn::Success)
+        msg.X = std::move(ev.first);
+        if (m_UpstreamGather.tryPushBack(std::move(msg)) != thread::QueueReturn::Success)
           break;
+        gathered++;
+      }
+      if (gathered < msgs.size())
+      {
+        r->pathContext().ShardStats(info.txID).dropped.fetch_add(
+            msgs.size() - gathered, std::memory_order_relaxed);
+        LogDebug("upstream queue on ", info, " is full, dropped ", msgs.size() - gathered);
       }
 
-      // Flush it:
-      r->loop()->call([self = shared_from_this(), r] {
+      // Flush it, and hand the emptied batch back for the next flush to queue into:
+      r->loop()->call([self = shared_from_this(),
+                       batch = std::make_shared<TrafficQueue_t>(std::move(msgs)),
+                       r] {
         std::vector<RelayUpstreamMessage> msgs;
         while (auto maybe = self->m_UpstreamGather.tryPopFront())
         {
-          msgs.push_back(*maybe);
+          msgs.push_back(std::move(*maybe));
         }
         self->HandleAllUpstream(std::move(msgs), r);
+        util::Lock lock{self->m_SpareMutex};
+        RecycleBatch(std::move(*batch), self->m_UpstreamSpare);
       });
     }
 
@@ -198,6 +242,7 @@ namespace llarp
               info.downstream,
               " to ",
               info.upstream);
+          RelayStats::CountRelayed(msg.X.size());
           r->SendToOrQueue(info.upstream, msg);
         }
       }
@@ -216,6 +261,7 @@ namespace llarp
             info.upstream,
             " to ",
             info.downstream);
+        RelayStats::CountRelayed(msg.X.size());
         r->SendToOrQueue(info.downstream, msg);
       }
       r->TriggerPump();
@@ -226,9 +272,20 @@ namespace llarp
     {
       if (not m_UpstreamQueue.empty())
       {
-        r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_UpstreamQueue, {}),
-                      r]() mutable { self->UpstreamWork(std::move(data), r); });
+        TrafficQueue_t batch;
+        {
+          util::Lock lock{m_SpareMutex};
+          batch = TakeBatch(m_UpstreamQueue, m_UpstreamSpare);
+        }
+        // relay frames are move only but jobs must be copyable, so the queue rides along in a
+        // shared_ptr
+        const auto frames = batch.size();
+        r->pathContext().QueueTransitWork(
+            info.txID,
+            frames,
+            [self = shared_from_this(),
+             data = std::make_shared<TrafficQueue_t>(std::move(batch)),
+             r] { self->UpstreamWork(std::move(*data), r); });
       }
     }
 
@@ -237,9 +294,18 @@ namespace llarp
     {
       if (not m_DownstreamQueue.empty())
       {
-        r->QueueWork([self = shared_from_this(),
-                      data = std::exchange(m_DownstreamQueue, {}),
-                      r]() mutable { self->DownstreamWork(std::move(data), r); });
+        TrafficQueue_t batch;
+        {
+          util::Lock lock{m_SpareMutex};
+          batch = TakeBatch(m_DownstreamQueue, m_DownstreamSpare);
+        }
+        const auto frames = batch.size();
+        r->pathContext().QueueTransitWork(
+            info.txID,
+            frames,
+            [self = shared_from_this(),
+             data = std::make_shared<TrafficQueue_t>(std::move(batch)),
+             r] { self->DownstreamWork(std::move(*data), r); });
       }
     }
 
@@ -446,7 +512,7 @@ namespace llarp
     TransitHop::Stop()
     {
       m_UpstreamGather.disable();
-      m_DownstreamGather.disable();
+      m_Stopped = true;
     }
 
     void
@@ -458,7 +524,10 @@ namespace llarp
     void
     TransitHop::QueueDestroySelf(AbstractRouter* r)
     {
-      r->loop()->call([self = shared_from_this()] { self->SetSelfDestruct(); });
+      r->loop()->call([self = shared_from_this(), r] {
+        self->SetSelfDestruct();
+        r->pathContext().ExpireTransitHopEarly(*self);
+      });
     }
   }  // namespace path
 }  // namespace llarp
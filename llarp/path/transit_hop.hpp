@@ -2,11 +2,13 @@
 
 #include <llarp/constants/path.hpp>
 #include "ihophandler.hpp"
+#include "path_index.hpp"
 #include "path_types.hpp"
 #include <llarp/routing/handler.hpp>
 #include <llarp/router_id.hpp>
 #include <llarp/util/compare_ptr.hpp>
 #include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/threading.hpp>
 
 namespace llarp
 {
@@ -84,6 +86,9 @@ namespace llarp
 
       bool destroy = false;
 
+      /// our place in PathContext's transit expiry list
+      ExpiryHook<TransitHop> expiryHook;
+
       bool
       operator<(const TransitHop& other) const
       {
@@ -207,7 +212,9 @@ namespace llarp
 
       std::set<std::shared_ptr<TransitHop>, ComparePtr<std::shared_ptr<TransitHop>>> m_FlushOthers;
       thread::Queue<RelayUpstreamMessage> m_UpstreamGather;
-      thread::Queue<RelayDownstreamMessage> m_DownstreamGather;
+      /// our forwarding shard hands batches back as spares while the event loop queues into them
+      util::Mutex m_SpareMutex;
+      std::atomic<bool> m_Stopped{false};
       std::atomic<uint32_t> m_UpstreamWorkCounter;
       std::atomic<uint32_t> m_DownstreamWorkCounter;
     };
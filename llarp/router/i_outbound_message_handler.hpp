@@ -1,9 +1,11 @@
 #pragma once
 
 #include <llarp/util/status.hpp>
+#include <llarp/util/types.hpp>
 
 #include <cstdint>
 #include <functional>
+#include <vector>
 
 namespace llarp
 {
@@ -34,6 +36,15 @@ namespace llarp
     virtual bool
     QueueMessage(const RouterID& remote, const ILinkMessage& msg, SendStatusHandler callback) = 0;
 
+    /// queue an already encoded relay message from any thread, with no status callback; waits
+    /// for a session to the remote like QueueMessage does.  returns false if it was dropped
+    virtual bool
+    QueueEncoded(
+        const RouterID& remote,
+        const PathID_t& pathid,
+        uint16_t priority,
+        std::vector<byte_t> msg) = 0;
+
     virtual void
     Pump() = 0;
 
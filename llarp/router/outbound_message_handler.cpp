@@ -13,6 +13,15 @@ namespace llarp
 {
   const PathID_t OutboundMessageHandler::zeroID;
 
+  OutboundMessageHandler::MessageQueueEntry
+  OutboundMessageHandler::PopTop(MessageQueue& queue)
+  {
+    // moving the encoded message out leaves the entry's priority, and so the heap, as it was
+    auto entry = std::move(const_cast<MessageQueueEntry&>(queue.top()));
+    queue.pop();
+    return entry;
+  }
+
   using namespace std::chrono_literals;
 
   OutboundMessageHandler::OutboundMessageHandler(size_t maxQueueSize)
@@ -36,17 +45,12 @@ namespace llarp
     ent.pathid = msg.pathid;
     ent.priority = msg.Priority();
 
-    std::array<byte_t, MAX_LINK_MSG_SIZE> linkmsg_buffer;
-    llarp_buffer_t buf{linkmsg_buffer};
-
-    if (!EncodeBuffer(msg, buf))
+    auto encoded = msg.Encode();
+    if (not encoded)
     {
       return false;
     }
-
-    ent.message.resize(buf.sz);
-
-    std::copy_n(buf.base, buf.sz, ent.message.data());
+    ent.message = std::move(*encoded);
 
     // if we have a session to the destination, queue the message and return
     if (_router->linkManager().HasSessionTo(remote))
@@ -55,29 +59,24 @@ namespace llarp
       return true;
     }
 
-    // if we don't have a session to the destination, queue the message onto
-    // a special pending session queue for that destination, and then create
-    // that pending session if there is not already a session establish attempt
-    // in progress.
-    bool shouldCreateSession = false;
-    {
-      util::Lock l{_mutex};
-
-      // create queue for <remote> if it doesn't exist, and get iterator
-      auto [queue_itr, is_new] = pendingSessionMessageQueues.emplace(remote, MessageQueue());
-      queue_itr->second.push(std::move(ent));
-
-      shouldCreateSession = is_new;
-    }
-
-    if (shouldCreateSession)
-    {
-      QueueSessionCreation(remote);
-    }
+    QueueForPendingSession(std::move(ent));
 
     return true;
   }
 
+  bool
+  OutboundMessageHandler::QueueEncoded(
+      const RouterID& remote, const PathID_t& pathid, uint16_t priority, std::vector<byte_t> msg)
+  {
+    MessageQueueEntry ent;
+    ent.router = remote;
+    ent.pathid = pathid;
+    ent.priority = priority;
+    ent.message = std::move(msg);
+    ent.haveSession = false;
+    return outboundQueue.tryPushBack(std::move(ent)) == llarp::thread::QueueReturn::Success;
+  }
+
   void
   OutboundMessageHandler::Pump()
   {
@@ -175,30 +174,39 @@ namespace llarp
     _router->linkManager().GetSessionMaker()->CreateSessionTo(remote, fn);
   }
 
-  bool
-  OutboundMessageHandler::EncodeBuffer(const ILinkMessage& msg, llarp_buffer_t& buf)
+  void
+  OutboundMessageHandler::QueueForPendingSession(MessageQueueEntry ent)
   {
-    if (!msg.BEncode(&buf))
+    const auto remote = ent.router;
+    // if we don't have a session to the destination, queue the message onto
+    // a special pending session queue for that destination, and then create
+    // that pending session if there is not already a session establish attempt
+    // in progress.
+    bool shouldCreateSession = false;
     {
-      LogWarn("failed to encode outbound message, buffer size left: ", buf.size_left());
-      return false;
+      util::Lock l{_mutex};
+
+      // create queue for <remote> if it doesn't exist, and get iterator
+      auto [queue_itr, is_new] = pendingSessionMessageQueues.emplace(remote, MessageQueue());
+      queue_itr->second.push(std::move(ent));
+
+      shouldCreateSession = is_new;
     }
-    // set size of message
-    buf.sz = buf.cur - buf.base;
-    buf.cur = buf.base;
 
-    return true;
+    if (shouldCreateSession)
+    {
+      QueueSessionCreation(remote);
+    }
   }
 
   bool
-  OutboundMessageHandler::Send(const MessageQueueEntry& ent)
+  OutboundMessageHandler::Send(MessageQueueEntry ent)
   {
-    const llarp_buffer_t buf{ent.message};
     m_queueStats.sent++;
     SendStatusHandler callback = ent.inform;
     return _router->linkManager().SendTo(
         ent.router,
-        buf,
+        std::move(ent.message),
         [this, callback](ILinkSession::DeliveryStatus status) {
           if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
             DoCallback(callback, SendStatus::Success);
@@ -211,11 +219,11 @@ namespace llarp
   }
 
   bool
-  OutboundMessageHandler::SendIfSession(const MessageQueueEntry& ent)
+  OutboundMessageHandler::SendIfSession(MessageQueueEntry ent)
   {
     if (_router->linkManager().HasSessionTo(ent.router))
     {
-      return Send(ent);
+      return Send(std::move(ent));
     }
     return false;
   }
@@ -254,6 +262,17 @@ namespace llarp
         continue;
       }
 
+      // relayed from a transit shard, which could not look the session up itself
+      if (not entry.haveSession)
+      {
+        if (not _router->linkManager().HasSessionTo(entry.router))
+        {
+          QueueForPendingSession(std::move(entry));
+          continue;
+        }
+        entry.haveSession = true;
+      }
+
       auto [queue_itr, is_new] = outboundMessageQueues.emplace(entry.pathid, MessageQueue());
 
       if (is_new && !entry.pathid.IsZero())
@@ -284,9 +303,7 @@ namespace llarp
     auto& routing_mq = outboundMessageQueues[zeroID];
     while (not routing_mq.empty())
     {
-      const MessageQueueEntry& entry = routing_mq.top();
-      Send(entry);
-      routing_mq.pop();
+      Send(PopTop(routing_mq));
     }
 
     size_t num_queues = roundRobinOrder.size();
@@ -326,10 +343,7 @@ namespace llarp
       auto& message_queue = outboundMessageQueues[pathid];
       if (message_queue.size() > 0)
       {
-        const MessageQueueEntry& entry = message_queue.top();
-
-        Send(entry);
-        message_queue.pop();
+        Send(PopTop(message_queue));
 
         consecutive_empty = 0;
         consecutive_empty++;
@@ -373,17 +387,16 @@ namespace llarp
 
     while (!movedMessages.empty())
     {
-      const MessageQueueEntry& entry = movedMessages.top();
+      auto entry = PopTop(movedMessages);
 
       if (status == SendStatus::Success)
       {
-        Send(entry);
+        Send(std::move(entry));
       }
       else
       {
         DoCallback(entry.inform, status);
       }
-      movedMessages.pop();
     }
   }
 
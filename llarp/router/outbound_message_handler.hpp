@@ -47,6 +47,22 @@ namespace llarp
     QueueMessage(const RouterID& remote, const ILinkMessage& msg, SendStatusHandler callback)
         override EXCLUDES(_mutex);
 
+    /* Called by transit forwarding shards to hand a relayed message straight to the shared
+     * outbound message queue.  The session lookup QueueMessage does up front is not safe off the
+     * event loop, so it happens when Pump() takes the message off the shared queue: with no
+     * session to the remote yet the message waits on that remote's pending session queue, just
+     * like one from QueueMessage would.
+     *
+     * Safe to call from any thread; the queue stats are left to the event loop thread, so the
+     * caller counts what it drops.
+     */
+    bool
+    QueueEncoded(
+        const RouterID& remote,
+        const PathID_t& pathid,
+        uint16_t priority,
+        std::vector<byte_t> msg) override;
+
     /* Called when pumping output queues, typically scheduled via a call to Router::TriggerPump().
      *
      * Processes messages on the shared message queue into their paths' respective
@@ -84,6 +100,8 @@ namespace llarp
       SendStatusHandler inform;
       PathID_t pathid;
       RouterID router;
+      /// false until we know there is a session to router, for messages from QueueEncoded
+      bool haveSession = true;
 
       bool
       operator>(const MessageQueueEntry& other) const
@@ -122,22 +140,29 @@ namespace llarp
     void
     QueueSessionCreation(const RouterID& remote);
 
-    bool
-    EncodeBuffer(const ILinkMessage& msg, llarp_buffer_t& buf);
+    /* parks a message on its router's pending session queue, starting a session to the
+     * router if this is the first message waiting on one
+     */
+    void
+    QueueForPendingSession(MessageQueueEntry ent) EXCLUDES(_mutex);
+
+    /* takes the highest priority entry off a queue, moving rather than copying its message */
+    static MessageQueueEntry
+    PopTop(MessageQueue& queue);
 
     /* sends the message along to the link layer, and hopefully out to the network
      *
      * returns the result of the call to LinkManager::SendTo()
      */
     bool
-    Send(const MessageQueueEntry& ent);
+    Send(MessageQueueEntry ent);
 
     /* Sends the message along to the link layer if we have a session to the remote
      *
      * returns the result of the Send() call, or false if no session.
      */
     bool
-    SendIfSession(const MessageQueueEntry& ent);
+    SendIfSession(MessageQueueEntry ent);
 
     /* queues a message to the shared outbound message queue.
      *
@@ -12,6 +12,7 @@
 #include <llarp/iwp/iwp.hpp>
 #include <llarp/link/server.hpp>
 #include <llarp/messages/link_message.hpp>
+#include <llarp/messages/relay.hpp>
 #include <llarp/net/net.hpp>
 #include <stdexcept>
 #include <llarp/util/buffer.hpp>
@@ -105,7 +106,11 @@ namespace llarp
         {"services", _hiddenServiceContext.ExtractStatus()},
         {"exit", _exitContext.ExtractStatus()},
         {"links", _linkManager.ExtractStatus()},
-        {"outboundMessages", _outboundMessageHandler.ExtractStatus()}};
+        {"linkCrypto", m_LinkCrypto ? m_LinkCrypto->ExtractStatus() : util::StatusObject{}},
+        {"outboundMessages", _outboundMessageHandler.ExtractStatus()},
+        {"relay", RelayStats::ExtractStatus()},
+        {"transit", paths.ExtractStatus()},
+        {"keyExchange", paths.KeyExchange().ExtractStatus()}};
   }
 
   util::StatusObject
@@ -397,14 +402,39 @@ namespace llarp
       throw std::runtime_error("Failed to start rpc server");
 
     if (conf.router.m_workerThreads > 0)
+    {
       m_lmq->set_general_threads(conf.router.m_workerThreads);
+      paths.KeyExchange().SetParallelism(conf.router.m_workerThreads);
+    }
 
     m_lmq->start();
 
+    {
+      size_t numShards = conf.router.m_linkCryptoThreads;
+      if (numShards == 0)
+        numShards = std::max(std::thread::hardware_concurrency(), 1u);
+      m_LinkCrypto = std::make_unique<thread::ShardedWorkerPool>(
+          numShards,
+          conf.router.m_JobQueueSize,
+          conf.router.m_pinLinkCryptoThreads,
+          "llarp-link");
+      m_LinkCrypto->Start();
+      LogInfo("started ", numShards, " link crypto threads");
+    }
+
     _nodedb = std::move(nodedb);
 
     m_isServiceNode = conf.router.m_isRelay;
 
+    if (m_isServiceNode)
+    {
+      size_t numShards = conf.router.m_transitThreads;
+      if (numShards == 0)
+        numShards = std::max(std::thread::hardware_concurrency(), 1u);
+      paths.StartTransitShards(numShards, conf.router.m_JobQueueSize);
+      LogInfo("started ", numShards, " transit forwarding threads");
+    }
+
     if (whitelistRouters)
     {
       m_lokidRpcClient->ConnectAsync(lokidRPCAddr);
@@ -752,7 +782,7 @@ namespace llarp
           util::memFn(&Router::ConnectionTimedOut, this),
           util::memFn(&AbstractRouter::SessionClosed, this),
           util::memFn(&AbstractRouter::TriggerPump, this),
-          util::memFn(&AbstractRouter::QueueWork, this));
+          util::memFn(&Router::QueueLinkCryptoWork, this));
 
       const std::string& key = serverConfig.m_interface;
       int af = serverConfig.addressFamily;
@@ -1427,6 +1457,9 @@ namespace llarp
   Router::AfterStopLinks()
   {
     Close();
+    if (m_LinkCrypto)
+      m_LinkCrypto->Stop();
+    paths.StopTransitShards();
     m_lmq.reset();
   }
 
@@ -1553,6 +1586,20 @@ namespace llarp
     m_lmq->job(std::move(func));
   }
 
+  void
+  Router::QueueLinkCryptoWork(uint64_t affinity, std::function<void(void)> func)
+  {
+    if (not m_LinkCrypto)
+    {
+      // no crypto threads (yet or any more), do it on the caller
+      func();
+      return;
+    }
+    // a full shard means the workers cannot keep up; doing the batch here rather than dropping
+    // it slows the caller down to their pace, and it shows in the shard's jobsRunInline
+    m_LinkCrypto->QueueOrRunJob(affinity, std::move(func));
+  }
+
   void
   Router::QueueDiskIO(std::function<void(void)> func)
   {
@@ -1607,7 +1654,7 @@ namespace llarp
         util::memFn(&Router::ConnectionTimedOut, this),
         util::memFn(&AbstractRouter::SessionClosed, this),
         util::memFn(&AbstractRouter::TriggerPump, this),
-        util::memFn(&AbstractRouter::QueueWork, this));
+        util::memFn(&Router::QueueLinkCryptoWork, this));
 
     if (!link)
       throw std::runtime_error("NewOutboundLink() failed to provide a link");
@@ -34,6 +34,7 @@
 #include <llarp/util/mem.hpp>
 #include <llarp/util/status.hpp>
 #include <llarp/util/str.hpp>
+#include <llarp/util/thread/sharded_worker_pool.hpp>
 #include <llarp/util/time.hpp>
 
 #include <functional>
@@ -193,6 +194,11 @@ namespace llarp
     void
     QueueWork(std::function<void(void)> func) override;
 
+    /// queue link layer crypto on the dedicated crypto shards; work with the same affinity key
+    /// runs in order on one thread.  runs it right away when the shards are not running.
+    void
+    QueueLinkCryptoWork(uint64_t affinity, std::function<void(void)> func);
+
     void
     QueueDiskIO(std::function<void(void)> func) override;
 
@@ -220,6 +226,8 @@ namespace llarp
     std::shared_ptr<NodeDB> _nodedb;
     llarp_time_t _startedAt;
     const oxenmq::TaggedThreadID m_DiskThread;
+    /// dedicated threads for link layer encrypt/decrypt, sharded by session
+    std::unique_ptr<thread::ShardedWorkerPool> m_LinkCrypto;
 
     llarp_time_t
     Uptime() const override;
@@ -11,6 +11,7 @@
 #include <llarp/service/auth.hpp>
 #include <llarp/service/name.hpp>
 #include <llarp/router/abstractrouter.hpp>
+#include <llarp/path/path_context.hpp>
 #include <llarp/dns/dns.hpp>
 
 namespace llarp::rpc
@@ -141,6 +142,13 @@ namespace llarp::rpc
                 defer.reply(CreateJSONResponse(r->ExtractSummaryStatus()));
               });
             })
+        .add_request_command(
+            "path_stats",
+            [&](oxenmq::Message& msg) {
+              m_Router->loop()->call([defer = msg.send_later(), r = m_Router]() {
+                defer.reply(CreateJSONResponse(r->pathContext().ExtractBuildStats()));
+              });
+            })
         .add_request_command(
             "quic_connect",
             [&](oxenmq::Message& msg) {
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "convotag.hpp"
+#include "session.hpp"
+
+#include <cstdint>
+#include <memory>
+
+namespace llarp
+{
+  // clang-format off
+  namespace exit { struct BaseSession; }
+  namespace path { struct Path; }
+  // clang-format on
+
+  namespace service
+  {
+    struct OutboundContext;
+
+    /// what Endpoint::SendToOrQueue resolves a remote to when it can send to it right away, kept
+    /// by callers that send many packets the same way so they can skip looking it up again
+    struct ConvoRoute
+    {
+      ConvoTag tag;
+      /// the endpoint's route generation when resolved, the route is stale once it moves on
+      uint64_t generation = 0;
+      /// the outbound session we send on, if the convo is ours
+      std::shared_ptr<OutboundContext> outbound;
+      /// the session we send on, if the remote is a snode
+      std::shared_ptr<exit::BaseSession> snode;
+      /// for inbound convos: our path to the remote's reply intro and the convo's route
+      /// generation when resolved.  the reply intro and session key are read off the convo
+      /// when sending, so only a move to another path makes the route stale.
+      std::shared_ptr<path::Path> path;
+      uint64_t convoGeneration = 0;
+
+      /// true if nothing the route was resolved from has moved on: the endpoint's generation,
+      /// and for an inbound convo the convo it goes out on
+      bool
+      Current(uint64_t endpointGeneration, const Session* convo) const
+      {
+        if (generation != endpointGeneration)
+          return false;
+        if (outbound or snode)
+          return true;
+        return convo and convo->routeGeneration == convoGeneration;
+      }
+    };
+  }  // namespace service
+}  // namespace llarp
@@ -71,6 +71,11 @@ namespace llarp
       if (conf.m_Hops.has_value())
         numHops = *conf.m_Hops;
 
+      if (conf.m_PathSelection.has_value())
+        SetPathSelection(*conf.m_PathSelection);
+
+      m_MultipathLanes = conf.m_MultipathLanes;
+
       conf.m_ExitMap.ForEachEntry(
           [&](const IPRange& range, const service::Address& addr) { MapExitRange(range, addr); });
 
@@ -293,6 +298,9 @@ namespace llarp
       m_IntrosetLookupFilter.Decay(now);
       // expire name cache
       m_state->nameCache.Decay(now);
+      // what convo routes go through may expire below
+      const auto sessionCounts = std::make_tuple(
+          m_state->m_SNodeSessions.size(), m_state->m_RemoteSessions.size(), Sessions().size());
       // expire snode sessions
       EndpointUtil::ExpireSNodeSessions(now, m_state->m_SNodeSessions);
       // expire pending tx
@@ -307,6 +315,12 @@ namespace llarp
           now, m_state->m_RemoteSessions, m_state->m_DeadSessions, Sessions());
       // expire convotags
       EndpointUtil::ExpireConvoSessions(now, Sessions());
+      if (sessionCounts
+          != std::make_tuple(
+              m_state->m_SNodeSessions.size(),
+              m_state->m_RemoteSessions.size(),
+              Sessions().size()))
+        InvalidateConvoRoutes();
 
       if (NumInStatus(path::ePathEstablished) > 1)
       {
@@ -323,7 +337,10 @@ namespace llarp
                   if (auto* addr = std::get_if<service::Address>(&*maybe_addr))
                   {
                     if (maybe_range.has_value())
+                    {
                       m_ExitMap.Insert(*maybe_range, *addr);
+                      InvalidateConvoRoutes();
+                    }
                     if (maybe_auth.has_value())
                       SetAuthInfoForEndpoint(*addr, *maybe_auth);
                   }
@@ -438,6 +455,7 @@ namespace llarp
         itr = Sessions().emplace(tag, Session{}).first;
         itr->second.inbound = inbound;
         itr->second.remote = info;
+        InvalidateConvoRoutes();
       }
     }
 
@@ -453,6 +471,7 @@ namespace llarp
         {
           itr = sessions.erase(itr);
           removed++;
+          InvalidateConvoRoutes();
         }
         else
           ++itr;
@@ -474,8 +493,8 @@ namespace llarp
     void
     Endpoint::PutIntroFor(const ConvoTag& tag, const Introduction& intro)
     {
-      auto& s = Sessions()[tag];
-      s.intro = intro;
+      // routes never send by the intro the remote has of us, so none go stale
+      Sessions()[tag].intro = intro;
     }
 
     bool
@@ -496,7 +515,7 @@ namespace llarp
       {
         return;
       }
-      itr->second.replyIntro = intro;
+      itr->second.PutReplyIntro(intro);
     }
 
     bool
@@ -723,6 +742,7 @@ namespace llarp
       };
       resetState(m_state->m_RemoteSessions, [](const auto& item) { return item.second; });
       resetState(m_state->m_SNodeSessions, [](const auto& item) { return item.second; });
+      InvalidateConvoRoutes();
     }
 
     bool
@@ -794,6 +814,7 @@ namespace llarp
       if (remoteSessions.count(addr) < MaxOutboundContextPerRemote)
       {
         remoteSessions.emplace(addr, std::make_shared<OutboundContext>(introset, this));
+        InvalidateConvoRoutes();
         LogInfo("Created New outbound context for ", addr.ToString());
       }
 
@@ -1243,7 +1264,8 @@ namespace llarp
     void
     Endpoint::RemoveConvoTag(const ConvoTag& t)
     {
-      Sessions().erase(t);
+      if (Sessions().erase(t))
+        InvalidateConvoRoutes();
     }
 
     void
@@ -1532,6 +1554,7 @@ namespace llarp
             false,
             this);
         m_state->m_SNodeSessions[snode] = session;
+        InvalidateConvoRoutes();
       }
       EnsureRouterIsKnown(snode);
       auto range = nodeSessions.equal_range(snode);
@@ -1812,10 +1835,6 @@ namespace llarp
       {
         // inbound conversation
         LogTrace("Have inbound convo");
-        auto transfer = std::make_shared<routing::PathTransferMessage>();
-        ProtocolFrame& f = transfer->T;
-        f.R = 0;
-        std::shared_ptr<path::Path> p;
         if (const auto maybe = GetBestConvoTagFor(remote))
         {
           // the remote guy's intro
@@ -1846,40 +1865,7 @@ namespace llarp
                 tag);
             return false;
           }
-
-          f.T = tag;
-          // TODO: check expiration of our end
-          auto m = std::make_shared<ProtocolMessage>(f.T);
-          m->PutBuffer(data);
-          f.N.Randomize();
-          f.C.Zero();
-          f.R = 0;
-          transfer->Y.Randomize();
-          m->proto = t;
-          m->introReply = p->intro;
-          m->sender = m_Identity.pub;
-          if (auto maybe = GetSeqNoForConvo(f.T))
-          {
-            m->seqno = *maybe;
-          }
-          else
-          {
-            LogWarn(Name(), " could not set sequence number, no session T=", f.T);
-            return false;
-          }
-          f.S = m->seqno;
-          f.F = p->intro.pathID;
-          transfer->P = replyIntro.pathID;
-          Router()->QueueWork([transfer, p, m, K, this]() {
-            if (not transfer->T.EncryptAndSign(*m, K, m_Identity))
-            {
-              LogError("failed to encrypt and sign for sessionn T=", transfer->T.T);
-              return;
-            }
-            m_SendQueue.tryPushBack(SendEvent_t{transfer, p});
-            Router()->TriggerPump();
-          });
-          return true;
+          return SendOnInboundConvo(tag, std::move(p), replyIntro, K, data, t);
         }
         else
         {
@@ -1937,6 +1923,144 @@ namespace llarp
       return true;
     }
 
+    bool
+    Endpoint::SendOnInboundConvo(
+        ConvoTag tag,
+        path::Path_ptr p,
+        const Introduction& replyIntro,
+        const SharedSecret& K,
+        const llarp_buffer_t& data,
+        ProtocolType t)
+    {
+      auto transfer = std::make_shared<routing::PathTransferMessage>();
+      ProtocolFrame& f = transfer->T;
+      f.T = tag;
+      // TODO: check expiration of our end
+      auto m = std::make_shared<ProtocolMessage>(f.T);
+      m->PutBuffer(data);
+      f.N.Randomize();
+      f.C.Zero();
+      f.R = 0;
+      transfer->Y.Randomize();
+      m->proto = t;
+      m->introReply = p->intro;
+      m->sender = m_Identity.pub;
+      if (auto maybe = GetSeqNoForConvo(f.T))
+      {
+        m->seqno = *maybe;
+      }
+      else
+      {
+        LogWarn(Name(), " could not set sequence number, no session T=", f.T);
+        return false;
+      }
+      f.S = m->seqno;
+      f.F = p->intro.pathID;
+      transfer->P = replyIntro.pathID;
+      Router()->QueueWork([transfer, p, m, K, this]() {
+        if (not transfer->T.EncryptAndSign(*m, K, m_Identity))
+        {
+          LogError("failed to encrypt and sign for sessionn T=", transfer->T.T);
+          return;
+        }
+        m_SendQueue.tryPushBack(SendEvent_t{transfer, p});
+        Router()->TriggerPump();
+      });
+      return true;
+    }
+
+    std::optional<Endpoint::ConvoRoute>
+    Endpoint::ResolveConvoRoute(const std::variant<Address, RouterID>& remote)
+    {
+      ConvoRoute route;
+      route.generation = m_ConvoRouteGeneration;
+      if (const auto* router = std::get_if<RouterID>(&remote))
+      {
+        // what SendToOrQueue does once the snode session is up
+        const auto itr = m_state->m_SNodeSessions.find(*router);
+        if (itr == m_state->m_SNodeSessions.end() or not itr->second->IsReady())
+          return std::nullopt;
+        route.snode = itr->second;
+        route.tag = ConvoTag{route.snode->CurrentPath()->as_array()};
+        return route;
+      }
+      const auto& addr = std::get<Address>(remote);
+      if (addr == m_Identity.pub.Addr())
+        return std::nullopt;
+      if (HasInboundConvo(addr))
+      {
+        const auto maybe = GetBestConvoTagFor(addr);
+        if (not maybe)
+          return std::nullopt;
+        const auto itr = Sessions().find(*maybe);
+        if (itr == Sessions().end())
+          return std::nullopt;
+        route.path = GetPathByRouter(itr->second.replyIntro.router);
+        if (not route.path)
+          return std::nullopt;
+        route.tag = *maybe;
+        route.convoGeneration = itr->second.routeGeneration;
+        return route;
+      }
+      if (not WantsOutboundSession(addr))
+        return std::nullopt;
+      const auto range = m_state->m_RemoteSessions.equal_range(addr);
+      for (auto itr = range.first; itr != range.second; ++itr)
+      {
+        if (itr->second->ReadyToSend())
+        {
+          route.outbound = itr->second;
+          route.tag = route.outbound->currentConvoTag;
+          return route;
+        }
+      }
+      return std::nullopt;
+    }
+
+    const Session*
+    Endpoint::InboundConvoFor(const ConvoRoute& route) const
+    {
+      const auto itr = Sessions().find(route.tag);
+      const auto* convo = itr == Sessions().end() ? nullptr : &itr->second;
+      if (not route.Current(m_ConvoRouteGeneration, convo) or not route.path
+          or not route.path->IsReady())
+        return nullptr;
+      return convo;
+    }
+
+    bool
+    Endpoint::ConvoRouteReady(const ConvoRoute& route) const
+    {
+      if (route.outbound)
+        return route.Current(m_ConvoRouteGeneration, nullptr) and route.outbound->ReadyToSend();
+      if (route.snode)
+        return route.Current(m_ConvoRouteGeneration, nullptr) and route.snode->IsReady();
+      return InboundConvoFor(route) != nullptr;
+    }
+
+    bool
+    Endpoint::SendOnConvoRoute(
+        const ConvoRoute& route, const llarp_buffer_t& payload, ProtocolType t)
+    {
+      if (payload.sz == 0)
+        return false;
+      if (route.outbound or route.snode)
+      {
+        if (not ConvoRouteReady(route))
+          return false;
+        if (route.outbound)
+          route.outbound->AsyncEncryptAndSendTo(payload, t);
+        else
+          route.snode->SendPacketToRemote(payload, t);
+        return true;
+      }
+      const auto* convo = InboundConvoFor(route);
+      if (not convo)
+        return false;
+      return SendOnInboundConvo(
+          route.tag, route.path, convo->replyIntro, convo->sharedKey, payload, t);
+    }
+
     bool
     Endpoint::SendToOrQueue(
         const std::variant<Address, RouterID>& addr, const llarp_buffer_t& data, ProtocolType t)
@@ -2031,6 +2155,7 @@ namespace llarp
       if (not exit.IsZero())
         LogInfo(Name(), " map ", range, " to exit at ", exit);
       m_ExitMap.Insert(range, exit);
+      InvalidateConvoRoutes();
     }
 
     void
@@ -2043,6 +2168,7 @@ namespace llarp
         LogInfo(Name(), " unmap ", item.first, " exit range mapping");
         return true;
       });
+      InvalidateConvoRoutes();
     }
 
     std::optional<AuthInfo>
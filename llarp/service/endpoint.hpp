@@ -7,6 +7,7 @@
 #include <llarp/path/path.hpp>
 #include <llarp/path/pathbuilder.hpp>
 #include "address.hpp"
+#include "convo_route.hpp"
 #include "handler.hpp"
 #include "identity.hpp"
 #include "pendingbuffer.hpp"
@@ -311,6 +312,13 @@ namespace llarp
       bool
       ShouldBuildMore(llarp_time_t now) const override;
 
+      /// how many paths each of our sessions stripes its traffic over, 1 for one path
+      size_t
+      MultipathLanes() const
+      {
+        return m_MultipathLanes;
+      }
+
       virtual llarp_time_t
       PathAlignmentTimeout() const
       {
@@ -458,6 +466,30 @@ namespace llarp
       bool
       SendToOrQueue(const RouterID& addr, const llarp_buffer_t& payload, ProtocolType t);
 
+      using ConvoRoute = service::ConvoRoute;
+
+      /// resolve how packets to a remote would be sent right now, nullopt if they would be
+      /// queued for a session that is not ready or they are to ourselves
+      std::optional<ConvoRoute>
+      ResolveConvoRoute(const std::variant<Address, RouterID>& remote);
+
+      /// true if a route we resolved before is still current and the session or path under it
+      /// is ready to send on; resolve it again if not
+      bool
+      ConvoRouteReady(const ConvoRoute& route) const;
+
+      /// send on a route we resolved before, returns false without sending if it is not ready
+      bool
+      SendOnConvoRoute(const ConvoRoute& route, const llarp_buffer_t& payload, ProtocolType t);
+
+      /// moves on whenever convos, sessions or address mappings come or go in a way that can
+      /// change what a remote resolves to.  changes within a convo move its own generation.
+      uint64_t
+      ConvoRouteGeneration() const
+      {
+        return m_ConvoRouteGeneration;
+      }
+
       std::optional<AuthInfo>
       MaybeGetAuthInfoForEndpoint(service::Address addr);
 
@@ -482,10 +514,33 @@ namespace llarp
       void
       PrefetchServicesByTag(const Tag& tag);
 
+      /// mark every resolved ConvoRoute stale
+      void
+      InvalidateConvoRoutes()
+      {
+        m_ConvoRouteGeneration++;
+      }
+
      private:
       void
       HandleVerifyGotRouter(dht::GotRouterMessage_constptr msg, RouterID id, bool valid);
 
+      /// the convo an inbound route goes out on if the route is current and its path ready
+      const Session*
+      InboundConvoFor(const ConvoRoute& route) const;
+
+      /// send on an inbound convo over our path p to the remote's reply intro
+      bool
+      SendOnInboundConvo(
+          ConvoTag tag,
+          path::Path_ptr p,
+          const Introduction& replyIntro,
+          const SharedSecret& K,
+          const llarp_buffer_t& data,
+          ProtocolType t);
+
+      uint64_t m_ConvoRouteGeneration = 0;
+
       bool
       OnLookup(
           const service::Address& addr,
@@ -516,6 +571,7 @@ namespace llarp
       Identity m_Identity;
       net::IPRangeMap<service::Address> m_ExitMap;
       bool m_PublishIntroSet = true;
+      size_t m_MultipathLanes = 1;
       std::unique_ptr<EndpointState> m_state;
       std::shared_ptr<IAuthPolicy> m_AuthPolicy;
       std::unordered_map<Address, AuthInfo> m_RemoteAuthInfos;
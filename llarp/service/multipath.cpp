@@ -0,0 +1,106 @@
+#include "multipath.hpp"
+
+#include <algorithm>
+
+namespace llarp
+{
+  namespace service
+  {
+    double
+    MultipathStriper::Lane::Share() const
+    {
+      return weight / std::max(rtt, 1.0);
+    }
+
+    util::StatusObject
+    MultipathStriper::Lane::ExtractStatus() const
+    {
+      return util::StatusObject{
+          {"local", local.ToHex()},
+          {"remote", remote.ExtractStatus()},
+          {"rtt", rtt},
+          {"weight", weight},
+          {"sent", sent},
+          {"drops", drops}};
+    }
+
+    void
+    MultipathStriper::SetLanes(std::vector<Lane> lanes)
+    {
+      if (lanes.size() > maxLanes)
+        lanes.resize(maxLanes);
+      for (auto& lane : lanes)
+      {
+        if (const auto* old = Find(lane.local, lane.remote.pathID))
+        {
+          lane.weight = old->weight;
+          lane.credit = old->credit;
+          lane.sent = old->sent;
+          lane.drops = old->drops;
+        }
+      }
+      m_Lanes = std::move(lanes);
+    }
+
+    const MultipathStriper::Lane*
+    MultipathStriper::Next()
+    {
+      // smooth weighted round robin: every lane earns its share, the richest sends and pays
+      // for everyone, so frames interleave rather than going out in runs per lane
+      Lane* chosen = nullptr;
+      double total = 0;
+      for (auto& lane : m_Lanes)
+      {
+        const auto share = lane.Share();
+        lane.credit += share;
+        total += share;
+        if (chosen == nullptr or lane.credit > chosen->credit)
+          chosen = &lane;
+      }
+      if (chosen)
+        chosen->credit -= total;
+      return chosen;
+    }
+
+    void
+    MultipathStriper::OnSent(const PathID_t& local, const PathID_t& remote)
+    {
+      if (auto* lane = Find(local, remote))
+      {
+        lane->sent++;
+        // lanes that keep carrying frames slowly earn a bigger share
+        lane->weight = std::min(lane->weight + 1 / lane->weight, MaxWeight);
+      }
+    }
+
+    void
+    MultipathStriper::OnDrop(const PathID_t& local, const PathID_t& remote)
+    {
+      if (auto* lane = Find(local, remote))
+      {
+        lane->drops++;
+        lane->weight = std::max(lane->weight / 2, MinWeight);
+      }
+    }
+
+    util::StatusObject
+    MultipathStriper::ExtractStatus() const
+    {
+      std::vector<util::StatusObject> lanes;
+      for (const auto& lane : m_Lanes)
+        lanes.emplace_back(lane.ExtractStatus());
+      return util::StatusObject{{"maxLanes", maxLanes}, {"lanes", lanes}};
+    }
+
+    MultipathStriper::Lane*
+    MultipathStriper::Find(const PathID_t& local, const PathID_t& remote)
+    {
+      for (auto& lane : m_Lanes)
+      {
+        if (lane.local == local and lane.remote.pathID == remote)
+          return &lane;
+      }
+      return nullptr;
+    }
+  }  // namespace service
+}  // namespace llarp
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "intro.hpp"
+#include <llarp/path/path_types.hpp>
+#include <llarp/path/pathset.hpp>
+#include <llarp/util/status.hpp>
+
+#include <vector>
+
+namespace llarp
+{
+  namespace service
+  {
+    /// stripes one session's frames over several paths to the remote's introset, each lane
+    /// given a share of the frames by its weight over its round trip.  nothing acks frames at
+    /// this layer, so this only divides the traffic between lanes: it does not limit what is
+    /// in flight on any of them, that is left to the paths.
+    struct MultipathStriper
+    {
+      /// weight a new lane starts with
+      static constexpr double InitialWeight = 4;
+      static constexpr double MinWeight = 1;
+      static constexpr double MaxWeight = 256;
+
+      /// one of our paths and the remote intro it sends to
+      struct Lane
+      {
+        /// rxid of our path, which is what frames and drops come back to us on
+        PathID_t local;
+        path::Path_ptr path;
+        Introduction remote;
+        /// round trip over our path and theirs in milliseconds
+        double rtt = 1;
+        /// relative share of the frames this lane gets per round trip: creeps up as it sends
+        /// and halves when the remote's pivot drops one of its frames
+        double weight = InitialWeight;
+        /// smooth weighted round robin credit
+        double credit = 0;
+        uint64_t sent = 0;
+        uint64_t drops = 0;
+
+        /// weight over round trip, what the lane's share of frames is in proportion to
+        double
+        Share() const;
+
+        util::StatusObject
+        ExtractStatus() const;
+      };
+
+      /// the most lanes we stripe over, 1 for just the one path
+      size_t maxLanes = 1;
+
+      bool
+      Enabled() const
+      {
+        return maxLanes > 1;
+      }
+
+      /// replace the lanes with these, best first; lanes we already had keep their weights
+      void
+      SetLanes(std::vector<Lane> lanes);
+
+      /// the lane the next frame goes over, nullptr if we have none
+      const Lane*
+      Next();
+
+      /// the best lane, which replies are asked to come back over whichever lane a frame took,
+      /// so the remote does not chase our paths frame by frame; nullptr if we have none
+      const Lane*
+      Best() const
+      {
+        return m_Lanes.empty() ? nullptr : &m_Lanes.front();
+      }
+
+      /// a frame went out on this lane
+      void
+      OnSent(const PathID_t& local, const PathID_t& remote);
+
+      /// a frame on this lane was dropped by the remote's pivot router
+      void
+      OnDrop(const PathID_t& local, const PathID_t& remote);
+
+      size_t
+      NumLanes() const
+      {
+        return m_Lanes.size();
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      Lane*
+      Find(const PathID_t& local, const PathID_t& remote);
+
+      std::vector<Lane> m_Lanes;
+    };
+  }  // namespace service
+}  // namespace llarp
@@ -41,6 +41,7 @@ namespace llarp
     bool
     OutboundContext::HandleDataDrop(path::Path_ptr p, const PathID_t& dst, uint64_t seq)
     {
+      m_Striper.OnDrop(p->RXID(), dst);
       // pick another intro
       if (dst == remoteIntro.pathID && remoteIntro.router == p->Endpoint())
       {
@@ -80,6 +81,9 @@ namespace llarp
       // this will make it so that there is less of a chance for timing races
       sendTimeout += parent->PathAlignmentTimeout();
       connectTimeout += parent->PathAlignmentTimeout();
+      // keep a path around for every lane we stripe over
+      m_Striper.maxLanes = parent->MultipathLanes();
+      numDesiredPaths = std::max(numDesiredPaths, m_Striper.maxLanes);
     }
 
     OutboundContext::~OutboundContext() = default;
@@ -328,6 +332,8 @@ namespace llarp
       obj["currentRemoteIntroset"] = currentIntroSet.ExtractStatus();
       obj["nextIntro"] = m_NextIntro.ExtractStatus();
       obj["readyToSend"] = ReadyToSend();
+      if (m_Striper.Enabled())
+        obj["multipath"] = m_Striper.ExtractStatus();
       return obj;
     }
 
@@ -395,6 +401,9 @@ namespace llarp
           }
         }
       }
+      if (m_Striper.Enabled() and ReadyToSend())
+        UpdateLanes(now);
+
       // lookup router in intro if set and unknown
       if (not m_NextIntro.router.IsZero())
         m_Endpoint->EnsureRouterIsKnown(m_NextIntro.router);
@@ -470,9 +479,92 @@ namespace llarp
       }
       if (m_NextIntro.router.IsZero())
         return std::nullopt;
+      // once we can send, spread our paths over the remote's intros so there are lanes to
+      // stripe over
+      if (m_Striper.Enabled() and ReadyToSend())
+      {
+        if (const auto router = LeastServedIntroRouter(Now()))
+          return GetHopsAlignedToForBuild(*router, m_Endpoint->SnodeBlacklist());
+      }
       return GetHopsAlignedToForBuild(m_NextIntro.router, m_Endpoint->SnodeBlacklist());
     }
 
+    std::optional<RouterID>
+    OutboundContext::LeastServedIntroRouter(llarp_time_t now) const
+    {
+      std::unordered_map<RouterID, size_t> served;
+      for (const auto& intro : currentIntroSet.intros)
+      {
+        if (intro.ExpiresSoon(now, path::intro_path_spread))
+          continue;
+        if (m_Endpoint->SnodeBlacklist().count(intro.router))
+          continue;
+        served.emplace(intro.router, 0);
+      }
+      ForEachPath([&served](const path::Path_ptr& path) {
+        const auto status = path->Status();
+        if (status != path::ePathBuilding and status != path::ePathEstablished)
+          return;
+        if (auto itr = served.find(path->Endpoint()); itr != served.end())
+          itr->second++;
+      });
+      std::optional<RouterID> least;
+      size_t fewest = 0;
+      for (const auto& [router, num] : served)
+      {
+        // the next intro wins ties, as it is where we would build otherwise
+        if (not least or num < fewest or (num == fewest and router == m_NextIntro.router))
+        {
+          least = router;
+          fewest = num;
+        }
+      }
+      return least;
+    }
+
+    void
+    OutboundContext::UpdateLanes(llarp_time_t now)
+    {
+      std::vector<MultipathStriper::Lane> candidates;
+      for (const auto& intro : currentIntroSet.intros)
+      {
+        if (intro.ExpiresSoon(now, path::intro_path_spread))
+          continue;
+        ForEachPath([&](const path::Path_ptr& path) {
+          if (not path->IsReady() or path->Endpoint() != intro.router)
+            return;
+          if (path->ExpiresSoon(now, path::intro_path_spread))
+            return;
+          MultipathStriper::Lane lane;
+          lane.local = path->RXID();
+          lane.path = path;
+          lane.remote = intro;
+          lane.rtt = path->quality.Cost()
+              + std::chrono::duration<double, std::milli>(intro.latency).count();
+          candidates.emplace_back(std::move(lane));
+        });
+      }
+      // a lane over a path with no round trip yet would look the fastest of all
+      path::DropUnmeasured(candidates, [](const auto& lane) -> const path::PathQuality& {
+        return lane.path->quality;
+      });
+      std::sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.rtt < b.rtt;
+      });
+      // lanes sharing a path or an intro would share its bottleneck too
+      std::vector<MultipathStriper::Lane> lanes;
+      std::unordered_set<PathID_t> usedLocal, usedRemote;
+      for (auto& lane : candidates)
+      {
+        if (usedLocal.count(lane.local) or usedRemote.count(lane.remote.pathID))
+          continue;
+        usedLocal.insert(lane.local);
+        usedRemote.insert(lane.remote.pathID);
+        lanes.emplace_back(std::move(lane));
+      }
+      m_Striper.SetLanes(std::move(lanes));
+    }
+
     bool
     OutboundContext::ShouldBuildMore(llarp_time_t now) const
     {
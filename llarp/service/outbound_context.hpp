@@ -157,6 +157,16 @@ namespace llarp
       void
       SwapIntros();
 
+      /// pair our ready paths up with the remote's intros for the striper, cheapest first and
+      /// no path or intro in two lanes
+      void
+      UpdateLanes(llarp_time_t now);
+
+      /// the intro router to build our next path to when striping: the one with the fewest of
+      /// our paths among the remote's good intros
+      std::optional<RouterID>
+      LeastServedIntroRouter(llarp_time_t now) const;
+
       bool
       IntroGenerated() const override;
       bool
@@ -25,10 +25,17 @@ namespace llarp
 
     bool
     SendContext::Send(std::shared_ptr<ProtocolFrame> msg, path::Path_ptr path)
+    {
+      return Send(std::move(msg), std::move(path), remoteIntro.pathID);
+    }
+
+    bool
+    SendContext::Send(
+        std::shared_ptr<ProtocolFrame> msg, path::Path_ptr path, PathID_t remotePath)
     {
       if (path->IsReady()
           and m_SendQueue.tryPushBack(std::make_pair(
-                  std::make_shared<routing::PathTransferMessage>(*msg, remoteIntro.pathID), path))
+                  std::make_shared<routing::PathTransferMessage>(*msg, remotePath), path))
               == thread::QueueReturn::Success)
       {
         m_Endpoint->Router()->TriggerPump();
@@ -52,9 +59,12 @@ namespace llarp
           lastGoodSend = r->Now();
           flushpaths.emplace(path);
           m_Endpoint->ConvoTagTX(msg->T.T);
+          m_Striper.OnSent(path->RXID(), msg->P);
           const auto rtt = (path->intro.latency + remoteIntro.latency) * 2;
           rttRMS += rtt * rtt.count();
         }
+        else
+          m_Striper.OnDrop(path->RXID(), msg->P);
       }
       // flush the select path's upstream
       for (const auto& path : flushpaths)
@@ -78,7 +88,19 @@ namespace llarp
       f->T = currentConvoTag;
       f->S = ++sequenceNo;
 
-      auto path = m_PathSet->GetPathByRouter(remoteIntro.router);
+      // with multipath on each frame goes over the next lane, otherwise over our best path to
+      // the current intro
+      path::Path_ptr path;
+      Introduction remote = remoteIntro;
+      path::Path_ptr replyPath;
+      if (const auto* lane = m_Striper.Next(); lane and lane->path->IsReady())
+      {
+        path = lane->path;
+        remote = lane->remote;
+        replyPath = m_Striper.Best()->path;
+      }
+      else
+        path = m_PathSet->GetPathByRouter(remoteIntro.router);
       if (!path)
       {
         ShiftIntroRouter(remoteIntro.router);
@@ -94,8 +116,11 @@ namespace llarp
       }
 
       auto m = std::make_shared<ProtocolMessage>();
-      m_DataHandler->PutIntroFor(f->T, remoteIntro);
-      m_DataHandler->PutReplyIntroFor(f->T, path->intro);
+      // replies come back over the best lane's path however this frame goes
+      if (not replyPath or not replyPath->IsReady())
+        replyPath = path;
+      m_DataHandler->PutIntroFor(f->T, remote);
+      m_DataHandler->PutReplyIntroFor(f->T, replyPath->intro);
       m->proto = t;
       if (auto maybe = m_Endpoint->GetSeqNoForConvo(f->T))
       {
@@ -106,18 +131,20 @@ namespace llarp
         LogWarn(m_PathSet->Name(), " could not get sequence number for session T=", f->T);
         return;
       }
-      m->introReply = path->intro;
-      f->F = m->introReply.pathID;
+      m->introReply = replyPath->intro;
+      // resets and auth results come back to the path id we sent from via the router the frame
+      // arrived at, so that has to be the path this frame took
+      f->F = path->intro.pathID;
       m->sender = m_Endpoint->GetIdentity().pub;
       m->tag = f->T;
       m->PutBuffer(payload);
-      m_Endpoint->Router()->QueueWork([f, m, shared, path, this] {
+      m_Endpoint->Router()->QueueWork([f, m, shared, path, remotePath = remote.pathID, this] {
         if (not f->EncryptAndSign(*m, shared, m_Endpoint->GetIdentity()))
         {
           LogError(m_PathSet->Name(), " failed to sign message");
           return;
         }
-        Send(f, path);
+        Send(f, path, remotePath);
       });
     }
 
@@ -3,6 +3,7 @@
 #include <llarp/path/pathset.hpp>
 #include <llarp/routing/path_transfer_message.hpp>
 #include "intro.hpp"
+#include "multipath.hpp"
 #include "protocol.hpp"
 #include <llarp/util/buffer.hpp>
 #include <llarp/util/types.hpp>
@@ -30,6 +31,10 @@ namespace llarp
       bool
       Send(std::shared_ptr<ProtocolFrame> f, path::Path_ptr path);
 
+      /// queue send a fully encrypted hidden service frame via a path to a remote path
+      bool
+      Send(std::shared_ptr<ProtocolFrame> f, path::Path_ptr path, PathID_t remotePath);
+
       /// flush upstream traffic when in router thread
       void
       FlushUpstream();
@@ -53,6 +58,8 @@ namespace llarp
       using SendEvent_t = std::pair<Msg_ptr, path::Path_ptr>;
 
       thread::Queue<SendEvent_t> m_SendQueue;
+      /// spreads our frames over several paths when multipath is on
+      MultipathStriper m_Striper;
 
       std::function<void(AuthResult)> authResultListener;
 
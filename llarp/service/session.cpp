@@ -19,6 +19,15 @@ namespace llarp
       return obj;
     }
 
+    void
+    Session::PutReplyIntro(const Introduction& intro)
+    {
+      // routes pin our path to the intro's router, the rest of it is read when sending
+      if (replyIntro.router != intro.router)
+        routeGeneration++;
+      replyIntro = intro;
+    }
+
     Address
     Session::Addr() const
     {
@@ -33,12 +33,19 @@ namespace llarp
       bool inbound = false;
       bool forever = false;
 
+      /// moves on when something a route resolved to this convo pins changes
+      uint64_t routeGeneration = 0;
+
       Duration_t lastSend{};
       Duration_t lastRecv{};
 
       util::StatusObject
       ExtractStatus() const;
 
+      /// put the intro we reply to
+      void
+      PutReplyIntro(const Introduction& intro);
+
       /// called to indicate we recieved on this session
       void
       RX();
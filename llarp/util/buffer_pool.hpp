@@ -0,0 +1,254 @@
+#pragma once
+
+#include "types.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// process wide pool of fixed size buffers in a few size classes, for packets that are
+    /// leased on one thread and freed on another.  every set of Sizes is a pool of its own.
+    ///
+    /// buffers are carved out of slabs and recycled through per thread free lists, which trade
+    /// batches with a shared free list per size class when they run dry or overflow, so leasing
+    /// and returning a buffer takes no lock and steady state traffic does not touch the heap.
+    /// once a class's shared free list grows past ReleaseThreshold the slabs it holds every
+    /// buffer of are freed, so memory does not stay at its peak after a burst.  slabs are never
+    /// freed while any of their buffers is leased, so buffers may be returned at any time, even
+    /// while statics are torn down.
+    template <size_t... Sizes>
+    class SizeClassPool
+    {
+     public:
+      static constexpr size_t NumClasses = sizeof...(Sizes);
+      /// buffer size of each class, smallest first
+      static constexpr std::array<size_t, NumClasses> ClassSizes{Sizes...};
+      /// how many buffers of a class we allocate at once when its free lists run dry
+      static constexpr size_t SlabBuffers = 64;
+      /// free buffers of each class a thread keeps for itself
+      static constexpr size_t ThreadCacheSize = 256;
+      /// how many buffers move between a thread and the shared free list in one go
+      static constexpr size_t TransferSize = 64;
+      /// idle buffers a class's shared free list holds before it frees the slabs it has all of
+      static constexpr size_t ReleaseThreshold = 8192;
+
+      static_assert(NumClasses > 0 and NumClasses < 256);
+
+      /// the smallest class whose buffers hold sz bytes, the largest if none do
+      static constexpr uint8_t
+      ClassFor(size_t sz)
+      {
+        uint8_t cls = 0;
+        while (cls + 1 < NumClasses and ClassSizes[cls] < sz)
+          ++cls;
+        return cls;
+      }
+
+      /// a free buffer of this class, nullptr if there are none anywhere
+      static byte_t*
+      TakeFree(uint8_t cls)
+      {
+        if (not t_CacheGone)
+          return t_Cache.Take(cls);
+        auto& shared = Shared()[cls];
+        std::lock_guard lock{shared.mutex};
+        if (shared.free.empty())
+          return nullptr;
+        auto* buf = shared.free.back();
+        shared.free.pop_back();
+        shared.Shrunk();
+        return buf;
+      }
+
+      /// a buffer of this class out of a new slab, whose other buffers are put on the free list
+      static byte_t*
+      Carve(uint8_t cls)
+      {
+        const size_t size = ClassSizes[cls];
+        auto* slab = new byte_t[size * SlabBuffers];
+        {
+          auto& shared = Shared()[cls];
+          std::lock_guard lock{shared.mutex};
+          shared.slabs.insert(
+              std::upper_bound(shared.slabs.begin(), shared.slabs.end(), slab), slab);
+        }
+        for (size_t idx = SlabBuffers - 1; idx > 0; --idx)
+          Give(cls, slab + (idx * size));
+        return slab;
+      }
+
+      /// a buffer of this class, off a free list if there is one
+      static byte_t*
+      Take(uint8_t cls)
+      {
+        if (auto* buf = TakeFree(cls))
+          return buf;
+        return Carve(cls);
+      }
+
+      /// return a buffer taken from this class
+      static void
+      Give(uint8_t cls, byte_t* buf)
+      {
+        if (not t_CacheGone)
+        {
+          t_Cache.Give(cls, buf);
+          return;
+        }
+        auto& shared = Shared()[cls];
+        std::lock_guard lock{shared.mutex};
+        shared.free.push_back(buf);
+        shared.Grew();
+      }
+
+      /// number of slabs freed because all their buffers sat idle
+      static uint64_t
+      ReleasedSlabs()
+      {
+        uint64_t released = 0;
+        for (const auto& shared : Shared())
+          released += shared.released.load(std::memory_order_relaxed);
+        return released;
+      }
+
+     private:
+      /// where threads that free more buffers of a class than they lease leave them for the
+      /// threads that lease more than they free.  buffers are pieces of slabs and cannot be
+      /// deleted one at a time, so a slab is freed only once every one of its buffers is idle
+      /// here.
+      struct SharedFree
+      {
+        size_t slabBytes = 0;
+        std::mutex mutex;
+        std::vector<byte_t*> free;
+        /// every live slab, sorted
+        std::vector<byte_t*> slabs;
+        /// free list size at which we next look for whole slabs to free
+        size_t releaseAt = ReleaseThreshold;
+        std::atomic<uint64_t> released{0};
+
+        /// the free list shrank, look again once it has grown by the release threshold
+        void
+        Shrunk()
+        {
+          releaseAt = std::min(releaseAt, free.size() + ReleaseThreshold);
+        }
+
+        /// the free list grew, free the slabs whose buffers are all on it if it grew enough
+        void
+        Grew()
+        {
+          if (free.size() < releaseAt)
+            return;
+          std::sort(free.begin(), free.end());
+          auto slab = slabs.begin();
+          auto run = free.begin();
+          auto kept = free.begin();
+          while (run != free.end())
+          {
+            // the slab the run of buffers starting at run belongs to
+            slab = std::upper_bound(slab, slabs.end(), *run) - 1;
+            auto end = std::lower_bound(run, free.end(), *slab + slabBytes);
+            if (static_cast<size_t>(end - run) == SlabBuffers)
+            {
+              byte_t* const idle = *slab;
+              slab = slabs.erase(slab);
+              delete[] idle;
+              released.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+              kept = std::move(run, end, kept);
+            run = end;
+          }
+          free.erase(kept, free.end());
+          releaseAt = free.size() + ReleaseThreshold;
+        }
+      };
+
+      static std::array<SharedFree, NumClasses>&
+      Shared()
+      {
+        // never destroyed, so buffers can still be returned while statics are torn down
+        static auto* shared = [] {
+          auto* classes = new std::array<SharedFree, NumClasses>{};
+          for (size_t cls = 0; cls < NumClasses; ++cls)
+            (*classes)[cls].slabBytes = ClassSizes[cls] * SlabBuffers;
+          return classes;
+        }();
+        return *shared;
+      }
+
+      /// a thread's own free buffers, so leasing and returning one takes no lock
+      struct ThreadCache
+      {
+        std::array<std::vector<byte_t*>, NumClasses> free;
+
+        ThreadCache()
+        {
+          for (auto& list : free)
+            list.reserve(ThreadCacheSize);
+        }
+
+        ~ThreadCache()
+        {
+          for (size_t cls = 0; cls < NumClasses; ++cls)
+            GiveBack(cls, free[cls].size());
+          t_CacheGone = true;
+        }
+
+        /// take a free buffer, refilling from the shared list if we have none; nullptr if there
+        /// are none anywhere
+        byte_t*
+        Take(uint8_t cls)
+        {
+          auto& list = free[cls];
+          if (list.empty())
+          {
+            auto& shared = Shared()[cls];
+            std::lock_guard lock{shared.mutex};
+            const auto num = std::min(shared.free.size(), TransferSize);
+            list.insert(list.end(), shared.free.end() - num, shared.free.end());
+            shared.free.resize(shared.free.size() - num);
+            shared.Shrunk();
+          }
+          if (list.empty())
+            return nullptr;
+          auto* buf = list.back();
+          list.pop_back();
+          return buf;
+        }
+
+        void
+        Give(uint8_t cls, byte_t* buf)
+        {
+          if (free[cls].size() == ThreadCacheSize)
+            GiveBack(cls, TransferSize);
+          free[cls].push_back(buf);
+        }
+
+        /// move num of our free buffers of a class to the shared list
+        void
+        GiveBack(size_t cls, size_t num)
+        {
+          auto& list = free[cls];
+          auto& shared = Shared()[cls];
+          std::lock_guard lock{shared.mutex};
+          shared.free.insert(shared.free.end(), list.end() - num, list.end());
+          list.resize(list.size() - num);
+          shared.Grew();
+        }
+      };
+
+      /// set once a thread's cache is gone, after which its buffers go through the shared list
+      static inline thread_local bool t_CacheGone = false;
+      static inline thread_local ThreadCache t_Cache;
+    };
+  }  // namespace util
+}  // namespace llarp
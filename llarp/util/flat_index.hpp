@@ -0,0 +1,209 @@
+#pragma once
+
+#include "mix.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// flat open addressing index from a key to a nullable handle (a raw or shared pointer), for
+    /// the per packet lookups on the receive and relay paths.  Traits gives:
+    ///
+    ///   Key: what we look up by, equality comparable
+    ///   Value: what we store; a default constructed one is null and tests false
+    ///   static uint64_t Hash(uint64_t seed, const Key&): hashes a key under the index's secret
+    ///     seed, so peers choosing the keys can't line up long probe chains
+    ///
+    /// slots are probed linearly and erased by shifting back, so there are no tombstones, and a
+    /// lookup never locks or allocates.  not thread safe; its owner says which thread it
+    /// belongs to.
+    template <typename Traits>
+    class FlatIndex
+    {
+     public:
+      using Key = typename Traits::Key;
+      using Value = typename Traits::Value;
+      /// what a Value points at
+      using Element = typename std::pointer_traits<Value>::element_type;
+
+      /// seed keys the hash; initialSize is rounded up to a power of two
+      explicit FlatIndex(uint64_t seed, size_t initialSize = 64) : m_Seed{seed}
+      {
+        size_t capacity = 8;
+        while (capacity < initialSize)
+          capacity *= 2;
+        m_Slots.resize(capacity);
+      }
+
+      size_t
+      size() const
+      {
+        return m_Size;
+      }
+
+      bool
+      empty() const
+      {
+        return m_Size == 0;
+      }
+
+      size_t
+      Capacity() const
+      {
+        return m_Slots.size();
+      }
+
+      /// the value at this key, nullptr if there is none
+      const Value*
+      Find(const Key& key) const
+      {
+        for (size_t idx = Home(key);; idx = Next(idx))
+        {
+          const auto& slot = m_Slots[idx];
+          if (not slot.value)
+            return nullptr;
+          if (slot.key == key)
+            return &slot.value;
+        }
+      }
+
+      /// add a value; returns false and leaves the index alone if another value has this key
+      bool
+      Insert(const Key& key, Value value)
+      {
+        assert(value);
+        if ((m_Size + 1) * 2 > m_Slots.size())
+          Grow();
+        return Place(key, std::move(value));
+      }
+
+      /// returns false if there was nothing at this key
+      bool
+      Erase(const Key& key)
+      {
+        const auto hole = Locate(key);
+        if (not hole)
+          return false;
+        Remove(*hole);
+        return true;
+      }
+
+      /// remove this key only if it maps to target, so an owner going away never takes a newer
+      /// owner's entry at the same key with it; returns false otherwise
+      bool
+      Erase(const Key& key, const Element* target)
+      {
+        const auto hole = Locate(key);
+        if (not hole or &*m_Slots[*hole].value != target)
+          return false;
+        Remove(*hole);
+        return true;
+      }
+
+      /// visit every value, in no particular order
+      template <typename Visit_t>
+      void
+      ForEach(Visit_t&& visit) const
+      {
+        for (const auto& slot : m_Slots)
+        {
+          if (slot.value)
+            visit(slot.value);
+        }
+      }
+
+     private:
+      struct Slot
+      {
+        Key key;
+        Value value;
+      };
+
+      size_t
+      Home(const Key& key) const
+      {
+        return Traits::Hash(m_Seed, key) & (m_Slots.size() - 1);
+      }
+
+      size_t
+      Next(size_t idx) const
+      {
+        return (idx + 1) & (m_Slots.size() - 1);
+      }
+
+      /// the slot holding this key, if any
+      std::optional<size_t>
+      Locate(const Key& key) const
+      {
+        for (size_t idx = Home(key);; idx = Next(idx))
+        {
+          if (not m_Slots[idx].value)
+            return std::nullopt;
+          if (m_Slots[idx].key == key)
+            return idx;
+        }
+      }
+
+      void
+      Remove(size_t hole)
+      {
+        m_Slots[hole].value = Value{};
+        m_Size--;
+        // pull back later entries of this run that may live in the hole, i.e. whose home slot is
+        // no further along the run than the hole
+        const size_t mask = m_Slots.size() - 1;
+        for (size_t idx = Next(hole); m_Slots[idx].value; idx = Next(idx))
+        {
+          if (((idx - Home(m_Slots[idx].key)) & mask) >= ((idx - hole) & mask))
+          {
+            m_Slots[hole] = std::move(m_Slots[idx]);
+            m_Slots[idx].value = Value{};
+            hole = idx;
+          }
+        }
+      }
+
+      bool
+      Place(const Key& key, Value value)
+      {
+        for (size_t idx = Home(key);; idx = Next(idx))
+        {
+          auto& slot = m_Slots[idx];
+          if (not slot.value)
+          {
+            slot.key = key;
+            slot.value = std::move(value);
+            m_Size++;
+            return true;
+          }
+          if (slot.key == key)
+            return slot.value == value;
+        }
+      }
+
+      void
+      Grow()
+      {
+        std::vector<Slot> old(m_Slots.size() * 2);
+        std::swap(old, m_Slots);
+        m_Size = 0;
+        for (auto& slot : old)
+        {
+          if (slot.value)
+            Place(slot.key, std::move(slot.value));
+        }
+      }
+
+      const uint64_t m_Seed;
+      std::vector<Slot> m_Slots;
+      size_t m_Size = 0;
+    };
+  }  // namespace util
+}  // namespace llarp
@@ -0,0 +1,141 @@
+#pragma once
+
+#include "status.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// histogram of durations in microseconds, HDR style: each power of two range is split into
+    /// SubBuckets linear buckets, so a value lands in a bucket no wider than 1/SubBuckets of it
+    /// and a few hundred counters cover microseconds to days.  any thread may record; readers
+    /// see a consistent enough picture for status and rpc while recording goes on.
+    class LatencyHistogram
+    {
+     public:
+      using Duration_t = std::chrono::microseconds;
+
+      static constexpr size_t SubBucketBits = 3;
+      static constexpr size_t SubBuckets = size_t{1} << SubBucketBits;
+      /// values from 2^(Ranges + SubBucketBits - 1)us (about 50 days) up share the last bucket
+      static constexpr size_t Ranges = 40;
+      static constexpr size_t Buckets = Ranges * SubBuckets;
+
+      LatencyHistogram() = default;
+      LatencyHistogram(const LatencyHistogram&) = delete;
+      LatencyHistogram&
+      operator=(const LatencyHistogram&) = delete;
+
+      void
+      Record(Duration_t value)
+      {
+        const uint64_t us = value.count() > 0 ? value.count() : 0;
+        m_Counts[BucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+        m_Count.fetch_add(1, std::memory_order_relaxed);
+        m_Sum.fetch_add(us, std::memory_order_relaxed);
+        auto max = m_Max.load(std::memory_order_relaxed);
+        while (us > max and not m_Max.compare_exchange_weak(max, us, std::memory_order_relaxed))
+          ;
+      }
+
+      uint64_t
+      Count() const
+      {
+        return m_Count.load(std::memory_order_relaxed);
+      }
+
+      Duration_t
+      Max() const
+      {
+        return Duration_t{m_Max.load(std::memory_order_relaxed)};
+      }
+
+      Duration_t
+      Mean() const
+      {
+        const auto count = Count();
+        return Duration_t{count ? m_Sum.load(std::memory_order_relaxed) / count : 0};
+      }
+
+      /// the value at or below which fraction q (0 to 1) of the recorded values fall, rounded up
+      /// to the top of its bucket and never above the largest value recorded
+      Duration_t
+      Percentile(double q) const
+      {
+        const auto count = Count();
+        if (count == 0)
+          return Duration_t{0};
+        const auto rank =
+            std::max(uint64_t{1}, uint64_t(std::ceil(std::clamp(q, 0., 1.) * count)));
+        uint64_t seen = 0;
+        for (size_t bucket = 0; bucket < Buckets; ++bucket)
+        {
+          seen += m_Counts[bucket].load(std::memory_order_relaxed);
+          if (seen >= rank)
+            return std::min(Duration_t{LowerBound(bucket + 1) - 1}, Max());
+        }
+        return Max();
+      }
+
+      void
+      Clear()
+      {
+        for (auto& count : m_Counts)
+          count.store(0, std::memory_order_relaxed);
+        m_Count.store(0, std::memory_order_relaxed);
+        m_Sum.store(0, std::memory_order_relaxed);
+        m_Max.store(0, std::memory_order_relaxed);
+      }
+
+      /// count and the usual percentiles, in microseconds
+      util::StatusObject
+      ExtractStatus() const
+      {
+        return util::StatusObject{
+            {"count", Count()},
+            {"mean", Mean().count()},
+            {"p50", Percentile(0.5).count()},
+            {"p90", Percentile(0.9).count()},
+            {"p99", Percentile(0.99).count()},
+            {"max", Max().count()}};
+      }
+
+      /// the bucket a value in microseconds is counted in
+      static size_t
+      BucketFor(uint64_t us)
+      {
+        if (us < SubBuckets)
+          return us;
+        const size_t msb = 63 - __builtin_clzll(us);
+        const size_t range = msb - SubBucketBits + 1;
+        if (range >= Ranges)
+          return Buckets - 1;
+        return range * SubBuckets + ((us >> (msb - SubBucketBits)) & (SubBuckets - 1));
+      }
+
+      /// the smallest value in microseconds counted in a bucket
+      static uint64_t
+      LowerBound(size_t bucket)
+      {
+        const size_t range = bucket / SubBuckets;
+        const uint64_t sub = bucket % SubBuckets;
+        if (range == 0)
+          return sub;
+        return (SubBuckets + sub) << (range - 1);
+      }
+
+     private:
+      std::array<std::atomic<uint64_t>, Buckets> m_Counts{};
+      std::atomic<uint64_t> m_Count{0};
+      std::atomic<uint64_t> m_Sum{0};
+      std::atomic<uint64_t> m_Max{0};
+    };
+  }  // namespace util
+}  // namespace llarp
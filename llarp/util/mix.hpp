@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// splitmix64's finaliser, a cheap full avalanche of one word for hashing keys and values
+    /// under a secret seed
+    constexpr uint64_t
+    Mix64(uint64_t x)
+    {
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+  }  // namespace util
+}  // namespace llarp
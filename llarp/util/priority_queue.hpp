@@ -1,13 +1,35 @@
 #pragma once
 
+#include <algorithm>
+#include <functional>
 #include <queue>
 #include <vector>
 
 namespace llarp::util
 {
+  /// priority queue whose top can be moved out, for elements that are move only or costly to
+  /// copy
+  template <
+      typename T,
+      typename Container = std::vector<T>,
+      typename Compare = std::less<typename Container::value_type>>
+  class movable_priority_queue : public std::priority_queue<T, Container, Compare>
+  {
+   public:
+    /// remove the top element and hand it back
+    T
+    pop_top()
+    {
+      std::pop_heap(this->c.begin(), this->c.end(), this->comp);
+      T top = std::move(this->c.back());
+      this->c.pop_back();
+      return top;
+    }
+  };
+
   /// priority queue that uses operator > instead of operator <
   template <typename T, typename Container = std::vector<T>>
   using ascending_priority_queue =
-      std::priority_queue<T, Container, std::greater<typename Container::value_type>>;
+      movable_priority_queue<T, Container, std::greater<typename Container::value_type>>;
 
 }  // namespace llarp::util
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "mix.hpp"
+#include "time.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace llarp
+{
+  namespace util
+  {
+    /// remembers the random values (path nonces) it has seen for between one and two intervals,
+    /// in fixed memory: two blocked bloom filters, the current generation and the last, which
+    /// swap every interval.  insert and check touch one cache line per generation, and decay is
+    /// a swap and a clear of one generation however much traffic came through.
+    ///
+    /// the price is false positives, i.e. a fresh value taken for a replay.  each generation is
+    /// Blocks blocks of 512 bits (16KiB) and a value sets Probes bits in one block.  sized for
+    /// Capacity values an interval, 16 a block on average; averaging the false positive rate of
+    /// a block over its poisson load gives 1.6e-5 per generation, so at most 3.3e-5 for a
+    /// check against two full generations.  at twice that load it is 1.8e-3, so a generation
+    /// that fills up before its interval is over is rotated early: past Capacity values an
+    /// interval we remember the last Capacity to 2 * Capacity values rather than the last one to
+    /// two intervals, and Saturations() counts how often that happened.  values are hashed with
+    /// a per filter secret seed so a sender can't aim them at our blocks.
+    ///
+    /// Val_t is an AlignedBuffer of at least 16 bytes.
+    template <typename Val_t>
+    class RotatingReplayFilter
+    {
+     public:
+      using Time_t = std::chrono::milliseconds;
+
+      static constexpr size_t Blocks = 256;
+      static constexpr size_t Probes = 8;
+      static constexpr size_t Capacity = 4096;
+
+      static_assert(Val_t::SIZE >= 16, "values must be at least 16 bytes");
+      static_assert((Blocks & (Blocks - 1)) == 0, "blocks must be a power of two");
+
+      explicit RotatingReplayFilter(uint64_t seed, Time_t interval = 1s)
+          : m_Seed{seed}, m_Interval{interval}
+      {
+        Clear(0);
+        Clear(1);
+      }
+
+      /// values we are holding on to, counting both generations
+      size_t
+      Size() const
+      {
+        return m_Count[0] + m_Count[1];
+      }
+
+      /// true if we (probably) saw v in the last one to two intervals
+      bool
+      Contains(const Val_t& v) const
+      {
+        const auto probe = ProbeFor(v);
+        return Has(m_Current, probe) or Has(m_Current ^ 1, probe);
+      }
+
+      /// return true if inserted
+      /// return false if we (probably) already have it
+      bool
+      Insert(const Val_t& v, Time_t now = 0s)
+      {
+        if (now == 0s)
+          now = llarp::time_now_ms();
+        Decay(now);
+        const auto probe = ProbeFor(v);
+        if (Has(m_Current, probe) or Has(m_Current ^ 1, probe))
+          return false;
+        if (m_Count[m_Current] >= Capacity)
+        {
+          // full before its time: keep the false positive rate rather than the interval
+          Rotate(now);
+          m_Saturations++;
+        }
+        auto& block = m_Generations[m_Current][probe.block];
+        for (const auto bit : probe.bits)
+          block.words[bit / 64] |= uint64_t{1} << (bit % 64);
+        m_Count[m_Current]++;
+        return true;
+      }
+
+      /// start a new generation if the current one is an interval old, dropping the last
+      void
+      Decay(Time_t now = 0s)
+      {
+        if (now == 0s)
+          now = llarp::time_now_ms();
+        if (now < m_GenerationStarted + m_Interval)
+          return;
+        // nothing we hold is recent enough to keep if we've been idle for two intervals
+        if (now >= m_GenerationStarted + 2 * m_Interval)
+          Clear(m_Current);
+        Rotate(now);
+      }
+
+      Time_t
+      DecayInterval() const
+      {
+        return m_Interval;
+      }
+
+      /// how many generations filled up and were rotated before their interval was over
+      uint64_t
+      Saturations() const
+      {
+        return m_Saturations;
+      }
+
+     private:
+      struct alignas(64) Block
+      {
+        std::array<uint64_t, 8> words;
+      };
+
+      struct Probe
+      {
+        size_t block;
+        /// bits of the block to set or test, drawn independently; deriving them from two hashes
+        /// (double hashing) costs an order of magnitude in false positives in blocks this small
+        std::array<uint16_t, Probes> bits;
+      };
+
+      Probe
+      ProbeFor(const Val_t& v) const
+      {
+        uint64_t h = m_Seed;
+        for (size_t off = 0; off + sizeof(uint64_t) <= Val_t::SIZE; off += sizeof(uint64_t))
+        {
+          uint64_t word;
+          std::memcpy(&word, v.data() + off, sizeof(word));
+          h = Mix64(h ^ word);
+        }
+        Probe probe;
+        probe.block = h & (Blocks - 1);
+        uint64_t bits = 0;
+        for (size_t idx = 0; idx < Probes; ++idx)
+        {
+          // seven 9 bit positions to a word, each word a fresh hash of h
+          if (idx % 7 == 0)
+            bits = Mix64(h + (idx / 7 + 1) * 0x9e3779b97f4a7c15ULL);
+          probe.bits[idx] = bits & 511;
+          bits >>= 9;
+        }
+        return probe;
+      }
+
+      bool
+      Has(size_t generation, const Probe& probe) const
+      {
+        const auto& block = m_Generations[generation][probe.block];
+        for (const auto bit : probe.bits)
+        {
+          if ((block.words[bit / 64] & (uint64_t{1} << (bit % 64))) == 0)
+            return false;
+        }
+        return true;
+      }
+
+      void
+      Rotate(Time_t now)
+      {
+        m_Current ^= 1;
+        Clear(m_Current);
+        m_GenerationStarted = now;
+      }
+
+      void
+      Clear(size_t generation)
+      {
+        std::memset(m_Generations[generation].data(), 0, sizeof(m_Generations[generation]));
+        m_Count[generation] = 0;
+      }
+
+      const uint64_t m_Seed;
+      const Time_t m_Interval;
+      Time_t m_GenerationStarted = 0s;
+      size_t m_Current = 0;
+      uint64_t m_Saturations = 0;
+      std::array<size_t, 2> m_Count;
+      std::array<std::array<Block, Blocks>, 2> m_Generations;
+    };
+  }  // namespace util
+}  // namespace llarp
@@ -0,0 +1,148 @@
+#include "sharded_worker_pool.hpp"
+
+#include <llarp/util/logging/logger.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace llarp
+{
+  namespace thread
+  {
+    namespace
+    {
+      /// pin the calling thread to one logical cpu, wrapping around if we have more shards than
+      /// cpus
+      void
+      PinCurrentThread(size_t idx)
+      {
+#ifdef __linux__
+        const auto ncpus = std::max(std::thread::hardware_concurrency(), 1u);
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(idx % ncpus, &cpus);
+        if (const int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus); rc != 0)
+          LogWarn("failed to pin worker thread to cpu ", idx % ncpus, ": ", ::strerror(rc));
+#else
+        (void)idx;
+        LogWarn("pinning worker threads is not supported on this platform");
+#endif
+      }
+    }  // namespace
+
+    ShardedWorkerPool::ShardedWorkerPool(
+        size_t numShards, size_t queueSize, bool pinThreads, std::string name)
+        : m_PinThreads{pinThreads}, m_Name{std::move(name)}
+    {
+      assert(numShards > 0);
+      m_Shards.reserve(numShards);
+      for (size_t idx = 0; idx < numShards; ++idx)
+        m_Shards.emplace_back(std::make_unique<Shard>(queueSize));
+    }
+
+    ShardedWorkerPool::~ShardedWorkerPool()
+    {
+      Stop();
+    }
+
+    void
+    ShardedWorkerPool::Start()
+    {
+      if (m_Running.exchange(true))
+        return;
+      for (size_t idx = 0; idx < m_Shards.size(); ++idx)
+        m_Shards[idx]->worker = std::thread{[this, idx] { Run(idx); }};
+    }
+
+    void
+    ShardedWorkerPool::Stop()
+    {
+      if (not m_Running.exchange(false))
+        return;
+      // an empty job tells a shard to exit once it has drained everything queued before it
+      for (auto& shard : m_Shards)
+        shard->jobs.pushBack(Job_t{});
+      for (auto& shard : m_Shards)
+      {
+        if (shard->worker.joinable())
+          shard->worker.join();
+        shard->jobs.removeAll();
+      }
+    }
+
+    bool
+    ShardedWorkerPool::QueueJob(uint64_t key, Job_t job)
+    {
+      auto& shard = *m_Shards[ShardFor(key)];
+      if (not job or not m_Running.load(std::memory_order_relaxed)
+          or shard.jobs.tryPushBack(std::move(job)) != QueueReturn::Success)
+      {
+        shard.jobsDropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      }
+      return true;
+    }
+
+    bool
+    ShardedWorkerPool::QueueOrRunJob(uint64_t key, Job_t job)
+    {
+      if (not job)
+        return false;
+      auto& shard = *m_Shards[ShardFor(key)];
+      if (m_Running.load(std::memory_order_relaxed)
+          and shard.jobs.tryPushBack(std::move(job)) == QueueReturn::Success)
+        return true;
+      // a failed push leaves the job with us
+      shard.jobsRunInline.fetch_add(1, std::memory_order_relaxed);
+      job();
+      return false;
+    }
+
+    void
+    ShardedWorkerPool::Run(size_t idx)
+    {
+      util::SetThreadName(m_Name + "-" + std::to_string(idx));
+      if (m_PinThreads)
+        PinCurrentThread(idx);
+      auto& shard = *m_Shards[idx];
+      for (;;)
+      {
+        auto job = shard.jobs.popFront();
+        if (not job)
+          return;
+        const auto started = std::chrono::steady_clock::now();
+        job();
+        const auto busy = std::chrono::steady_clock::now() - started;
+        shard.busyNanos.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(busy).count(),
+            std::memory_order_relaxed);
+        shard.jobsRun.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    util::StatusObject
+    ShardedWorkerPool::ExtractStatus() const
+    {
+      std::vector<util::StatusObject> shards;
+      for (const auto& shard : m_Shards)
+      {
+        shards.emplace_back(util::StatusObject{
+            {"queueDepth", shard->jobs.size()},
+            {"queueCapacity", shard->jobs.capacity()},
+            {"jobsRun", shard->jobsRun.load(std::memory_order_relaxed)},
+            {"jobsDropped", shard->jobsDropped.load(std::memory_order_relaxed)},
+            {"jobsRunInline", shard->jobsRunInline.load(std::memory_order_relaxed)},
+            {"busyMS", shard->busyNanos.load(std::memory_order_relaxed) / 1'000'000}});
+      }
+      return util::StatusObject{
+          {"running", m_Running.load()}, {"pinned", m_PinThreads}, {"shards", shards}};
+    }
+  }  // namespace thread
+}  // namespace llarp
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "queue.hpp"
+
+#include <llarp/util/status.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llarp
+{
+  namespace thread
+  {
+    /// a fixed set of worker threads ("shards"), each draining its own job queue.
+    ///
+    /// jobs are routed to a shard by an affinity key, so every job queued with the same key runs
+    /// on the same thread in the order it was queued.  the link layer keys crypto jobs on the
+    /// remote address so a session's batches are never reordered and its keys stay in one
+    /// core's cache.
+    class ShardedWorkerPool
+    {
+     public:
+      using Job_t = std::function<void(void)>;
+
+      /// numShards: number of worker threads, must be at least 1
+      /// queueSize: per shard job queue capacity
+      /// pinThreads: pin shard N to logical cpu N (modulo the cpu count) where supported
+      /// name: thread name prefix
+      ShardedWorkerPool(size_t numShards, size_t queueSize, bool pinThreads, std::string name);
+
+      ShardedWorkerPool(const ShardedWorkerPool&) = delete;
+      ShardedWorkerPool&
+      operator=(const ShardedWorkerPool&) = delete;
+
+      /// stops and joins all shards
+      ~ShardedWorkerPool();
+
+      /// spawn the shard threads
+      void
+      Start();
+
+      /// run every job already queued then join the shard threads
+      void
+      Stop();
+
+      /// queue a job on the shard picked by key; does not block.  returns false (and drops the
+      /// job) if the pool is stopped or that shard's queue is full.
+      bool
+      QueueJob(uint64_t key, Job_t job);
+
+      /// queue a job on the shard picked by key, or run it on the caller if the pool is stopped
+      /// or that shard's queue is full, so the job is never dropped.  returns true if it was
+      /// queued.
+      bool
+      QueueOrRunJob(uint64_t key, Job_t job);
+
+      size_t
+      NumShards() const
+      {
+        return m_Shards.size();
+      }
+
+      /// index of the shard that runs jobs queued with key
+      size_t
+      ShardFor(uint64_t key) const
+      {
+        return key % m_Shards.size();
+      }
+
+      util::StatusObject
+      ExtractStatus() const;
+
+     private:
+      struct Shard
+      {
+        explicit Shard(size_t queueSize) : jobs{queueSize}
+        {}
+
+        Queue<Job_t> jobs;
+        std::thread worker;
+        std::atomic<uint64_t> jobsRun{0};
+        std::atomic<uint64_t> jobsDropped{0};
+        std::atomic<uint64_t> jobsRunInline{0};
+        std::atomic<uint64_t> busyNanos{0};
+      };
+
+      void
+      Run(size_t idx);
+
+      std::vector<std::unique_ptr<Shard>> m_Shards;
+      const bool m_PinThreads;
+      const std::string m_Name;
+      std::atomic<bool> m_Running{false};
+    };
+  }  // namespace thread
+}  // namespace llarp
@@ -37,10 +37,10 @@ namespace llarp::vpn
     net::IPPacket
     ReadNextPacket() override
     {
-      net::IPPacket pkt{};
-      const auto sz = read(m_fd, pkt.buf, sizeof(pkt.buf));
+      net::IPPacket pkt{net::IPPacket::MaxSize};
+      const auto sz = read(m_fd, pkt.buf, pkt.Capacity());
       if (sz >= 0)
-        pkt.sz = std::min(sz, ssize_t{sizeof(pkt.buf)});
+        pkt.sz = sz;
       return pkt;
     }
 
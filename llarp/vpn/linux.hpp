@@ -6,6 +6,8 @@
 #include <sys/types.h>
 #include <fcntl.h>
 #include "common.hpp"
+#include "offload.hpp"
+#include "queue_reader.hpp"
 #include <net/if.h>
 #include <linux/if_tun.h>
 
@@ -14,10 +16,13 @@
 #include <unistd.h>
 #include <arpa/inet.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <linux/rtnetlink.h>
 #include <llarp/net/net.hpp>
 #include <llarp/util/str.hpp>
 #include <exception>
+#include <memory>
+#include <vector>
 
 #include <oxenc/endian.h>
 
@@ -32,26 +37,73 @@ namespace llarp::vpn
 
   class LinuxInterface : public NetworkInterface
   {
-    const int m_fd;
+    /// packets split out of one super packet read off the only queue
+    struct PacketBatch
+    {
+      std::vector<net::IPPacket> pkts;
+      size_t num = 0;
+    };
+
+    /// one fd per queue, the first one is the one we write on
+    std::vector<int> m_fds;
     const InterfaceInfo m_Info;
+    /// with more than one queue: what reads them
+    std::unique_ptr<QueueReaders> m_Readers;
+    /// with offload: what the only queue is read into, the packets it was split into, and what
+    /// joins up the packets we write
+    std::vector<byte_t> m_ReadBuf;
+    PacketBatch m_Batch;
+    size_t m_BatchPos = 0;
+    std::unique_ptr<SegmentCoalescer> m_Coalescer;
 
    public:
-    LinuxInterface(InterfaceInfo info)
-        : NetworkInterface{}, m_fd{::open("/dev/net/tun", O_RDWR)}, m_Info{std::move(info)}
+    LinuxInterface(InterfaceInfo info) : NetworkInterface{}, m_Info{std::move(info)}
+    {
+      const size_t queues = std::max(m_Info.queues, size_t{1});
+      try
+      {
+        Open(queues);
+      }
+      catch (...)
+      {
+        Close();
+        throw;
+      }
+    }
 
+    virtual ~LinuxInterface()
     {
-      if (m_fd == -1)
-        throw std::runtime_error("cannot open /dev/net/tun " + std::string{strerror(errno)});
+      Close();
+    }
 
+   private:
+    void
+    Open(size_t queues)
+    {
       ifreq ifr{};
       in6_ifreq ifr6{};
       ifr.ifr_flags = IFF_TUN | IFF_NO_PI;
+      if (queues > 1)
+        ifr.ifr_flags |= IFF_MULTI_QUEUE;
+      if (m_Info.offload)
+        ifr.ifr_flags |= IFF_VNET_HDR;
       std::copy_n(
           m_Info.ifname.c_str(),
           std::min(m_Info.ifname.size(), sizeof(ifr.ifr_name)),
           ifr.ifr_name);
-      if (::ioctl(m_fd, TUNSETIFF, &ifr) == -1)
-        throw std::runtime_error("cannot set interface name: " + std::string{strerror(errno)});
+      // every queue is its own fd attached to the same interface; the readers poll theirs so
+      // they are non blocking from the start, and writes wait for room rather than drop
+      for (size_t idx = 0; idx < queues; ++idx)
+      {
+        const int fd = ::open("/dev/net/tun", O_RDWR | (queues > 1 ? O_NONBLOCK : 0));
+        if (fd == -1)
+          throw std::runtime_error("cannot open /dev/net/tun " + std::string{strerror(errno)});
+        m_fds.push_back(fd);
+        if (::ioctl(fd, TUNSETIFF, &ifr) == -1)
+          throw std::runtime_error("cannot set interface name: " + std::string{strerror(errno)});
+      }
+      if (m_Info.offload)
+        SetOffload();
       IOCTL control{AF_INET};
 
       control.ioctl(SIOCGIFFLAGS, &ifr);
@@ -89,26 +141,79 @@ namespace llarp::vpn
       }
       ifr.ifr_flags = static_cast<short>(flags | IFF_UP | IFF_NO_PI);
       control.ioctl(SIOCSIFFLAGS, &ifr);
+
+      if (queues == 1)
+        return;
+      m_Readers = std::make_unique<QueueReaders>(m_Info.ifname, m_fds, m_Info.offload);
+      LogInfo(m_Info.ifname, " reading ", queues, " queues");
     }
 
-    virtual ~LinuxInterface()
+    /// have the kernel put vnet headers on what we read and write, and hand us tcp super
+    /// packets.  the headers stay on even when the kernel won't offload, so reads and writes
+    /// look the same either way.
+    void
+    SetOffload()
     {
-      ::close(m_fd);
+      int hdrsize = sizeof(VNetHeader);
+      if (::ioctl(m_fds[0], TUNSETVNETHDRSZ, &hdrsize) == -1)
+        throw std::runtime_error("cannot set vnet header size: " + std::string{strerror(errno)});
+      const unsigned int offload = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+      if (::ioctl(m_fds[0], TUNSETOFFLOAD, offload) == -1)
+        LogWarn(m_Info.ifname, " cannot offload segmentation: ", strerror(errno));
+      else
+        LogInfo(m_Info.ifname, " offloading tcp segmentation");
+      m_Coalescer = std::make_unique<SegmentCoalescer>(
+          [fd = m_fds[0]](const VNetHeader& hdr, const byte_t* pkt, size_t sz) {
+            iovec iov[2] = {
+                {const_cast<VNetHeader*>(&hdr), sizeof(hdr)},
+                {const_cast<byte_t*>(pkt), sz}};
+            const auto wrote = WriteQueue(fd, iov, 2);
+            return wrote == static_cast<ssize_t>(sizeof(hdr) + sz);
+          });
     }
 
+    void
+    Close()
+    {
+      m_Readers.reset();
+      for (const int fd : m_fds)
+        ::close(fd);
+      m_fds.clear();
+    }
+
+   public:
     int
     PollFD() const override
     {
-      return m_fd;
+      return m_Readers ? m_Readers->PollFD() : m_fds[0];
     }
 
     net::IPPacket
     ReadNextPacket() override
     {
       net::IPPacket pkt;
-      const auto sz = read(m_fd, pkt.buf, sizeof(pkt.buf));
+      if (m_Readers)
+        return m_Readers->Next();
+      if (m_Info.offload)
+      {
+        // one super packet read makes a batch of the packets it is split into
+        while (m_BatchPos == m_Batch.num)
+        {
+          m_Batch.pkts.clear();
+          m_Batch.num = m_BatchPos = 0;
+          const auto sz = ReadOffloaded(m_fds[0], m_ReadBuf, m_Batch.pkts, m_Info.ifname);
+          if (sz == 0 or (sz < 0 and (errno == EAGAIN || errno == EWOULDBLOCK)))
+            return pkt;
+          if (sz < 0)
+            throw std::error_code{errno, std::system_category()};
+          m_Batch.num = m_Batch.pkts.size();
+        }
+        return std::move(m_Batch.pkts[m_BatchPos++]);
+      }
+      pkt = net::IPPacket{net::IPPacket::MaxSize};
+      const auto sz = read(m_fds[0], pkt.buf, pkt.Capacity());
       if (sz >= 0)
-        pkt.sz = std::min(sz, ssize_t{sizeof(pkt.buf)});
+        pkt.sz = sz;
       else if (errno == EAGAIN || errno == EWOULDBLOCK)
         pkt.sz = 0;
       else
@@ -116,15 +221,48 @@ namespace llarp::vpn
       return pkt;
     }
 
+    size_t
+    ReadPackets(net::IPPacket* pkts, size_t num) override
+    {
+      if (m_Info.offload or m_Readers)
+        return NetworkInterface::ReadPackets(pkts, num);
+      // read straight into the caller's packets, reusing what buffers they still hold
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        auto& pkt = pkts[idx];
+        if (pkt.Capacity() < net::IPPacket::MaxSize)
+          pkt = net::IPPacket{net::IPPacket::MaxSize};
+        const auto sz = read(m_fds[0], pkt.buf, pkt.Capacity());
+        if (sz > 0)
+        {
+          pkt.sz = sz;
+          continue;
+        }
+        if (sz < 0 and errno != EAGAIN and errno != EWOULDBLOCK)
+          throw std::error_code{errno, std::system_category()};
+        return idx;
+      }
+      return num;
+    }
+
     bool
     WritePacket(net::IPPacket pkt) override
     {
-      const auto sz = write(m_fd, pkt.buf, pkt.sz);
+      if (m_Coalescer)
+        return m_Coalescer->Add(pkt);
+      iovec iov{pkt.buf, pkt.sz};
+      const auto sz = WriteQueue(m_fds[0], &iov, 1);
       if (sz <= 0)
         return false;
       return sz == static_cast<ssize_t>(pkt.sz);
     }
 
+    bool
+    FlushWrites() override
+    {
+      return m_Coalescer == nullptr or m_Coalescer->Flush();
+    }
+
     std::string
     IfName() const override
     {
@@ -0,0 +1,307 @@
+#include "offload.hpp"
+
+#include <oxenc/endian.h>
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace llarp::vpn
+{
+  namespace
+  {
+    constexpr uint8_t IPProtoTCP = 6;
+    constexpr size_t IPv6HeaderSize = 40;
+
+    constexpr uint8_t TCPFin = 0x01;
+    constexpr uint8_t TCPPsh = 0x08;
+    constexpr uint8_t TCPAck = 0x10;
+    constexpr uint8_t TCPCwr = 0x80;
+
+    // offsets into a tcp header
+    constexpr size_t TCPSeq = 4;
+    constexpr size_t TCPOffset = 12;
+    constexpr size_t TCPFlags = 13;
+    constexpr size_t TCPCheck = 16;
+
+    /// where a tcp packet's headers end
+    struct TCPHeaders
+    {
+      bool v6 = false;
+      size_t ip = 0;
+      size_t tcp = 0;
+
+      size_t
+      Size() const
+      {
+        return ip + tcp;
+      }
+    };
+
+    /// the headers of an unfragmented tcp packet with no ipv6 extension headers
+    std::optional<TCPHeaders>
+    ParseTCP(const byte_t* pkt, size_t sz)
+    {
+      TCPHeaders hdrs;
+      if (sz < 1)
+        return std::nullopt;
+      switch (pkt[0] >> 4)
+      {
+        case 4:
+          hdrs.ip = (pkt[0] & 0x0f) * 4;
+          if (hdrs.ip < 20 or sz < hdrs.ip or pkt[9] != IPProtoTCP
+              or (oxenc::load_big_to_host<uint16_t>(pkt + 6) & 0x3fff))
+            return std::nullopt;
+          break;
+        case 6:
+          hdrs.v6 = true;
+          hdrs.ip = IPv6HeaderSize;
+          if (sz < hdrs.ip or pkt[6] != IPProtoTCP)
+            return std::nullopt;
+          break;
+        default:
+          return std::nullopt;
+      }
+      if (sz < hdrs.ip + 20)
+        return std::nullopt;
+      hdrs.tcp = (pkt[hdrs.ip + TCPOffset] >> 4) * 4;
+      if (hdrs.tcp < 20 or sz < hdrs.Size())
+        return std::nullopt;
+      return hdrs;
+    }
+
+    /// one's complement sum of the tcp pseudo header, unfolded
+    uint32_t
+    PseudoSum(const byte_t* pkt, const TCPHeaders& hdrs, size_t l4len)
+    {
+      // laid out as the ipv6 pseudo header's tail, which sums the same as ipv4's for l4len
+      // under 64k
+      byte_t tail[8]{};
+      oxenc::write_host_as_big<uint32_t>(l4len, tail);
+      tail[7] = IPProtoTCP;
+      uint32_t sum = 0;
+      const auto add = [&sum](const byte_t* buf, size_t sz) {
+        for (size_t idx = 0; idx + 1 < sz; idx += 2)
+        {
+          uint16_t word;
+          std::memcpy(&word, buf + idx, sizeof(word));
+          sum += word;
+        }
+      };
+      if (hdrs.v6)
+        add(pkt + 8, 32);
+      else
+        add(pkt + 12, 8);
+      add(tail, sizeof(tail));
+      return sum;
+    }
+
+    uint16_t
+    Fold(uint32_t sum)
+    {
+      sum = (sum & 0xFFff) + (sum >> 16);
+      sum += sum >> 16;
+      return sum;
+    }
+
+    void
+    SetIPLength(byte_t* pkt, const TCPHeaders& hdrs, size_t sz)
+    {
+      if (hdrs.v6)
+      {
+        oxenc::write_host_as_big<uint16_t>(sz - IPv6HeaderSize, pkt + 4);
+        return;
+      }
+      oxenc::write_host_as_big<uint16_t>(sz, pkt + 2);
+      std::fill_n(pkt + 10, 2, 0);
+      const auto check = net::ipchksum(pkt, hdrs.ip);
+      std::memcpy(pkt + 10, &check, sizeof(check));
+    }
+
+    /// the ip header and tcp payload size of a packet the coalescer may hold
+    std::optional<std::pair<TCPHeaders, size_t>>
+    Coalescable(const byte_t* pkt, size_t sz)
+    {
+      const auto hdrs = ParseTCP(pkt, sz);
+      if (not hdrs)
+        return std::nullopt;
+      const size_t len = hdrs->v6 ? oxenc::load_big_to_host<uint16_t>(pkt + 4) + IPv6HeaderSize
+                                  : oxenc::load_big_to_host<uint16_t>(pkt + 2);
+      // no ipv4 options, no empty segments, and nothing but acks that may be pushed
+      const auto flags = pkt[hdrs->ip + TCPFlags];
+      if (len != sz or (not hdrs->v6 and hdrs->ip != 20) or sz == hdrs->Size()
+          or (flags & ~TCPPsh) != TCPAck)
+        return std::nullopt;
+      return std::make_pair(*hdrs, sz - hdrs->Size());
+    }
+  }  // namespace
+
+  bool
+  SplitOffloaded(
+      const VNetHeader& hdr, const byte_t* data, size_t sz, std::vector<net::IPPacket>& out)
+  {
+    const auto gso = hdr.gso_type & ~VNetHeader::GSOECN;
+    if (gso == VNetHeader::GSONone)
+    {
+      const size_t check = size_t{hdr.csum_start} + hdr.csum_offset;
+      if (sz > net::IPPacket::MaxSize
+          or ((hdr.flags & VNetHeader::NeedsChecksum) and check + 2 > sz))
+        return false;
+      auto& pkt = out.emplace_back(sz);
+      std::copy_n(data, sz, pkt.buf);
+      pkt.sz = sz;
+      if (hdr.flags & VNetHeader::NeedsChecksum)
+      {
+        // the checksum field holds the pseudo header's sum, so summing from csum_start on
+        // gives the whole checksum
+        uint16_t sum = net::ipchksum(pkt.buf + hdr.csum_start, sz - hdr.csum_start);
+        if (sum == 0)
+          sum = 0xFFff;
+        std::memcpy(pkt.buf + check, &sum, sizeof(sum));
+      }
+      return true;
+    }
+    if (gso != VNetHeader::GSOTCPv4 and gso != VNetHeader::GSOTCPv6)
+      return false;
+
+    const auto hdrs = ParseTCP(data, sz);
+    if (not hdrs or hdrs->v6 != (gso == VNetHeader::GSOTCPv6) or hdr.gso_size == 0
+        or sz <= hdrs->Size() or hdrs->Size() + hdr.gso_size > net::IPPacket::MaxSize)
+      return false;
+
+    const auto headers = hdrs->Size();
+    const auto seq = oxenc::load_big_to_host<uint32_t>(data + hdrs->ip + TCPSeq);
+    const auto id = hdrs->v6 ? 0 : oxenc::load_big_to_host<uint16_t>(data + 4);
+    const auto flags = data[hdrs->ip + TCPFlags];
+    for (size_t pos = headers, idx = 0; pos < sz; pos += hdr.gso_size, ++idx)
+    {
+      const auto len = std::min<size_t>(hdr.gso_size, sz - pos);
+      auto& pkt = out.emplace_back(headers + len);
+      std::copy_n(data, headers, pkt.buf);
+      std::copy_n(data + pos, len, pkt.buf + headers);
+      pkt.sz = headers + len;
+
+      auto* tcp = pkt.buf + hdrs->ip;
+      oxenc::write_host_as_big<uint32_t>(seq + (pos - headers), tcp + TCPSeq);
+      // fin and push belong to the last segment, congestion window reduced to the first
+      auto segflags = flags;
+      if (pos + len < sz)
+        segflags &= ~(TCPFin | TCPPsh);
+      if (idx > 0)
+        segflags &= ~TCPCwr;
+      tcp[TCPFlags] = segflags;
+
+      if (not hdrs->v6)
+        oxenc::write_host_as_big<uint16_t>(id + idx, pkt.buf + 4);
+      SetIPLength(pkt.buf, *hdrs, pkt.sz);
+
+      const auto l4len = pkt.sz - hdrs->ip;
+      std::fill_n(tcp + TCPCheck, 2, 0);
+      const auto check = net::ipchksum(tcp, l4len, PseudoSum(pkt.buf, *hdrs, l4len));
+      std::memcpy(tcp + TCPCheck, &check, sizeof(check));
+    }
+    return true;
+  }
+
+  SegmentCoalescer::SegmentCoalescer(Write_t write) : m_Write{std::move(write)}
+  {
+    m_Held.reserve(MaxSize);
+  }
+
+  bool
+  SegmentCoalescer::Joins(const byte_t* pkt, size_t sz) const
+  {
+    const auto parsed = Coalescable(pkt, sz);
+    if (not parsed)
+      return false;
+    const auto& [hdrs, payload] = *parsed;
+    const auto* held = m_Held.data();
+    if (hdrs.Size() != m_HeaderSize or payload > m_SegmentSize
+        or m_Held.size() + payload > MaxSize or (held[0] >> 4) != (pkt[0] >> 4))
+      return false;
+
+    const auto same = [held, pkt](size_t from, size_t to) {
+      return std::equal(held + from, held + to, pkt + from);
+    };
+    // the same flow with everything but the lengths, ids and checksums alike
+    if (hdrs.v6 ? not(same(0, 4) and same(6, IPv6HeaderSize))
+                : not(same(0, 2) and same(6, 10) and same(12, 20)))
+      return false;
+    const auto* tcp = pkt + hdrs.ip;
+    const auto ip = hdrs.ip;
+    return same(ip, ip + TCPSeq)
+        and oxenc::load_big_to_host<uint32_t>(tcp + TCPSeq) == m_NextSeq
+        and same(ip + 8, ip + TCPFlags) and (tcp[TCPFlags] & ~TCPPsh) == held[ip + TCPFlags]
+        and same(ip + 14, ip + TCPCheck) and same(ip + 18, m_HeaderSize);
+  }
+
+  bool
+  SegmentCoalescer::Add(const net::IPPacket& pkt)
+  {
+    if (m_Segments and Joins(pkt.buf, pkt.sz))
+    {
+      const auto payload = pkt.sz - m_HeaderSize;
+      m_Held.insert(m_Held.end(), pkt.buf + m_HeaderSize, pkt.buf + pkt.sz);
+      m_Segments++;
+      m_NextSeq += payload;
+      const auto flags = pkt.buf[m_IPHeaderSize + TCPFlags];
+      // a short or pushed segment ends the run, as does one that would leave no room
+      if (payload < m_SegmentSize or (flags & TCPPsh)
+          or m_Held.size() + m_SegmentSize > MaxSize)
+      {
+        m_Held[m_IPHeaderSize + TCPFlags] |= flags & TCPPsh;
+        return Flush();
+      }
+      return true;
+    }
+    const bool flushed = Flush();
+    const auto parsed = Coalescable(pkt.buf, pkt.sz);
+    if (not parsed or (pkt.buf[parsed->first.ip + TCPFlags] & TCPPsh))
+      return m_Write(VNetHeader{}, pkt.buf, pkt.sz) and flushed;
+    const auto& [hdrs, payload] = *parsed;
+    m_Held.assign(pkt.buf, pkt.buf + pkt.sz);
+    m_Segments = 1;
+    m_IPHeaderSize = hdrs.ip;
+    m_HeaderSize = hdrs.Size();
+    m_SegmentSize = payload;
+    m_NextSeq = oxenc::load_big_to_host<uint32_t>(pkt.buf + hdrs.ip + TCPSeq) + payload;
+    return flushed;
+  }
+
+  bool
+  SegmentCoalescer::Flush()
+  {
+    if (m_Segments == 0)
+      return true;
+    auto* pkt = m_Held.data();
+    const auto sz = m_Held.size();
+    bool wrote;
+    if (m_Segments == 1)
+    {
+      wrote = m_Write(VNetHeader{}, pkt, sz);
+    }
+    else
+    {
+      TCPHeaders hdrs;
+      hdrs.v6 = (pkt[0] >> 4) == 6;
+      hdrs.ip = m_IPHeaderSize;
+      hdrs.tcp = m_HeaderSize - hdrs.ip;
+      SetIPLength(pkt, hdrs, sz);
+      // the kernel completes the checksum over the segments it makes from this
+      const auto partial = Fold(PseudoSum(pkt, hdrs, sz - hdrs.ip));
+      std::memcpy(pkt + hdrs.ip + TCPCheck, &partial, sizeof(partial));
+
+      VNetHeader hdr;
+      hdr.flags = VNetHeader::NeedsChecksum;
+      hdr.gso_type = hdrs.v6 ? VNetHeader::GSOTCPv6 : VNetHeader::GSOTCPv4;
+      hdr.hdr_len = m_HeaderSize;
+      hdr.gso_size = m_SegmentSize;
+      hdr.csum_start = hdrs.ip;
+      hdr.csum_offset = TCPCheck;
+      wrote = m_Write(hdr, pkt, sz);
+    }
+    m_Held.clear();
+    m_Segments = 0;
+    return wrote;
+  }
+}  // namespace llarp::vpn
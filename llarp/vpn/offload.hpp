@@ -0,0 +1,81 @@
+#pragma once
+
+#include <llarp/net/ip_packet.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace llarp::vpn
+{
+  /// what the kernel puts in front of every packet on a tun opened with IFF_VNET_HDR, laid out
+  /// as struct virtio_net_hdr in host byte order
+  struct VNetHeader
+  {
+    /// the l4 checksum is only the pseudo header's and has to be completed
+    static constexpr uint8_t NeedsChecksum = 1;
+
+    static constexpr uint8_t GSONone = 0;
+    static constexpr uint8_t GSOTCPv4 = 1;
+    static constexpr uint8_t GSOTCPv6 = 4;
+    static constexpr uint8_t GSOECN = 0x80;
+
+    uint8_t flags = 0;
+    uint8_t gso_type = GSONone;
+    /// ip and tcp header size of a super packet
+    uint16_t hdr_len = 0;
+    /// tcp payload per segment of a super packet
+    uint16_t gso_size = 0;
+    uint16_t csum_start = 0;
+    uint16_t csum_offset = 0;
+  };
+
+  static_assert(sizeof(VNetHeader) == 10);
+
+  /// turn a packet read off an offloading tun into the packets it stands for: tcp super packets
+  /// are cut into gso_size segments, and partial checksums are completed.  appends to out and
+  /// returns false, leaving out as it was, if it can't be made into packets that fit IPPacket.
+  /// this is done where the interface is read, not at onion framing: offload saves tun syscalls
+  /// and kernel segmentation, but each segment is still framed, encrypted and sent on its own.
+  bool
+  SplitOffloaded(
+      const VNetHeader& hdr, const byte_t* data, size_t sz, std::vector<net::IPPacket>& out);
+
+  /// joins consecutive tcp segments of a flow that are written to an offloading tun into super
+  /// packets, as GRO would, so the kernel takes a run of them in one write
+  class SegmentCoalescer
+  {
+   public:
+    /// the most an ip packet can hold
+    static constexpr size_t MaxSize = 65535;
+
+    /// writes a packet out, false if it was dropped
+    using Write_t = std::function<bool(const VNetHeader&, const byte_t*, size_t)>;
+
+    explicit SegmentCoalescer(Write_t write);
+
+    /// take a packet to write; it is held while the next one may join it.  returns false if a
+    /// write this made, of pkt or of what was held before it, was dropped.
+    bool
+    Add(const net::IPPacket& pkt);
+
+    /// write what is held, false if it was dropped
+    bool
+    Flush();
+
+   private:
+    /// true if pkt can go at the end of what we hold
+    bool
+    Joins(const byte_t* pkt, size_t sz) const;
+
+    Write_t m_Write;
+    /// the super packet being built, headers of its first segment and every payload
+    std::vector<byte_t> m_Held;
+    size_t m_Segments = 0;
+    size_t m_IPHeaderSize = 0;
+    /// ip and tcp headers
+    size_t m_HeaderSize = 0;
+    uint16_t m_SegmentSize = 0;
+    uint32_t m_NextSeq = 0;
+  };
+}  // namespace llarp::vpn
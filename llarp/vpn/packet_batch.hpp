@@ -0,0 +1,64 @@
+#pragma once
+#include <llarp/net/ip.hpp>
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/net/net_int.hpp>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace llarp::vpn
+{
+  /// where a packet from the user is going.  with exits on every v4 address is one
+  /// destination, however it was written.
+  inline huint128_t
+  PacketDestination(const net::IPPacket& pkt, bool exitEnabled)
+  {
+    auto dst = pkt.IsV4() ? pkt.dst4to6() : pkt.dstv6();
+    if (exitEnabled)
+      dst = net::ExpandV4(net::TruncateV6(dst));
+    return dst;
+  }
+
+  /// group a batch of packets from the user by destination, so each destination is looked up
+  /// once a batch, and call visit(dst, pkts, num) for each with its packets in the order they
+  /// were read.  visit may move from the packets.  returns true if any visit did.
+  template <typename Visit_t>
+  bool
+  VisitByDestination(std::vector<net::IPPacket>& pkts, bool exitEnabled, Visit_t&& visit)
+  {
+    std::vector<std::pair<huint128_t, net::IPPacket*>> dests;
+    dests.reserve(pkts.size());
+    for (auto& pkt : pkts)
+      dests.emplace_back(PacketDestination(pkt, exitEnabled), &pkt);
+    std::stable_sort(dests.begin(), dests.end(), [](const auto& left, const auto& right) {
+      return left.first < right.first;
+    });
+
+    std::vector<net::IPPacket*> group;
+    bool any = false;
+    for (auto itr = dests.begin(); itr != dests.end();)
+    {
+      const auto dst = itr->first;
+      group.clear();
+      for (; itr != dests.end() and itr->first == dst; ++itr)
+        group.push_back(itr->second);
+      any |= visit(dst, group.data(), group.size());
+    }
+    return any;
+  }
+
+  /// tell the senders of packets we have nowhere to send that their destination is
+  /// unreachable, calling write(icmp, src) with each reply and who it is for
+  template <typename Write_t>
+  void
+  ReplyUnreachable(net::IPPacket* const* pkts, size_t num, Write_t&& write)
+  {
+    for (size_t idx = 0; idx < num; ++idx)
+    {
+      const auto& pkt = *pkts[idx];
+      if (const auto icmp = pkt.MakeICMPUnreachable())
+        write(*icmp, pkt.IsV4() ? pkt.src4to6() : pkt.srcv6());
+    }
+  }
+}  // namespace llarp::vpn
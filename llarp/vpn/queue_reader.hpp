@@ -0,0 +1,297 @@
+#pragma once
+
+#include "offload.hpp"
+
+#include <llarp/net/ip_packet.hpp>
+#include <llarp/util/logging/logger.hpp>
+#include <llarp/util/thread/queue.hpp>
+#include <llarp/util/thread/threading.hpp>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace llarp::vpn
+{
+  /// read a packet off a tun queue opened with vnet headers into out, split into the packets it
+  /// stands for.  returns what read did.
+  inline ssize_t
+  ReadOffloaded(
+      int fd, std::vector<byte_t>& buf, std::vector<net::IPPacket>& out, const std::string& ifname)
+  {
+    buf.resize(sizeof(VNetHeader) + SegmentCoalescer::MaxSize);
+    const auto sz = ::read(fd, buf.data(), buf.size());
+    if (sz < static_cast<ssize_t>(sizeof(VNetHeader)))
+      return sz;
+    VNetHeader hdr;
+    std::memcpy(&hdr, buf.data(), sizeof(hdr));
+    if (not SplitOffloaded(hdr, buf.data() + sizeof(hdr), sz - sizeof(hdr), out))
+      LogWarn(ifname, " dropped a super packet we cannot split, gso size ", hdr.gso_size);
+    return sz;
+  }
+
+  /// how long a write waits for room on a non blocking queue before it gives up
+  constexpr int WriteWaitMS = 100;
+
+  /// write iov to a tun queue.  the queues of a multi queue tun are non blocking for their
+  /// readers, so when the kernel has no room we wait for some rather than drop the packet.
+  /// returns what writev did.
+  inline ssize_t
+  WriteQueue(int fd, const iovec* iov, int num)
+  {
+    for (;;)
+    {
+      const auto sz = ::writev(fd, iov, num);
+      if (sz >= 0)
+        return sz;
+      if (errno == EINTR)
+        continue;
+      if (errno != EAGAIN and errno != EWOULDBLOCK)
+        return sz;
+      pollfd pfd{fd, POLLOUT, 0};
+      const auto ready = ::poll(&pfd, 1, WriteWaitMS);
+      if (ready == 0)
+      {
+        errno = EAGAIN;
+        return -1;
+      }
+      if (ready == -1 and errno != EINTR)
+        return -1;
+    }
+  }
+
+  /// reads every queue of a multi queue tun on a thread of its own.  the kernel puts each flow
+  /// on one queue, so handing each queue's batches to the event loop in order keeps every flow
+  /// in order.
+  class QueueReaders
+  {
+    /// packets read off one queue in one go, recycled once the event loop is through with them
+    struct PacketBatch
+    {
+      std::vector<net::IPPacket> pkts;
+      size_t num = 0;
+    };
+
+    struct Reader
+    {
+      int fd;
+      /// what offloaded packets are read into before they are split
+      std::vector<byte_t> buf;
+      thread::Queue<PacketBatch> batches;
+      thread::Queue<PacketBatch> free;
+      std::thread thread;
+
+      Reader(int _fd, size_t queued) : fd{_fd}, batches{queued}, free{queued}
+      {}
+    };
+
+    const std::string m_IfName;
+    const bool m_Offload;
+    /// signalled by the readers when they hand over a batch, and what the event loop polls on
+    int m_WakeFD = -1;
+    /// signalled to stop the readers
+    int m_StopFD = -1;
+    std::vector<std::unique_ptr<Reader>> m_Readers;
+    /// the batch the event loop is reading packets out of and the reader it came from
+    PacketBatch m_Batch;
+    size_t m_BatchPos = 0;
+    Reader* m_BatchReader = nullptr;
+    size_t m_NextReader = 0;
+
+    void
+    ReadQueue(Reader& reader)
+    {
+      pollfd fds[2] = {{reader.fd, POLLIN, 0}, {m_StopFD, POLLIN, 0}};
+      for (;;)
+      {
+        if (::poll(fds, 2, -1) == -1)
+        {
+          if (errno == EINTR)
+            continue;
+          LogError("cannot poll ", m_IfName, ": ", strerror(errno));
+          return;
+        }
+        if (fds[1].revents)
+          return;
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+          LogError(m_IfName, " queue went away");
+          return;
+        }
+        auto batch = reader.free.tryPopFront().value_or(PacketBatch{});
+        if (m_Offload)
+          batch.pkts.clear();
+        else
+          batch.pkts.resize(ReadBatchSize);
+        batch.num = 0;
+        while (batch.num < ReadBatchSize)
+        {
+          if (m_Offload)
+          {
+            if (ReadOffloaded(reader.fd, reader.buf, batch.pkts, m_IfName) <= 0)
+              break;
+            batch.num = batch.pkts.size();
+            continue;
+          }
+          auto& pkt = batch.pkts[batch.num];
+          if (pkt.Capacity() < net::IPPacket::MaxSize)
+            pkt = net::IPPacket{net::IPPacket::MaxSize};
+          const auto sz = ::read(reader.fd, pkt.buf, pkt.Capacity());
+          if (sz <= 0)
+            break;
+          pkt.sz = sz;
+          batch.num++;
+        }
+        if (batch.num == 0)
+          continue;
+        // waits here while the event loop is behind, and the kernel drops off this queue
+        if (reader.batches.pushBack(std::move(batch)) != thread::QueueReturn::Success)
+          return;
+        const uint64_t one = 1;
+        [[maybe_unused]] const auto wrote = ::write(m_WakeFD, &one, sizeof(one));
+      }
+    }
+
+    /// make sure m_Batch has a packet left to read if any queue has one
+    bool
+    NextBatch()
+    {
+      if (m_BatchPos < m_Batch.num)
+        return true;
+      if (m_BatchReader)
+      {
+        m_BatchReader->free.tryPushBack(std::move(m_Batch));
+        m_BatchReader = nullptr;
+        m_Batch = PacketBatch{};
+        m_BatchPos = 0;
+      }
+      // look once more after clearing the wakeup, so a batch handed over in between is
+      // either seen now or wakes us again
+      for (int attempt = 0; attempt < 2; ++attempt)
+      {
+        for (size_t idx = 0; idx < m_Readers.size(); ++idx)
+        {
+          auto& reader = *m_Readers[m_NextReader];
+          m_NextReader = (m_NextReader + 1) % m_Readers.size();
+          if (auto maybe = reader.batches.tryPopFront())
+          {
+            m_Batch = std::move(*maybe);
+            m_BatchReader = &reader;
+            return true;
+          }
+        }
+        uint64_t count;
+        [[maybe_unused]] const auto got = ::read(m_WakeFD, &count, sizeof(count));
+      }
+      return false;
+    }
+
+    void
+    CloseEvents()
+    {
+      for (const int fd : {m_WakeFD, m_StopFD})
+      {
+        if (fd != -1)
+          ::close(fd);
+      }
+      m_WakeFD = m_StopFD = -1;
+    }
+
+   public:
+    /// most packets a queue reader reads before handing them to the event loop
+    static constexpr size_t ReadBatchSize = 64;
+    /// batches a queue reader can have waiting on the event loop before it waits as well
+    static constexpr size_t QueuedBatches = 16;
+
+    /// start a thread reading each of fds, which must be non blocking and are left to the
+    /// caller to close once we are stopped
+    QueueReaders(std::string ifname, const std::vector<int>& fds, bool offload)
+        : m_IfName{std::move(ifname)}, m_Offload{offload}
+    {
+      m_WakeFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      m_StopFD = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+      if (m_WakeFD == -1 or m_StopFD == -1)
+      {
+        const std::string err = strerror(errno);
+        CloseEvents();
+        throw std::runtime_error("cannot make eventfd: " + err);
+      }
+      for (const int fd : fds)
+        m_Readers.emplace_back(std::make_unique<Reader>(fd, QueuedBatches));
+      try
+      {
+        for (size_t idx = 0; idx < m_Readers.size(); ++idx)
+        {
+          m_Readers[idx]->thread = std::thread{[this, idx] {
+            util::SetThreadName(m_IfName + "-q" + std::to_string(idx));
+            ReadQueue(*m_Readers[idx]);
+          }};
+        }
+      }
+      catch (...)
+      {
+        Stop();
+        CloseEvents();
+        throw;
+      }
+    }
+
+    QueueReaders(const QueueReaders&) = delete;
+    QueueReaders&
+    operator=(const QueueReaders&) = delete;
+
+    ~QueueReaders()
+    {
+      Stop();
+      CloseEvents();
+    }
+
+    /// readable when a reader has handed over a batch
+    int
+    PollFD() const
+    {
+      return m_WakeFD;
+    }
+
+    /// the next packet read off any queue, or an empty packet if none are waiting
+    net::IPPacket
+    Next()
+    {
+      if (not NextBatch())
+        return net::IPPacket{};
+      return std::move(m_Batch.pkts[m_BatchPos++]);
+    }
+
+    /// stop every reader and wait for them to finish, whether they are waiting on their
+    /// queue or on the event loop
+    void
+    Stop()
+    {
+      if (m_Readers.empty())
+        return;
+      const uint64_t one = 1;
+      [[maybe_unused]] const auto wrote = ::write(m_StopFD, &one, sizeof(one));
+      for (auto& reader : m_Readers)
+        reader->batches.disable();
+      for (auto& reader : m_Readers)
+      {
+        if (reader->thread.joinable())
+          reader->thread.join();
+      }
+      m_Readers.clear();
+      m_Batch = PacketBatch{};
+      m_BatchPos = 0;
+      m_BatchReader = nullptr;
+      m_NextReader = 0;
+    }
+  };
+}  // namespace llarp::vpn
@@ -465,7 +465,9 @@ namespace llarp::vpn
       void
       Read(HANDLE dev)
       {
-        ReadFile(dev, pkt.buf, sizeof(pkt.buf), nullptr, &hdr);
+        if (pkt.Capacity() < net::IPPacket::MaxSize)
+          pkt = net::IPPacket{net::IPPacket::MaxSize};
+        ReadFile(dev, pkt.buf, pkt.Capacity(), nullptr, &hdr);
       }
     };
 
@@ -476,8 +478,7 @@ namespace llarp::vpn
     {
       LogDebug("write packet ", pkt.sz);
       asio_evt_pkt* ev = new asio_evt_pkt{false};
-      std::copy_n(pkt.buf, pkt.sz, ev->pkt.buf);
-      ev->pkt.sz = pkt.sz;
+      ev->pkt = std::move(pkt);
       WriteFile(m_Device, ev->pkt.buf, ev->pkt.sz, nullptr, &ev->hdr);
       return true;
     }
@@ -499,7 +500,7 @@ namespace llarp::vpn
         if (pkt->read)
         {
           pkt->pkt.sz = size;
-          m_ReadQueue.pushBack(pkt->pkt);
+          m_ReadQueue.pushBack(std::move(pkt->pkt));
           pkt->Read(m_Device);
         }
         else
@@ -1,6 +1,10 @@
 #include <crypto/crypto_libsodium.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <vector>
 
 #include <catch2/catch.hpp>
 
@@ -48,6 +52,99 @@ TEST_CASE("PQ crypto")
   REQUIRE(otherShared == shared);
 }
 
+namespace
+{
+  struct CryptoBatch
+  {
+    std::vector<std::vector<byte_t>> buffers;
+    std::vector<TunnelNonce> nonces;
+    std::vector<CryptoBatchItem> items;
+
+    CryptoBatch(size_t num, std::function<size_t(size_t)> sizeOf)
+        : buffers(num), nonces(num), items(num)
+    {
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        buffers[idx].resize(sizeOf(idx));
+        std::generate(buffers[idx].begin(), buffers[idx].end(), [n = idx]() mutable {
+          return static_cast<byte_t>(n++ * 31);
+        });
+        nonces[idx].Randomize();
+        items[idx] = CryptoBatchItem{buffers[idx].data(), buffers[idx].size(), nonces[idx].data()};
+      }
+    }
+  };
+}  // namespace
+
+TEST_CASE("batched xchacha20 matches one at a time", "[crypto]")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  SharedSecret key;
+  key.Randomize();
+  const size_t num = GENERATE(1, 2, 7, 8, 9, 16, 33, 64);
+  CryptoBatch batch{num, [](size_t idx) { return (idx * 197) % 1500; }};
+  auto expected = batch.buffers;
+
+  REQUIRE(crypto.xchacha20_batch(batch.items.data(), batch.items.size(), key));
+  for (size_t idx = 0; idx < num; ++idx)
+  {
+    const llarp_buffer_t buf{expected[idx]};
+    REQUIRE(crypto.xchacha20(buf, key, batch.nonces[idx]));
+    REQUIRE(batch.buffers[idx] == expected[idx]);
+  }
+}
+
+TEST_CASE("batched hmac matches one at a time", "[crypto]")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  SharedSecret key;
+  key.Randomize();
+  CryptoBatch batch{16, [](size_t idx) { return idx * 100; }};
+  std::vector<ShortHash> digests(batch.items.size());
+  for (size_t idx = 0; idx < digests.size(); ++idx)
+    batch.items[idx].digest = digests[idx].data();
+
+  REQUIRE(crypto.hmac_batch(batch.items.data(), batch.items.size(), key));
+  for (size_t idx = 0; idx < digests.size(); ++idx)
+  {
+    ShortHash expected;
+    REQUIRE(crypto.hmac(expected.data(), llarp_buffer_t{batch.buffers[idx]}, key));
+    REQUIRE(digests[idx] == expected);
+  }
+}
+
+TEST_CASE("xchacha20 throughput, one at a time vs batched", "[.][bench][crypto]")
+{
+  llarp::sodium::CryptoLibSodium crypto;
+  SharedSecret key;
+  key.Randomize();
+  constexpr size_t batchSize = 64;
+  constexpr size_t totalBytes = size_t{1} << 30;
+  for (const size_t size : {64, 256, 512, 1024, 1400})
+  {
+    CryptoBatch batch{batchSize, [size](size_t) { return size; }};
+    const size_t rounds = totalBytes / (size * batchSize);
+
+    auto started = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+    {
+      for (size_t idx = 0; idx < batchSize; ++idx)
+        crypto.xchacha20(llarp_buffer_t{batch.buffers[idx]}, key, batch.nonces[idx]);
+    }
+    const std::chrono::duration<double> scalar = std::chrono::steady_clock::now() - started;
+
+    started = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+      crypto.xchacha20_batch(batch.items.data(), batch.items.size(), key);
+    const std::chrono::duration<double> batched = std::chrono::steady_clock::now() - started;
+
+    const double gb = double(rounds * batchSize * size) / 1e9;
+    WARN(
+        size << " byte packets (" << simd::xchacha20_backend() << "): one at a time "
+             << (gb / scalar.count()) << " GB/s, batched " << (gb / batched.count()) << " GB/s");
+  }
+}
+
 #ifdef HAVE_CRYPT
 
 TEST_CASE("passwd hash valid")
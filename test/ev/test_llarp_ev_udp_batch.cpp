@@ -0,0 +1,164 @@
+#include <ev/ev.hpp>
+#include <ev/udp_handle.hpp>
+#include <net/sock_addr.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+
+#include <catch2/catch.hpp>
+
+using namespace std::literals;
+
+#ifndef _WIN32
+namespace
+{
+  /// the locally bound address of a udp handle listening on an ephemeral loopback port
+  llarp::SockAddr
+  BoundAddr(llarp::UDPHandle& udp)
+  {
+    sockaddr_storage addr{};
+    socklen_t len = sizeof(addr);
+    REQUIRE(udp.file_descriptor());
+    REQUIRE(getsockname(*udp.file_descriptor(), reinterpret_cast<sockaddr*>(&addr), &len) == 0);
+    return llarp::SockAddr{*reinterpret_cast<const sockaddr*>(&addr)};
+  }
+
+  struct PPSResult
+  {
+    size_t received;
+    std::chrono::duration<double> elapsed;
+
+    double
+    pps() const
+    {
+      return received / elapsed.count();
+    }
+  };
+
+  /// blasts `count` datagrams of `size` bytes at a udp handle over loopback, sending in batches of
+  /// `udp_batch_size`, and measures how long it takes the event loop to receive them.
+  PPSResult
+  MeasureRecv(bool batched, size_t count, size_t size)
+  {
+    auto loop = llarp::EventLoop::create();
+    std::atomic<size_t> received{0};
+    std::shared_ptr<llarp::UDPHandle> recv;
+    if (batched)
+      recv = loop->make_batched_udp(
+          [&](llarp::UDPHandle&, const std::vector<llarp::UDPDatagram>& pkts) {
+            received += pkts.size();
+          });
+    else
+      recv = loop->make_udp([&](llarp::UDPHandle&, llarp::SockAddr, llarp::OwnedBuffer) {
+        received++;
+      });
+    auto send = loop->make_udp([](llarp::UDPHandle&, llarp::SockAddr, llarp::OwnedBuffer) {});
+    REQUIRE(recv->listen(llarp::SockAddr{"127.0.0.1:0"}));
+    REQUIRE(send->listen(llarp::SockAddr{"127.0.0.1:0"}));
+    const auto to = BoundAddr(*recv);
+
+    std::thread runner{[loop] { loop->run(); }};
+
+    std::vector<byte_t> payload(size, 0x42);
+    std::vector<llarp::UDPDatagram> batch;
+    for (size_t idx = 0; idx < llarp::udp_batch_size; ++idx)
+      batch.push_back(llarp::UDPDatagram{to, payload.data(), payload.size()});
+
+    const auto started = std::chrono::steady_clock::now();
+    size_t sent = 0;
+    while (sent < count)
+    {
+      const auto result = send->send_batch(batch);
+      // queued datagrams go out once the socket has room
+      sent += result.sent + result.queued;
+      // let the receiver catch up rather than overflowing the socket buffer
+      while (sent - received > 4 * llarp::udp_batch_size
+             and std::chrono::steady_clock::now() - started < 10s)
+        std::this_thread::yield();
+    }
+    while (received < count and std::chrono::steady_clock::now() - started < 10s)
+      std::this_thread::yield();
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+
+    loop->call([&] {
+      recv.reset();
+      send.reset();
+      loop->stop();
+    });
+    runner.join();
+    return PPSResult{received.load(), elapsed};
+  }
+}  // namespace
+
+TEST_CASE("UDP handles receive datagrams over loopback", "[ev][udp]")
+{
+  const bool batched = GENERATE(false, true);
+  const auto result = MeasureRecv(batched, 1000, 512);
+  CHECK(result.received >= 1000);
+}
+
+TEST_CASE("Batched UDP sends wait for a full send buffer instead of dropping", "[ev][udp]")
+{
+  auto loop = llarp::EventLoop::create();
+  std::atomic<size_t> received{0};
+  auto recv = loop->make_batched_udp(
+      [&](llarp::UDPHandle&, const std::vector<llarp::UDPDatagram>& pkts) {
+        received += pkts.size();
+      });
+  auto send = loop->make_batched_udp(
+      [](llarp::UDPHandle&, const std::vector<llarp::UDPDatagram>&) {});
+  REQUIRE(recv->listen(llarp::SockAddr{"127.0.0.1:0"}));
+  REQUIRE(send->listen(llarp::SockAddr{"127.0.0.1:0"}));
+  const auto to = BoundAddr(*recv);
+  // a send buffer far smaller than the batch, so sendmmsg runs out of room part way
+  const int sndbuf = 4096;
+  REQUIRE(
+      setsockopt(*send->file_descriptor(), SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)) == 0);
+
+  constexpr size_t count = 128;
+  std::vector<byte_t> payload(256, 0x42);
+  std::vector<llarp::UDPDatagram> batch;
+  for (size_t idx = 0; idx < count; ++idx)
+    batch.push_back(llarp::UDPDatagram{to, payload.data(), payload.size()});
+
+  std::thread runner{[loop] { loop->run(); }};
+  std::promise<llarp::UDPSendResult> sent;
+  loop->call([&] { sent.set_value(send->send_batch(batch)); });
+  const auto result = sent.get_future().get();
+  // whatever the kernel had no room for waits rather than being dropped
+  CHECK(result.sent + result.queued == count);
+  CHECK(result.dropped == 0);
+
+  const auto started = std::chrono::steady_clock::now();
+  while (received < count and std::chrono::steady_clock::now() - started < 10s)
+    std::this_thread::sleep_for(1ms);
+  CHECK(received == count);
+
+  loop->call([&] {
+    recv.reset();
+    send.reset();
+    loop->stop();
+  });
+  runner.join();
+}
+
+TEST_CASE("UDP receive pps, single vs batched", "[.][bench][ev][udp]")
+{
+  constexpr size_t count = 500'000;
+  for (const size_t size : {64, 512, 1200})
+  {
+    const auto single = MeasureRecv(false, count, size);
+    const auto batched = MeasureRecv(true, count, size);
+    WARN(
+        size << " byte datagrams: single " << single.pps() << " pps, batched " << batched.pps()
+             << " pps");
+  }
+}
+#endif
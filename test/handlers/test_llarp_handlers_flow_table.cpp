@@ -0,0 +1,182 @@
+#include <handlers/flow_table.hpp>
+#include <net/ip.hpp>
+
+#include <oxenc/endian.h>
+
+#include <memory>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using handlers::FlowKey;
+using handlers::FlowTable;
+
+namespace
+{
+  constexpr uint32_t User = 0x0a000002;
+  constexpr uint32_t Remote = 0x0a000010;
+
+  /// a v4 packet of proto from User to Remote with ihl header words, starting with ports if
+  /// room is left for them
+  net::IPPacket
+  MakeV4(uint8_t proto, size_t sz, uint8_t ihl = 5)
+  {
+    net::IPPacket pkt{sz};
+    std::fill_n(pkt.buf, sz, 0);
+    pkt.buf[0] = 0x40 | ihl;
+    oxenc::write_host_as_big<uint16_t>(sz, pkt.buf + 2);
+    pkt.buf[8] = 64;
+    pkt.buf[9] = proto;
+    oxenc::write_host_as_big(User, pkt.buf + 12);
+    oxenc::write_host_as_big(Remote, pkt.buf + 16);
+    const size_t hdr = ihl * 4;
+    if (sz >= hdr + 4)
+    {
+      oxenc::write_host_as_big<uint16_t>(1234, pkt.buf + hdr);
+      oxenc::write_host_as_big<uint16_t>(53, pkt.buf + hdr + 2);
+    }
+    pkt.sz = sz;
+    return pkt;
+  }
+
+  FlowKey
+  KeyFor(uint16_t srcport)
+  {
+    FlowKey key;
+    key.src = net::ExpandV4(huint32_t{User});
+    key.dst = net::ExpandV4(huint32_t{Remote});
+    key.proto = 17;
+    key.srcport = srcport;
+    key.dstport = 53;
+    return key;
+  }
+
+  /// an outbound route; the session it points at stands in for one and is never used
+  service::ConvoRoute
+  OutboundRoute(uint64_t generation)
+  {
+    static auto owner = std::make_shared<int>();
+    service::ConvoRoute route;
+    route.tag.Fill(2);
+    route.generation = generation;
+    route.outbound = std::shared_ptr<service::OutboundContext>{
+        owner, reinterpret_cast<service::OutboundContext*>(owner.get())};
+    return route;
+  }
+}  // namespace
+
+TEST_CASE("flow keys are the 5 tuple of user packets", "[handlers]")
+{
+  const auto dst = net::ExpandV4(huint32_t{Remote});
+
+  const auto udp = handlers::MakeFlowKey(MakeV4(17, 28), dst);
+  CHECK(udp.src == net::ExpandV4(huint32_t{User}));
+  CHECK(udp.dst == dst);
+  CHECK(udp.proto == 17);
+  CHECK(udp.srcport == 1234);
+  CHECK(udp.dstport == 53);
+  CHECK(udp == KeyFor(1234));
+  CHECK(FlowKey::Hash{}(udp) == FlowKey::Hash{}(KeyFor(1234)));
+
+  // ports are found past ip options
+  const auto tcp = handlers::MakeFlowKey(MakeV4(6, 44, 6), dst);
+  CHECK(tcp.proto == 6);
+  CHECK(tcp.srcport == 1234);
+  CHECK(tcp.dstport == 53);
+
+  // protocols without ports, and packets too short to hold them, key on addresses alone
+  for (const auto& key :
+       {handlers::MakeFlowKey(MakeV4(1, 28), dst), handlers::MakeFlowKey(MakeV4(17, 22), dst)})
+  {
+    CHECK(key.src == udp.src);
+    CHECK(key.srcport == 0);
+    CHECK(key.dstport == 0);
+  }
+
+  // the destination is the one the packet was looked up by
+  const auto other = handlers::MakeFlowKey(MakeV4(17, 28), net::ExpandV4(huint32_t{Remote + 1}));
+  CHECK_FALSE(other == udp);
+}
+
+TEST_CASE("flows miss once what their route pins moves on", "[handlers]")
+{
+  uint64_t generation = 0;
+  service::Session convo;
+  convo.replyIntro.router.Fill(1);
+  const auto ready = [&](const service::ConvoRoute& route) {
+    return route.Current(generation, route.outbound ? nullptr : &convo);
+  };
+
+  service::ConvoRoute inbound;
+  inbound.tag.Fill(1);
+  inbound.generation = generation;
+  inbound.convoGeneration = convo.routeGeneration;
+
+  FlowTable flows;
+  const auto inboundKey = KeyFor(1);
+  const auto outboundKey = KeyFor(2);
+  flows.Put(inboundKey, inbound, service::ProtocolType::TrafficV4, false, 0s);
+  flows.Put(outboundKey, OutboundRoute(generation), service::ProtocolType::TrafficV4, false, 0s);
+  REQUIRE(flows.Size() == 2);
+
+  CHECK(flows.Find(inboundKey, ready));
+  CHECK(flows.Find(outboundKey, ready));
+  CHECK_FALSE(flows.Find(KeyFor(3), ready));
+  CHECK(flows.Hits() == 2);
+  CHECK(flows.Misses() == 1);
+
+  // the remote moving to another path to us is read when sending, so nothing goes stale
+  auto intro = convo.replyIntro;
+  intro.pathID.Fill(9);
+  convo.PutReplyIntro(intro);
+  CHECK(flows.Find(inboundKey, ready));
+  CHECK(flows.Find(outboundKey, ready));
+
+  // replying through another router changes the path inbound routes pinned, but outbound
+  // routes never reply by it
+  intro.router.Fill(2);
+  convo.PutReplyIntro(intro);
+  CHECK_FALSE(flows.Find(inboundKey, ready));
+  CHECK(flows.Find(outboundKey, ready));
+  // the stale flow is gone
+  CHECK(flows.Size() == 1);
+
+  // the endpoint moving on takes every route with it
+  generation++;
+  CHECK_FALSE(flows.Find(outboundKey, ready));
+  CHECK(flows.Size() == 0);
+
+  CHECK(flows.Hits() == 5);
+  CHECK(flows.Misses() == 3);
+  const auto status = flows.ExtractStatus();
+  CHECK(status["hits"] == 5);
+  CHECK(status["misses"] == 3);
+  CHECK(status["size"] == 0);
+}
+
+TEST_CASE("flows expire when idle or stale and are dropped when the table fills", "[handlers]")
+{
+  FlowTable flows;
+  flows.Put(KeyFor(1), OutboundRoute(0), service::ProtocolType::TrafficV4, false, 0s);
+  flows.Put(KeyFor(2), OutboundRoute(1), service::ProtocolType::TrafficV4, false, 0s);
+  flows.Put(KeyFor(3), OutboundRoute(1), service::ProtocolType::TrafficV4, false, 20s);
+
+  flows.Expire(10s, 1);
+  CHECK(flows.Size() == 2);
+  flows.Expire(FlowTable::IdleTimeout + 10s, 1);
+  CHECK(flows.Size() == 1);
+  const auto any = [](const auto&) { return true; };
+  CHECK(flows.Find(KeyFor(3), any));
+
+  flows.Clear();
+  for (size_t idx = 0; idx < FlowTable::MaxFlows; ++idx)
+    flows.Put(KeyFor(idx), OutboundRoute(0), service::ProtocolType::TrafficV4, false, 0s);
+  CHECK(flows.Size() == FlowTable::MaxFlows);
+  // a flow we have is updated in place
+  flows.Put(KeyFor(0), OutboundRoute(0), service::ProtocolType::Exit, true, 1s);
+  CHECK(flows.Size() == FlowTable::MaxFlows);
+  // a new one starts the table again
+  flows.Put(KeyFor(FlowTable::MaxFlows), OutboundRoute(0), service::ProtocolType::Exit, true, 1s);
+  CHECK(flows.Size() == 1);
+}
@@ -0,0 +1,154 @@
+#include <iwp/congestion.hpp>
+
+#include <deque>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  using CC_t = iwp::CongestionControl;
+
+  /// send until the window or pacer says stop; returns how many went out
+  size_t
+  Fill(CC_t& cc, llarp_time_t now)
+  {
+    size_t sent = 0;
+    while (cc.CanSend(now))
+    {
+      cc.OnSent();
+      sent++;
+    }
+    return sent;
+  }
+}  // namespace
+
+TEST_CASE("iwp congestion control window", "[iwp]")
+{
+  CC_t cc{400ms};
+  cc.SetMinRTO(CC_t::MinRTO);
+  llarp_time_t now = 10s;
+
+  // no rtt yet: the initial window goes out unpaced
+  CHECK(cc.PacingRate() == 0);
+  CHECK(cc.RetransmitTimeout() == 400ms);
+  REQUIRE(Fill(cc, now) == size_t(CC_t::InitialWindow));
+  CHECK_FALSE(cc.CanSend(now));
+  CHECK(cc.PacingDelay() == 0s);
+
+  SECTION("slow start doubles per round trip")
+  {
+    now += 100ms;
+    cc.OnRTTSample(100ms);
+    cc.OnAcked(10, now);
+    CHECK(cc.Window() == 20);
+    CHECK(cc.InFlight() == 0);
+    CHECK(cc.SmoothedRTT() == 100ms);
+    CHECK(cc.RetransmitTimeout() == 300ms);
+    // 2x gain in slow start: 20 fragments per 100ms rtt is 400 fragments/s
+    CHECK(cc.PacingRate() == Approx(400));
+  }
+
+  SECTION("an idle window does not grow")
+  {
+    cc.OnAcked(10, now);
+    cc.OnSent();
+    cc.OnAcked(1, now);
+    CHECK(cc.Window() == 20);
+  }
+
+  SECTION("losses shrink the window once per rtt")
+  {
+    cc.OnRTTSample(100ms);
+    cc.OnLoss(4, now);
+    CHECK(cc.Window() == Approx(10 * CC_t::Beta));
+    CHECK(cc.InFlight() == 6);
+    cc.OnLoss(2, now + 50ms);
+    CHECK(cc.Window() == Approx(10 * CC_t::Beta));
+    CHECK(cc.InFlight() == 4);
+    cc.OnLoss(1, now + 150ms);
+    CHECK(cc.Window() == Approx(10 * CC_t::Beta * CC_t::Beta));
+
+    // lots of losses never take us under the floor
+    for (int idx = 0; idx < 20; ++idx)
+    {
+      now += 1s;
+      cc.OnSent();
+      cc.OnLoss(1, now);
+    }
+    CHECK(cc.Window() == CC_t::MinWindow);
+  }
+
+  SECTION("congestion avoidance grows back towards the old window")
+  {
+    cc.OnRTTSample(50ms);
+    cc.OnLoss(10, now);
+    const auto shrunk = cc.Window();
+    // a greedy sender on a lossless 50ms path: every fragment is acked one rtt after it left
+    std::deque<std::pair<llarp_time_t, size_t>> acks;
+    for (int tick = 0; tick < 2000; ++tick)
+    {
+      now += 1ms;
+      while (not acks.empty() and acks.front().first <= now)
+      {
+        cc.OnAcked(acks.front().second, now);
+        acks.pop_front();
+      }
+      if (const auto sent = Fill(cc, now))
+        acks.emplace_back(now + 50ms, sent);
+    }
+    CHECK(cc.Window() > shrunk);
+    CHECK(cc.Window() > 10);
+  }
+}
+
+TEST_CASE("iwp congestion control paces sends", "[iwp]")
+{
+  CC_t cc{400ms};
+  llarp_time_t now = 10s;
+  cc.OnRTTSample(10ms);
+  // 10 fragments per 10ms at 2x gain: 2000 fragments/s, so 2 per ms
+  REQUIRE(cc.PacingRate() == Approx(2000));
+  REQUIRE(cc.CanSend(now));
+  // the pacer starts with a small burst, then needs the clock to move
+  const auto burst = Fill(cc, now);
+  CHECK(burst >= 2);
+  CHECK(burst < 10);
+  CHECK(cc.PacingDelay() == 1ms);
+  now += 1ms;
+  CHECK(Fill(cc, now) == 2);
+}
+
+TEST_CASE("iwp congestion control rtt estimator", "[iwp]")
+{
+  CC_t cc{400ms};
+  cc.SetMinRTO(CC_t::MinRTO);
+  cc.OnRTTSample(80ms);
+  CHECK(cc.SmoothedRTT() == 80ms);
+  // srtt + 4 * rttvar = 80 + 4 * 40
+  CHECK(cc.RetransmitTimeout() == 240ms);
+  for (int idx = 0; idx < 50; ++idx)
+    cc.OnRTTSample(20ms);
+  CHECK(cc.SmoothedRTT() == 20ms);
+  CHECK(cc.RetransmitTimeout() == CC_t::MinRTO);
+  for (int idx = 0; idx < 50; ++idx)
+    cc.OnRTTSample(2s);
+  CHECK(cc.RetransmitTimeout() == 400ms);
+}
+
+TEST_CASE("iwp congestion control keeps the old rto floor without sack", "[iwp]")
+{
+  CC_t cc{400ms};
+  for (int idx = 0; idx < 50; ++idx)
+    cc.OnRTTSample(20ms);
+  CHECK(cc.SmoothedRTT() == 20ms);
+  CHECK(cc.RetransmitTimeout() == 400ms);
+  cc.SetMinRTO(CC_t::MinRTO);
+  CHECK(cc.RetransmitTimeout() == CC_t::MinRTO);
+  // the peer stopped advertising sack
+  cc.SetMinRTO(400ms);
+  CHECK(cc.RetransmitTimeout() == 400ms);
+}
@@ -0,0 +1,380 @@
+#include "llarp_test.hpp"
+
+#include <iwp/iwp.hpp>
+#include <iwp/session.hpp>
+#include <messages/link_intro.hpp>
+#include <util/buffer.hpp>
+#include <util/thread/sharded_worker_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#endif
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+#ifndef _WIN32
+namespace
+{
+  /// run f on the loop and wait for what it returns
+  template <typename Func>
+  auto
+  OnLoop(EventLoop& loop, Func f)
+  {
+    std::promise<decltype(f())> result;
+    loop.call([&] { result.set_value(f()); });
+    return result.get_future().get();
+  }
+
+  template <typename Pred>
+  bool
+  WaitFor(Pred pred, std::chrono::seconds timeout = 10s)
+  {
+    const auto started = std::chrono::steady_clock::now();
+    while (not pred())
+    {
+      if (std::chrono::steady_clock::now() - started > timeout)
+        return false;
+      std::this_thread::sleep_for(1ms);
+    }
+    return true;
+  }
+
+  /// a message for the link to carry; never starts with 'd' so it is not mistaken for a link
+  /// intro
+  ILinkSession::Message_t
+  MakeMessage(size_t idx)
+  {
+    constexpr std::array<size_t, 4> sizes{
+        1, 600, iwp::FragmentSize * 2 + 7, iwp::FragmentSize * iwp::MaxFragments / 2};
+    ILinkSession::Message_t msg(sizes[idx % sizes.size()]);
+    for (size_t pos = 0; pos < msg.size(); ++pos)
+      msg[pos] = static_cast<byte_t>(idx + pos);
+    msg[0] = 0xff;
+    return msg;
+  }
+
+  /// one end of a loopback pair of iwp link layers
+  struct LinkEnd
+  {
+    std::shared_ptr<KeyManager> keys = std::make_shared<KeyManager>();
+    RouterContact rc;
+    iwp::LinkLayer_ptr link;
+    std::atomic<size_t> established{0};
+    std::atomic<size_t> delivered{0};
+    /// whole messages handed up by our sessions; only touched on the loop
+    std::vector<ILinkSession::Message_t> received;
+    std::atomic<size_t> numReceived{0};
+    std::atomic<size_t> bytesReceived{0};
+
+    LinkEnd()
+    {
+      CryptoManager::instance()->identity_keygen(keys->identityKey);
+      CryptoManager::instance()->encryption_keygen(keys->encryptionKey);
+      CryptoManager::instance()->encryption_keygen(keys->transportKey);
+    }
+
+    bool
+    HandleMessage(ILinkSession* session, const llarp_buffer_t& buf, bool keep)
+    {
+      if (not session->IsEstablished())
+      {
+        // nothing but the remote's link intro comes up before the session is
+        LinkIntroMessage lim;
+        lim.session = session;
+        ManagedBuffer copy{buf};
+        return lim.BDecode(&copy.underlying) and lim.HandleMessage(nullptr);
+      }
+      if (keep)
+        received.emplace_back(buf.base, buf.base + buf.sz);
+      bytesReceived += buf.sz;
+      numReceived++;
+      return true;
+    }
+
+    bool
+    Start(
+        bool inbound,
+        const EventLoop_ptr& loop,
+        std::function<void(void)> pump,
+        thread::ShardedWorkerPool& workers,
+        std::atomic<size_t>& jobs,
+        bool keep)
+    {
+      const auto make = inbound ? &iwp::NewInboundLink : &iwp::NewOutboundLink;
+      link = make(
+          keys,
+          loop,
+          [this]() -> const RouterContact& { return rc; },
+          [this, keep](ILinkSession* session, const llarp_buffer_t& buf) {
+            return HandleMessage(session, buf, keep);
+          },
+          [this](Signature& sig, const llarp_buffer_t& buf) {
+            return CryptoManager::instance()->sign(sig, keys->identityKey, buf);
+          },
+          nullptr,
+          [this](ILinkSession*, bool) {
+            established++;
+            return true;
+          },
+          [](RouterContact, RouterContact) { return true; },
+          [](ILinkSession*) {},
+          [](RouterID) {},
+          [] {},
+          [&workers, &jobs](uint64_t key, Work_t work) {
+            jobs++;
+            workers.QueueJob(key, std::move(work));
+          });
+      if (not link->Configure(loop, std::move(pump), SockAddr{"127.0.0.1:0"}) or not link->Start())
+        return false;
+      rc.enckey = keys->encryptionKey.toPublic();
+      if (inbound)
+      {
+        // what we advertise has to carry the port we actually got
+        AddressInfo ai;
+        sockaddr_storage addr{};
+        socklen_t len = sizeof(addr);
+        const auto fd = link->GetUDPFD();
+        if (not fd or not link->GetOurAddressInfo(ai)
+            or getsockname(*fd, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+          return false;
+        ai.port = SockAddr{*reinterpret_cast<const sockaddr*>(&addr)}.getPort();
+        rc.addrs.push_back(ai);
+      }
+      return rc.Sign(keys->identityKey);
+    }
+
+    /// message bytes our sessions copied in and out of packets, and packet bytes we copied off
+    /// the socket
+    uint64_t
+    BytesCopied() const
+    {
+      uint64_t copied = link->PacketBuffers().BytesCopied();
+      link->ForEachSession(
+          [&copied](const ILinkSession* session) {
+            copied += session->GetSessionStats().totalBytesCopied;
+          },
+          false);
+      return copied;
+    }
+
+    /// packets our sessions took off the wire, acks and the like included
+    uint64_t
+    PacketsReceived() const
+    {
+      uint64_t packets = 0;
+      link->ForEachSession(
+          [&packets](const ILinkSession* session) {
+            packets += session->GetSessionStats().totalPacketsRX;
+          },
+          false);
+      return packets;
+    }
+  };
+
+  /// a loopback pair of iwp link layers with a session between them, on their own loop and
+  /// crypto workers
+  struct LinkPair
+  {
+    const EventLoop_ptr loop = EventLoop::create();
+    thread::ShardedWorkerPool workers{2, 1024, false, "iwp-test"};
+    std::atomic<size_t> jobs{0};
+    LinkEnd alice, bob;
+    std::thread runner;
+    std::atomic<bool> pumpQueued{false};
+    const bool blockBogons = RouterContact::BlockBogons;
+
+    LinkPair()
+    {
+      // the pair talks over loopback
+      RouterContact::BlockBogons = false;
+      workers.Start();
+      runner = std::thread{[loop = loop] { loop->run(); }};
+    }
+
+    ~LinkPair()
+    {
+      OnLoop(*loop, [&] {
+        for (auto* end : {&alice, &bob})
+        {
+          if (end->link)
+            end->link->Stop();
+        }
+        return true;
+      });
+      workers.Stop();
+      OnLoop(*loop, [&] {
+        alice.link.reset();
+        bob.link.reset();
+        loop->stop();
+        return true;
+      });
+      runner.join();
+      RouterContact::BlockBogons = blockBogons;
+    }
+
+    /// bring up both links and a session between them; keep says whether the ends hold on to
+    /// what they receive
+    bool
+    Start(bool keep)
+    {
+      const auto pump = [this] { TriggerPump(); };
+      return OnLoop(
+                 *loop,
+                 [&] {
+                   return alice.Start(false, loop, pump, workers, jobs, keep)
+                       and bob.Start(true, loop, pump, workers, jobs, keep)
+                       and alice.link->TryEstablishTo(bob.rc);
+                 })
+          and WaitFor([&] { return alice.established > 0 and bob.established > 0; });
+    }
+
+    /// pump both links on the loop, once however many sessions ask for it before it runs
+    void
+    TriggerPump()
+    {
+      if (pumpQueued.exchange(true))
+        return;
+      loop->call_soon([this] {
+        pumpQueued = false;
+        for (const auto* end : {&alice, &bob})
+        {
+          if (end->link)
+            end->link->Pump();
+        }
+      });
+    }
+
+    /// queue messages from one end to the other
+    static bool
+    Send(LinkEnd& from, const LinkEnd& to, const std::vector<ILinkSession::Message_t>& msgs)
+    {
+      bool queued = true;
+      for (const auto& msg : msgs)
+      {
+        queued &= from.link->SendTo(
+            to.rc.pubkey,
+            msg,
+            [&from](auto status) {
+              if (status == ILinkSession::DeliveryStatus::eDeliverySuccess)
+                from.delivered++;
+            },
+            0);
+      }
+      return queued;
+    }
+
+    uint64_t
+    BytesCopied()
+    {
+      return OnLoop(*loop, [&] { return alice.BytesCopied() + bob.BytesCopied(); });
+    }
+
+    uint64_t
+    PacketsReceived()
+    {
+      return OnLoop(*loop, [&] { return alice.PacketsReceived() + bob.PacketsReceived(); });
+    }
+  };
+}  // namespace
+
+TEST_CASE_METHOD(
+    test::LlarpTest<>,
+    "iwp sessions carry messages through the crypto worker handoff",
+    "[iwp]")
+{
+  LinkPair pair;
+  REQUIRE(pair.Start(true));
+
+  constexpr size_t count = 64;
+  std::vector<ILinkSession::Message_t> toBob, toAlice;
+  size_t payload = 0;
+  for (size_t idx = 0; idx < count; ++idx)
+  {
+    toBob.emplace_back(MakeMessage(idx));
+    toAlice.emplace_back(MakeMessage(idx + count));
+    payload += toBob.back().size() + toAlice.back().size();
+  }
+  CHECK(OnLoop(*pair.loop, [&] {
+    return LinkPair::Send(pair.alice, pair.bob, toBob)
+        and LinkPair::Send(pair.bob, pair.alice, toAlice);
+  }));
+  CHECK(WaitFor([&] {
+    return pair.alice.numReceived == count and pair.bob.numReceived == count
+        and pair.alice.delivered == count and pair.bob.delivered == count;
+  }));
+
+  // every message byte is copied into a packet and back out of one on its way, on top of the
+  // packets the link copies off the socket
+  CHECK(pair.BytesCopied() >= payload * 3);
+
+  // every batch went through the workers and each message came out as it went in; messages
+  // may be handed up in any order
+  CHECK(pair.jobs > 0);
+  OnLoop(*pair.loop, [&] {
+    for (auto [sent, got] :
+         {std::pair{&toBob, &pair.bob.received}, std::pair{&toAlice, &pair.alice.received}})
+    {
+      std::sort(sent->begin(), sent->end());
+      std::sort(got->begin(), got->end());
+      CHECK(*got == *sent);
+    }
+    return true;
+  });
+}
+
+TEST_CASE_METHOD(
+    test::LlarpTest<>, "iwp session pair bytes copied per packet", "[.][bench][iwp]")
+{
+  LinkPair pair;
+  REQUIRE(pair.Start(false));
+
+  // messages of a whole fragment each, so every one rides in its own MTU sized packet
+  constexpr size_t rounds = 1000;
+  constexpr size_t batch = 64;
+  std::vector<ILinkSession::Message_t> msgs;
+  for (size_t idx = 0; idx < batch; ++idx)
+  {
+    msgs.emplace_back(iwp::FragmentSize, static_cast<byte_t>(idx));
+    msgs.back()[0] = 0xff;
+  }
+
+  const auto copiedBefore = pair.BytesCopied();
+  const auto packetsBefore = pair.PacketsReceived();
+  const auto started = std::chrono::steady_clock::now();
+  for (size_t round = 1; round <= rounds; ++round)
+  {
+    // keep a batch in flight each way without overrunning the send queues
+    REQUIRE(OnLoop(*pair.loop, [&] {
+      return LinkPair::Send(pair.alice, pair.bob, msgs)
+          and LinkPair::Send(pair.bob, pair.alice, msgs);
+    }));
+    REQUIRE(WaitFor([&] {
+      return pair.alice.delivered == round * batch and pair.bob.delivered == round * batch;
+    }));
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+  const auto copied = pair.BytesCopied() - copiedBefore;
+  const auto messages = 2 * rounds * batch;
+  const double payload = messages * iwp::FragmentSize;
+  REQUIRE(pair.alice.bytesReceived + pair.bob.bytesReceived == payload);
+  // the packets received include the acks coming back, so also give the figure per message,
+  // which is per MTU sized data packet
+  const double packets = pair.PacketsReceived() - packetsBefore;
+  WARN(
+      messages << " MTU sized messages in " << packets << " packets: "
+               << (copied / double(messages)) << " bytes copied per data packet, "
+               << (copied / packets) << " per packet received, " << (copied / payload)
+               << " per message byte, " << (payload / elapsed.count() / 1e6) << " MB/s");
+}
+#endif
@@ -0,0 +1,211 @@
+#include <iwp/message_table.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  struct TestMessage
+  {
+    uint64_t m_MsgID = 0;
+    llarp_time_t m_Deadline = 0s;
+  };
+
+  using Table_t = iwp::MessageTable<TestMessage>;
+
+  std::vector<uint64_t>
+  LiveIDs(Table_t& table)
+  {
+    std::vector<uint64_t> ids;
+    table.ForEach([&](const TestMessage& msg) { ids.push_back(msg.m_MsgID); });
+    return ids;
+  }
+}  // namespace
+
+TEST_CASE("iwp message table keyed by msgid", "[iwp]")
+{
+  Table_t table{1024, 4};
+
+  SECTION("sequential ids grow the ring and erase in any order")
+  {
+    for (uint64_t id = 100; id < 110; ++id)
+      REQUIRE(table.Emplace(TestMessage{id}));
+    CHECK(table.size() == 10);
+    CHECK(table.Capacity() == 16);
+    CHECK(table.Emplace(TestMessage{105}) == nullptr);
+
+    REQUIRE(table.Erase(100));
+    REQUIRE(table.Erase(104));
+    REQUIRE(table.Erase(109));
+    CHECK_FALSE(table.Erase(104));
+    CHECK(table.Find(104) == nullptr);
+    REQUIRE(table.Find(105));
+    CHECK(table.Find(105)->m_MsgID == 105);
+    REQUIRE(table.Front());
+    CHECK(table.Front()->m_MsgID == 101);
+    CHECK(LiveIDs(table) == std::vector<uint64_t>{101, 102, 103, 105, 106, 107, 108});
+  }
+
+  SECTION("ids arriving out of order extend either edge")
+  {
+    REQUIRE(table.Emplace(TestMessage{50}));
+    REQUIRE(table.Emplace(TestMessage{47}));
+    REQUIRE(table.Emplace(TestMessage{60}));
+    REQUIRE(table.Emplace(TestMessage{44}));
+    CHECK(LiveIDs(table) == std::vector<uint64_t>{44, 47, 50, 60});
+    for (auto id : {44, 47, 50, 60})
+      REQUIRE(table.Find(id));
+  }
+
+  SECTION("ids wrapping past 2^64 stay in one window")
+  {
+    const uint64_t start = ~uint64_t{0} - 2;
+    for (uint64_t id = start; id != 3; ++id)
+      REQUIRE(table.Emplace(TestMessage{id}));
+    CHECK(table.size() == 6);
+    CHECK(table.Front()->m_MsgID == start);
+    REQUIRE(table.Find(1));
+  }
+
+  SECTION("window is bounded")
+  {
+    REQUIRE(table.Emplace(TestMessage{0}));
+    CHECK(table.Emplace(TestMessage{1024}) == nullptr);
+    REQUIRE(table.Emplace(TestMessage{1023}));
+    CHECK(table.Capacity() == 1024);
+    REQUIRE(table.Erase(0));
+    REQUIRE(table.Emplace(TestMessage{1024}));
+    CHECK(LiveIDs(table) == std::vector<uint64_t>{1023, 1024});
+  }
+
+  SECTION("ring shrinks back once a far ahead msgid is gone")
+  {
+    for (uint64_t id = 0; id < 4; ++id)
+      REQUIRE(table.Emplace(TestMessage{id}));
+    REQUIRE(table.Emplace(TestMessage{1000}));
+    CHECK(table.Capacity() == 1024);
+    REQUIRE(table.Erase(1000));
+    CHECK(table.Capacity() == 8);
+    CHECK(LiveIDs(table) == std::vector<uint64_t>{0, 1, 2, 3});
+
+    REQUIRE(table.Emplace(TestMessage{900}));
+    for (uint64_t id = 0; id < 4; ++id)
+      REQUIRE(table.Erase(id));
+    CHECK(table.Capacity() == 4);
+    REQUIRE(table.Find(900));
+    REQUIRE(table.Erase(900));
+    CHECK(table.Capacity() == 4);
+  }
+
+  SECTION("emptying the table lets it start anywhere")
+  {
+    REQUIRE(table.Emplace(TestMessage{7}));
+    REQUIRE(table.Erase(7));
+    CHECK(table.empty());
+    REQUIRE(table.Emplace(TestMessage{1'000'000}));
+    CHECK(table.Front()->m_MsgID == 1'000'000);
+  }
+}
+
+TEST_CASE("iwp message timer wheel fires due msgids once", "[iwp]")
+{
+  iwp::MessageTimerWheel wheel{10ms, 8};
+  std::vector<uint64_t> fired;
+  auto collect = [&](uint64_t id) { fired.push_back(id); };
+
+  wheel.Schedule(1, 1'000ms);
+  wheel.Schedule(2, 1'005ms);
+  wheel.Schedule(3, 1'040ms);
+  // lands in the same bucket as 1 and 2, one turn of the wheel later
+  wheel.Schedule(4, 1'080ms);
+
+  wheel.Expire(1'002ms, collect);
+  CHECK(fired == std::vector<uint64_t>{1});
+  wheel.Expire(1'030ms, collect);
+  CHECK(fired == std::vector<uint64_t>{1, 2});
+  wheel.Expire(1'050ms, collect);
+  CHECK(fired == std::vector<uint64_t>{1, 2, 3});
+  CHECK(wheel.size() == 1);
+
+  // rescheduling from inside the callback, including in the past, fires on the next call
+  wheel.Expire(1'100ms, [&](uint64_t id) {
+    fired.push_back(id);
+    wheel.Schedule(id + 10, 0ms);
+  });
+  CHECK(fired == std::vector<uint64_t>{1, 2, 3, 4});
+  wheel.Expire(1'100ms, collect);
+  CHECK(fired == std::vector<uint64_t>{1, 2, 3, 4, 14});
+
+  // long gaps between calls still catch everything
+  wheel.Schedule(5, 2'000ms);
+  wheel.Schedule(6, 2'500ms);
+  wheel.Expire(10'000ms, collect);
+  REQUIRE(fired.size() == 7);
+  std::sort(fired.begin() + 5, fired.end());
+  CHECK(fired == std::vector<uint64_t>{1, 2, 3, 4, 14, 5, 6});
+  CHECK(wheel.size() == 0);
+}
+
+TEST_CASE("iwp message table pump cost", "[.][bench][iwp]")
+{
+  // pump every 1ms with `inflight` messages each due every 400ms, like Session::Pump with
+  // TXFlushInterval: the old std::map walk against the timer wheel
+  constexpr size_t inflight = 8192;
+  constexpr auto interval = 400ms;
+  constexpr size_t pumps = 2000;
+
+  std::map<uint64_t, TestMessage> map;
+  Table_t table{inflight * 2};
+  iwp::MessageTimerWheel wheel{10ms, 64};
+  for (uint64_t id = 0; id < inflight; ++id)
+  {
+    const auto due = llarp_time_t{id % interval.count()};
+    map.emplace(id, TestMessage{id, due});
+    table.Emplace(TestMessage{id, due});
+    wheel.Schedule(id, due);
+  }
+
+  size_t mapFlushed = 0;
+  const auto mapStarted = std::chrono::steady_clock::now();
+  for (size_t pump = 0; pump < pumps; ++pump)
+  {
+    const llarp_time_t now{pump};
+    for (auto& [id, msg] : map)
+    {
+      if (msg.m_Deadline <= now)
+      {
+        msg.m_Deadline = now + interval;
+        mapFlushed++;
+      }
+    }
+  }
+  const std::chrono::duration<double> mapElapsed = std::chrono::steady_clock::now() - mapStarted;
+
+  size_t wheelFlushed = 0;
+  const auto wheelStarted = std::chrono::steady_clock::now();
+  for (size_t pump = 0; pump < pumps; ++pump)
+  {
+    const llarp_time_t now{pump};
+    wheel.Expire(now, [&](uint64_t id) {
+      auto* msg = table.Find(id);
+      msg->m_Deadline = now + interval;
+      wheel.Schedule(id, msg->m_Deadline);
+      wheelFlushed++;
+    });
+  }
+  const std::chrono::duration<double> wheelElapsed =
+      std::chrono::steady_clock::now() - wheelStarted;
+
+  CHECK(mapFlushed == wheelFlushed);
+  WARN(
+      inflight << " in flight, " << pumps << " pumps: std::map walk "
+               << (mapElapsed.count() * 1e6 / pumps) << "us/pump, timer wheel "
+               << (wheelElapsed.count() * 1e6 / pumps) << "us/pump");
+}
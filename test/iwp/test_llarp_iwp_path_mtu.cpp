@@ -0,0 +1,131 @@
+#include "llarp_test.hpp"
+
+#include <iwp/path_mtu.hpp>
+#include <iwp/session.hpp>
+
+#include <algorithm>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  using PMTU_t = iwp::PathMTU;
+
+  constexpr uint16_t
+  Rung(size_t idx)
+  {
+    return PMTU_t::FragmentSizeFor(PMTU_t::ProbeDatagramSizes[idx]);
+  }
+
+  /// send `data` cut at `fragsize` through an InboundMessage built the way Session::HandleXMIT
+  /// builds one; returns how many packets it took, or 0 if it did not arrive intact
+  size_t
+  Deliver(ILinkSession::Message_t data, size_t fragsize)
+  {
+    auto pool = std::make_shared<PacketBufferPool>();
+    iwp::OutboundMessage tx{7, std::move(data), 1s, nullptr, 0, fragsize};
+    std::optional<iwp::InboundMessage> rx;
+    size_t packets = 0;
+    while (tx.HasPending())
+    {
+      auto pkt = tx.SendNextFragment(*pool, 1s);
+      REQUIRE(pkt.size() <= udp_batch_max_datagram_size);
+      packets++;
+      const byte_t* ptr = pkt.data() + iwp::PacketOverhead + iwp::CommandOverhead;
+      if (pkt[iwp::PacketOverhead + 1] == iwp::Command::eXMIT)
+      {
+        const auto sz = oxenc::load_big_to_host<uint16_t>(ptr);
+        const size_t extra = pkt.size() - iwp::XMITOverhead;
+        rx.emplace(7, sz, ShortHash{ptr + 10}, 1s, std::max(extra, iwp::FragmentSize));
+        rx->HandleData(0, llarp_buffer_t{pkt.data() + iwp::XMITOverhead, extra}, 1s);
+        continue;
+      }
+      REQUIRE(rx);
+      const auto idx = oxenc::load_big_to_host<uint16_t>(ptr);
+      rx->HandleData(idx, llarp_buffer_t{ptr + 10, pkt.size() - (iwp::PacketOverhead + 12)}, 1s);
+    }
+    if (not rx or not rx->IsCompleted() or not rx->Verify())
+      return 0;
+    tx.Ack(rx->AcksBitmask());
+    return tx.IsTransmitted() ? packets : 0;
+  }
+}  // namespace
+
+TEST_CASE("iwp path mtu search", "[iwp]")
+{
+  PMTU_t pmtu;
+  llarp_time_t now = 10s;
+  REQUIRE(pmtu.FragmentSize() == iwp::FragmentSize);
+  // every rung is bigger than the last and the top one fills an ethernet frame over ipv6
+  for (size_t idx = 1; idx < PMTU_t::ProbeDatagramSizes.size(); ++idx)
+    CHECK(Rung(idx) > Rung(idx - 1));
+  CHECK(Rung(0) > iwp::FragmentSize);
+  CHECK(Rung(PMTU_t::ProbeDatagramSizes.size() - 1) + iwp::XMITOverhead == 1500 - 48);
+  CHECK(Rung(PMTU_t::ProbeDatagramSizes.size() - 1) <= iwp::MaxFragmentSize);
+
+  REQUIRE(pmtu.NextProbe(now) == Rung(0));
+  // one probe at a time
+  CHECK_FALSE(pmtu.NextProbe(now + 100ms));
+  // acks for anything but the outstanding probe are ignored
+  pmtu.OnProbeAcked(Rung(1), now);
+  CHECK(pmtu.FragmentSize() == iwp::FragmentSize);
+  pmtu.OnProbeAcked(Rung(0), now + 50ms);
+  CHECK(pmtu.FragmentSize() == Rung(0));
+
+  SECTION("a rung that never gets through ends the search for a while")
+  {
+    for (size_t probe = 0; probe < PMTU_t::MaxProbes; ++probe)
+    {
+      REQUIRE(pmtu.NextProbe(now) == Rung(1));
+      now += PMTU_t::ProbeTimeout;
+    }
+    CHECK_FALSE(pmtu.NextProbe(now));
+    CHECK_FALSE(pmtu.NextProbe(now + PMTU_t::RaiseInterval / 2));
+    CHECK(pmtu.FragmentSize() == Rung(0));
+    CHECK(pmtu.NextProbe(now + PMTU_t::RaiseInterval) == Rung(1));
+  }
+
+  SECTION("climbs to the top rung and stops")
+  {
+    for (size_t idx = 1; idx < PMTU_t::ProbeDatagramSizes.size(); ++idx)
+    {
+      now += 100ms;
+      REQUIRE(pmtu.NextProbe(now) == Rung(idx));
+      pmtu.OnProbeAcked(Rung(idx), now);
+    }
+    CHECK(pmtu.FragmentSize() == Rung(PMTU_t::ProbeDatagramSizes.size() - 1));
+    CHECK_FALSE(pmtu.NextProbe(now + 1min));
+  }
+
+  SECTION("repeated delivery timeouts fall back to the default fragment size")
+  {
+    for (size_t idx = 1; idx < PMTU_t::BlackHoleTimeouts; ++idx)
+      pmtu.OnDeliveryTimeout(now);
+    pmtu.OnDelivered();
+    pmtu.OnDeliveryTimeout(now);
+    CHECK(pmtu.FragmentSize() == Rung(0));
+    for (size_t idx = 1; idx < PMTU_t::BlackHoleTimeouts; ++idx)
+      pmtu.OnDeliveryTimeout(now);
+    CHECK(pmtu.FragmentSize() == iwp::FragmentSize);
+    CHECK_FALSE(pmtu.NextProbe(now + 1min));
+    CHECK(pmtu.NextProbe(now + PMTU_t::RaiseInterval) == Rung(0));
+  }
+}
+
+TEST_CASE_METHOD(test::LlarpTest<>, "iwp messages cut at the negotiated fragment size", "[iwp]")
+{
+  ILinkSession::Message_t data(MAX_LINK_MSG_SIZE);
+  std::generate(data.begin(), data.end(), [n = 0]() mutable { return byte_t(n++ * 7); });
+
+  CHECK(Deliver(data, iwp::FragmentSize) == 8);
+  // what an ethernet path gets us, and the biggest fragments we take (jumbo frames, loopback)
+  CHECK(Deliver(data, Rung(2)) == 7);
+  CHECK(Deliver(data, iwp::MaxFragmentSize) == 5);
+  // a relayed ip packet just over the default fragment size now takes one packet
+  data.resize(iwp::FragmentSize + 100);
+  CHECK(Deliver(data, iwp::FragmentSize) == 2);
+  CHECK(Deliver(data, Rung(0)) == 1);
+}
@@ -0,0 +1,334 @@
+#include "llarp_test.hpp"
+
+#include <iwp/session.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  /// one direction of a lossy link with a fixed one way delay
+  struct LossyWire
+  {
+    struct InFlight
+    {
+      llarp_time_t arrives;
+      ILinkSession::Packet_t pkt;
+    };
+
+    std::deque<InFlight> packets;
+    std::mt19937_64& rng;
+    /// drop probability, in parts per thousand
+    uint64_t lossPerMille;
+    llarp_time_t delay;
+
+    void
+    Send(ILinkSession::Packet_t pkt, llarp_time_t now)
+    {
+      if (rng() % 1000 < lossPerMille)
+        return;
+      packets.push_back(InFlight{now + delay, std::move(pkt)});
+    }
+
+    template <typename Visit_t>
+    void
+    Deliver(llarp_time_t now, Visit_t&& visit)
+    {
+      while (not packets.empty() and packets.front().arrives <= now)
+      {
+        auto pkt = std::move(packets.front().pkt);
+        packets.pop_front();
+        visit(pkt);
+      }
+    }
+  };
+
+  struct LoopbackResult
+  {
+    std::vector<llarp_time_t> latencies;
+    size_t dropped = 0;
+    uint64_t fastRetransmits = 0;
+
+    llarp_time_t
+    Percentile(double pct) const
+    {
+      auto sorted = latencies;
+      std::sort(sorted.begin(), sorted.end());
+      if (sorted.empty())
+        return 0s;
+      return sorted[std::min(sorted.size() - 1, size_t(sorted.size() * pct))];
+    }
+
+    double
+    Mean() const
+    {
+      double sum = 0;
+      for (const auto lat : latencies)
+        sum += lat.count();
+      return latencies.empty() ? 0 : sum / latencies.size();
+    }
+  };
+
+  /// a sender and a receiver running the iwp reliable message rules of Session (pacing,
+  /// retransmit timeouts, ACKS, NACK, and SACK + fast retransmit when `sack` is set) in
+  /// plaintext over a lossy simulated wire, stepping a fake clock 1ms at a time.  sends
+  /// `count` full size messages, one every `interval`, and records how long each takes to be
+  /// fully acked.
+  LoopbackResult
+  RunLoopback(
+      bool sack,
+      uint64_t lossPerMille,
+      size_t count,
+      llarp_time_t interval = 100ms,
+      llarp_time_t delay = 25ms)
+  {
+    auto pool = std::make_shared<PacketBufferPool>();
+    std::mt19937_64 rng{1234};
+    LossyWire toReceiver{{}, rng, lossPerMille, delay};
+    LossyWire toSender{{}, rng, lossPerMille, delay};
+    llarp_time_t now = 10s;
+
+    iwp::CongestionControl cc{iwp::TXFlushInterval};
+    if (sack)
+      cc.SetMinRTO(iwp::CongestionControl::MinRTO);
+    iwp::MessageTable<iwp::OutboundMessage> tx{MaxSendQueueSize};
+    std::deque<uint64_t> paced;
+    std::map<uint64_t, llarp_time_t> started;
+
+    iwp::MessageTable<iwp::InboundMessage> rx{MaxSendQueueSize};
+    std::map<uint64_t, iwp::InboundMessage> completed;
+
+    LoopbackResult result;
+    uint64_t nextID = 0;
+    llarp_time_t nextSend = now;
+    const auto deadline = now + interval * count + 10s;
+
+    auto gotAcks = [&](iwp::OutboundMessage& msg, byte_t bitmask) {
+      if (const auto acked = msg.Ack(bitmask))
+      {
+        if (msg.m_RTTSampleable)
+        {
+          cc.OnRTTSample(now - msg.m_FirstSentAt);
+          msg.m_RTTSampleable = false;
+        }
+        cc.OnAcked(acked, now);
+      }
+      if (not msg.IsTransmitted())
+        return false;
+      result.latencies.push_back(now - started[msg.m_MsgID]);
+      tx.Erase(msg.m_MsgID);
+      return true;
+    };
+
+    auto completeRX = [&](iwp::InboundMessage& msg) {
+      REQUIRE(msg.Verify());
+      toSender.Send(msg.ACKS(*pool), now);
+      const auto rxid = msg.m_MsgID;
+      completed.emplace(rxid, std::move(msg));
+      rx.Erase(rxid);
+    };
+
+    while (now < deadline and (nextID < count or not tx.empty()))
+    {
+      now += 1ms;
+
+      toReceiver.Deliver(now, [&](ILinkSession::Packet_t& pkt) {
+        const byte_t* ptr = pkt.data() + iwp::PacketOverhead + iwp::CommandOverhead;
+        if (pkt[iwp::PacketOverhead + 1] == iwp::Command::eXMIT)
+        {
+          const auto sz = oxenc::load_big_to_host<uint16_t>(ptr);
+          const auto rxid = oxenc::load_big_to_host<uint64_t>(ptr + 2);
+          if (completed.count(rxid) or rx.Find(rxid))
+            return;
+          auto* msg = rx.Emplace(iwp::InboundMessage{rxid, sz, ShortHash{ptr + 10}, now});
+          const auto fragsz = std::min<size_t>(sz, iwp::FragmentSize);
+          msg->HandleData(0, llarp_buffer_t{ptr + 10 + ShortHash::SIZE, fragsz}, now);
+          if (msg->IsCompleted())
+            completeRX(*msg);
+          return;
+        }
+        const auto idx = oxenc::load_big_to_host<uint16_t>(ptr);
+        const auto rxid = oxenc::load_big_to_host<uint64_t>(ptr + 2);
+        auto* msg = rx.Find(rxid);
+        if (msg == nullptr)
+        {
+          if (auto itr = completed.find(rxid); itr != completed.end())
+            toSender.Send(itr->second.ACKS(*pool), now);
+          else
+          {
+            auto nack = iwp::CreatePacket(*pool, iwp::Command::eNACK, 8);
+            oxenc::write_host_as_big(
+                rxid, nack.data() + iwp::PacketOverhead + iwp::CommandOverhead);
+            toSender.Send(std::move(nack), now);
+          }
+          return;
+        }
+        const llarp_buffer_t buf{ptr + 10, pkt.size() - (iwp::PacketOverhead + 12)};
+        msg->HandleData(idx, buf, now);
+        if (sack and not msg->IsCompleted() and msg->ShouldSendSACK())
+          toSender.Send(msg->SACK(*pool), now);
+        if (msg->IsCompleted())
+          completeRX(*msg);
+      });
+
+      toSender.Deliver(now, [&](ILinkSession::Packet_t& pkt) {
+        const byte_t* ptr = pkt.data() + iwp::PacketOverhead + iwp::CommandOverhead;
+        switch (pkt[iwp::PacketOverhead + 1])
+        {
+          case iwp::Command::eACKS:
+            if (auto* msg = tx.Find(oxenc::load_big_to_host<uint64_t>(ptr)))
+              gotAcks(*msg, ptr[8]);
+            break;
+          case iwp::Command::eSACK: {
+            const auto decoded = iwp::DecodeSACK(pkt);
+            REQUIRE(decoded);
+            auto* msg = tx.Find(decoded->msgid);
+            if (msg == nullptr or gotAcks(*msg, decoded->acks))
+              break;
+            if (const auto lost = msg->FastRetransmit(decoded->gaps, now, cc.MinRTT()))
+            {
+              cc.OnLoss(lost, now);
+              paced.push_front(msg->m_MsgID);
+              result.fastRetransmits += lost;
+            }
+            break;
+          }
+          case iwp::Command::eNACK:
+            if (auto* msg = tx.Find(oxenc::load_big_to_host<uint64_t>(ptr)))
+            {
+              cc.OnLoss(msg->Requeue(iwp::Fragments_t{1}), now);
+              paced.push_front(msg->m_MsgID);
+            }
+            break;
+        }
+      });
+
+      // retransmit timeouts and delivery timeouts
+      const auto rto = cc.RetransmitTimeout();
+      std::vector<uint64_t> timedout;
+      tx.ForEach([&](iwp::OutboundMessage& msg) {
+        if (msg.IsTimedOut(now))
+        {
+          timedout.push_back(msg.m_MsgID);
+          return;
+        }
+        if (msg.ShouldFlush(now, rto))
+        {
+          if (const auto lost = msg.RequeueUnAcked())
+          {
+            cc.OnLoss(lost, now);
+            paced.push_back(msg.m_MsgID);
+          }
+        }
+      });
+      for (const auto txid : timedout)
+      {
+        cc.OnDiscard(tx.Find(txid)->InFlight());
+        tx.Erase(txid);
+        result.dropped++;
+      }
+
+      if (nextID < count and now >= nextSend)
+      {
+        ILinkSession::Message_t data(MAX_LINK_MSG_SIZE);
+        std::generate(data.begin(), data.end(), [&] { return byte_t(rng()); });
+        tx.Emplace(iwp::OutboundMessage{nextID, std::move(data), now, nullptr, 0});
+        started[nextID] = now;
+        paced.push_back(nextID++);
+        nextSend += interval;
+      }
+
+      // Session::SendPaced, with the event loop timer standing in as "try again next tick"
+      while (not paced.empty())
+      {
+        auto* msg = tx.Find(paced.front());
+        if (msg == nullptr or not msg->HasPending())
+        {
+          paced.pop_front();
+          continue;
+        }
+        if (not cc.CanSend(now))
+          break;
+        toReceiver.Send(msg->SendNextFragment(*pool, now), now);
+        cc.OnSent();
+      }
+
+      // receiver's periodic ACKS
+      rx.ForEach([&](iwp::InboundMessage& msg) {
+        if (msg.ShouldSendACKS(now))
+          msg.SendACKS(*pool, [&](auto pkt) { toSender.Send(std::move(pkt), now); }, now);
+      });
+    }
+    return result;
+  }
+}  // namespace
+
+TEST_CASE_METHOD(test::LlarpTest<>, "iwp SACK reports gaps as ranges", "[iwp]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  ShortHash digest;
+  iwp::InboundMessage msg{42, MAX_LINK_MSG_SIZE, digest, 1s};
+  const std::vector<byte_t> frag(iwp::FragmentSize);
+  const llarp_buffer_t buf{frag};
+
+  msg.HandleData(0, buf, 1s);
+  CHECK(msg.Gaps().none());
+  CHECK_FALSE(msg.ShouldSendSACK());
+
+  for (auto idx : {2, 5})
+    msg.HandleData(idx * iwp::FragmentSize, buf, 1s);
+  CHECK(msg.Gaps() == iwp::Fragments_t{0b11010});
+  REQUIRE(msg.ShouldSendSACK());
+
+  const auto decoded = iwp::DecodeSACK(msg.SACK(*pool));
+  REQUIRE(decoded);
+  CHECK(decoded->msgid == 42);
+  CHECK(decoded->acks == 0b100101);
+  CHECK(decoded->gaps == iwp::Fragments_t{0b11010});
+  // nothing new to report until another fragment shows up
+  CHECK_FALSE(msg.ShouldSendSACK());
+  msg.HandleData(7 * iwp::FragmentSize, buf, 1s);
+  CHECK(msg.ShouldSendSACK());
+
+  auto truncated = msg.SACK(*pool);
+  CHECK_FALSE(iwp::DecodeSACK(pool->CopyFrom(truncated.data(), iwp::PacketOverhead + 6)));
+}
+
+TEST_CASE_METHOD(
+    test::LlarpTest<>, "iwp SACK fast retransmit cuts completion latency under loss", "[iwp]")
+{
+  const auto lossless = RunLoopback(true, 0, 50);
+  REQUIRE(lossless.latencies.size() == 50);
+  CHECK(lossless.fastRetransmits == 0);
+
+  const auto withoutSACK = RunLoopback(false, 30, 200);
+  const auto withSACK = RunLoopback(true, 30, 200);
+  CHECK(withSACK.fastRetransmits > 0);
+  CHECK(withSACK.dropped < withoutSACK.dropped);
+  CHECK(withSACK.Mean() < withoutSACK.Mean());
+}
+
+TEST_CASE_METHOD(
+    test::LlarpTest<>, "iwp SACK message completion latency", "[.][bench][iwp]")
+{
+  for (const uint64_t loss : {0, 10, 20, 50})
+  {
+    const auto before = RunLoopback(false, loss, 2000);
+    const auto after = RunLoopback(true, loss, 2000);
+    WARN(
+        "loss " << loss / 10.0 << "%, 50ms rtt: timer only mean " << before.Mean() << "ms p50 "
+                << before.Percentile(0.5).count() << "ms p99 " << before.Percentile(0.99).count()
+                << "ms dropped " << before.dropped << "; with SACK mean " << after.Mean()
+                << "ms p50 " << after.Percentile(0.5).count() << "ms p99 "
+                << after.Percentile(0.99).count() << "ms dropped " << after.dropped << " ("
+                << after.fastRetransmits << " fast retransmits)");
+  }
+}
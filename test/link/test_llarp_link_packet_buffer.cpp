@@ -0,0 +1,137 @@
+#include <link/packet_buffer.hpp>
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using llarp::PacketBuffer;
+using llarp::PacketBufferPool;
+
+TEST_CASE("PacketBufferPool recycles buffers", "[link][packet-buffer]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  const byte_t* first = nullptr;
+  {
+    auto pkt = pool->Acquire(100);
+    REQUIRE(pkt.size() == 100);
+    REQUIRE(pkt.capacity() == PacketBufferPool::BufferSize);
+    CHECK(pool->Hits() + pool->Misses() == 1);
+    first = pkt.data();
+  }
+  // a freed buffer is the next one this thread leases
+  CHECK(pool->Acquire(10).data() == first);
+  // steady state: every lease comes off a free list
+  const auto misses = pool->Misses();
+  for (size_t idx = 0; idx < 10 * PacketBufferPool::SlabBuffers; ++idx)
+  {
+    auto pkt = pool->Acquire(1200);
+    pkt[0] = 1;
+  }
+  CHECK(pool->Misses() == misses);
+  CHECK(pool->Hits() + pool->Misses() == 2 + 10 * PacketBufferPool::SlabBuffers);
+}
+
+TEST_CASE("PacketBufferPool grows by slabs", "[link][packet-buffer]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  // more than any free list could be holding from other tests
+  constexpr size_t count = 64 * PacketBufferPool::SlabBuffers;
+  std::vector<PacketBuffer> held;
+  for (size_t idx = 0; idx < count; ++idx)
+    held.emplace_back(pool->Acquire(64));
+  // each miss carves a slab that serves the next SlabBuffers - 1 leases
+  CHECK(pool->Misses() >= 1);
+  CHECK(pool->Misses() <= count / PacketBufferPool::SlabBuffers + 1);
+  CHECK(pool->ExtractStatus()["allocated"] == pool->Misses() * PacketBufferPool::SlabBuffers);
+  held.clear();
+  const auto misses = pool->Misses();
+  for (size_t idx = 0; idx < count; ++idx)
+    held.emplace_back(pool->Acquire(64));
+  CHECK(pool->Misses() == misses);
+}
+
+TEST_CASE("PacketBuffers freed on another thread come back", "[link][packet-buffer]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  constexpr size_t count = 16 * PacketBufferPool::SlabBuffers;
+  std::vector<PacketBuffer> held;
+  for (size_t round = 0; round < 4; ++round)
+  {
+    for (size_t idx = 0; idx < count; ++idx)
+      held.emplace_back(pool->Acquire(64));
+    // what the crypto workers do to packets the socket reader leased
+    std::thread{[&held] { held.clear(); }}.join();
+    if (round == 0)
+      continue;
+    // the worker gave them back to the shared free list when it exited
+    CHECK(pool->Misses() <= count / PacketBufferPool::SlabBuffers + 1);
+  }
+}
+
+TEST_CASE("PacketBufferPool frees slabs left idle after a burst", "[link][packet-buffer]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  // a burst far bigger than the shared free list keeps idle
+  constexpr size_t count = 4 * PacketBufferPool::ReleaseThreshold;
+  std::vector<PacketBuffer> held;
+  for (size_t idx = 0; idx < count; ++idx)
+    held.emplace_back(pool->Acquire(64));
+  const auto released = PacketBufferPool::ReleasedSlabs();
+  // freed on a thread that then exits, so all of them end up on the shared free list
+  std::thread{[&held] { held.clear(); }}.join();
+  CHECK(PacketBufferPool::ReleasedSlabs() > released);
+  CHECK(pool->ExtractStatus()["releasedSlabs"] == PacketBufferPool::ReleasedSlabs());
+  // what is left still leases fine
+  for (size_t idx = 0; idx < count; ++idx)
+    held.emplace_back(pool->Acquire(64));
+  held.clear();
+}
+
+TEST_CASE("PacketBuffer is move only and keeps its contents", "[link][packet-buffer]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  const std::vector<byte_t> data{1, 2, 3, 4, 5};
+  auto pkt = pool->CopyFrom(data.data(), data.size());
+  const auto* ptr = pkt.data();
+
+  PacketBuffer moved{std::move(pkt)};
+  CHECK(pkt.empty());
+  CHECK(pkt.data() == nullptr);
+  CHECK(moved.data() == ptr);
+  CHECK(std::equal(moved.begin(), moved.end(), data.begin(), data.end()));
+
+  PacketBuffer assigned;
+  assigned = std::move(moved);
+  CHECK(assigned.data() == ptr);
+  assigned.resize(2);
+  CHECK(assigned.size() == 2);
+}
+
+TEST_CASE("PacketBufferPool serves oversized packets from the heap", "[link][packet-buffer]")
+{
+  auto pool = std::make_shared<PacketBufferPool>();
+  auto pkt = pool->Acquire(PacketBufferPool::BufferSize + 1);
+  CHECK(pkt.size() == PacketBufferPool::BufferSize + 1);
+  CHECK(pkt.capacity() == PacketBufferPool::BufferSize + 1);
+  CHECK(pool->Misses() == 1);
+  CHECK(pool->ExtractStatus()["oversized"] == 1);
+  const auto* big = pkt.data();
+  pkt = PacketBuffer{};
+  // the heap buffer was freed rather than put on a free list
+  auto small = pool->Acquire(10);
+  CHECK(small.data() != big);
+  CHECK(small.capacity() == PacketBufferPool::BufferSize);
+}
+
+TEST_CASE("PacketBuffer outlives its pool", "[link][packet-buffer]")
+{
+  PacketBuffer pkt;
+  {
+    auto pool = std::make_shared<PacketBufferPool>();
+    pkt = pool->Acquire(32);
+  }
+  std::fill(pkt.begin(), pkt.end(), 0xff);
+  CHECK(pkt.size() == 32);
+}
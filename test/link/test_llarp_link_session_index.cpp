@@ -0,0 +1,89 @@
+#include <link/session_index.hpp>
+#include <router_id.hpp>
+
+#include <chrono>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  struct TestSession
+  {
+    size_t id;
+  };
+
+  using Index_t = SessionIndex<TestSession>;
+
+  SockAddr
+  AddrFor(size_t idx)
+  {
+    // alternate v4 and v6 remotes, a few of them sharing an ip on different ports
+    SockAddr addr;
+    if (idx % 2)
+      addr.setIPv4(10, uint8_t(idx >> 16), uint8_t(idx >> 8), uint8_t(idx));
+    else
+      addr.setIPv6(huint128_t{uint128_t{0xfd00'0000'0000'0000ULL, idx / 4}});
+    addr.setPort(1090 + (idx % 4));
+    return addr;
+  }
+}  // namespace
+
+TEST_CASE("link session index lookup rate", "[.][bench][link]")
+{
+  // the receive path with 10k established sessions: the old address -> router id -> session
+  // double lookup against one probe of the flat index
+  constexpr size_t sessions = 10'000;
+  constexpr size_t lookups = 10'000'000;
+
+  std::unordered_map<SockAddr, RouterID> authedAddrs;
+  std::unordered_multimap<RouterID, std::shared_ptr<TestSession>> authedLinks;
+  Index_t index{std::random_device{}()};
+  std::vector<SockAddr> addrs;
+  std::mt19937_64 rng{1};
+  for (size_t idx = 1; idx <= sessions; ++idx)
+  {
+    RouterID pk;
+    std::generate(pk.begin(), pk.end(), [&] { return byte_t(rng()); });
+    auto session = std::make_shared<TestSession>(TestSession{idx});
+    addrs.push_back(AddrFor(idx));
+    authedAddrs.emplace(addrs.back(), pk);
+    authedLinks.emplace(pk, session);
+    index.Insert(addrs.back(), session);
+  }
+  // datagrams from all over, like a busy relay's socket
+  std::vector<uint32_t> order(lookups);
+  std::generate(order.begin(), order.end(), [&] { return rng() % sessions; });
+
+  size_t mapSum = 0;
+  const auto mapStarted = std::chrono::steady_clock::now();
+  for (const auto idx : order)
+  {
+    auto itr = authedAddrs.find(addrs[idx]);
+    if (itr == authedAddrs.end())
+      continue;
+    if (auto s_itr = authedLinks.find(itr->second); s_itr != authedLinks.end())
+      mapSum += s_itr->second->id;
+  }
+  const std::chrono::duration<double> mapElapsed = std::chrono::steady_clock::now() - mapStarted;
+
+  size_t indexSum = 0;
+  const auto indexStarted = std::chrono::steady_clock::now();
+  for (const auto idx : order)
+  {
+    if (const auto* session = index.Find(addrs[idx]))
+      indexSum += (*session)->id;
+  }
+  const std::chrono::duration<double> indexElapsed =
+      std::chrono::steady_clock::now() - indexStarted;
+
+  CHECK(mapSum == indexSum);
+  WARN(
+      sessions << " sessions: unordered_map pair " << (lookups / mapElapsed.count() / 1e6)
+               << "M lookups/s, flat index " << (lookups / indexElapsed.count() / 1e6)
+               << "M lookups/s");
+}
@@ -0,0 +1,238 @@
+#include <net/ip_packet.hpp>
+#include <util/priority_queue.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using net::IPPacket;
+
+namespace
+{
+  /// an ipv4 udp packet of sz bytes to dst
+  std::vector<byte_t>
+  MakeUDP(size_t sz, uint8_t dst = 1)
+  {
+    std::vector<byte_t> pkt(sz);
+    pkt[0] = 0x45;
+    pkt[2] = sz >> 8;
+    pkt[3] = sz & 0xff;
+    pkt[8] = 64;
+    pkt[9] = 17;
+    const byte_t addrs[8] = {10, 0, 0, 1, 172, 16, 0, dst};
+    std::memcpy(&pkt[12], addrs, sizeof(addrs));
+    for (size_t idx = 20; idx < sz; ++idx)
+      pkt[idx] = idx;
+    return pkt;
+  }
+
+  IPPacket
+  ToPacket(const std::vector<byte_t>& data)
+  {
+    IPPacket pkt;
+    REQUIRE(pkt.Load(llarp_buffer_t{data}));
+    return pkt;
+  }
+}  // namespace
+
+TEST_CASE("ip packets hold buffers sized to what they carry", "[net]")
+{
+  IPPacket empty;
+  CHECK(empty.buf == nullptr);
+  CHECK(empty.sz == 0);
+  CHECK(empty.Capacity() == 0);
+
+  const auto small = ToPacket(MakeUDP(60));
+  CHECK(small.sz == 60);
+  CHECK(small.Capacity() >= 60);
+  CHECK(small.Capacity() < 256);
+
+  const auto full = ToPacket(MakeUDP(IPPacket::MaxSize));
+  CHECK(full.Capacity() == IPPacket::MaxSize);
+  CHECK(IPPacket{IPPacket::MaxSize * 2}.Capacity() == IPPacket::MaxSize);
+
+  IPPacket big;
+  const auto tooBig = MakeUDP(IPPacket::MaxSize + 1);
+  CHECK(not big.Load(llarp_buffer_t{tooBig}));
+
+  // loading more than fits takes a bigger buffer, loading less keeps the one we have
+  auto pkt = ToPacket(MakeUDP(100));
+  pkt.timestamp = 5ms;
+  const auto data = MakeUDP(1000);
+  REQUIRE(pkt.Load(llarp_buffer_t{data}));
+  CHECK(pkt.Capacity() >= 1000);
+  CHECK(pkt.timestamp == 5ms);
+  CHECK(std::equal(data.begin(), data.end(), pkt.buf));
+  const auto* before = pkt.buf;
+  REQUIRE(pkt.Load(llarp_buffer_t{MakeUDP(40)}));
+  CHECK(pkt.buf == before);
+  CHECK(pkt.sz == 40);
+}
+
+TEST_CASE("ip packets move their buffer and copy on request", "[net]")
+{
+  const auto data = MakeUDP(300);
+  auto pkt = ToPacket(data);
+  pkt.timestamp = 7ms;
+  const auto* bytes = pkt.buf;
+
+  IPPacket moved{std::move(pkt)};
+  CHECK(moved.buf == bytes);
+  CHECK(moved.sz == data.size());
+  CHECK(moved.timestamp == 7ms);
+  CHECK(pkt.buf == nullptr);
+  CHECK(pkt.sz == 0);
+
+  auto copy = moved.Copy();
+  CHECK(copy.buf != moved.buf);
+  CHECK(copy.sz == moved.sz);
+  CHECK(copy.timestamp == 7ms);
+  copy.buf[20] ^= 0xff;
+  CHECK(std::equal(data.begin(), data.end(), moved.buf));
+  CHECK(IPPacket{}.Copy().buf == nullptr);
+
+  // a freed buffer is the next one handed out of its size
+  const auto* held = moved.buf;
+  moved = IPPacket{};
+  CHECK(IPPacket{data.size()}.buf == held);
+}
+
+TEST_CASE("move only packets pop off a priority queue in order", "[net]")
+{
+  util::movable_priority_queue<IPPacket, std::vector<IPPacket>, IPPacket::CompareOrder> queue;
+  for (const auto ms : {3, 1, 4, 2})
+  {
+    auto pkt = ToPacket(MakeUDP(40 + ms));
+    pkt.timestamp = std::chrono::milliseconds{ms};
+    queue.push(std::move(pkt));
+  }
+  for (const auto ms : {4, 3, 2, 1})
+  {
+    const auto pkt = queue.pop_top();
+    CHECK(pkt.timestamp == std::chrono::milliseconds{ms});
+    CHECK(pkt.sz == 40 + size_t(ms));
+  }
+  CHECK(queue.empty());
+}
+
+namespace
+{
+  /// what IPPacket was before it became a handle
+  struct InlinePacket
+  {
+    llarp_time_t timestamp;
+    size_t sz;
+    alignas(net::ip_header) byte_t buf[IPPacket::MaxSize];
+
+    bool
+    Load(const llarp_buffer_t& pkt)
+    {
+      if (pkt.sz > sizeof(buf) or pkt.sz == 0)
+        return false;
+      sz = pkt.sz;
+      std::copy_n(pkt.base, sz, buf);
+      return true;
+    }
+  };
+
+  template <typename Packet>
+  struct WritePacket
+  {
+    uint64_t seqno;
+    Packet pkt;
+
+    bool
+    operator>(const WritePacket& other) const
+    {
+      return seqno > other.seqno;
+    }
+  };
+
+  /// packets per second through the path a TunEndpoint takes them on: read off the interface
+  /// in batches, handed through the packet router's handlers to the batch of user packets and
+  /// grouped by destination, and the other way loaded off the network into the seqno ordered
+  /// queue and popped to be written to the interface
+  template <typename Packet, typename Pop>
+  double
+  TunPacketRate(const std::vector<std::vector<byte_t>>& traffic, size_t rounds, Pop pop)
+  {
+    constexpr size_t batch = 64;
+    std::vector<Packet> pkts(batch);
+    std::vector<Packet> userPackets;
+    util::ascending_priority_queue<WritePacket<Packet>> toUser;
+    size_t written = 0;
+    uint64_t sum = 0;
+    // the udp handler the router sends everything through, and the base handler behind it
+    const std::function<void(Packet)> base = [&userPackets](Packet pkt) {
+      userPackets.emplace_back(std::move(pkt));
+    };
+    const std::function<void(Packet)> udp = [&base](Packet pkt) { base(std::move(pkt)); };
+    std::unordered_map<uint8_t, std::function<void(Packet)>> handlers{{17, udp}};
+
+    const auto started = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < rounds; ++round)
+    {
+      for (size_t idx = 0; idx < batch; ++idx)
+      {
+        const auto& data = traffic[(round * batch + idx) % traffic.size()];
+        pkts[idx].Load(llarp_buffer_t{data});
+      }
+      for (size_t idx = 0; idx < batch; ++idx)
+        handlers.at(pkts[idx].buf[9])(std::move(pkts[idx]));
+      std::vector<std::pair<uint8_t, Packet*>> dests;
+      for (auto& pkt : userPackets)
+        dests.emplace_back(pkt.buf[19], &pkt);
+      std::stable_sort(dests.begin(), dests.end(), [](const auto& left, const auto& right) {
+        return left.first < right.first;
+      });
+      for (const auto& [dst, pkt] : dests)
+        sum += dst + pkt->sz;
+      userPackets.clear();
+
+      for (size_t idx = 0; idx < batch; ++idx)
+      {
+        const auto& data = traffic[(round * batch + idx + 7) % traffic.size()];
+        WritePacket<Packet> write;
+        write.seqno = batch - idx;
+        write.pkt.Load(llarp_buffer_t{data});
+        toUser.push(std::move(write));
+      }
+      while (not toUser.empty())
+        written += pop(toUser).sz;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    CHECK(written > 0);
+    CHECK(sum > 0);
+    return rounds * batch * 2 / elapsed.count();
+  }
+}  // namespace
+
+TEST_CASE("tun endpoint packet rate, inline vs pooled packets", "[.][bench][net]")
+{
+  // mostly acks and dns sized packets with a full sized one in every four
+  std::vector<std::vector<byte_t>> traffic;
+  for (size_t idx = 0; idx < 256; ++idx)
+    traffic.emplace_back(MakeUDP(idx % 4 ? 60 + idx % 3 * 40 : 1400, idx % 16));
+  constexpr size_t rounds = 100'000;
+
+  const auto inlineRate = TunPacketRate<InlinePacket>(traffic, rounds, [](auto& queue) {
+    // what Pump did: copy the top out, then pop it
+    InlinePacket pkt{queue.top().pkt};
+    queue.pop();
+    return pkt;
+  });
+  const auto pooledRate = TunPacketRate<IPPacket>(
+      traffic, rounds, [](auto& queue) { return queue.pop_top().pkt; });
+  WARN(
+      "tun endpoint: inline packets " << (inlineRate / 1e6) << "M pkts/s, pooled packets "
+                                      << (pooledRate / 1e6) << "M pkts/s, IPPacket is "
+                                      << sizeof(IPPacket) << " bytes, was "
+                                      << sizeof(InlinePacket));
+}
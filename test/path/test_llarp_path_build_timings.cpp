@@ -0,0 +1,63 @@
+#include <path/build_timings.hpp>
+
+#include <memory>
+#include <thread>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("a build trace records each stage once", "[path]")
+{
+  auto timings = std::make_shared<path::BuildTimings>();
+  path::BuildTrace trace;
+  // nothing is recorded for a build that was never started
+  trace.KeysDone();
+  trace.Established();
+  CHECK(timings->keys.Count() == 0);
+
+  trace.Start(timings);
+  std::this_thread::sleep_for(std::chrono::milliseconds{2});
+  trace.KeysDone();
+  trace.Sent();
+  trace.StatusArrived(2);
+  trace.Confirmed();
+  trace.Established();
+  CHECK(timings->keys.Count() == 1);
+  CHECK(timings->keys.Max() >= std::chrono::milliseconds{2});
+  CHECK(timings->send.Count() == 1);
+  CHECK(timings->status[2].Count() == 1);
+  CHECK(timings->confirm.Count() == 1);
+  CHECK(timings->established.Count() == 1);
+  CHECK(timings->established.Max() >= timings->keys.Max());
+
+  // a path coming back from the dead isn't built again
+  trace.Established();
+  CHECK(timings->established.Count() == 1);
+}
+
+TEST_CASE("build timings report hop positions we heard from", "[path]")
+{
+  auto timings = std::make_shared<path::BuildTimings>();
+  for (size_t hop = 0; hop < 3; ++hop)
+  {
+    path::BuildTrace trace;
+    trace.Start(timings);
+    trace.KeysDone();
+    trace.Sent();
+    trace.StatusArrived(hop);
+  }
+  // positions past the longest path are counted at the last one
+  path::BuildTrace far;
+  far.Start(timings);
+  far.StatusArrived(100);
+  CHECK(timings->status.back().Count() == 1);
+
+  timings->status.back().Clear();
+  const auto status = timings->ExtractStatus();
+  REQUIRE(status["status"].size() == 3);
+  for (const auto& hop : status["status"])
+    CHECK(hop["count"] == 1);
+  CHECK(status["keys"]["count"] == 3);
+  CHECK(status["established"]["count"] == 0);
+}
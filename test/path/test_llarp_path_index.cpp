@@ -0,0 +1,185 @@
+#include <path/path_index.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+namespace
+{
+  struct TestHop
+  {
+    size_t id;
+    llarp_time_t expires = 0s;
+    path::ExpiryHook<TestHop> hook;
+
+    llarp_time_t
+    ExpireTime() const
+    {
+      return expires;
+    }
+  };
+
+  using Index_t = path::PathIndex<TestHop>;
+  using Expiry_t = path::ExpiryList<TestHop, &TestHop::hook>;
+
+  PathID_t
+  IDFor(size_t idx)
+  {
+    PathID_t id;
+    std::memcpy(id.data(), &idx, sizeof(idx));
+    return id;
+  }
+
+  RouterID
+  RouterFor(size_t idx)
+  {
+    RouterID router;
+    router.Fill(byte_t(idx));
+    return router;
+  }
+
+  std::vector<size_t>
+  ExpiryOrder(const Expiry_t& list)
+  {
+    std::vector<size_t> order;
+    list.ForEach([&](const TestHop* hop) { order.push_back(hop->id); });
+    return order;
+  }
+}  // namespace
+
+TEST_CASE("path index keys on path id, side and neighbour", "[path]")
+{
+  // what the index holds in general is covered for every FlatIndex in test_llarp_util_flat_index
+  Index_t index{42};
+  TestHop hop{1, 0s, {}}, other{2, 0s, {}};
+  const auto find = [&index](size_t id, path::HopSide side, size_t router) -> TestHop* {
+    const auto* found = index.Find({IDFor(id), side, RouterFor(router)});
+    return found ? *found : nullptr;
+  };
+  REQUIRE(index.Insert({IDFor(7), path::HopSide::Upstream, RouterFor(1)}, &hop));
+
+  // the same id from another side or another neighbour is another key
+  CHECK(find(7, path::HopSide::Upstream, 1) == &hop);
+  CHECK(find(7, path::HopSide::Downstream, 1) == nullptr);
+  CHECK(find(7, path::HopSide::Upstream, 2) == nullptr);
+  CHECK(index.Insert({IDFor(7), path::HopSide::Upstream, RouterFor(2)}, &other));
+  CHECK(index.Insert({IDFor(7), path::HopSide::Downstream, RouterFor(1)}, &other));
+  CHECK(find(7, path::HopSide::Upstream, 2) == &other);
+  CHECK(find(7, path::HopSide::Upstream, 1) == &hop);
+
+  // our own paths answer whoever asks
+  CHECK(index.Insert({IDFor(8), path::HopSide::Own}, &hop));
+  const auto* own = index.Find({IDFor(8), path::HopSide::Own});
+  REQUIRE(own);
+  CHECK(*own == &hop);
+  CHECK(index.size() == 4);
+}
+
+TEST_CASE("transit expiry list stays in expiry order", "[path]")
+{
+  Expiry_t list;
+  std::vector<std::weak_ptr<TestHop>> weak;
+  // mostly arriving with the most time left, a few shorter lived ones
+  for (const auto& [id, expires] : std::vector<std::pair<size_t, llarp_time_t>>{
+           {1, 10s}, {2, 20s}, {3, 30s}, {4, 15s}, {5, 30s}, {6, 5s}})
+  {
+    auto hop = std::make_shared<TestHop>(TestHop{id, expires, {}});
+    weak.push_back(hop);
+    list.Insert(std::move(hop));
+  }
+  CHECK(list.size() == 6);
+  CHECK(ExpiryOrder(list) == std::vector<size_t>{6, 1, 4, 2, 3, 5});
+
+  // the list keeps its hops alive until they are unlinked
+  CHECK_FALSE(weak[2].expired());
+  list.MoveToFront(weak[2].lock().get());
+  CHECK(ExpiryOrder(list) == std::vector<size_t>{3, 6, 1, 4, 2, 5});
+  auto hop = list.Unlink(list.Front());
+  CHECK(hop->id == 3);
+  hop.reset();
+  CHECK(weak[2].expired());
+  list.Unlink(weak[4].lock().get());
+  CHECK(ExpiryOrder(list) == std::vector<size_t>{6, 1, 4, 2});
+
+  list.Clear();
+  CHECK(list.empty());
+  CHECK(list.Front() == nullptr);
+  for (const auto& ptr : weak)
+    CHECK(ptr.expired());
+}
+
+TEST_CASE("path index lookup rate", "[.][bench][path]")
+{
+  // the relay path with 10k transit hops: the old multimap's equal_range plus neighbour check
+  // against one probe of the flat index
+  constexpr size_t hops = 10'000;
+  constexpr size_t lookups = 10'000'000;
+
+  std::unordered_multimap<PathID_t, std::pair<RouterID, TestHop*>> multimap;
+  Index_t index{std::random_device{}()};
+  std::vector<TestHop> storage(hops);
+  std::vector<std::pair<PathID_t, RouterID>> keys;
+  std::mt19937_64 rng{1};
+  for (size_t idx = 0; idx < hops; ++idx)
+  {
+    storage[idx].id = idx + 1;
+    PathID_t tx, rx;
+    std::generate(tx.begin(), tx.end(), [&] { return byte_t(rng()); });
+    std::generate(rx.begin(), rx.end(), [&] { return byte_t(rng()); });
+    RouterID up, down;
+    std::generate(up.begin(), up.end(), [&] { return byte_t(rng()); });
+    std::generate(down.begin(), down.end(), [&] { return byte_t(rng()); });
+    for (const auto& id : {tx, rx})
+    {
+      multimap.emplace(id, std::make_pair(up, &storage[idx]));
+      multimap.emplace(id, std::make_pair(down, &storage[idx]));
+      index.Insert({id, path::HopSide::Upstream, up}, &storage[idx]);
+      index.Insert({id, path::HopSide::Downstream, down}, &storage[idx]);
+    }
+    keys.emplace_back(rx, down);
+  }
+  std::vector<uint32_t> order(lookups);
+  std::generate(order.begin(), order.end(), [&] { return rng() % hops; });
+
+  size_t mapSum = 0;
+  const auto mapStarted = std::chrono::steady_clock::now();
+  for (const auto idx : order)
+  {
+    const auto& [id, from] = keys[idx];
+    auto range = multimap.equal_range(id);
+    for (auto itr = range.first; itr != range.second; ++itr)
+    {
+      if (itr->second.first == from)
+      {
+        mapSum += itr->second.second->id;
+        break;
+      }
+    }
+  }
+  const std::chrono::duration<double> mapElapsed = std::chrono::steady_clock::now() - mapStarted;
+
+  size_t indexSum = 0;
+  const auto indexStarted = std::chrono::steady_clock::now();
+  for (const auto idx : order)
+  {
+    const auto& [id, from] = keys[idx];
+    if (const auto* hop = index.Find({id, path::HopSide::Downstream, from}))
+      indexSum += (*hop)->id;
+  }
+  const std::chrono::duration<double> indexElapsed =
+      std::chrono::steady_clock::now() - indexStarted;
+
+  CHECK(mapSum == indexSum);
+  WARN(
+      hops << " transit hops: unordered_multimap " << (lookups / mapElapsed.count() / 1e6)
+           << "M lookups/s, flat index " << (lookups / indexElapsed.count() / 1e6)
+           << "M lookups/s");
+}
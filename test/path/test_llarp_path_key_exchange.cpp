@@ -0,0 +1,227 @@
+#include "llarp_test.hpp"
+
+#include <crypto/crypto.hpp>
+#include <path/key_exchange.hpp>
+#include <util/thread/sharded_worker_pool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using Service_t = path::KeyExchangeService;
+
+namespace
+{
+  /// stands in for the router's worker threads: round robin over a worker pool
+  struct Workers
+  {
+    explicit Workers(size_t threads) : pool{threads, 4096, false, "test-kx"}
+    {
+      pool.Start();
+    }
+
+    ~Workers()
+    {
+      pool.Stop();
+    }
+
+    Service_t::WorkerFunc_t
+    Func()
+    {
+      return [this](auto job) { pool.QueueJob(next++, std::move(job)); };
+    }
+
+    thread::ShardedWorkerPool pool;
+    std::atomic<uint64_t> next{0};
+  };
+
+  void
+  WaitFor(const std::atomic<size_t>& count, size_t wanted)
+  {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while (count < wanted and std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds{1});
+  }
+}  // namespace
+
+TEST_CASE("a path build's exchanges get a worker each", "[path]")
+{
+  std::vector<Service_t::Job_t> queued;
+  Service_t service{[&](auto job) { queued.push_back(std::move(job)); }, 8};
+
+  size_t ran = 0;
+  service.Queue(std::vector<Service_t::Job_t>(4, [&] { ran++; }));
+  // fewer exchanges than workers: one worker job each
+  REQUIRE(queued.size() == 4);
+  CHECK(service.ExtractStatus()["draining"] == 4);
+  for (auto& job : queued)
+    job();
+  CHECK(ran == 4);
+  auto status = service.ExtractStatus();
+  CHECK(status["draining"] == 0);
+  CHECK(status["pending"] == 0);
+  CHECK(status["exchanges"] == 4);
+
+  // nothing is going, so the next exchange gets a worker job of its own
+  queued.clear();
+  service.Queue([&] { ran++; });
+  REQUIRE(queued.size() == 1);
+  queued.front()();
+  CHECK(ran == 5);
+}
+
+TEST_CASE("a burst of exchanges is batched over the workers", "[path]")
+{
+  std::vector<Service_t::Job_t> queued;
+  Service_t service{[&](auto job) { queued.push_back(std::move(job)); }, 4};
+
+  // a burst of LRCMs queued one at a time while the workers are busy
+  size_t ran = 0;
+  for (size_t idx = 0; idx < 200; ++idx)
+    service.Queue([&] { ran++; });
+  // never more worker jobs than the parallelism
+  REQUIRE(queued.size() == 4);
+  CHECK(service.ExtractStatus()["pending"] == 200);
+
+  // each drain takes its share a batch at a time, at most MaxBatch at once
+  queued.front()();
+  CHECK(ran == 200);
+  const auto status = service.ExtractStatus();
+  CHECK(status["exchanges"] == 200);
+  CHECK(status["batches"] < 200);
+  CHECK(status["batches"] >= 200 / Service_t::MaxBatch);
+  // the other drains find nothing left and finish
+  for (size_t idx = 1; idx < queued.size(); ++idx)
+    queued[idx]();
+  CHECK(service.ExtractStatus()["draining"] == 0);
+}
+
+TEST_CASE("key exchanges run on many workers at once", "[path]")
+{
+  Workers workers{4};
+  Service_t service{workers.Func(), 4};
+  std::atomic<size_t> ran{0};
+  std::vector<std::thread> queuers;
+  for (size_t thread = 0; thread < 4; ++thread)
+  {
+    queuers.emplace_back([&] {
+      for (size_t idx = 0; idx < 1000; ++idx)
+        service.Queue([&] { ran++; });
+    });
+  }
+  for (auto& thread : queuers)
+    thread.join();
+  WaitFor(ran, 4000);
+  // let the last drains finish before the service goes
+  workers.pool.Stop();
+  CHECK(ran == 4000);
+  CHECK(service.ExtractStatus()["exchanges"] == 4000);
+
+  service.RecordBuild(std::chrono::milliseconds{3});
+  service.RecordCommit(std::chrono::microseconds{250});
+  const auto status = service.ExtractStatus();
+  CHECK(status["buildLatency"]["count"] == 1);
+  CHECK(status["commitLatency"]["max"] == 250);
+}
+
+TEST_CASE_METHOD(test::LlarpTest<>, "path build key exchange latency", "[.][bench][path]")
+{
+  // an endpoint rebuilding `builds` 4 hop paths at once.  each hop is two keygens and two dh,
+  // as in a build.  the old way ran a build's hops one after another, a worker job each; the
+  // service runs them all at once and batches them when there are more than workers.
+  constexpr size_t builds = 64;
+  constexpr size_t hops = 4;
+  const size_t threads = std::max(std::thread::hardware_concurrency(), 2u);
+  auto crypto = CryptoManager::instance();
+  SecretKey relayKey;
+  crypto->encryption_keygen(relayKey);
+  const PubKey relay{seckey_topublic(relayKey)};
+
+  auto hopWork = [&] {
+    SecretKey commkey, framekey;
+    SharedSecret shared;
+    TunnelNonce nonce;
+    nonce.Randomize();
+    crypto->encryption_keygen(commkey);
+    crypto->dh_client(shared, relay, commkey, nonce);
+    crypto->encryption_keygen(framekey);
+    crypto->dh_client(shared, relay, framekey, nonce);
+  };
+
+  struct Build
+  {
+    std::chrono::steady_clock::time_point started;
+    std::atomic<size_t> pending{hops};
+    size_t next = 0;
+  };
+
+  auto report = [&](const char* name, const util::LatencyHistogram& latency, auto elapsed) {
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    WARN(
+        name << ": " << builds << " builds of " << hops << " hops on " << threads
+             << " workers in " << ms << "ms, build p50 " << latency.Percentile(0.5).count()
+             << "us p99 " << latency.Percentile(0.99).count() << "us");
+  };
+
+  {
+    Workers workers{threads};
+    auto work = workers.Func();
+    util::LatencyHistogram latency;
+    std::atomic<size_t> done{0};
+    std::vector<std::unique_ptr<Build>> running(builds);
+    std::function<void(Build*)> nextHop = [&](Build* build) {
+      hopWork();
+      if (++build->next < hops)
+        work([&, build] { nextHop(build); });
+      else
+      {
+        latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - build->started));
+        done++;
+      }
+    };
+    const auto started = std::chrono::steady_clock::now();
+    for (auto& build : running)
+    {
+      build = std::make_unique<Build>();
+      build->started = std::chrono::steady_clock::now();
+      work([&, ptr = build.get()] { nextHop(ptr); });
+    }
+    WaitFor(done, builds);
+    report("sequential hops", latency, std::chrono::steady_clock::now() - started);
+  }
+  {
+    Workers workers{threads};
+    Service_t service{workers.Func(), threads};
+    util::LatencyHistogram latency;
+    std::atomic<size_t> done{0};
+    std::vector<std::unique_ptr<Build>> running(builds);
+    const auto started = std::chrono::steady_clock::now();
+    for (auto& build : running)
+    {
+      build = std::make_unique<Build>();
+      build->started = std::chrono::steady_clock::now();
+      std::vector<Service_t::Job_t> jobs;
+      for (size_t hop = 0; hop < hops; ++hop)
+      {
+        jobs.emplace_back([&, ptr = build.get()] {
+          hopWork();
+          if (ptr->pending.fetch_sub(1) != 1)
+            return;
+          latency.Record(std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - ptr->started));
+          done++;
+        });
+      }
+      service.Queue(std::move(jobs));
+    }
+    WaitFor(done, builds);
+    workers.pool.Stop();
+    report("key exchange service", latency, std::chrono::steady_clock::now() - started);
+  }
+}
@@ -0,0 +1,229 @@
+#include "llarp_test.hpp"
+
+#include <crypto/crypto.hpp>
+#include <messages/relay.hpp>
+#include <path/ihophandler.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <utility>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using HopHandler_t = path::IHopHandler;
+
+namespace
+{
+  uint64_t
+  BytesCopied()
+  {
+    return RelayStats::ExtractStatus()["bytesCopied"].get<uint64_t>();
+  }
+
+  /// decode the way LinkMessageParser does, which eats the message type itself
+  template <typename Relay_t>
+  bool
+  Decode(Relay_t& msg, const ILinkSession::Message_t& encoded)
+  {
+    ILinkSession::Message_t copy{encoded};
+    llarp_buffer_t buf{copy};
+    return bencode_read_dict(
+        [&msg](llarp_buffer_t* buffer, llarp_buffer_t* key) {
+          if (key == nullptr)
+            return true;
+          if (*key == "a")
+          {
+            llarp_buffer_t type;
+            return bencode_read_string(buffer, &type);
+          }
+          return msg.DecodeKey(*key, buffer);
+        },
+        &buf);
+  }
+
+  /// a transit hop's work on a flushed batch: cipher it in place and lay each payload out as
+  /// the next hop's message; returns the bytes it would send
+  template <typename Batch_t>
+  size_t
+  ForwardBatch(Batch_t& batch, const SharedSecret& key, const PathID_t& txid)
+  {
+    std::vector<CryptoBatchItem> items;
+    items.reserve(batch.size());
+    for (auto& [data, nonce] : batch)
+      items.push_back(CryptoBatchItem{data.data(), data.size(), nonce.data()});
+    CryptoManager::instance()->xchacha20_batch(items.data(), items.size(), key);
+    size_t sent = 0;
+    for (auto& [data, nonce] : batch)
+    {
+      RelayUpstreamMessage msg;
+      msg.pathid = txid;
+      msg.Y = nonce;
+      msg.X = std::move(data);
+      if (const auto encoded = msg.Encode())
+        sent += encoded->size();
+    }
+    return sent;
+  }
+}  // namespace
+
+TEMPLATE_TEST_CASE(
+    "relay messages are laid out around their payload",
+    "[path]",
+    RelayUpstreamMessage,
+    RelayDownstreamMessage)
+{
+  std::vector<byte_t> payload(1500);
+  std::generate(payload.begin(), payload.end(), [n = 0]() mutable { return byte_t(n++); });
+  TestType msg;
+  std::fill(msg.pathid.begin(), msg.pathid.end(), 0x42);
+  std::fill(msg.Y.begin(), msg.Y.end(), 0x24);
+  msg.X = RelayFrame{payload.data(), payload.size()};
+
+  // the same bytes on the wire as encoding into a max size scratch buffer
+  std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+  llarp_buffer_t scratch{tmp};
+  REQUIRE(msg.BEncode(&scratch));
+  const ILinkSession::Message_t expected{tmp.data(), scratch.cur};
+
+  // a const message encodes into a copy and keeps its payload
+  const auto copied = std::as_const(msg).Encode();
+  REQUIRE(copied);
+  CHECK(*copied == expected);
+  CHECK(msg.X.size() == payload.size());
+
+  const auto before = BytesCopied();
+  const auto encoded = msg.Encode();
+  REQUIRE(encoded);
+  CHECK(*encoded == expected);
+  // the frame went out with the message, so it cannot go out again
+  CHECK(msg.X.empty());
+  CHECK_FALSE(msg.Encode());
+
+  TestType decoded;
+  REQUIRE(Decode(decoded, *encoded));
+  CHECK(decoded.pathid == msg.pathid);
+  CHECK(decoded.Y == msg.Y);
+  REQUIRE(decoded.X.size() == payload.size());
+  CHECK(std::equal(payload.begin(), payload.end(), decoded.X.begin()));
+  // copied in from the link once, and not at all to go back out
+  CHECK(BytesCopied() - before == payload.size());
+
+  // a hop ciphers the payload in place and sends the frame on as its next message
+  for (auto& b : decoded.X)
+    b ^= 0x5a;
+  decoded.pathid.Randomize();
+  const auto relayed = decoded.Encode();
+  REQUIRE(relayed);
+  CHECK(relayed->size() == encoded->size());
+  TestType next;
+  REQUIRE(Decode(next, *relayed));
+  CHECK(next.pathid == decoded.pathid);
+  CHECK(next.X.data()[0] == (payload[0] ^ 0x5a));
+
+  // there is no relay message without a payload
+  CHECK_FALSE(TestType{}.Encode());
+  TestType empty;
+  empty.X = RelayFrame{payload.data(), 0};
+  CHECK_FALSE(empty.Encode());
+
+  // nothing bigger than a link message can carry
+  payload.resize(MAX_RELAY_PAYLOAD_SIZE + 1);
+  msg.X = RelayFrame{payload.data(), payload.size()};
+  CHECK_FALSE(msg.Encode());
+  payload.resize(MAX_RELAY_PAYLOAD_SIZE);
+  msg.X = RelayFrame{payload.data(), payload.size()};
+  const auto biggest = msg.Encode();
+  REQUIRE(biggest);
+  CHECK(Decode(decoded, *biggest));
+}
+
+TEST_CASE("relay frame header sizes", "[path]")
+{
+  // every payload length prefix width, checked against the bencoder
+  const std::vector<size_t> sizes{0, 9, 10, 99, 100, 999, 1000, MAX_RELAY_PAYLOAD_SIZE};
+  for (const auto sz : sizes)
+  {
+    RelayUpstreamMessage msg;
+    msg.X = RelayFrame{std::vector<byte_t>(sz).data(), sz};
+    std::array<byte_t, MAX_LINK_MSG_SIZE> tmp;
+    llarp_buffer_t scratch{tmp};
+    REQUIRE(msg.BEncode(&scratch));
+    const size_t encodedSize = scratch.cur - scratch.base;
+    CHECK(encodedSize == RelayFrame::HeaderSize(sz) + sz + RelayFrame::TrailerSize);
+  }
+}
+
+TEST_CASE("hop traffic batches are recycled between flushes", "[path]")
+{
+  HopHandler_t::TrafficQueue_t queue, spare;
+  const byte_t payload[64] = {};
+  for (size_t idx = 0; idx < 100; ++idx)
+    queue.emplace_back(RelayFrame{payload, sizeof(payload)}, TunnelNonce{});
+
+  auto batch = HopHandler_t::TakeBatch(queue, spare);
+  CHECK(batch.size() == 100);
+  CHECK(queue.empty());
+  const auto capacity = batch.capacity();
+  HopHandler_t::RecycleBatch(std::move(batch), spare);
+  CHECK(spare.empty());
+  CHECK(spare.capacity() == capacity);
+
+  // the next flush queues into the recycled array
+  batch = HopHandler_t::TakeBatch(queue, spare);
+  CHECK(queue.capacity() == capacity);
+  CHECK(spare.capacity() == 0);
+
+  // a burst's worth of array isn't kept around
+  HopHandler_t::TrafficQueue_t burst;
+  burst.reserve(HopHandler_t::MaxSpareBatch + 1);
+  HopHandler_t::RecycleBatch(std::move(burst), spare);
+  CHECK(spare.capacity() == 0);
+}
+
+TEST_CASE_METHOD(test::LlarpTest<>, "transit hop forwarding rate", "[.][bench][path]")
+{
+  // relayed messages through one hop: queued as they arrive, flushed every `perFlush`, ciphered
+  // and laid out for the next hop.  the old list queue, swapped for an empty one at every flush,
+  // against the contiguous batch recycled between flushes.
+  constexpr size_t messages = 1'000'000;
+  constexpr size_t perFlush = 32;
+  SharedSecret key;
+  key.Randomize();
+  PathID_t txid;
+  txid.Randomize();
+  std::vector<byte_t> payload(1024);
+  std::generate(payload.begin(), payload.end(), [n = 0]() mutable { return byte_t(n++); });
+  TunnelNonce nonce;
+  nonce.Randomize();
+
+  auto run = [&](auto&& queue, auto&& flush) {
+    size_t sent = 0;
+    const auto started = std::chrono::steady_clock::now();
+    for (size_t idx = 1; idx <= messages; ++idx)
+    {
+      queue.emplace_back(RelayFrame{payload.data(), payload.size()}, nonce);
+      if (idx % perFlush == 0)
+        sent += flush(queue);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    CHECK(sent > messages * payload.size());
+    return messages / elapsed.count();
+  };
+
+  const auto listRate = run(std::list<HopHandler_t::TrafficEvent_t>{}, [&](auto& queue) {
+    auto batch = std::exchange(queue, {});
+    return ForwardBatch(batch, key, txid);
+  });
+  HopHandler_t::TrafficQueue_t spare;
+  const auto batchRate = run(HopHandler_t::TrafficQueue_t{}, [&](auto& queue) {
+    auto batch = HopHandler_t::TakeBatch(queue, spare);
+    const auto sent = ForwardBatch(batch, key, txid);
+    HopHandler_t::RecycleBatch(std::move(batch), spare);
+    return sent;
+  });
+  WARN(
+      "1KiB payloads, " << perFlush << " per flush: list queue " << (listRate / 1e6)
+                        << "M msgs/s, recycled batch " << (batchRate / 1e6) << "M msgs/s");
+}
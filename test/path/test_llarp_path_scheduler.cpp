@@ -0,0 +1,126 @@
+#include <path/path_scheduler.hpp>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+
+TEST_CASE("path quality smooths probe round trips and loss", "[path]")
+{
+  path::PathQuality quality;
+  quality.OnRoundTrip(200ms);
+  // the first probe is taken as is
+  CHECK(quality.RoundTrip() == Approx(200));
+  CHECK(quality.Loss() == 0);
+  CHECK(quality.Cost() == Approx(200));
+
+  quality.OnRoundTrip(600ms);
+  CHECK(quality.RoundTrip() == Approx(300));
+
+  // a lost probe makes the path cost more without touching its round trip
+  quality.OnProbeLost();
+  CHECK(quality.Loss() == Approx(path::PathQuality::Alpha));
+  CHECK(quality.Cost() == Approx(300 / (1 - path::PathQuality::Alpha)));
+  // and is forgotten as probes come back
+  for (size_t idx = 0; idx < 20; ++idx)
+    quality.OnRoundTrip(300ms);
+  CHECK(quality.Loss() < 0.01);
+
+  // a path that lost everything still has a cost to compare
+  for (size_t idx = 0; idx < 100; ++idx)
+    quality.OnProbeLost();
+  CHECK(quality.Cost() == Approx(300 / (1 - path::PathQuality::MaxLoss)));
+}
+
+TEST_CASE("path selections by name", "[path]")
+{
+  for (auto selection :
+       {path::PathSelection::eRandom,
+        path::PathSelection::eWeighted,
+        path::PathSelection::ePowerOfTwo})
+    CHECK(path::ParsePathSelection(path::ToString(selection)) == selection);
+  CHECK_THROWS_AS(path::ParsePathSelection("fastest"), std::invalid_argument);
+}
+
+TEST_CASE("path scheduler spreads traffic towards the faster paths", "[path]")
+{
+  constexpr size_t picks = 20'000;
+  const std::vector<double> costs{100, 200, 400, 800};
+  path::PathScheduler scheduler;
+
+  auto spread = [&](path::PathSelection selection) {
+    scheduler.selection = selection;
+    std::array<size_t, 4> counts{};
+    for (size_t idx = 0; idx < picks; ++idx)
+      counts.at(scheduler.Pick(costs))++;
+    return counts;
+  };
+
+  SECTION("random ignores cost")
+  {
+    for (auto count : spread(path::PathSelection::eRandom))
+      CHECK(count == Approx(picks / 4).epsilon(0.1));
+  }
+
+  SECTION("weighted goes by inverse square cost")
+  {
+    // weights 16:4:1:1/4
+    const auto counts = spread(path::PathSelection::eWeighted);
+    CHECK(counts[0] == Approx(picks * 16 / 21.25).epsilon(0.05));
+    CHECK(counts[1] == Approx(picks * 4 / 21.25).epsilon(0.1));
+    CHECK(counts[3] < counts[2]);
+  }
+
+  SECTION("power of two never takes the slowest")
+  {
+    // the fastest is in half of the pairs, the next in a third, the next in a sixth
+    const auto counts = spread(path::PathSelection::ePowerOfTwo);
+    CHECK(counts[0] == Approx(picks / 2).epsilon(0.05));
+    CHECK(counts[1] == Approx(picks / 3).epsilon(0.1));
+    CHECK(counts[2] == Approx(picks / 6).epsilon(0.1));
+    CHECK(counts[3] == 0);
+
+    // with two paths that is always the faster one
+    for (size_t idx = 0; idx < 100; ++idx)
+      CHECK(scheduler.Pick({300, 100}) == 1);
+  }
+
+  // nothing to choose between
+  CHECK(scheduler.Pick({500}) == 0);
+}
+
+TEST_CASE("path scheduler never prefers an unprobed path to a probed one", "[path]")
+{
+  path::PathQuality measured;
+  measured.OnRoundTrip(400ms);
+  const path::PathQuality unmeasured;
+  REQUIRE(measured.Measured());
+  REQUIRE_FALSE(unmeasured.Measured());
+  // on cost alone the path nothing is known about would look the fastest
+  REQUIRE(unmeasured.Cost() < measured.Cost());
+
+  const auto quality = [](const path::PathQuality* q) -> const path::PathQuality& { return *q; };
+  std::vector<const path::PathQuality*> candidates{&unmeasured, &measured};
+  path::DropUnmeasured(candidates, quality);
+  REQUIRE(candidates.size() == 1);
+  CHECK(candidates[0] == &measured);
+
+  // so the power of two pick between the survivors goes by measured cost only
+  path::PathQuality slower;
+  slower.OnRoundTrip(800ms);
+  std::vector<const path::PathQuality*> three{&slower, &unmeasured, &measured};
+  path::DropUnmeasured(three, quality);
+  REQUIRE(three.size() == 2);
+  path::PathScheduler scheduler;
+  for (size_t idx = 0; idx < 100; ++idx)
+    CHECK(three[scheduler.Pick({three[0]->Cost(), three[1]->Cost()})] == &measured);
+
+  // with nothing probed yet every path stays a candidate
+  std::vector<const path::PathQuality*> fresh{&unmeasured, &unmeasured};
+  path::DropUnmeasured(fresh, quality);
+  CHECK(fresh.size() == 2);
+}
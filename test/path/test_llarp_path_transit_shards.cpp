@@ -0,0 +1,83 @@
+#include <path/path_context.hpp>
+
+#include <algorithm>
+#include <future>
+#include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+TEST_CASE("transit work is partitioned across shards by path", "[path]")
+{
+  path::PathContext ctx{nullptr};
+  ctx.StartTransitShards(4, 1024);
+
+  std::vector<PathID_t> paths(32);
+  for (auto& id : paths)
+    id.Randomize();
+
+  // every job on a path runs on one thread, in the order it was queued
+  std::mutex mutex;
+  std::map<PathID_t, std::vector<size_t>> ran;
+  std::map<PathID_t, std::set<std::thread::id>> threads;
+  for (size_t job = 0; job < 20; ++job)
+  {
+    for (const auto& id : paths)
+    {
+      ctx.QueueTransitWork(id, 1, [&, id, job] {
+        ctx.ShardStats(id).frames++;
+        std::lock_guard lock{mutex};
+        ran[id].push_back(job);
+        threads[id].insert(std::this_thread::get_id());
+      });
+    }
+  }
+  ctx.StopTransitShards();
+
+  for (const auto& id : paths)
+  {
+    REQUIRE(ran[id].size() == 20);
+    CHECK(std::is_sorted(ran[id].begin(), ran[id].end()));
+    CHECK(threads[id].size() == 1);
+  }
+
+  const auto status = ctx.ExtractStatus();
+  const auto& shards = status["shards"];
+  REQUIRE(shards.size() == 4);
+  uint64_t frames = 0;
+  for (const auto& shard : shards)
+  {
+    frames += shard["frames"].get<uint64_t>();
+    CHECK(shard["frames"].get<uint64_t>() == shard["jobsRun"].get<uint64_t>());
+  }
+  CHECK(frames == paths.size() * 20);
+}
+
+TEST_CASE("transit batches a full shard drops are counted", "[path]")
+{
+  path::PathContext ctx{nullptr};
+  ctx.StartTransitShards(1, 1);
+  PathID_t id;
+  id.Randomize();
+
+  // hold the only shard so its one slot queue fills up
+  std::promise<void> release;
+  auto released = release.get_future().share();
+  ctx.QueueTransitWork(id, 1, [released] { released.wait(); });
+  for (size_t idx = 0; idx < 8; ++idx)
+    ctx.QueueTransitWork(id, 3, [] {});
+  release.set_value();
+  ctx.StopTransitShards();
+
+  // at most one of the batches found the slot free
+  const auto status = ctx.ExtractStatus();
+  const auto dropped = status["shards"][0]["dropped"].get<uint64_t>();
+  CHECK(dropped >= 7 * 3);
+  CHECK(dropped == ctx.ShardStats(id).dropped);
+  CHECK(dropped / 3 == status["shards"][0]["jobsDropped"].get<uint64_t>());
+}
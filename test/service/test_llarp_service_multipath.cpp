@@ -0,0 +1,102 @@
+#include <service/multipath.hpp>
+
+#include <array>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using Striper_t = service::MultipathStriper;
+
+namespace
+{
+  Striper_t::Lane
+  MakeLane(uint8_t id, double rtt)
+  {
+    Striper_t::Lane lane;
+    lane.local.Fill(id);
+    lane.remote.pathID.Fill(id + 100);
+    lane.rtt = rtt;
+    return lane;
+  }
+
+  size_t
+  LaneIndex(const Striper_t::Lane* lane)
+  {
+    REQUIRE(lane);
+    return lane->local[0];
+  }
+}  // namespace
+
+TEST_CASE("multipath striper spreads frames by weight over round trip", "[service]")
+{
+  Striper_t striper;
+  striper.maxLanes = 3;
+  CHECK(striper.Next() == nullptr);
+
+  // the same weight over 100ms, 200ms and 400ms round trips: 4:2:1
+  striper.SetLanes({MakeLane(0, 100), MakeLane(1, 200), MakeLane(2, 400)});
+  std::array<size_t, 3> counts{};
+  size_t longestRun = 0;
+  size_t run = 0;
+  size_t last = 3;
+  for (size_t idx = 0; idx < 700; ++idx)
+  {
+    const auto lane = LaneIndex(striper.Next());
+    counts.at(lane)++;
+    run = lane == last ? run + 1 : 1;
+    longestRun = std::max(longestRun, run);
+    last = lane;
+  }
+  CHECK(counts[0] == Approx(400).margin(2));
+  CHECK(counts[1] == Approx(200).margin(2));
+  CHECK(counts[2] == Approx(100).margin(2));
+  // frames interleave rather than going out a lane at a time
+  CHECK(longestRun <= 2);
+}
+
+TEST_CASE("multipath lane weights grow on sends and halve on drops", "[service]")
+{
+  Striper_t striper;
+  striper.maxLanes = 2;
+  // lanes past the most we stripe over are left out
+  striper.SetLanes({MakeLane(0, 100), MakeLane(1, 100), MakeLane(2, 100)});
+  REQUIRE(striper.NumLanes() == 2);
+
+  const auto first = MakeLane(0, 100);
+  const auto second = MakeLane(1, 100);
+  for (size_t idx = 0; idx < 100; ++idx)
+    striper.OnSent(first.local, first.remote.pathID);
+  striper.OnDrop(second.local, second.remote.pathID);
+  // frames that weren't ours change nothing
+  striper.OnDrop(first.local, second.remote.pathID);
+
+  auto status = striper.ExtractStatus();
+  const double grown = status["lanes"][0]["weight"];
+  CHECK(grown > Striper_t::InitialWeight + 10);
+  CHECK(grown <= Striper_t::MaxWeight);
+  CHECK(status["lanes"][0]["sent"] == 100);
+  CHECK(status["lanes"][1]["weight"] == Striper_t::InitialWeight / 2);
+  CHECK(status["lanes"][1]["drops"] == 1);
+
+  // the lane that kept sending gets most of the frames
+  std::array<size_t, 2> counts{};
+  for (size_t idx = 0; idx < 1000; ++idx)
+    counts.at(LaneIndex(striper.Next()))++;
+  CHECK(counts[0] > counts[1] * 5);
+
+  // replies stay on the best lane whichever lane frames go over
+  CHECK(LaneIndex(striper.Best()) == 0);
+
+  // a lane keeps its weight across updates, a new one starts afresh
+  striper.SetLanes({MakeLane(2, 50), MakeLane(0, 100)});
+  CHECK(LaneIndex(striper.Best()) == 2);
+  status = striper.ExtractStatus();
+  CHECK(status["lanes"][0]["weight"] == Striper_t::InitialWeight);
+  CHECK(status["lanes"][1]["weight"] == grown);
+
+  // drops never take a lane below the minimum weight
+  for (size_t idx = 0; idx < 20; ++idx)
+    striper.OnDrop(first.local, first.remote.pathID);
+  CHECK(striper.ExtractStatus()["lanes"][1]["weight"] == Striper_t::MinWeight);
+}
@@ -0,0 +1,52 @@
+#include <util/buffer_pool.hpp>
+
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using Pool_t = llarp::util::SizeClassPool<64, 256, 1024>;
+
+TEST_CASE("size class pool picks the smallest class that fits", "[util][buffer-pool]")
+{
+  CHECK(Pool_t::ClassFor(0) == 0);
+  CHECK(Pool_t::ClassFor(64) == 0);
+  CHECK(Pool_t::ClassFor(65) == 1);
+  CHECK(Pool_t::ClassFor(1024) == 2);
+  // nothing is bigger than the last class
+  CHECK(Pool_t::ClassFor(4096) == 2);
+}
+
+TEST_CASE("size class pool recycles buffers per class", "[util][buffer-pool]")
+{
+  auto* small = Pool_t::Take(0);
+  auto* big = Pool_t::Take(2);
+  REQUIRE(small != nullptr);
+  REQUIRE(big != nullptr);
+  Pool_t::Give(0, small);
+  Pool_t::Give(2, big);
+  // a freed buffer is the next one this thread takes of its class
+  CHECK(Pool_t::TakeFree(0) == small);
+  CHECK(Pool_t::TakeFree(2) == big);
+  Pool_t::Give(0, small);
+  Pool_t::Give(2, big);
+}
+
+TEST_CASE("size class pool frees slabs left idle on another thread", "[util][buffer-pool]")
+{
+  // a burst far bigger than the shared free list keeps idle
+  constexpr size_t count = 4 * Pool_t::ReleaseThreshold;
+  std::vector<byte_t*> held;
+  for (size_t idx = 0; idx < count; ++idx)
+    held.push_back(Pool_t::Take(1));
+  const auto released = Pool_t::ReleasedSlabs();
+  // freed on a thread that then exits, so all of them end up on the shared free list
+  std::thread{[&held] {
+    for (auto* buf : held)
+      Pool_t::Give(1, buf);
+  }}.join();
+  CHECK(Pool_t::ReleasedSlabs() > released);
+  // and the other classes still lease fine
+  for (size_t idx = 0; idx < Pool_t::SlabBuffers * 2; ++idx)
+    Pool_t::Give(0, Pool_t::Take(0));
+}
@@ -0,0 +1,143 @@
+#include <link/session_index.hpp>
+#include <path/path_index.hpp>
+
+#include <cstring>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  struct TestEntry
+  {
+    size_t id;
+  };
+
+  /// the link layer's sessions by remote address
+  struct SessionCase
+  {
+    using Index_t = SessionIndex<TestEntry>;
+
+    static SessionKey
+    KeyFor(size_t idx)
+    {
+      // alternate v4 and v6 remotes, a few of them sharing an ip on different ports
+      SockAddr addr;
+      if (idx % 2)
+        addr.setIPv4(10, uint8_t(idx >> 16), uint8_t(idx >> 8), uint8_t(idx));
+      else
+        addr.setIPv6(huint128_t{uint128_t{0xfd00'0000'0000'0000ULL, idx / 4}});
+      addr.setPort(1090 + (idx % 4));
+      return addr;
+    }
+
+    static Index_t::Value
+    ValueOf(const std::shared_ptr<TestEntry>& entry)
+    {
+      return entry;
+    }
+  };
+
+  /// path context's hops by path id, side and neighbour
+  struct PathCase
+  {
+    using Index_t = path::PathIndex<TestEntry>;
+
+    static path::PathKey
+    KeyFor(size_t idx)
+    {
+      // ids shared between sides and neighbours
+      PathID_t id;
+      const size_t shared = idx / 4;
+      std::memcpy(id.data(), &shared, sizeof(shared));
+      RouterID neighbour;
+      neighbour.Fill(byte_t(idx % 2));
+      return {id, idx & 2 ? path::HopSide::Upstream : path::HopSide::Downstream, neighbour};
+    }
+
+    static Index_t::Value
+    ValueOf(const std::shared_ptr<TestEntry>& entry)
+    {
+      return entry.get();
+    }
+  };
+
+  template <typename Case>
+  size_t
+  IDAt(const typename Case::Index_t& index, size_t idx)
+  {
+    const auto* found = index.Find(Case::KeyFor(idx));
+    return found ? (*found)->id : 0;
+  }
+}  // namespace
+
+TEMPLATE_TEST_CASE("flat index holds one value per key", "[util]", SessionCase, PathCase)
+{
+  typename TestType::Index_t index{42, 4};
+  CHECK(index.Capacity() == 8);
+  CHECK(index.Find(TestType::KeyFor(1)) == nullptr);
+  CHECK_FALSE(index.Erase(TestType::KeyFor(1)));
+
+  std::vector<std::shared_ptr<TestEntry>> entries;
+  for (size_t idx = 0; idx <= 100; ++idx)
+    entries.emplace_back(std::make_shared<TestEntry>(TestEntry{idx}));
+  for (size_t idx = 1; idx <= 100; ++idx)
+    REQUIRE(index.Insert(TestType::KeyFor(idx), TestType::ValueOf(entries[idx])));
+  CHECK(index.size() == 100);
+  CHECK(index.Capacity() == 256);
+  for (size_t idx = 1; idx <= 100; ++idx)
+    REQUIRE(IDAt<TestType>(index, idx) == idx);
+  CHECK(index.Find(TestType::KeyFor(101)) == nullptr);
+
+  // a taken key stays with the value that has it, and only that value erases it by value
+  CHECK(index.Insert(TestType::KeyFor(7), TestType::ValueOf(entries[7])));
+  CHECK_FALSE(index.Insert(TestType::KeyFor(7), TestType::ValueOf(entries[0])));
+  CHECK_FALSE(index.Erase(TestType::KeyFor(7), entries[0].get()));
+  CHECK(IDAt<TestType>(index, 7) == 7);
+  CHECK(index.Erase(TestType::KeyFor(7), entries[7].get()));
+  CHECK(index.Find(TestType::KeyFor(7)) == nullptr);
+  CHECK(index.Erase(TestType::KeyFor(8)));
+  CHECK(index.size() == 98);
+
+  size_t visited = 0;
+  index.ForEach([&](const auto&) { visited++; });
+  CHECK(visited == 98);
+}
+
+TEMPLATE_TEST_CASE(
+    "flat index erase keeps probe runs intact", "[util]", SessionCase, PathCase)
+{
+  // a tiny table with lots of churn, checked against std::map after every step
+  typename TestType::Index_t index{7, 8};
+  std::vector<std::shared_ptr<TestEntry>> entries;
+  for (size_t idx = 0; idx < 64; ++idx)
+    entries.emplace_back(std::make_shared<TestEntry>(TestEntry{idx + 1}));
+  std::map<size_t, size_t> model;
+  std::mt19937_64 rng{99};
+  for (size_t step = 0; step < 20'000; ++step)
+  {
+    const size_t key = rng() % entries.size();
+    if (rng() % 2)
+    {
+      // inserting a key again for the value that has it is fine
+      REQUIRE(index.Insert(TestType::KeyFor(key), TestType::ValueOf(entries[key])));
+      model[key] = key + 1;
+    }
+    else
+      REQUIRE(index.Erase(TestType::KeyFor(key)) == (model.erase(key) == 1));
+    REQUIRE(index.size() == model.size());
+    if (step % 64 == 0)
+    {
+      for (size_t other = 0; other < entries.size(); ++other)
+      {
+        const auto itr = model.find(other);
+        REQUIRE(IDAt<TestType>(index, other) == (itr == model.end() ? 0 : itr->second));
+      }
+    }
+  }
+}
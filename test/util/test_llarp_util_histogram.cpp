@@ -0,0 +1,91 @@
+#include <util/histogram.hpp>
+
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+using Histogram_t = util::LatencyHistogram;
+
+TEST_CASE("latency histogram buckets", "[histogram]")
+{
+  // exact below SubBuckets, then SubBuckets buckets per power of two
+  for (uint64_t us = 0; us < Histogram_t::SubBuckets; ++us)
+    CHECK(Histogram_t::BucketFor(us) == us);
+  CHECK(Histogram_t::BucketFor(8) == 8);
+  CHECK(Histogram_t::BucketFor(16) == 16);
+  CHECK(Histogram_t::BucketFor(17) == 16);
+  CHECK(Histogram_t::BucketFor(18) == 17);
+
+  // every value is in the bucket whose bounds hold it, and no bucket is wider than 1/8 of it
+  std::mt19937_64 rng{1};
+  for (size_t idx = 0; idx < 100'000; ++idx)
+  {
+    const uint64_t us = rng() >> (rng() % 64);
+    const auto bucket = Histogram_t::BucketFor(us);
+    REQUIRE(bucket < Histogram_t::Buckets);
+    if (bucket == Histogram_t::Buckets - 1)
+    {
+      REQUIRE(us >= Histogram_t::LowerBound(bucket));
+      continue;
+    }
+    REQUIRE(Histogram_t::LowerBound(bucket) <= us);
+    REQUIRE(us < Histogram_t::LowerBound(bucket + 1));
+    const auto width = Histogram_t::LowerBound(bucket + 1) - Histogram_t::LowerBound(bucket);
+    REQUIRE(width * Histogram_t::SubBuckets <= std::max<uint64_t>(us, Histogram_t::SubBuckets));
+  }
+}
+
+TEST_CASE("latency histogram percentiles", "[histogram]")
+{
+  Histogram_t histogram;
+  CHECK(histogram.Count() == 0);
+  CHECK(histogram.Percentile(0.5) == 0us);
+
+  // 1ms to 1s in 1ms steps
+  for (size_t ms = 1; ms <= 1000; ++ms)
+    histogram.Record(std::chrono::milliseconds{ms});
+  CHECK(histogram.Count() == 1000);
+  CHECK(histogram.Max() == 1s);
+  CHECK(histogram.Mean() == 500500us);
+  const auto p50 = histogram.Percentile(0.5);
+  CHECK(p50 >= 500ms);
+  CHECK(p50 < 562500us);
+  const auto p99 = histogram.Percentile(0.99);
+  CHECK(p99 >= 990ms);
+  CHECK(p99 <= 1s);
+  CHECK(histogram.Percentile(1) == 1s);
+  CHECK(histogram.Percentile(0) < 1125us);
+
+  const auto status = histogram.ExtractStatus();
+  CHECK(status["count"] == 1000);
+  CHECK(status["max"] == 1'000'000);
+
+  // negative durations count as zero
+  histogram.Clear();
+  histogram.Record(-5us);
+  CHECK(histogram.Count() == 1);
+  CHECK(histogram.Max() == 0us);
+}
+
+TEST_CASE("latency histogram records from many threads", "[histogram]")
+{
+  Histogram_t histogram;
+  std::vector<std::thread> threads;
+  for (size_t thread = 1; thread <= 4; ++thread)
+  {
+    threads.emplace_back([&histogram, thread] {
+      for (size_t idx = 0; idx < 10'000; ++idx)
+        histogram.Record(std::chrono::microseconds{thread * 100});
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  CHECK(histogram.Count() == 40'000);
+  CHECK(histogram.Max() == 400us);
+  CHECK(histogram.Mean() == 250us);
+}
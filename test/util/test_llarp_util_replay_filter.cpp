@@ -0,0 +1,151 @@
+#include <util/replay_filter.hpp>
+#include <util/decaying_hashset.hpp>
+#include <crypto/types.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  using Filter_t = util::RotatingReplayFilter<TunnelNonce>;
+
+  TunnelNonce
+  NonceFor(uint64_t idx)
+  {
+    TunnelNonce nonce;
+    std::memcpy(nonce.data(), &idx, sizeof(idx));
+    std::memcpy(nonce.data() + 8, &idx, sizeof(idx));
+    return nonce;
+  }
+
+  /// how many of count values nobody inserted the filter claims to have seen
+  size_t
+  FalsePositives(const Filter_t& filter, uint64_t first, size_t count)
+  {
+    size_t found = 0;
+    for (uint64_t idx = first; idx < first + count; ++idx)
+      found += filter.Contains(NonceFor(idx));
+    return found;
+  }
+}  // namespace
+
+TEST_CASE("replay filter rejects replays", "[replay-filter]")
+{
+  static constexpr auto now = 10s;
+  Filter_t filter{42};
+  CHECK(filter.DecayInterval() == 1s);
+  const auto nonce = NonceFor(1);
+  REQUIRE(not filter.Contains(nonce));
+  REQUIRE(filter.Insert(nonce, now));
+  REQUIRE(filter.Contains(nonce));
+  REQUIRE(not filter.Insert(nonce, now));
+  REQUIRE(filter.Insert(NonceFor(2), now));
+  CHECK(filter.Size() == 2);
+}
+
+TEST_CASE("replay filter remembers values for one to two intervals", "[replay-filter]")
+{
+  static constexpr auto start = 10s;
+  Filter_t filter{42};
+  const auto old = NonceFor(1), fresh = NonceFor(2);
+  REQUIRE(filter.Insert(old, start));
+  filter.Decay(start + 500ms);
+  REQUIRE(filter.Contains(old));
+
+  // rotated once: still held in the last generation
+  REQUIRE(filter.Insert(fresh, start + 1s));
+  REQUIRE(filter.Contains(old));
+  REQUIRE(not filter.Insert(old, start + 1500ms));
+
+  // rotated twice: gone, while the value from the last interval stays
+  filter.Decay(start + 2s);
+  REQUIRE(not filter.Contains(old));
+  REQUIRE(filter.Contains(fresh));
+  CHECK(filter.Size() == 1);
+
+  // idle for two intervals and nothing is recent enough to keep
+  filter.Decay(start + 4s);
+  REQUIRE(not filter.Contains(fresh));
+  CHECK(filter.Size() == 0);
+}
+
+TEST_CASE("replay filter false positive rate at capacity", "[replay-filter]")
+{
+  // the documented bounds are 1.6e-5 for one full generation and 3.3e-5 for two; allow some
+  // slack over them for the sample
+  static constexpr size_t trials = 1'000'000;
+  static constexpr auto start = 10s;
+  Filter_t filter{std::random_device{}()};
+  for (uint64_t idx = 0; idx < Filter_t::Capacity; ++idx)
+    REQUIRE(filter.Insert(NonceFor(idx), start));
+  CHECK(FalsePositives(filter, 1'000'000, trials) < trials * 1e-4);
+
+  size_t inserted = 0;
+  for (uint64_t idx = Filter_t::Capacity; idx < 2 * Filter_t::Capacity; ++idx)
+    inserted += filter.Insert(NonceFor(idx), start + 1s);
+  // a fresh value taken for a replay is dropped, which must be rare
+  CHECK(inserted >= Filter_t::Capacity - 4);
+  CHECK(filter.Saturations() == 0);
+  for (uint64_t idx = 0; idx < 2 * Filter_t::Capacity; ++idx)
+    REQUIRE(filter.Contains(NonceFor(idx)));
+  CHECK(FalsePositives(filter, 1'000'000, trials) < trials * 2e-4);
+}
+
+TEST_CASE("replay filter rotates early when a generation fills up", "[replay-filter]")
+{
+  static constexpr size_t trials = 1'000'000;
+  static constexpr auto start = 10s;
+  Filter_t filter{std::random_device{}()};
+  // eight times capacity inside one interval
+  size_t inserted = 0;
+  for (uint64_t idx = 0; idx < 8 * Filter_t::Capacity; ++idx)
+    inserted += filter.Insert(NonceFor(idx), start + std::chrono::milliseconds{idx % 100});
+  CHECK(inserted >= 8 * Filter_t::Capacity - 16);
+  CHECK(filter.Saturations() >= 6);
+  CHECK(filter.Size() <= 2 * Filter_t::Capacity);
+  // the most recent values are still caught, and the false positive rate holds
+  for (uint64_t idx = 7 * Filter_t::Capacity; idx < 8 * Filter_t::Capacity; ++idx)
+    REQUIRE(filter.Contains(NonceFor(idx)));
+  CHECK(FalsePositives(filter, 1'000'000'000, trials) < trials * 2e-4);
+}
+
+TEST_CASE("replay filter insert rate", "[.][bench][util]")
+{
+  // a busy path's nonces, a path build's worth of them every interval: the old decaying hash set
+  // against the rotating filter, both decayed every 100 inserts like ExpirePaths would
+  constexpr size_t nonces = 10'000'000;
+  constexpr size_t perInterval = Filter_t::Capacity;
+  std::vector<TunnelNonce> order(nonces);
+  for (auto& nonce : order)
+    nonce.Randomize();
+
+  auto run = [&](auto& filter) {
+    size_t inserted = 0;
+    const auto started = std::chrono::steady_clock::now();
+    for (size_t idx = 0; idx < nonces; ++idx)
+    {
+      const auto now = 10s + std::chrono::milliseconds{idx * 1000 / perInterval};
+      inserted += filter.Insert(order[idx], now);
+      if (idx % 100 == 0)
+        filter.Decay(now);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+    CHECK(inserted > nonces * 0.999);
+    return nonces / elapsed.count();
+  };
+
+  util::DecayingHashSet<TunnelNonce> hashset;
+  const auto hashsetRate = run(hashset);
+  auto filter = std::make_unique<Filter_t>(std::random_device{}());
+  const auto filterRate = run(*filter);
+  WARN(
+      perInterval << " nonces/s: decaying hash set " << (hashsetRate / 1e6)
+                  << "M inserts/s, rotating filter " << (filterRate / 1e6) << "M inserts/s");
+}
@@ -0,0 +1,237 @@
+#include <vpn/offload.hpp>
+
+#include <oxenc/endian.h>
+
+#include <cstring>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using vpn::VNetHeader;
+
+namespace
+{
+  constexpr size_t TCPHeaderSize = 32;
+  constexpr uint16_t MSS = 1448;
+
+  /// a tcp super packet of payload bytes with timestamp options and the given flags
+  std::vector<byte_t>
+  MakeTCP(bool v6, size_t payload, uint32_t seq, uint8_t flags, uint16_t sport = 1234)
+  {
+    const size_t ip = v6 ? 40 : 20;
+    std::vector<byte_t> pkt(ip + TCPHeaderSize + payload);
+    if (v6)
+    {
+      pkt[0] = 0x60;
+      oxenc::write_host_as_big<uint16_t>(pkt.size() - 40, &pkt[4]);
+      pkt[6] = 6;
+      pkt[7] = 64;
+      for (size_t idx = 0; idx < 32; ++idx)
+        pkt[8 + idx] = idx + 1;
+    }
+    else
+    {
+      pkt[0] = 0x45;
+      oxenc::write_host_as_big<uint16_t>(pkt.size(), &pkt[2]);
+      oxenc::write_host_as_big<uint16_t>(0x4000, &pkt[6]);
+      pkt[8] = 64;
+      pkt[9] = 6;
+      const byte_t addrs[8] = {10, 0, 0, 1, 172, 16, 0, 2};
+      std::memcpy(&pkt[12], addrs, sizeof(addrs));
+    }
+    auto* tcp = &pkt[ip];
+    oxenc::write_host_as_big<uint16_t>(sport, tcp);
+    oxenc::write_host_as_big<uint16_t>(443, tcp + 2);
+    oxenc::write_host_as_big<uint32_t>(seq, tcp + 4);
+    oxenc::write_host_as_big<uint32_t>(0xabcdef, tcp + 8);
+    tcp[12] = (TCPHeaderSize / 4) << 4;
+    tcp[13] = flags;
+    oxenc::write_host_as_big<uint16_t>(512, tcp + 14);
+    // nop, nop, timestamps
+    const byte_t options[12] = {1, 1, 8, 10, 0, 0, 0, 7, 0, 0, 0, 9};
+    std::memcpy(tcp + 20, options, sizeof(options));
+    for (size_t idx = 0; idx < payload; ++idx)
+      tcp[TCPHeaderSize + idx] = idx * 7;
+    return pkt;
+  }
+
+  /// true if the ip and tcp checksums of pkt are right
+  bool
+  ChecksumsGood(const byte_t* pkt, size_t sz)
+  {
+    const bool v6 = (pkt[0] >> 4) == 6;
+    const size_t ip = v6 ? 40 : 20;
+    if (not v6 and net::ipchksum(pkt, ip) != 0)
+      return false;
+    std::vector<byte_t> pseudo(v6 ? 32 : 8);
+    std::memcpy(pseudo.data(), pkt + (v6 ? 8 : 12), pseudo.size());
+    pseudo.resize(pseudo.size() + 4);
+    oxenc::write_host_as_big<uint16_t>(6, &pseudo[pseudo.size() - 4]);
+    oxenc::write_host_as_big<uint16_t>(sz - ip, &pseudo[pseudo.size() - 2]);
+    const uint16_t sum = ~net::ipchksum(pseudo.data(), pseudo.size());
+    return net::ipchksum(pkt + ip, sz - ip, sum) == 0;
+  }
+
+  net::IPPacket
+  ToPacket(const std::vector<byte_t>& data)
+  {
+    net::IPPacket pkt{data.size()};
+    std::copy(data.begin(), data.end(), pkt.buf);
+    pkt.sz = data.size();
+    return pkt;
+  }
+
+  struct Written
+  {
+    VNetHeader hdr;
+    std::vector<byte_t> data;
+  };
+}  // namespace
+
+TEST_CASE("tcp super packets split into segments and coalesce back", "[vpn]")
+{
+  const bool v6 = GENERATE(false, true);
+  const size_t ip = v6 ? 40 : 20;
+  const size_t headers = ip + TCPHeaderSize;
+  // as much as fits a 1500 byte packet
+  const uint16_t mss = net::IPPacket::MaxSize - headers;
+  const auto super = MakeTCP(v6, mss * 2 + 1000, 5000, 0x18);
+
+  VNetHeader hdr;
+  hdr.gso_type = v6 ? VNetHeader::GSOTCPv6 : VNetHeader::GSOTCPv4;
+  hdr.hdr_len = headers;
+  hdr.gso_size = mss;
+  std::vector<net::IPPacket> segments;
+  REQUIRE(vpn::SplitOffloaded(hdr, super.data(), super.size(), segments));
+  REQUIRE(segments.size() == 3);
+
+  size_t pos = headers;
+  for (size_t idx = 0; idx < segments.size(); ++idx)
+  {
+    const auto& seg = segments[idx];
+    const size_t payload = idx == 2 ? 1000 : mss;
+    REQUIRE(seg.sz == headers + payload);
+    CHECK(ChecksumsGood(seg.buf, seg.sz));
+    CHECK(oxenc::load_big_to_host<uint32_t>(seg.buf + ip + 4) == 5000 + pos - headers);
+    // only the last segment is pushed
+    CHECK(seg.buf[ip + 13] == (idx == 2 ? 0x18 : 0x10));
+    CHECK(std::equal(seg.buf + headers, seg.buf + seg.sz, super.begin() + pos));
+    pos += payload;
+  }
+
+  std::vector<Written> written;
+  vpn::SegmentCoalescer coalescer{[&written](const auto& hdr, const byte_t* buf, size_t sz) {
+    written.push_back({hdr, std::vector<byte_t>(buf, buf + sz)});
+    return true;
+  }};
+  for (const auto& seg : segments)
+    CHECK(coalescer.Add(seg));
+  // the pushed segment ends the run, so it is out without a flush
+  REQUIRE(written.size() == 1);
+  const auto& joined = written[0];
+  CHECK(joined.hdr.gso_type == hdr.gso_type);
+  CHECK(joined.hdr.flags == VNetHeader::NeedsChecksum);
+  CHECK(joined.hdr.gso_size == mss);
+  CHECK(joined.hdr.hdr_len == headers);
+  CHECK(joined.hdr.csum_start == ip);
+  CHECK(joined.hdr.csum_offset == 16);
+  REQUIRE(joined.data.size() == super.size());
+  CHECK(std::equal(joined.data.begin() + headers, joined.data.end(), super.begin() + headers));
+
+  // what the kernel would make of it is what we started with
+  std::vector<net::IPPacket> again;
+  REQUIRE(vpn::SplitOffloaded(joined.hdr, joined.data.data(), joined.data.size(), again));
+  REQUIRE(again.size() == segments.size());
+  for (size_t idx = 0; idx < again.size(); ++idx)
+  {
+    REQUIRE(again[idx].sz == segments[idx].sz);
+    CHECK(std::equal(again[idx].buf, again[idx].buf + again[idx].sz, segments[idx].buf));
+  }
+}
+
+TEST_CASE("segments of other flows or out of order are written alone", "[vpn]")
+{
+  std::vector<Written> written;
+  vpn::SegmentCoalescer coalescer{[&written](const auto& hdr, const byte_t* buf, size_t sz) {
+    written.push_back({hdr, std::vector<byte_t>(buf, buf + sz)});
+    return true;
+  }};
+
+  coalescer.Add(ToPacket(MakeTCP(false, MSS, 0, 0x10)));
+  coalescer.Add(ToPacket(MakeTCP(false, MSS, MSS, 0x10, 4321)));
+  coalescer.Add(ToPacket(MakeTCP(false, MSS, MSS * 3, 0x10, 4321)));
+  // a syn is never held
+  coalescer.Add(ToPacket(MakeTCP(false, 0, 0, 0x02)));
+  REQUIRE(written.size() == 4);
+  coalescer.Add(ToPacket(MakeTCP(false, MSS, 0, 0x10)));
+  coalescer.Add(ToPacket(MakeTCP(false, MSS, MSS, 0x10)));
+  CHECK(written.size() == 4);
+  coalescer.Flush();
+  REQUIRE(written.size() == 5);
+  for (size_t idx = 0; idx < 4; ++idx)
+  {
+    CHECK(written[idx].hdr.gso_type == VNetHeader::GSONone);
+    CHECK(written[idx].hdr.flags == 0);
+  }
+  CHECK(written[4].hdr.gso_type == VNetHeader::GSOTCPv4);
+  CHECK(written[4].data.size() == 20 + TCPHeaderSize + MSS * 2);
+  // nothing left to write
+  coalescer.Flush();
+  CHECK(written.size() == 5);
+}
+
+TEST_CASE("dropped coalesced writes are reported", "[vpn]")
+{
+  bool accept = false;
+  size_t writes = 0;
+  vpn::SegmentCoalescer coalescer{[&](const auto&, const byte_t*, size_t) {
+    writes++;
+    return accept;
+  }};
+
+  // a syn is written straight away
+  CHECK_FALSE(coalescer.Add(ToPacket(MakeTCP(false, 0, 0, 0x02))));
+  // a held segment isn't written yet
+  CHECK(coalescer.Add(ToPacket(MakeTCP(false, MSS, 0, 0x10))));
+  CHECK(writes == 1);
+  // another flow writes out what was held, which is dropped
+  CHECK_FALSE(coalescer.Add(ToPacket(MakeTCP(false, MSS, 0, 0x10, 4321))));
+  CHECK(writes == 2);
+  accept = true;
+  CHECK(coalescer.Flush());
+  CHECK(writes == 3);
+  accept = false;
+  CHECK(coalescer.Flush());
+  CHECK(writes == 3);
+}
+
+TEST_CASE("partial checksums are completed on read", "[vpn]")
+{
+  auto pkt = MakeTCP(false, 100, 1, 0x18);
+  std::vector<net::IPPacket> full;
+  VNetHeader hdr;
+  // what the kernel hands us with checksum offload: only the pseudo header is summed
+  const uint16_t ipcheck = net::ipchksum(pkt.data(), 20);
+  std::memcpy(&pkt[10], &ipcheck, 2);
+  std::vector<byte_t> pseudo(pkt.begin() + 12, pkt.begin() + 20);
+  pseudo.insert(pseudo.end(), {0, 6, 0, byte_t(TCPHeaderSize + 100)});
+  const uint16_t partial = ~net::ipchksum(pseudo.data(), pseudo.size());
+  std::memcpy(&pkt[20 + 16], &partial, 2);
+  CHECK(not ChecksumsGood(pkt.data(), pkt.size()));
+
+  hdr.flags = VNetHeader::NeedsChecksum;
+  hdr.csum_start = 20;
+  hdr.csum_offset = 16;
+  REQUIRE(vpn::SplitOffloaded(hdr, pkt.data(), pkt.size(), full));
+  REQUIRE(full.size() == 1);
+  CHECK(ChecksumsGood(full[0].buf, full[0].sz));
+
+  // super packets that can't be cut into packets we can carry are refused
+  const auto huge = MakeTCP(false, 4000, 0, 0x10);
+  VNetHeader big;
+  big.gso_type = VNetHeader::GSOTCPv4;
+  big.gso_size = 2000;
+  CHECK(not vpn::SplitOffloaded(big, huge.data(), huge.size(), full));
+  CHECK(full.size() == 1);
+}
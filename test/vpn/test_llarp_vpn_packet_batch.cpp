@@ -0,0 +1,108 @@
+#include <vpn/packet_batch.hpp>
+
+#include <oxenc/endian.h>
+
+#include <map>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+
+namespace
+{
+  /// a udp packet from src to dst carrying seq
+  net::IPPacket
+  MakeUDP(uint32_t src, uint32_t dst, uint16_t seq)
+  {
+    net::IPPacket pkt{30};
+    std::fill_n(pkt.buf, 30, 0);
+    pkt.buf[0] = 0x45;
+    oxenc::write_host_as_big<uint16_t>(30, pkt.buf + 2);
+    pkt.buf[8] = 64;
+    pkt.buf[9] = 17;
+    oxenc::write_host_as_big(src, pkt.buf + 12);
+    oxenc::write_host_as_big(dst, pkt.buf + 16);
+    oxenc::write_host_as_big<uint16_t>(1234, pkt.buf + 20);
+    oxenc::write_host_as_big<uint16_t>(53, pkt.buf + 22);
+    oxenc::write_host_as_big<uint16_t>(10, pkt.buf + 24);
+    oxenc::write_host_as_big(seq, pkt.buf + 28);
+    pkt.sz = 30;
+    return pkt;
+  }
+
+  uint16_t
+  SeqOf(const net::IPPacket& pkt)
+  {
+    return oxenc::load_big_to_host<uint16_t>(pkt.buf + 28);
+  }
+
+  constexpr uint32_t User = 0x0a000002;
+  constexpr uint32_t First = 0x0a000010;
+  constexpr uint32_t Second = 0x0a000020;
+  constexpr uint32_t Unmapped = 0x0a000030;
+}  // namespace
+
+TEST_CASE("user packets are grouped by destination in the order they were read", "[vpn]")
+{
+  std::vector<net::IPPacket> pkts;
+  const std::vector<uint32_t> dsts{First, Second, First, Unmapped, Second, First, Unmapped};
+  for (size_t idx = 0; idx < dsts.size(); ++idx)
+    pkts.emplace_back(MakeUDP(User, dsts[idx], idx));
+
+  std::map<huint128_t, std::vector<uint16_t>> groups;
+  size_t visits = 0;
+  const bool sent = vpn::VisitByDestination(pkts, false, [&](auto dst, auto** group, size_t num) {
+    visits++;
+    auto& seqs = groups[dst];
+    for (size_t idx = 0; idx < num; ++idx)
+      seqs.push_back(SeqOf(*group[idx]));
+    return dst == net::ExpandV4(huint32_t{First});
+  });
+  CHECK(sent);
+  // one visit a destination
+  CHECK(visits == 3);
+  CHECK(groups[net::ExpandV4(huint32_t{First})] == std::vector<uint16_t>{0, 2, 5});
+  CHECK(groups[net::ExpandV4(huint32_t{Second})] == std::vector<uint16_t>{1, 4});
+  CHECK(groups[net::ExpandV4(huint32_t{Unmapped})] == std::vector<uint16_t>{3, 6});
+
+  // nothing sent, nothing reported
+  CHECK_FALSE(vpn::VisitByDestination(pkts, false, [](auto, auto**, size_t) { return false; }));
+}
+
+TEST_CASE("user packets with nowhere to go are answered with icmp unreachable", "[vpn]")
+{
+  std::vector<net::IPPacket> pkts;
+  const std::vector<uint32_t> dsts{First, Unmapped, First, Unmapped};
+  for (size_t idx = 0; idx < dsts.size(); ++idx)
+    pkts.emplace_back(MakeUDP(User, dsts[idx], idx));
+
+  const auto unmapped = net::ExpandV4(huint32_t{Unmapped});
+  std::vector<std::pair<huint128_t, std::vector<byte_t>>> replies;
+  vpn::VisitByDestination(pkts, false, [&](auto dst, auto** group, size_t num) {
+    if (dst != unmapped)
+      return true;
+    vpn::ReplyUnreachable(group, num, [&](const net::IPPacket& icmp, huint128_t src) {
+      replies.emplace_back(src, std::vector<byte_t>(icmp.buf, icmp.buf + icmp.sz));
+    });
+    return false;
+  });
+
+  // one reply for each packet to the unmapped destination, in order and only for those
+  REQUIRE(replies.size() == 2);
+  for (size_t idx = 0; idx < replies.size(); ++idx)
+  {
+    const auto& [src, icmp] = replies[idx];
+    CHECK(src == net::ExpandV4(huint32_t{User}));
+    REQUIRE(icmp.size() == 20 + 8 + 20 + 8);
+    CHECK(icmp[9] == 1);
+    CHECK(oxenc::load_big_to_host<uint32_t>(&icmp[12]) == Unmapped);
+    CHECK(oxenc::load_big_to_host<uint32_t>(&icmp[16]) == User);
+    // destination unreachable, host unknown
+    CHECK(icmp[20] == 3);
+    CHECK(icmp[21] == 7);
+    // it quotes the packet it answers
+    const auto& pkt = pkts[idx * 2 + 1];
+    CHECK(std::equal(icmp.begin() + 28, icmp.end(), pkt.buf));
+  }
+}
@@ -0,0 +1,179 @@
+#ifdef __linux__
+#include <vpn/queue_reader.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+using namespace llarp;
+using namespace std::literals;
+using vpn::QueueReaders;
+
+namespace
+{
+  /// datagram socket pairs standing in for the queues of a tun: the readers get the first end
+  /// of each and we write what the kernel would have on the second
+  struct Queues
+  {
+    std::vector<std::array<int, 2>> pairs;
+
+    explicit Queues(size_t num)
+    {
+      for (size_t idx = 0; idx < num; ++idx)
+      {
+        auto& pair = pairs.emplace_back();
+        REQUIRE(::socketpair(AF_UNIX, SOCK_DGRAM | SOCK_NONBLOCK, 0, pair.data()) == 0);
+      }
+    }
+
+    ~Queues()
+    {
+      for (const auto& pair : pairs)
+      {
+        ::close(pair[0]);
+        ::close(pair[1]);
+      }
+    }
+
+    std::vector<int>
+    ReadEnds() const
+    {
+      std::vector<int> fds;
+      for (const auto& pair : pairs)
+        fds.push_back(pair[0]);
+      return fds;
+    }
+  };
+
+  /// write a packet naming its queue and its place on it, true if it went out
+  bool
+  WriteNumbered(int fd, uint8_t queue, uint16_t seq)
+  {
+    std::array<byte_t, 40> pkt{};
+    pkt[0] = queue;
+    pkt[1] = seq >> 8;
+    pkt[2] = seq & 0xff;
+    iovec iov{pkt.data(), pkt.size()};
+    return vpn::WriteQueue(fd, &iov, 1) == static_cast<ssize_t>(pkt.size());
+  }
+
+  bool
+  WaitReadable(int fd)
+  {
+    pollfd pfd{fd, POLLIN, 0};
+    return ::poll(&pfd, 1, 5000) == 1;
+  }
+}  // namespace
+
+TEST_CASE("tun queue readers keep each queue in order", "[vpn]")
+{
+  constexpr size_t NumQueues = 3;
+  constexpr uint16_t PerQueue = 2000;
+  Queues queues{NumQueues};
+  QueueReaders readers{"test", queues.ReadEnds(), false};
+
+  std::atomic<size_t> failed = 0;
+  std::vector<std::thread> writers;
+  for (size_t queue = 0; queue < NumQueues; ++queue)
+  {
+    writers.emplace_back([&, queue] {
+      for (uint16_t seq = 0; seq < PerQueue; ++seq)
+      {
+        if (not WriteNumbered(queues.pairs[queue][1], queue, seq))
+          failed++;
+      }
+    });
+  }
+
+  std::array<uint16_t, NumQueues> next{};
+  size_t received = 0;
+  size_t outOfOrder = 0;
+  while (received < NumQueues * PerQueue and WaitReadable(readers.PollFD()))
+  {
+    for (auto pkt = readers.Next(); pkt.sz; pkt = readers.Next())
+    {
+      REQUIRE(pkt.sz == 40);
+      const uint16_t seq = (pkt.buf[1] << 8) | pkt.buf[2];
+      auto& want = next.at(pkt.buf[0]);
+      if (seq != want)
+        outOfOrder++;
+      want = seq + 1;
+      received++;
+    }
+  }
+  for (auto& writer : writers)
+    writer.join();
+
+  CHECK(failed == 0);
+  CHECK(received == NumQueues * PerQueue);
+  CHECK(outOfOrder == 0);
+  for (const auto want : next)
+    CHECK(want == PerQueue);
+  // nothing is left over once every packet is through
+  CHECK(readers.Next().sz == 0);
+}
+
+TEST_CASE("tun queue readers stop on their eventfd", "[vpn]")
+{
+  Queues queues{2};
+  QueueReaders readers{"test", queues.ReadEnds(), false};
+
+  SECTION("while waiting on their queues")
+  {
+    std::this_thread::sleep_for(10ms);
+  }
+
+  SECTION("while waiting on the event loop")
+  {
+    // nobody takes batches, so the readers fill what they can hand over and stop reading,
+    // after which writes run out of room and give up
+    bool stalled = false;
+    for (uint16_t seq = 0; not stalled and seq < 10000; ++seq)
+      stalled = not WriteNumbered(queues.pairs[0][1], 0, seq);
+    CHECK(stalled);
+    CHECK(errno == EAGAIN);
+  }
+
+  const auto started = std::chrono::steady_clock::now();
+  readers.Stop();
+  CHECK(std::chrono::steady_clock::now() - started < 1s);
+  // stopping twice is harmless, and nothing is read after
+  readers.Stop();
+  CHECK(readers.Next().sz == 0);
+}
+
+TEST_CASE("tun queue writes wait for room rather than drop", "[vpn]")
+{
+  Queues queues{1};
+  const int fd = queues.pairs[0][1];
+  const auto fill = [fd] {
+    std::array<byte_t, 40> pkt{};
+    while (::write(fd, pkt.data(), pkt.size()) > 0)
+      ;
+    REQUIRE(errno == EAGAIN);
+  };
+
+  fill();
+  std::thread reader{[&] {
+    std::this_thread::sleep_for(20ms);
+    std::array<byte_t, 40> pkt{};
+    while (::read(queues.pairs[0][0], pkt.data(), pkt.size()) > 0)
+      ;
+  }};
+  CHECK(WriteNumbered(fd, 0, 0));
+  reader.join();
+
+  // with nobody reading we give up after a while
+  fill();
+  CHECK_FALSE(WriteNumbered(fd, 0, 1));
+  CHECK(errno == EAGAIN);
+}
+#endif